@@ -8,13 +8,27 @@ set(llfio_HEADERS
   "include/llfio/ntkernel-error-category/include/ntkernel-error-category/detail/ntkernel_category_impl.ipp"
   "include/llfio/ntkernel-error-category/include/ntkernel-error-category/ntkernel_category.hpp"
   "include/llfio/revision.hpp"
+  "include/llfio/v2.0/algorithm/aligned_buffer_pool.hpp"
+  "include/llfio/v2.0/algorithm/block_cache.hpp"
   "include/llfio/v2.0/algorithm/clone.hpp"
   "include/llfio/v2.0/algorithm/contents.hpp"
+  "include/llfio/v2.0/algorithm/deduplicate.hpp"
   "include/llfio/v2.0/algorithm/difference.hpp"
+  "include/llfio/v2.0/algorithm/handle_adapter/block_cached.hpp"
+  "include/llfio/v2.0/algorithm/handle_adapter/bounce_buffered.hpp"
+  "include/llfio/v2.0/algorithm/handle_adapter/buffered.hpp"
   "include/llfio/v2.0/algorithm/handle_adapter/cached_parent.hpp"
+  "include/llfio/v2.0/algorithm/handle_adapter/checksummed.hpp"
   "include/llfio/v2.0/algorithm/handle_adapter/combining.hpp"
+  "include/llfio/v2.0/algorithm/handle_adapter/compressed.hpp"
+  "include/llfio/v2.0/algorithm/handle_adapter/cow_overlay.hpp"
+  "include/llfio/v2.0/algorithm/handle_adapter/erasure_coded.hpp"
+  "include/llfio/v2.0/algorithm/handle_adapter/striped.hpp"
   "include/llfio/v2.0/algorithm/handle_adapter/xor.hpp"
+  "include/llfio/v2.0/algorithm/parallel_copy.hpp"
+  "include/llfio/v2.0/algorithm/readahead.hpp"
   "include/llfio/v2.0/algorithm/reduce.hpp"
+  "include/llfio/v2.0/algorithm/scan_stream.hpp"
   "include/llfio/v2.0/algorithm/shared_fs_mutex/atomic_append.hpp"
   "include/llfio/v2.0/algorithm/shared_fs_mutex/base.hpp"
   "include/llfio/v2.0/algorithm/shared_fs_mutex/byte_ranges.hpp"
@@ -23,21 +37,35 @@ set(llfio_HEADERS
   "include/llfio/v2.0/algorithm/shared_fs_mutex/safe_byte_ranges.hpp"
   "include/llfio/v2.0/algorithm/summarize.hpp"
   "include/llfio/v2.0/algorithm/traverse.hpp"
+  "include/llfio/v2.0/algorithm/tree_digest.hpp"
   "include/llfio/v2.0/algorithm/trivial_vector.hpp"
+  "include/llfio/v2.0/algorithm/write_behind.hpp"
   "include/llfio/v2.0/byte_io_handle.hpp"
   "include/llfio/v2.0/byte_io_multiplexer.hpp"
   "include/llfio/v2.0/byte_socket_handle.hpp"
   "include/llfio/v2.0/config.hpp"
   "include/llfio/v2.0/deadline.h"
+  "include/llfio/v2.0/detail/impl/aligned_buffer_pool.ipp"
+  "include/llfio/v2.0/detail/impl/block_cache.ipp"
   "include/llfio/v2.0/detail/impl/byte_io_multiplexer.ipp"
   "include/llfio/v2.0/detail/impl/byte_socket_handle.ipp"
   "include/llfio/v2.0/detail/impl/cached_parent_handle_adapter.ipp"
+  "include/llfio/v2.0/detail/impl/checksummed_handle_adapter.ipp"
   "include/llfio/v2.0/detail/impl/clone.ipp"
+  "include/llfio/v2.0/detail/impl/combining_kernels.ipp"
+  "include/llfio/v2.0/detail/impl/compressed_handle_adapter.ipp"
   "include/llfio/v2.0/detail/impl/config.ipp"
+  "include/llfio/v2.0/detail/impl/cpu_features.hpp"
+  "include/llfio/v2.0/detail/impl/deduplicate.ipp"
+  "include/llfio/v2.0/detail/impl/difference.ipp"
   "include/llfio/v2.0/detail/impl/dynamic_thread_pool_group.ipp"
+  "include/llfio/v2.0/detail/impl/erasure_coded_handle_adapter.ipp"
   "include/llfio/v2.0/detail/impl/fast_random_file_handle.ipp"
+  "include/llfio/v2.0/detail/impl/file_handle.ipp"
   "include/llfio/v2.0/detail/impl/getaddrinfo_category.hpp"
   "include/llfio/v2.0/detail/impl/map_handle.ipp"
+  "include/llfio/v2.0/detail/impl/parallel_copy.ipp"
+  "include/llfio/v2.0/detail/impl/parallel_for_each.hpp"
   "include/llfio/v2.0/detail/impl/path_discovery.ipp"
   "include/llfio/v2.0/detail/impl/path_view.ipp"
   "include/llfio/v2.0/detail/impl/posix/byte_io_handle.ipp"
@@ -60,13 +88,16 @@ set(llfio_HEADERS
   "include/llfio/v2.0/detail/impl/posix/symlink_handle.ipp"
   "include/llfio/v2.0/detail/impl/posix/test/io_uring_multiplexer.ipp"
   "include/llfio/v2.0/detail/impl/posix/utils.ipp"
+  "include/llfio/v2.0/detail/impl/readahead.ipp"
   "include/llfio/v2.0/detail/impl/reduce.ipp"
   "include/llfio/v2.0/detail/impl/safe_byte_ranges.ipp"
+  "include/llfio/v2.0/detail/impl/scan_stream.ipp"
   "include/llfio/v2.0/detail/impl/storage_profile.ipp"
   "include/llfio/v2.0/detail/impl/test/null_multiplexer.ipp"
   "include/llfio/v2.0/detail/impl/tls_socket_handle.ipp"
   "include/llfio/v2.0/detail/impl/tls_socket_sources/openssl.ipp"
   "include/llfio/v2.0/detail/impl/traverse.ipp"
+  "include/llfio/v2.0/detail/impl/tree_digest.ipp"
   "include/llfio/v2.0/detail/impl/windows/byte_io_handle.ipp"
   "include/llfio/v2.0/detail/impl/windows/byte_io_multiplexer.ipp"
   "include/llfio/v2.0/detail/impl/windows/byte_socket_handle.ipp"
@@ -89,6 +120,7 @@ set(llfio_HEADERS
   "include/llfio/v2.0/detail/impl/windows/test/iocp_multiplexer.ipp"
   "include/llfio/v2.0/detail/impl/windows/tls_socket_sources/schannel.ipp"
   "include/llfio/v2.0/detail/impl/windows/utils.ipp"
+  "include/llfio/v2.0/detail/impl/write_behind.ipp"
   "include/llfio/v2.0/directory_handle.hpp"
   "include/llfio/v2.0/dynamic_thread_pool_group.hpp"
   "include/llfio/v2.0/fast_random_file_handle.hpp"
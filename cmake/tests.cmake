@@ -1,19 +1,33 @@
 # DO NOT EDIT, GENERATED BY SCRIPT
 set(llfio_TESTS
   "test/test_kernel_decl.hpp"
+  "test/tests/bounce_buffered.cpp"
+  "test/tests/buffered.cpp"
+  "test/tests/byte_io_handle_multiple.cpp"
   "test/tests/byte_socket_handle.cpp"
   "test/tests/clone_extents.cpp"
+  "test/tests/contents_stream.cpp"
   "test/tests/current_path.cpp"
+  "test/tests/deduplicate.cpp"
+  "test/tests/difference.cpp"
   "test/tests/directory_handle_create_close/kernel_directory_handle.cpp.hpp"
   "test/tests/directory_handle_create_close/runner.cpp"
   "test/tests/directory_handle_enumerate/kernel_directory_handle_enumerate.cpp.hpp"
   "test/tests/directory_handle_enumerate/runner.cpp"
+  "test/tests/directory_handle_fill_metadata.cpp"
   "test/tests/dynamic_thread_pool_group.cpp"
   "test/tests/extended_attributes.cpp"
   "test/tests/fast_random_file_handle.cpp"
   "test/tests/file_handle_create_close/kernel_file_handle.cpp.hpp"
   "test/tests/file_handle_create_close/runner.cpp"
   "test/tests/file_handle_lock_unlock.cpp"
+  "test/tests/file_handle_ranges.cpp"
+  "test/tests/handle_adapter_block_cached.cpp"
+  "test/tests/handle_adapter_checksummed.cpp"
+  "test/tests/handle_adapter_compressed.cpp"
+  "test/tests/handle_adapter_cow_overlay.cpp"
+  "test/tests/handle_adapter_erasure_coded.cpp"
+  "test/tests/handle_adapter_striped.cpp"
   "test/tests/handle_adapter_xor.cpp"
   "test/tests/issue0009.cpp"
   "test/tests/issue0027.cpp"
@@ -25,11 +39,14 @@ set(llfio_TESTS
   "test/tests/map_handle_create_close/runner.cpp"
   "test/tests/mapped.cpp"
   "test/tests/mapped_file_handle.cpp"
+  "test/tests/parallel_copy.cpp"
   "test/tests/path_discovery.cpp"
   "test/tests/path_view.cpp"
   "test/tests/pipe_handle.cpp"
   "test/tests/process_handle.cpp"
+  "test/tests/readahead.cpp"
   "test/tests/reduce.cpp"
+  "test/tests/scan_stream.cpp"
   "test/tests/section_handle_create_close/kernel_section_handle.cpp.hpp"
   "test/tests/section_handle_create_close/runner.cpp"
   "test/tests/shared_fs_mutex.cpp"
@@ -38,8 +55,10 @@ set(llfio_TESTS
   "test/tests/symlink_handle_create_close/runner.cpp"
   "test/tests/tls_socket_handle.cpp"
   "test/tests/traverse.cpp"
+  "test/tests/tree_digest.cpp"
   "test/tests/trivial_vector.cpp"
   "test/tests/utils.cpp"
+  "test/tests/write_behind.cpp"
 )
 # DO NOT EDIT, GENERATED BY SCRIPT
 set(llfio_COMPILE_TESTS
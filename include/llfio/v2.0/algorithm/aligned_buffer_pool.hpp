@@ -0,0 +1,133 @@
+/* A pool of aligned i/o buffers
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#ifndef LLFIO_ALGORITHM_ALIGNED_BUFFER_POOL_HPP
+#define LLFIO_ALGORITHM_ALIGNED_BUFFER_POOL_HPP
+
+#include "../map_handle.hpp"
+
+//! \file aligned_buffer_pool.hpp Provides a pool of aligned i/o buffers.
+
+LLFIO_V2_NAMESPACE_BEGIN
+
+namespace algorithm
+{
+  namespace detail
+  {
+    struct aligned_buffer_pool_impl;
+  }
+
+  /*! \class aligned_buffer_pool
+  \brief A pool of fixed size, aligned, i/o buffers carved out of a single `map_handle`.
+
+  Unbuffered i/o (`caching::none`) requires buffers aligned to the device's block
+  size, and mapping a fresh region for every i/o is expensive. This pool maps one
+  region up front and hands out slices of it as `byte_io_handle::registered_buffer_type`,
+  which return themselves to the pool when the last reference to them is released.
+
+  As the buffers are registered buffer types, they can be passed to the
+  `read(registered_buffer_type, ...)` and `write(registered_buffer_type, ...)`
+  overloads of `byte_io_handle`. As every buffer lies within `region()`, a
+  multiplexer which needs buffers registered up front (e.g. io_uring's fixed buffers)
+  can register the whole region once, and then use `index_of()` to find the index of
+  any buffer handed out.
+
+  If the pool is exhausted, or more bytes are requested than `buffer_size()`,
+  `allocate()` falls back to mapping a new buffer of its own if `config::fallback_to_mapping`
+  is set, otherwise it fails with `errc::resource_unavailable_try_again`. Buffers
+  obtained this way have no index.
+
+  Copies of this object refer to the same pool, and the pool's region is not
+  released until all copies, and all buffers handed out, have been destroyed.
+  The pool is threadsafe.
+  */
+  class LLFIO_DECL aligned_buffer_pool
+  {
+  public:
+    using registered_buffer_type = byte_io_handle::registered_buffer_type;
+
+    //! Configuration for the pool.
+    struct config
+    {
+      //! The size of each buffer. Zero means `utils::file_buffer_default_size()`. Rounded up to `alignment`.
+      size_t buffer_size{0};
+      //! The number of buffers in the pool.
+      size_t buffers{16};
+      //! The alignment of each buffer, which must be a power of two. Zero means `utils::page_size()`.
+      size_t alignment{0};
+      //! Whether to map a new buffer when the pool cannot satisfy an allocation.
+      bool fallback_to_mapping{true};
+    };
+
+  private:
+    std::shared_ptr<detail::aligned_buffer_pool_impl> _p;
+
+    explicit aligned_buffer_pool(std::shared_ptr<detail::aligned_buffer_pool_impl> p)
+        : _p(std::move(p))
+    {
+    }
+
+  public:
+    //! Default constructor, creating an invalid pool.
+    aligned_buffer_pool() = default;
+
+    //! Creates a pool.
+    static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<aligned_buffer_pool> create(config c) noexcept;
+    //! \overload
+    static result<aligned_buffer_pool> create() noexcept { return create(config()); }
+
+    //! True if the pool is valid.
+    bool is_valid() const noexcept { return _p != nullptr; }
+    //! The size of each buffer in the pool.
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC size_t buffer_size() const noexcept;
+    //! The alignment of each buffer in the pool.
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC size_t alignment() const noexcept;
+    //! The number of buffers in the pool.
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC size_t buffers() const noexcept;
+    //! The number of buffers currently available in the pool.
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC size_t available() const noexcept;
+    //! The region of memory from which all pooled buffers are carved, for registering with a multiplexer.
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC span<byte> region() const noexcept;
+    //! The index within the pool of a buffer, or `(size_t) -1` if it did not come from the pool.
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC size_t index_of(const registered_buffer_type &b) const noexcept;
+
+    /*! \brief Returns a buffer of at least `bytes`, which is `buffer_size()` if zero.
+
+    The buffer returned may be larger than requested. Its contents are whatever was
+    last written into it.
+    */
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<registered_buffer_type> allocate(size_t bytes = 0) noexcept;
+  };
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
+
+#if LLFIO_HEADERS_ONLY == 1 && !defined(DOXYGEN_SHOULD_SKIP_THIS)
+#define LLFIO_INCLUDED_BY_HEADER 1
+#include "../detail/impl/aligned_buffer_pool.ipp"
+#undef LLFIO_INCLUDED_BY_HEADER
+#endif
+
+#endif
@@ -0,0 +1,183 @@
+/* A sharded user space block cache for file handles
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+
+#ifndef LLFIO_ALGORITHM_BLOCK_CACHE_HPP
+#define LLFIO_ALGORITHM_BLOCK_CACHE_HPP
+
+#include "../map_handle.hpp"
+
+//! \file block_cache.hpp Provides a sharded user space block cache for file handles.
+
+LLFIO_V2_NAMESPACE_BEGIN
+
+namespace algorithm
+{
+  namespace detail
+  {
+    struct block_cache_impl;
+  }
+
+  /*! \class block_cache
+  \brief A user space cache of fixed size blocks of files, shared between any number of
+  file handles, with ARC replacement.
+
+  Files opened with `caching::none` bypass the kernel page cache, which avoids caching
+  everything twice when the application has its own cache, but leaves nothing cached
+  at all if it does not. This class is such a cache, with an explicit capacity, which
+  any number of handles can share.
+
+  The memory for the cache is a single `map_handle` of `config::capacity` bytes, divided
+  into frames of `config::block_size` bytes. Frames are page aligned, and blocks are read
+  from the file whole at block aligned offsets, so reads through the cache satisfy the
+  alignment requirements of `caching::none` whatever the alignment of the reads made of
+  the cache. Blocks are keyed by the `unique_id()` of the file and the block index, so
+  different handles to the same inode share cached blocks.
+
+  To reduce lock contention, the cache is divided into `config::shards` shards, each with
+  its own lock and a share of the frames, with blocks assigned to shards by hash. Each
+  shard uses Adaptive Replacement Cache (ARC) replacement: blocks used once are kept in
+  one list, blocks used more than once in another, and the balance between the two is
+  adapted using the history of recently evicted blocks. This keeps a one-off scan of a
+  large file from evicting the frequently used blocks.
+
+  Writes through the cache are written through to the file, and any cached copies of the
+  blocks written are updated. Only whole blocks are cached, so the partial last block of
+  a file is always read from the file. Anything which modifies a file other than writing
+  through this cache, such as truncation, other processes, or deleting the file and
+  reusing its inode, must be followed by `invalidate()`.
+
+  `prefetch()` reads blocks into the cache without copying them anywhere, for example
+  when the application knows what it will read next.
+
+  Copies of this object refer to the same cache, and its memory is not released until
+  all copies have been destroyed. The cache is threadsafe.
+  */
+  class LLFIO_DECL block_cache
+  {
+  public:
+    using extent_type = file_handle::extent_type;
+    using size_type = file_handle::size_type;
+    using buffer_type = file_handle::buffer_type;
+    using const_buffer_type = file_handle::const_buffer_type;
+    using buffers_type = file_handle::buffers_type;
+    using const_buffers_type = file_handle::const_buffers_type;
+    template <class T> using io_request = file_handle::io_request<T>;
+    template <class T> using io_result = file_handle::io_result<T>;
+
+    //! Configuration for the block cache.
+    struct config
+    {
+      //! The number of bytes of memory to use for cached blocks. This is rounded down to a whole number of blocks per shard.
+      size_t capacity{64 * 1024 * 1024};
+      //! The size of block in which files are cached, which is rounded up to a multiple of the page size.
+      size_t block_size{65536};
+      //! The number of shards. Zero means twice the number of hardware threads, rounded up to a power of two.
+      size_t shards{0};
+    };
+
+    //! Statistics about the block cache, summed over all shards.
+    struct statistics
+    {
+      //! The number of blocks read which were found in the cache.
+      uint64_t hits{0};
+      //! The number of blocks read which had to be read from the file.
+      uint64_t misses{0};
+      //! Of the misses, the number of blocks which had recently been evicted, which adapts the replacement policy.
+      uint64_t ghost_hits{0};
+      //! The number of blocks read into the cache by `prefetch()`.
+      uint64_t prefetches{0};
+      //! The number of blocks evicted to make room for others.
+      uint64_t evictions{0};
+      //! The number of cached blocks removed by `invalidate()`.
+      uint64_t invalidations{0};
+      //! The number of blocks currently cached.
+      size_t resident_blocks{0};
+    };
+
+  private:
+    std::shared_ptr<detail::block_cache_impl> _p;
+
+    explicit block_cache(std::shared_ptr<detail::block_cache_impl> p)
+        : _p(std::move(p))
+    {
+    }
+
+  public:
+    //! Default constructor, creating an invalid cache.
+    block_cache() = default;
+
+    //! Creates a cache.
+    static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<block_cache> create(config c) noexcept;
+    //! \overload
+    static result<block_cache> create() noexcept { return create(config()); }
+
+    //! True if the cache is valid.
+    bool is_valid() const noexcept { return _p != nullptr; }
+    //! The number of bytes of blocks which can be cached.
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC size_t capacity() const noexcept;
+    //! The size of the blocks cached.
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC size_t block_size() const noexcept;
+    //! The number of shards.
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC size_t shards() const noexcept;
+    //! Statistics summed over all shards.
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC statistics stats() const noexcept;
+    //! Resets the counters in the statistics to zero.
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void reset_stats() noexcept;
+
+    /*! \brief Reads from `h` through the cache.
+
+    The blocks covering the request which are cached are copied from the cache. Runs of
+    consecutive blocks which are not are read from `h` whole in a single read, copied to
+    the request, and added to the cache. A short read from `h` is taken to be the end of
+    the file.
+    */
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC io_result<buffers_type> read(file_handle &h, io_request<buffers_type> reqs, deadline d = deadline()) noexcept;
+    /*! \brief Writes to `h`, then updates any cached copies of the blocks written with the
+    bytes which were written.
+    */
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC io_result<const_buffers_type> write(file_handle &h, io_request<const_buffers_type> reqs, deadline d = deadline()) noexcept;
+    /*! \brief Reads the blocks covering `bytes` at `offset` of `h` which are not cached
+    into the cache, returning how many of the bytes lie within the file.
+    */
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<extent_type> prefetch(file_handle &h, extent_type offset, extent_type bytes, deadline d = deadline()) noexcept;
+    //! \brief Removes any cached blocks of `h` overlapping `bytes` at `offset`, which default to the whole file.
+    void invalidate(const file_handle &h, extent_type offset = 0, extent_type bytes = (extent_type) -1) noexcept { invalidate(h.unique_id(), offset, bytes); }
+    //! \overload
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void invalidate(const file_handle::unique_id_type &id, extent_type offset = 0, extent_type bytes = (extent_type) -1) noexcept;
+    //! \brief Removes all cached blocks.
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void clear() noexcept;
+  };
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
+
+#if LLFIO_HEADERS_ONLY == 1 && !defined(DOXYGEN_SHOULD_SKIP_THIS)
+#define LLFIO_INCLUDED_BY_HEADER 1
+#include "../detail/impl/block_cache.ipp"
+#undef LLFIO_INCLUDED_BY_HEADER
+#endif
+
+#endif
@@ -34,6 +34,9 @@ LLFIO_V2_NAMESPACE_BEGIN
 
 namespace algorithm
 {
+  //! The size of file at and above which `clone_or_copy()` copies using `parallel_copy()`, if it is available.
+  static constexpr file_handle::extent_type parallel_copy_threshold = 64 * 1024 * 1024;
+
   /*! \brief Clone or copy the extents of the filesystem entity identified by `src`
   to `destdir` optionally renamed to `destleaf`.
 
@@ -50,6 +53,9 @@ namespace algorithm
   modified timestamp (and permissions on POSIX) to the source, it is NOT copied, and
   zero is returned.
   \param d Deadline by which to complete the operation.
+  \param method If not null, the methods by which the content was transferred are
+  OR-ed into it. This lets you tell whether the destination is a cheap snapshot of
+  the source sharing its storage (`file_handle::clone_method::reflinked`), or a copy.
 
   Firstly, a `file_handle` is constructed at the destination using `creation`,
   which defaults to always creating a new inode. The caching used for the
@@ -67,7 +73,9 @@ namespace algorithm
   destination file is unlinked and an error code comparing equal to
   `errc::no_space_on_device` is returned.
 
-  Next, `file_handle::clone_extents()` with `emulate_if_unsupported = true` is
+  Next, if the source is at least `parallel_copy_threshold` bytes long, `parallel_copy()`
+  is used to copy the allocated extents of the source using many concurrent streams.
+  Otherwise `file_handle::clone_extents()` with `emulate_if_unsupported = true` is
   called on the whole file content. This copies only the allocated extents in
   blocks sized whatever is the large page size on this platform (2Mb on x64).
 
@@ -78,7 +86,7 @@ namespace algorithm
   LLFIO_HEADERS_ONLY_FUNC_SPEC result<file_handle::extent_type> clone_or_copy(file_handle &src, const path_handle &destdir, path_view destleaf = {},
                                                                               bool preserve_timestamps = true, bool force_copy_now = false,
                                                                               file_handle::creation creation = file_handle::creation::always_new,
-                                                                              deadline d = {}) noexcept;
+                                                                              deadline d = {}, file_handle::clone_method *method = nullptr) noexcept;
 
 #if 0
 #ifdef _MSC_VER
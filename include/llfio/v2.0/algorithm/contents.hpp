@@ -27,6 +27,8 @@ Distributed under the Boost Software License, Version 1.0.
 
 #include "traverse.hpp"
 
+#include "../symlink_handle.hpp"
+
 #include <memory>
 #include <mutex>
 
@@ -71,20 +73,25 @@ namespace algorithm
     friend inline result<contents_type> contents(const path_handle &dirh, contents_visitor *visitor, size_t threads, bool force_slow_path) noexcept;
 
   protected:
-    struct _state_type
+    struct _state_base
     {
       const path_handle &rootdirh;
       std::atomic<size_t> rootdirpathlen{0};
       std::atomic<stat_t::want> metadata{stat_t::want::all};
+
+      explicit _state_base(const path_handle &_rootdirh)
+          : rootdirh(_rootdirh)
+      {
+      }
+    };
+    struct _state_type : _state_base
+    {
       contents_type contents;
 
       std::mutex lock;
       std::vector<std::shared_ptr<contents_type>> all_thread_contents;
 
-      explicit _state_type(const path_handle &_rootdirh)
-          : rootdirh(_rootdirh)
-      {
-      }
+      using _state_base::_state_base;
     };
 
     static std::shared_ptr<contents_type> _thread_contents(_state_type *state) noexcept
@@ -109,6 +116,85 @@ namespace algorithm
       }
     }
 
+    /* Calculates the path of `dirh` relative to the root into `dirhpath`, and fetches
+    the metadata missing from the entries in a single batch. Returns the metadata which
+    still needs to be fetched for each entry, and reduces `count` by the entries which
+    can't be stat'd.
+    */
+    result<stat_t::want> _prepare(_state_base *state, const directory_handle &dirh, directory_handle::buffers_type &contents, filesystem::path &dirhpath,
+                                  size_t &count) const
+    {
+      for(;;)
+      {
+        OUTCOME_TRY(dirhpath, dirh.current_path());
+        auto rootdirpathlen = state->rootdirpathlen.load(std::memory_order_relaxed);
+        if(dirhpath.native().size() <= rootdirpathlen)
+        {
+          // This is the root
+          dirhpath.clear();
+          break;
+        }
+        dirhpath = dirhpath.native().substr(rootdirpathlen);
+        auto r = directory_handle::directory(state->rootdirh, dirhpath);
+        if(r && r.value().unique_id() == dirh.unique_id())
+        {
+          break;
+        }
+        OUTCOME_TRY(dirhpath, state->rootdirh.current_path());
+        state->rootdirpathlen.store(dirhpath.native().size() + 1, std::memory_order_relaxed);
+      }
+      auto _metadata_ = state->metadata.load(std::memory_order_relaxed);
+      if((_metadata_ & (contents_include_metadata | contents.metadata())) != _metadata_)
+      {
+        state->metadata.store(_metadata_ & (contents_include_metadata | contents.metadata()), std::memory_order_relaxed);
+      }
+      auto need_stat = contents_include_metadata & ~contents.metadata();
+      count = contents.size();
+      if(need_stat)
+      {
+        // Fetch the missing metadata for all entries in a single batch, dropping
+        // entries which can't be stat'd. If batching fails entirely, fall back
+        // to opening each entry in turn.
+        if(auto failed = dirh.fill_metadata(contents, need_stat))
+        {
+          count -= failed.value();
+          need_stat = stat_t::want::none;
+        }
+      }
+      return need_stat;
+    }
+    // Whether `entry` is to be included, fetching any metadata still needed
+    result<bool> _include(const directory_handle &dirh, directory_entry &entry, stat_t::want need_stat) const
+    {
+      if((contents_include_files && entry.stat.st_type == filesystem::file_type::regular) ||
+         (contents_include_directories && entry.stat.st_type == filesystem::file_type::directory) ||
+         (contents_include_symlinks && entry.stat.st_type == filesystem::file_type::symlink))
+      {
+        if(!need_stat)
+        {
+          return true;
+        }
+        if(entry.stat.st_type == filesystem::file_type::symlink)
+        {
+          // Stat the link rather than its target, as fill_metadata() does
+          auto r = symlink_handle::symlink(dirh, entry.leafname);
+          if(r)
+          {
+            OUTCOME_TRY(entry.stat.fill(r.value(), need_stat));
+            return true;
+          }
+          return false;
+        }
+        auto r = file_handle::file(dirh, entry.leafname, file_handle::mode::attr_read);
+        if(r)
+        {
+          OUTCOME_TRY(entry.stat.fill(r.value(), need_stat));
+          return true;
+        }
+      }
+      return false;
+    }
+
   public:
     /*! \brief The default implementation accumulates the contents into thread
     local storage. At traverse end, all the thread local storages are coalesced
@@ -122,50 +208,17 @@ namespace algorithm
         (void) depth;
         if(!contents.empty())
         {
-          contents_type toadd;
-          toadd.reserve(contents.size());
           filesystem::path dirhpath;
-          for(;;)
-          {
-            OUTCOME_TRY(dirhpath, dirh.current_path());
-            auto rootdirpathlen = state->rootdirpathlen.load(std::memory_order_relaxed);
-            if(dirhpath.native().size() <= rootdirpathlen)
-            {
-              break;
-            }
-            dirhpath = dirhpath.native().substr(rootdirpathlen);
-            auto r = directory_handle::directory(state->rootdirh, dirhpath);
-            if(r && r.value().unique_id() == dirh.unique_id())
-            {
-              break;
-            }
-            OUTCOME_TRY(dirhpath, state->rootdirh.current_path());
-            state->rootdirpathlen.store(dirhpath.native().size() + 1, std::memory_order_relaxed);
-          }
-          auto _metadata_ = state->metadata.load(std::memory_order_relaxed);
-          if((_metadata_ & (contents_include_metadata | contents.metadata())) != _metadata_)
-          {
-            state->metadata.store(_metadata_ & (contents_include_metadata | contents.metadata()), std::memory_order_relaxed);
-          }
+          size_t count = 0;
+          OUTCOME_TRY(auto &&need_stat, _prepare(state, dirh, contents, dirhpath, count));
           auto into = _thread_contents(state);
-          for(auto &entry : contents)
+          for(size_t n = 0; n < count; n++)
           {
-            auto need_stat = contents_include_metadata & ~contents.metadata();
-            if((contents_include_files && entry.stat.st_type == filesystem::file_type::regular) ||
-               (contents_include_directories && entry.stat.st_type == filesystem::file_type::directory) ||
-               (contents_include_symlinks && entry.stat.st_type == filesystem::file_type::symlink))
+            auto &entry = contents[n];
+            OUTCOME_TRY(auto &&include, _include(dirh, entry, need_stat));
+            if(include)
             {
-              if(!need_stat)
-              {
-                into->emplace_back(dirhpath / entry.leafname, entry.stat);
-                continue;
-              }
-              auto r = file_handle::file(dirh, entry.leafname, file_handle::mode::attr_read);
-              if(r)
-              {
-                OUTCOME_TRY(entry.stat.fill(r.value(), need_stat));
-                into->emplace_back(dirhpath / entry.leafname, entry.stat);
-              }
+              into->emplace_back(dirhpath / entry.leafname, entry.stat);
             }
           }
         }
@@ -219,6 +272,9 @@ namespace algorithm
 
   It is race free to concurrent relocations of `dirh`. It is entirely implemented
   in header-only code, as it is very simple.
+
+  As a full path is stored per entry, memory consumption grows with the size of
+  the tree. For very large trees, consider `contents_stream()` instead.
   */
   inline result<contents_visitor::contents_type> contents(const path_handle &dirh, contents_visitor *visitor = nullptr, size_t threads = 0,
                                                           bool force_slow_path = false) noexcept
@@ -235,6 +291,159 @@ namespace algorithm
     return {std::move(state.contents)};
   }
 
+  /*! \brief One directory's worth of contents, as emitted by `contents_stream()`.
+
+  Rather than a full path per entry, each batch carries the path of its directory
+  relative to the root once, and the leafnames of its entries packed into a single
+  arena. Batches are reused by each thread of the traversal, so their storage is
+  only ever as large as the largest directory seen by that thread.
+  */
+  struct contents_batch
+  {
+    //! An entry in the batch
+    struct entry_type
+    {
+      //! Offset of the leafname into `leafnames`
+      size_t leafname_offset{0};
+      //! Length of the leafname, excluding its zero terminator
+      size_t leafname_length{0};
+      //! The metadata of the entry, see `metadata` for which parts are valid
+      stat_t stat{nullptr};
+    };
+
+    //! A unique id for this directory within the traversal, assigned in order of enumeration.
+    uint64_t directory_id{0};
+    //! The path of this directory, relative to the root. Empty for the root.
+    filesystem::path directory;
+    //! The metadata valid within all the `stat_t` in `entries`, which may vary between directories.
+    stat_t::want metadata{stat_t::want::none};
+    //! The entries within this directory
+    std::vector<entry_type> entries;
+    //! Zero terminated leafnames of `entries`, packed end to end
+    std::vector<filesystem::path::value_type> leafnames;
+
+    //! Returns the leafname of an entry, which is valid until the batch is next reused.
+    path_view leafname(const entry_type &entry) const noexcept
+    {
+      return path_view(leafnames.data() + entry.leafname_offset, entry.leafname_length, path_view::zero_terminated);
+    }
+    //! Empties the batch, keeping its storage
+    void clear() noexcept
+    {
+      directory.clear();
+      entries.clear();
+      leafnames.clear();
+    }
+  };
+
+  /*! \brief A visitor for the filesystem streaming contents algorithm.
+
+  Instead of accumulating the contents, each directory enumerated is passed
+  to `contents_emit()` as a `contents_batch`, from whichever thread enumerated
+  it. Memory consumption is therefore independent of the size of the tree.
+  */
+  struct contents_stream_visitor : contents_visitor
+  {
+    using contents_visitor::contents_visitor;
+
+    friend inline result<size_t> contents_stream(const path_handle &dirh, contents_stream_visitor *visitor, size_t threads, bool force_slow_path) noexcept;
+
+  protected:
+    struct _stream_state_type : _state_base
+    {
+      std::atomic<uint64_t> next_directory_id{0};
+
+      using _state_base::_state_base;
+    };
+
+  public:
+    /*! \brief Called with the contents of each directory, concurrently from
+    multiple kernel threads. `batch` is only valid for the duration of the call.
+    Returning a failure aborts the traversal.
+    */
+    virtual result<void> contents_emit(void *data, const contents_batch &batch) noexcept = 0;
+
+    /*! \brief This implementation fills a thread local `contents_batch` with the
+    included entries of the directory, and emits it if it is not empty.
+    */
+    virtual result<void> post_enumeration(void *data, const directory_handle &dirh, directory_handle::buffers_type &contents, size_t depth) noexcept override
+    {
+      try
+      {
+        auto *state = (_stream_state_type *) data;
+        (void) depth;
+        if(!contents.empty())
+        {
+          static thread_local contents_batch batch;
+          batch.clear();
+          size_t count = 0;
+          OUTCOME_TRY(auto &&need_stat, _prepare(state, dirh, contents, batch.directory, count));
+          batch.entries.reserve(count);
+          for(size_t n = 0; n < count; n++)
+          {
+            auto &entry = contents[n];
+            OUTCOME_TRY(auto &&include, _include(dirh, entry, need_stat));
+            if(include)
+            {
+              path_view::not_zero_terminated_rendered_path<> leaf(entry.leafname);
+              contents_batch::entry_type e;
+              e.leafname_offset = batch.leafnames.size();
+              e.leafname_length = leaf.size();
+              e.stat = entry.stat;
+              batch.leafnames.insert(batch.leafnames.end(), leaf.data(), leaf.data() + leaf.size());
+              batch.leafnames.push_back(0);
+              batch.entries.push_back(e);
+            }
+          }
+          if(!batch.entries.empty())
+          {
+            batch.directory_id = state->next_directory_id.fetch_add(1, std::memory_order_relaxed);
+            batch.metadata = contents_include_metadata | contents.metadata();
+            OUTCOME_TRY(contents_emit(data, batch));
+          }
+        }
+        return success();
+      }
+      catch(...)
+      {
+        return error_from_exception();
+      }
+    }
+
+    //! There is nothing to merge, so this returns the result unmodified.
+    virtual result<size_t> finished(void *data, result<size_t> result) noexcept override
+    {
+      (void) data;
+      return result;
+    }
+  };
+
+  /*! \brief Stream the contents of everything within and under `dirh` to
+  `visitor->contents_emit()`, one directory at a time, in no particular order.
+
+  Unlike `contents()`, this does not hold the contents of the tree in memory,
+  nor does it store a full path per entry. Each `contents_batch` carries its
+  directory's path relative to `dirh` once, plus its entries' leafnames in a
+  single arena, and is reused by the next directory enumerated by the same
+  thread. Memory consumption is thus bounded by the largest directory, rather
+  than by the size of the tree, which suits trees with tens of millions of
+  entries. What to do with each batch, e.g. serialise it to disc, is up to
+  the visitor.
+
+  \return The number of directories traversed, as per `traverse()`.
+  */
+  inline result<size_t> contents_stream(const path_handle &dirh, contents_stream_visitor *visitor, size_t threads = 0, bool force_slow_path = false) noexcept
+  {
+    if(visitor == nullptr)
+    {
+      return errc::invalid_argument;
+    }
+    contents_stream_visitor::_stream_state_type state(dirh);
+    OUTCOME_TRY(auto &&dirhpath, dirh.current_path());
+    state.rootdirpathlen.store(dirhpath.native().size() + 1, std::memory_order_relaxed);
+    return traverse(dirh, visitor, threads, &state, force_slow_path);
+  }
+
 }  // namespace algorithm
 
 LLFIO_V2_NAMESPACE_END
@@ -0,0 +1,134 @@
+/* A filesystem algorithm which deduplicates the content of a directory tree
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#ifndef LLFIO_ALGORITHM_DEDUPLICATE_HPP
+#define LLFIO_ALGORITHM_DEDUPLICATE_HPP
+
+#include "tree_digest.hpp"
+
+#include <vector>
+
+//! \file deduplicate.hpp Provides a directory tree content deduplication algorithm.
+
+LLFIO_V2_NAMESPACE_BEGIN
+
+namespace algorithm
+{
+  /*! \brief Make the `extent.length` bytes of `dest` at `destoffset` share the storage
+  of the bytes of `src` at `extent.offset`, if and only if they have identical content.
+
+  \return The number of bytes now sharing storage, which is less than `extent.length`
+  if the content differs.
+  \param src The file whose storage is to be shared.
+  \param extent The extent of `src` to share.
+  \param dest The file whose storage is to be released. It must be open for writing,
+  unless you own it and your kernel is 4.19 or later.
+  \param destoffset The offset in `dest` of the content to compare and share.
+
+  Unlike `file_handle::clone_extents_to()`, the kernel locks both files and compares
+  their content before remapping, so this is safe in the face of concurrent modification.
+  The offsets and length must be multiples of the filing system block size, except that
+  the extent may end at the end of both files.
+
+  This is implemented using `FIDEDUPERANGE` on Linux, which is supported by btrfs, XFS
+  and others, in steps of 16Mb. On other platforms, or filing systems without support,
+  an error comparing equal to `errc::operation_not_supported` is returned. Windows'
+  `FSCTL_DUPLICATE_EXTENTS_TO_FILE` does not compare the content, so is not used.
+  */
+  LLFIO_HEADERS_ONLY_FUNC_SPEC result<file_handle::extent_type> deduplicate_extents(file_handle &src, file_handle::extent_pair extent, file_handle &dest,
+                                                                                    file_handle::extent_type destoffset) noexcept;
+
+  //! \brief Configuration for `deduplicate()`.
+  struct deduplicate_config
+  {
+    //! Files smaller than this are not worth deduplicating.
+    file_handle::extent_type minimum_size{64 * 1024};
+    //! How many bytes from the front and the back of each candidate to hash before hashing the whole file.
+    size_t partial_hash_bytes{64 * 1024};
+    //! The size of the chunks into which file content is split for hashing in parallel.
+    size_t chunk_size{4 * 1024 * 1024};
+    //! The number of threads to use for traversal, hashing and deduplication, zero means the default.
+    size_t threads{0};
+    //! Passed through to `traverse()`.
+    bool force_slow_path{false};
+    //! If true, duplicates are found, but not deduplicated.
+    bool dry_run{false};
+  };
+
+  //! \brief The result of `deduplicate()`.
+  struct deduplicate_result
+  {
+    /*! Groups of files found to have identical content, each sorted by path. The
+    first in each group is the file whose storage the others now share.
+    */
+    std::vector<std::vector<filesystem::path>> duplicates;
+    //! The number of files which now share storage with another.
+    size_t files_deduplicated{0};
+    //! The number of files which already shared all their storage with another.
+    size_t files_already_shared{0};
+    //! The number of files which could not be deduplicated, due to having changed, disappeared, or lack of permission.
+    size_t files_failed{0};
+    //! The number of bytes which now share storage, and so are reclaimed.
+    file_handle::extent_type bytes_deduplicated{0};
+    //! The number of bytes of content hashed to find the duplicates.
+    file_handle::extent_type bytes_hashed{0};
+  };
+
+  /*! \brief Find the files within and under `dirh` with identical content, and make
+  them share their storage.
+
+  The tree is enumerated using `contents()`, and the regular files of at least
+  `config.minimum_size` bytes are grouped by device and maximum extent. Hard links to
+  the same inode are only considered once. The members of each group of two or more
+  files then have the front and back `config.partial_hash_bytes` of their content
+  hashed, and the members of each subgroup with matching partial hashes then have
+  their entire content hashed. Hashing is split into chunks spread across the dynamic
+  thread pool, in the same way as `tree_digest()`, so only candidates which might be
+  duplicates are ever read in full.
+
+  Each group of files with identical hashes is then deduplicated using
+  `deduplicate_extents()` onto its first member, with the groups deduplicated in
+  parallel. As the kernel compares the content before sharing storage, files modified
+  after being hashed are safely skipped, as are files already sharing all their
+  storage with the first member according to `file_handle::detailed_extents()`.
+
+  If the filing system does not support deduplication, an error comparing equal to
+  `errc::operation_not_supported` is returned, unless `config.dry_run` is true.
+  Only whole files are deduplicated, not identical extents within otherwise
+  differing files.
+  */
+  LLFIO_HEADERS_ONLY_FUNC_SPEC result<deduplicate_result> deduplicate(const path_handle &dirh, const deduplicate_config &config = {}) noexcept;
+
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
+
+#if LLFIO_HEADERS_ONLY == 1 && !defined(DOXYGEN_SHOULD_SKIP_THIS)
+#define LLFIO_INCLUDED_BY_HEADER 1
+#include "../detail/impl/deduplicate.ipp"
+#undef LLFIO_INCLUDED_BY_HEADER
+#endif
+
+#endif
@@ -25,15 +25,17 @@ Distributed under the Boost Software License, Version 1.0.
 #ifndef LLFIO_ALGORITHM_DIFFERENCE_HPP
 #define LLFIO_ALGORITHM_DIFFERENCE_HPP
 
-#include "traverse.hpp"
+#include "contents.hpp"
 
-//! \file compare.hpp Provides a directory tree difference algorithm.
+#include <vector>
+
+//! \file difference.hpp Provides a directory tree difference algorithm.
 
 LLFIO_V2_NAMESPACE_BEGIN
 
 namespace algorithm
 {
-  /*!
+  /*! \brief A difference between two directory trees, as returned by `difference()`.
    */
   struct difference_item
   {
@@ -50,88 +52,88 @@ namespace algorithm
       directory_renamed,            //!< A directory was renamed within this tree
       directory_removed,            //!< A directory was removed
       symlink_added,                //!< A symlink was added
-      symlink_removed               //!< A symlink was removed
+      symlink_removed,              //!< A symlink was removed
+      content_changed               //!< Content differs, though its metadata does not. Only reported if content comparison was requested.
     } changed{change_t::unknown};
     int8_t content_comparison{0};  //!< `memcmp()` of content, if requested
+    //! The path relative to the root of the tree after, or before if removed.
+    filesystem::path path;
+    //! If renamed, the path relative to the root of the tree before. If linked, the path of what it was linked to.
+    filesystem::path previous_path;
+    //! The metadata of the item in the tree before, if it was there.
+    stat_t before{nullptr};
+    //! The metadata of the item in the tree after, if it is there.
+    stat_t after{nullptr};
   };
+
   /*! \brief A visitor for the filesystem traversal and comparison algorithm.
 
-  Note that at any time, returning a failure causes `compare()` to exit as soon
+  Note that at any time, returning a failure causes `difference()` to exit as soon
   as possible with the same failure.
 
-  You can override the members here inherited from `traverse_visitor`, however note
-  that `compare()` is entirely implemented using `traverse()`, so not calling the
-  implementations here will affect operation.
+  You can override the members here inherited from `contents_visitor`, however note
+  that `difference()` is entirely implemented using `contents()` on each tree, so not
+  calling the implementations here will affect operation.
   */
-  struct compare_visitor : public traverse_visitor
+  struct compare_visitor : public contents_visitor
   {
-    //! This override ignores failures to traverse into the directory.
-    virtual result<directory_handle> directory_open_failed(void *data, result<void>::error_type &&error, const directory_handle &dirh, path_view leaf,
-                                                           size_t depth) noexcept override
+    //! The metadata compared by default.
+    static constexpr stat_t::want default_metadata()
+    {
+      return stat_t::want::type | stat_t::want::dev | stat_t::want::ino | stat_t::want::perms | stat_t::want::uid | stat_t::want::gid | stat_t::want::mtim | stat_t::want::size;
+    }
+    //! Default constructor, comparing the default metadata
+    compare_visitor()
+        : contents_visitor(default_metadata())
     {
-      (void) error;
-      (void) dirh;
-      (void) leaf;
-      (void) depth;
-      auto *state = (traversal_summary *) data;
-      lock_guard<spinlock> g(state->_lock);
-      state->directory_opens_failed++;
-      return success();  // ignore failure to enter
     }
-    //! This override implements the summary
-    virtual result<void> post_enumeration(void *data, const directory_handle &dirh, directory_handle::buffers_type &contents, size_t depth) noexcept override
+    //! Construct an instance comparing `metadata`, which must include `type`.
+    explicit compare_visitor(stat_t::want metadata)
+        : contents_visitor(metadata)
     {
-      try
-      {
-        auto *state = (traversal_summary *) data;
-        traversal_summary acc;
-        acc.max_depth = depth;
-        for(auto &entry : contents)
-        {
-          OUTCOME_TRY(accumulate(acc, state, &dirh, entry, contents.metadata()));
-        }
-        state->operator+=(acc);
-        return success();
-      }
-      catch(...)
-      {
-        return error_from_exception();
-      }
     }
   };
 
-  /*! \brief Summarise the directory identified `dirh`, and everything therein.
-
-  It can be useful to summarise a directory hierarchy, especially to determine how
-  much storage it occupies, but also how many mounted filesystems it straddles etc.
-  You should specify what metadata you wish to summarise, if this is a subset of
-  what metadata `directory_handle::read()` returns, performance will be considerably
-  better. The default summarises all possible metadata.
-
-  This is a trivial implementation on top of `algorithm::traverse()`, indeed it is
-  implemented entirely as header code. You should review the documentation for
-  `algorithm::traverse()`, as this algorithm is entirely implemented using that algorithm.
+  /*! \brief Calculate the differences between the directory trees `before` and `after`,
+  sorted by path.
+
+  Each tree has its contents enumerated with `contents()`, and the two are then matched
+  by path. Items whose device and inode appear in both trees, but at different paths, are
+  reported as renamed, or as linked if the original path is still present. This assumes
+  these are comparable between the trees, which is true for one tree compared to an earlier
+  enumeration of itself. Snapshots usually have a device of their own, so to compare a tree
+  with a snapshot of itself, leave `dev` out of the metadata compared. If `ino` is not in
+  the metadata compared, renames are reported as a removal and an addition.
+  The children of a renamed directory are not reported, unless something else changed.
+  Changes of modification time on directories are ignored, as these are caused by
+  changes to their children which are reported anyway.
+
+  If `compare_content` is true, the content of every regular file in both trees is
+  compared, with the result written into `content_comparison`. Files whose content
+  differs without their metadata having changed are reported as `content_changed`.
+  Comparison maps both files and uses the SIMD `combine_compare()`, with files compared
+  in parallel across the dynamic thread pool. Files which disappear before they can be
+  compared are skipped.
+
+  \param before The tree before.
+  \param after The tree after.
+  \param compare_content Whether to compare the content of all regular files.
+  \param visitor An optional visitor, which sets the metadata compared.
+  \param threads The number of threads to use for traversal and comparison, zero means the default.
+  \param force_slow_path Passed through to `traverse()`.
   */
-  inline result<traversal_summary> summarize(const path_handle &dirh, stat_t::want want = traversal_summary::default_metadata(),
-                                             summarize_visitor *visitor = nullptr, size_t threads = 0, bool force_slow_path = false) noexcept
-  {
-    LLFIO_LOG_FUNCTION_CALL(&dirh);
-    summarize_visitor default_visitor;
-    if(visitor == nullptr)
-    {
-      visitor = &default_visitor;
-    }
-    result<traversal_summary> state(in_place_type<traversal_summary>);
-    state.assume_value().want = want;
-    directory_entry entry{{}, stat_t(nullptr)};
-    OUTCOME_TRY(entry.stat.fill(dirh, want));
-    OUTCOME_TRY(summarize_visitor::accumulate(state.assume_value(), &state.assume_value(), nullptr, entry, want));
-    OUTCOME_TRY(traverse(dirh, visitor, threads, &state.assume_value(), force_slow_path));
-    return state;
-  }
+  LLFIO_HEADERS_ONLY_FUNC_SPEC result<std::vector<difference_item>> difference(const path_handle &before, const path_handle &after,
+                                                                               bool compare_content = false, compare_visitor *visitor = nullptr,
+                                                                               size_t threads = 0, bool force_slow_path = false) noexcept;
 
 }  // namespace algorithm
 
 LLFIO_V2_NAMESPACE_END
 
+#if LLFIO_HEADERS_ONLY == 1 && !defined(DOXYGEN_SHOULD_SKIP_THIS)
+#define LLFIO_INCLUDED_BY_HEADER 1
+#include "../detail/impl/difference.ipp"
+#undef LLFIO_INCLUDED_BY_HEADER
+#endif
+
 #endif
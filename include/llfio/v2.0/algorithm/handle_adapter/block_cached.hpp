@@ -0,0 +1,159 @@
+/* A handle adapter reading and writing a file through a block cache
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+
+#ifndef LLFIO_ALGORITHM_HANDLE_ADAPTER_BLOCK_CACHED_H
+#define LLFIO_ALGORITHM_HANDLE_ADAPTER_BLOCK_CACHED_H
+
+#include "../block_cache.hpp"
+#include "combining.hpp"
+
+//! \file handle_adapter/block_cached.hpp Provides `block_cached_handle_adapter`.
+
+LLFIO_V2_NAMESPACE_EXPORT_BEGIN
+
+namespace algorithm
+{
+  namespace detail
+  {
+    template <class Target, class Source> struct block_cached_handle_adapter_op
+    {
+      static_assert(std::is_void<Source>::value, "A second handle is not possible with block_cached_handle_adapter");
+      static_assert(std::is_base_of<file_handle, Target>::value, "block_cached_handle_adapter requires a file handle");
+
+      using buffer_type = typename Target::buffer_type;
+      using const_buffer_type = typename Target::const_buffer_type;
+      using const_buffers_type = typename Target::const_buffers_type;
+
+      // All i/o is done by the overrides below, so these are never called
+      static result<buffer_type> do_read(buffer_type out, buffer_type /*unused*/, buffer_type /*unused*/) noexcept { return out; }
+      static result<const_buffer_type> do_write(buffer_type t, buffer_type /*unused*/, const_buffer_type in) noexcept { return buffer_type{t.data(), in.size()}; }
+      static result<const_buffers_type> adjust_written_buffers(const_buffers_type out, const_buffer_type /*unused*/, const_buffer_type /*unused*/) noexcept
+      {
+        return out;
+      }
+
+      template <class Base> struct override_ : public Base
+      {
+        using path_type = byte_io_handle::path_type;
+        using extent_type = byte_io_handle::extent_type;
+        using size_type = byte_io_handle::size_type;
+        using mode = byte_io_handle::mode;
+        using creation = byte_io_handle::creation;
+        using caching = byte_io_handle::caching;
+        using flag = byte_io_handle::flag;
+        using barrier_kind = byte_io_handle::barrier_kind;
+        using buffer_type = byte_io_handle::buffer_type;
+        using const_buffer_type = byte_io_handle::const_buffer_type;
+        using buffers_type = byte_io_handle::buffers_type;
+        using const_buffers_type = byte_io_handle::const_buffers_type;
+        template <class T> using io_request = byte_io_handle::io_request<T>;
+        template <class T> using io_result = byte_io_handle::io_result<T>;
+
+      protected:
+        block_cache _cache;
+
+      public:
+        override_() = default;
+        //! Constructor. `cache` may be shared with any number of other adapters.
+        override_(Target *a, void *b, mode _mode, flag flags, byte_io_multiplexer *ctx, block_cache cache)
+            : Base(a, b, _mode, flags, ctx)
+            , _cache(std::move(cache))
+        {
+          assert(_cache.is_valid());
+        }
+
+        //! The block cache used.
+        const block_cache &cache() const noexcept { return _cache; }
+        //! \brief Reads the blocks covering `bytes` at `offset` into the cache, if they are not already.
+        result<extent_type> prefetch(extent_type offset, extent_type bytes, deadline d = deadline()) noexcept
+        {
+          return _cache.prefetch(*this->_target, offset, bytes, d);
+        }
+        //! \brief Removes any cached blocks of this file, e.g. after somebody else has modified it.
+        void invalidate(extent_type offset = 0, extent_type bytes = (extent_type) -1) noexcept { _cache.invalidate(*this->_target, offset, bytes); }
+
+      protected:
+        //! Reads from the target through the cache.
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<buffers_type> _do_read(io_request<buffers_type> reqs, deadline d = deadline()) noexcept override
+        {
+          return _cache.read(*this->_target, reqs, d);
+        }
+        //! Writes to the target, updating any cached copies of the blocks written.
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<const_buffers_type> _do_write(io_request<const_buffers_type> reqs, deadline d = deadline()) noexcept override
+        {
+          return _cache.write(*this->_target, reqs, d);
+        }
+        //! \brief Barriers the target handle, as writes are never held in the cache.
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<const_buffers_type> _do_barrier(io_request<const_buffers_type> reqs, barrier_kind kind, deadline d) noexcept override
+        {
+          return this->_target->barrier(reqs, kind, d);
+        }
+
+      public:
+        //! \brief Return the valid extents of the target handle
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<std::vector<file_handle::extent_pair>> extents() const noexcept override { return this->_target->extents(); }
+        //! \brief Truncate the target handle, removing any cached blocks beyond the new size
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> truncate(extent_type newsize) noexcept override
+        {
+          OUTCOME_TRY(auto &&ret, this->_target->truncate(newsize));
+          _cache.invalidate(*this->_target, newsize);
+          return ret;
+        }
+        //! \brief Punches a hole in the target handle, removing any cached blocks overlapping it
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> zero(file_handle::extent_pair extent, deadline d = deadline()) noexcept override
+        {
+          OUTCOME_TRY(auto &&ret, this->_target->zero(extent, d));
+          _cache.invalidate(*this->_target, extent.offset, extent.length);
+          return ret;
+        }
+      };
+    };
+  }  // namespace detail
+
+  /*! \brief A handle which reads and writes a file handle through a `block_cache`.
+  \tparam Target The type of the handle being cached.
+
+  This gives files opened with `caching::none` a user space cache whose capacity and
+  replacement policy are under the control of the application, and which can be shared
+  by many files. Construct with `block_cached_handle_adapter<>(&fh, nullptr, mode, flags,
+  ctx, cache)`.
+
+  Reads are served from the cache where possible, with blocks not cached being read from
+  the target whole, so reads of any size and alignment work with `caching::none`. Writes
+  are written through to the target as they are, so must still meet its alignment
+  requirements, and then update any cached copies of the blocks written. `truncate()` and
+  `zero()` remove the affected blocks from the cache. Call `invalidate()` if the file is
+  modified other than through a `block_cache`.
+
+  `prefetch()` reads blocks into the cache ahead of need.
+  */
+  template <class Target = file_handle> using block_cached_handle_adapter = combining_handle_adapter<detail::block_cached_handle_adapter_op, Target, void>;
+
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
+
+#endif
@@ -0,0 +1,321 @@
+/* Adapts any file handle to transparently bounce unaligned i/o
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#ifndef LLFIO_BOUNCE_BUFFERED_HANDLE_ADAPTER_HPP
+#define LLFIO_BOUNCE_BUFFERED_HANDLE_ADAPTER_HPP
+
+#include "../../file_handle.hpp"
+#include "../../statfs.hpp"
+#include "../aligned_buffer_pool.hpp"
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4251)  // dll interface
+#endif
+
+//! \file handle_adapter/bounce_buffered.hpp Adapts any `file_handle` to accept unaligned i/o when opened with `caching::none`
+LLFIO_V2_NAMESPACE_BEGIN
+
+namespace algorithm
+{
+  /*! \brief Adapts any `construct()`-able `file_handle` to transparently bounce unaligned i/o when the
+  handle requires aligned i/o.
+
+  Handles opened with `caching::none` (`O_DIRECT`) require that the file offset, the buffer
+  addresses and the buffer lengths of every i/o are all aligned to the device's block size.
+  This adapter checks every i/o, and passes through those which are aligned, or all i/o if the
+  handle does not require aligned i/o. Unaligned i/o is instead bounced through an aligned
+  buffer covering the aligned extent of the request. For reads, the aligned extent is read,
+  and the requested portion copied out. For writes, the partial blocks at either edge are
+  first read, the data to be written is copied in over them, and the aligned extent is
+  written. If the aligned write extended the file beyond what was requested, the file is
+  truncated back.
+
+  Bounce buffers are taken from the `aligned_buffer_pool` supplied, if it is valid and its
+  buffers are big enough, otherwise they are freshly mapped. If the pool is valid,
+  `allocate_registered_buffer()` also returns buffers from the pool.
+
+  The alignment defaults to the `f_iosize` reported by `statfs_t`, which is what
+  `storage_profile` reports as `device_min_io_size`, clamped to between 512 bytes and the
+  page size.
+
+  \warning The read-modify-write of the edge blocks is not atomic. Concurrent writers
+  to the same blocks, or concurrent extension of the file, can lose data. Use byte range
+  locks if you need that.
+
+  \note Only i/o issued without a multiplexer is bounced.
+  */
+  template <class T> LLFIO_REQUIRES(sizeof(construct<T>) > 0) class LLFIO_DECL bounce_buffered_handle_adapter : public T
+  {
+    static_assert(sizeof(construct<T>) > 0, "Type T must be registered with the construct<T> framework so bounce_buffered_handle_adapter<T> knows how to construct it");  // NOLINT
+    static_assert(std::is_base_of<file_handle, T>::value, "Type T must be a file_handle");
+
+  public:
+    //! The handle type being adapted
+    using adapted_handle_type = T;
+    using extent_type = typename T::extent_type;
+    using size_type = typename T::size_type;
+    using buffer_type = typename T::buffer_type;
+    using const_buffer_type = typename T::const_buffer_type;
+    using buffers_type = typename T::buffers_type;
+    using const_buffers_type = typename T::const_buffers_type;
+    using registered_buffer_type = typename T::registered_buffer_type;
+    template <class U> using io_request = typename T::template io_request<U>;
+    template <class U> using io_result = typename T::template io_result<U>;
+
+  protected:
+    aligned_buffer_pool _pool;
+    size_t _alignment{0};
+
+    size_t _device_alignment() const noexcept
+    {
+      const size_t pagesize = utils::page_size();
+      statfs_t s;
+      if(!s.fill(*this, statfs_t::want::iosize) || s.f_iosize == (uint64_t) -1 || s.f_iosize == 0 || (s.f_iosize & (s.f_iosize - 1)) != 0)
+      {
+        return pagesize;
+      }
+      // Some network filesystems report their transfer size, which can be megabytes
+      return (size_t) std::max((uint64_t) 512, std::min((uint64_t) pagesize, s.f_iosize));
+    }
+    template <class B> bool _is_aligned(extent_type offset, span<B> buffers) const noexcept
+    {
+      const size_t mask = _alignment - 1;
+      if((offset & mask) != 0)
+      {
+        return false;
+      }
+      for(auto &b : buffers)
+      {
+        if((((uintptr_t) b.data()) & mask) != 0 || (b.size() & mask) != 0)
+        {
+          return false;
+        }
+      }
+      return true;
+    }
+    result<registered_buffer_type> _bounce_buffer(size_t bytes) noexcept
+    {
+      if(_pool.is_valid() && bytes <= _pool.buffer_size())
+      {
+        auto r = _pool.allocate(bytes);
+        if(r)
+        {
+          return r;
+        }
+      }
+      return LLFIO_V2_NAMESPACE::detail::map_handle_allocate_registered_buffer(bytes);
+    }
+    // Reads the block at `blockoffset` into `dest`, zero filling anything beyond the end of the file
+    result<void> _read_block(byte *dest, extent_type blockoffset, deadline d) noexcept
+    {
+      buffer_type b{dest, _alignment};
+      OUTCOME_TRY(auto &&filled, adapted_handle_type::_do_read(io_request<buffers_type>(buffers_type(&b, 1), blockoffset), d));
+      size_t done = 0;
+      for(auto &i : filled)
+      {
+        if(i.data() != dest + done)
+        {
+          memmove(dest + done, i.data(), i.size());
+        }
+        done += i.size();
+      }
+      memset(dest + done, 0, _alignment - done);
+      return success();
+    }
+
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<registered_buffer_type> _do_allocate_registered_buffer(size_t &bytes) noexcept override
+    {
+      if(_pool.is_valid() && bytes <= _pool.buffer_size())
+      {
+        auto r = _pool.allocate(bytes);
+        if(r)
+        {
+          bytes = r.value()->size();
+          return r;
+        }
+      }
+      return adapted_handle_type::_do_allocate_registered_buffer(bytes);
+    }
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<buffers_type> _do_read(io_request<buffers_type> reqs, deadline d) noexcept override
+    {
+      LLFIO_LOG_FUNCTION_CALL(this);
+      if(!this->requires_aligned_io() || _is_aligned(reqs.offset, reqs.buffers))
+      {
+        return adapted_handle_type::_do_read(reqs, d);
+      }
+      size_t bytes = 0;
+      for(auto &b : reqs.buffers)
+      {
+        bytes += b.size();
+      }
+      const extent_type mask = _alignment - 1;
+      const extent_type begin = reqs.offset & ~mask, end = (reqs.offset + bytes + mask) & ~mask;
+      OUTCOME_TRY(auto &&bounce, _bounce_buffer((size_t) (end - begin)));
+      buffer_type b{bounce->data(), (size_t) (end - begin)};
+      OUTCOME_TRY(auto &&filled, adapted_handle_type::_do_read(io_request<buffers_type>(buffers_type(&b, 1), begin), d));
+      // The file may have been shorter than the aligned extent
+      const byte *src = filled.empty() ? bounce->data() : filled[0].data();
+      size_t avail = 0;
+      for(auto &i : filled)
+      {
+        avail += i.size();
+      }
+      const size_t skip = (size_t) (reqs.offset - begin);
+      src += skip;
+      avail = (avail > skip) ? (avail - skip) : 0;
+      for(auto &i : reqs.buffers)
+      {
+        const size_t tocopy = std::min(i.size(), avail);
+        memcpy(i.data(), src, tocopy);
+        i = {i.data(), tocopy};
+        src += tocopy;
+        avail -= tocopy;
+      }
+      return reqs.buffers;
+    }
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<buffers_type> _do_read(registered_buffer_type base, io_request<buffers_type> reqs, deadline d) noexcept override
+    {
+      if(!this->requires_aligned_io() || _is_aligned(reqs.offset, reqs.buffers))
+      {
+        return adapted_handle_type::_do_read(std::move(base), reqs, d);
+      }
+      return bounce_buffered_handle_adapter::_do_read(reqs, d);
+    }
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<const_buffers_type> _do_write(io_request<const_buffers_type> reqs, deadline d) noexcept override
+    {
+      LLFIO_LOG_FUNCTION_CALL(this);
+      if(!this->requires_aligned_io() || _is_aligned(reqs.offset, reqs.buffers))
+      {
+        return adapted_handle_type::_do_write(reqs, d);
+      }
+      size_t bytes = 0;
+      for(auto &b : reqs.buffers)
+      {
+        bytes += b.size();
+      }
+      if(bytes == 0)
+      {
+        return reqs.buffers;
+      }
+      const extent_type mask = _alignment - 1;
+      const extent_type begin = reqs.offset & ~mask, end = (reqs.offset + bytes + mask) & ~mask, requested_end = reqs.offset + bytes;
+      OUTCOME_TRY(auto &&bounce, _bounce_buffer((size_t) (end - begin)));
+      OUTCOME_TRY(auto &&oldextent, this->maximum_extent());
+      // Read-modify-write the partial blocks at either edge
+      if(reqs.offset != begin)
+      {
+        OUTCOME_TRY(_read_block(bounce->data(), begin, d));
+      }
+      if(requested_end != end && (reqs.offset == begin || end - _alignment != begin))
+      {
+        OUTCOME_TRY(_read_block(bounce->data() + (end - _alignment - begin), end - _alignment, d));
+      }
+      byte *dest = bounce->data() + (reqs.offset - begin);
+      for(auto &i : reqs.buffers)
+      {
+        memcpy(dest, i.data(), i.size());
+        dest += i.size();
+      }
+      const_buffer_type b{bounce->data(), (size_t) (end - begin)};
+      OUTCOME_TRY(adapted_handle_type::_do_write(io_request<const_buffers_type>(const_buffers_type(&b, 1), begin), d));
+      const extent_type newextent = std::max(oldextent, requested_end);
+      if(end > newextent)
+      {
+        // The aligned write extended the file further than asked
+        OUTCOME_TRY(this->truncate(newextent));
+      }
+      return reqs.buffers;
+    }
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<const_buffers_type> _do_write(registered_buffer_type base, io_request<const_buffers_type> reqs, deadline d) noexcept override
+    {
+      if(!this->requires_aligned_io() || _is_aligned(reqs.offset, reqs.buffers))
+      {
+        return adapted_handle_type::_do_write(std::move(base), reqs, d);
+      }
+      return bounce_buffered_handle_adapter::_do_write(reqs, d);
+    }
+
+  public:
+    bounce_buffered_handle_adapter() = default;
+    bounce_buffered_handle_adapter(bounce_buffered_handle_adapter &&) = default;  // NOLINT
+    bounce_buffered_handle_adapter &operator=(bounce_buffered_handle_adapter &&o) noexcept
+    {
+      if(this == &o)
+      {
+        return *this;
+      }
+      this->~bounce_buffered_handle_adapter();
+      new(this) bounce_buffered_handle_adapter(std::move(o));
+      return *this;
+    }
+    /*! Adapts `o`, taking bounce buffers from `pool` if it is valid. If `alignment` is zero,
+    it is determined from the device.
+    */
+    explicit bounce_buffered_handle_adapter(adapted_handle_type &&o, aligned_buffer_pool pool = {}, size_t alignment = 0)
+        : adapted_handle_type(std::move(o))
+        , _pool(std::move(pool))
+    {
+      _alignment = (alignment != 0) ? alignment : _device_alignment();
+    }
+
+    //! The alignment which i/o must have to not be bounced.
+    size_t alignment() const noexcept { return _alignment; }
+    //! The pool from which bounce buffers are taken.
+    const aligned_buffer_pool &pool() const noexcept { return _pool; }
+  };
+  /*! \brief Constructs a `T` adapted into an implementation which bounces unaligned i/o.
+
+  This function works via the `construct<T>()` free function framework for which your `handle`
+  implementation must have registered its construction details.
+  */
+  template <class T, class... Args> inline result<bounce_buffered_handle_adapter<T>> bounce_buffered(aligned_buffer_pool pool, Args &&... args) noexcept
+  {
+    construct<T> constructor{std::forward<Args>(args)...};
+    OUTCOME_TRY(auto &&h, constructor());
+    return bounce_buffered_handle_adapter<T>(std::move(h), std::move(pool));
+  }
+
+}  // namespace algorithm
+
+//! \brief Constructor for `algorithm::bounce_buffered_handle_adapter<T>`
+template <class T> struct construct<algorithm::bounce_buffered_handle_adapter<T>>
+{
+  construct<T> args;
+  algorithm::aligned_buffer_pool pool;
+  result<algorithm::bounce_buffered_handle_adapter<T>> operator()() const noexcept
+  {
+    OUTCOME_TRY(auto &&h, args());
+    return algorithm::bounce_buffered_handle_adapter<T>(std::move(h), pool);
+  }
+};
+
+LLFIO_V2_NAMESPACE_END
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#endif
@@ -0,0 +1,423 @@
+/* Adapts any i/o handle to buffer reads and coalesce small writes
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#ifndef LLFIO_BUFFERED_HANDLE_ADAPTER_HPP
+#define LLFIO_BUFFERED_HANDLE_ADAPTER_HPP
+
+#include "../../byte_io_handle.hpp"
+#include "../../statfs.hpp"
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4251)  // dll interface
+#endif
+
+//! \file handle_adapter/buffered.hpp Adapts any `byte_io_handle` to buffer reads and coalesce small writes
+LLFIO_V2_NAMESPACE_BEGIN
+
+namespace algorithm
+{
+  /*! \brief Adapts any `construct()`-able `byte_io_handle` to buffer reads and coalesce small writes
+  in user space.
+
+  `byte_io_handle` is deliberately unbuffered, so every small read or write costs a syscall.
+  This adapter keeps one read buffer and one write buffer of `buffer_size()` bytes each.
+
+  For seekable handles, the file is divided into blocks of `buffer_size()` bytes aligned to
+  multiples of the buffer size. Reads smaller than the buffer size are served from a cached copy of
+  the block containing them, which is read in whole when needed. Writes smaller than the buffer
+  size are copied into the write buffer if they fall within the same block as, and touch or
+  overlap, the writes already buffered. Otherwise the buffered writes are written out first.
+  A block which becomes completely written is written out immediately, so the handle sees
+  large aligned writes. Reads and writes of the buffer size or larger are passed straight
+  through, after writing out any buffered writes.
+
+  For non-seekable handles such as pipes and sockets, offsets are ignored. Reads are served
+  from whatever the last read of up to `buffer_size()` bytes returned, and writes are appended
+  into the write buffer until it is full.
+
+  Buffered writes are written out by `flush()`, `barrier()`, `close()`, destruction, and any read
+  which overlaps them. The buffered read data is discarded by any write which overlaps it, and by
+  `discard_read_buffer()`. You must call `flush()` yourself before doing anything to the handle
+  other than reading and writing through this adapter, e.g. before truncating it, as buffered writes
+  are invisible to everything but this adapter.
+
+  The buffer size defaults to `utils::file_buffer_default_size()` rounded up to a multiple of
+  the device's i/o size, found as described for `bounce_buffered_handle_adapter`, so that every
+  completely written block reaches the device as whole device blocks.
+
+  \note Only i/o issued without a multiplexer is buffered. This adapter is not thread safe.
+  */
+  template <class T> LLFIO_REQUIRES(sizeof(construct<T>) > 0) class LLFIO_DECL buffered_handle_adapter : public T
+  {
+    static_assert(sizeof(construct<T>) > 0, "Type T must be registered with the construct<T> framework so buffered_handle_adapter<T> knows how to construct it");  // NOLINT
+    static_assert(std::is_base_of<byte_io_handle, T>::value, "Type T must be a byte_io_handle");
+
+  public:
+    //! The handle type being adapted
+    using adapted_handle_type = T;
+    using extent_type = typename T::extent_type;
+    using size_type = typename T::size_type;
+    using buffer_type = typename T::buffer_type;
+    using const_buffer_type = typename T::const_buffer_type;
+    using buffers_type = typename T::buffers_type;
+    using const_buffers_type = typename T::const_buffers_type;
+    using registered_buffer_type = typename T::registered_buffer_type;
+    using barrier_kind = typename T::barrier_kind;
+    template <class U> using io_request = typename T::template io_request<U>;
+    template <class U> using io_result = typename T::template io_result<U>;
+
+  protected:
+    size_t _buffer_size{0};
+    registered_buffer_type _rbuf, _wbuf;
+    extent_type _roffset{0};       // The offset of the block in the read buffer
+    size_t _rpos{0}, _rlen{0};     // The read buffer holds valid data from _rpos to _rlen
+    extent_type _woffset{0};       // The offset of the block in the write buffer
+    size_t _wbegin{0}, _wend{0};   // The write buffer holds data to be written from _wbegin to _wend
+
+    size_t _default_buffer_size() const noexcept
+    {
+      size_t iosize = utils::page_size();
+      statfs_t s;
+      if(this->is_seekable() && s.fill(*this, statfs_t::want::iosize) && s.f_iosize != (uint64_t) -1 && s.f_iosize != 0 && s.f_iosize <= (1U << 24U))
+      {
+        iosize = (size_t) s.f_iosize;
+      }
+      const size_t bytes = std::max(utils::file_buffer_default_size(), iosize);
+      return (bytes + iosize - 1) / iosize * iosize;
+    }
+    result<void> _allocate_buffers() noexcept
+    {
+      size_t bytes = _buffer_size;
+      OUTCOME_TRY(_rbuf, adapted_handle_type::_do_allocate_registered_buffer(bytes));
+      bytes = _buffer_size;
+      OUTCOME_TRY(_wbuf, adapted_handle_type::_do_allocate_registered_buffer(bytes));
+      return success();
+    }
+    static bool _overlaps(extent_type a, extent_type alen, extent_type b, extent_type blen) noexcept { return a < b + blen && b < a + alen; }
+    template <class B> static size_t _bytes(span<B> buffers) noexcept
+    {
+      size_t bytes = 0;
+      for(auto &b : buffers)
+      {
+        bytes += b.size();
+      }
+      return bytes;
+    }
+    result<void> _flush(deadline d) noexcept
+    {
+      if(_rlen > 0 && _wend > _wbegin && this->is_seekable() && _overlaps(_woffset + _wbegin, _wend - _wbegin, _roffset, _rlen))
+      {
+        // The read buffer was filled from the file before these writes reached it
+        discard_read_buffer();
+      }
+      LLFIO_DEADLINE_TO_SLEEP_INIT(d);
+      while(_wend > _wbegin)
+      {
+        deadline nd;
+        LLFIO_DEADLINE_TO_PARTIAL_DEADLINE(nd, d);
+        const_buffer_type b{_wbuf->data() + _wbegin, _wend - _wbegin};
+        OUTCOME_TRY(auto &&written, adapted_handle_type::_do_write(io_request<const_buffers_type>(const_buffers_type(&b, 1), _woffset + _wbegin), nd));
+        const size_t bytes = _bytes(written);
+        if(bytes == 0)
+        {
+          return errc::resource_unavailable_try_again;  // something is wrong
+        }
+        // Non-seekable handles may accept fewer bytes than offered
+        _wbegin += bytes;
+      }
+      _wbegin = _wend = 0;
+      return success();
+    }
+    // Refills the read buffer from `offset`, returning false if there is nothing to read there
+    result<bool> _fill(extent_type offset, deadline d) noexcept
+    {
+      _rpos = _rlen = 0;
+      _roffset = offset;
+      buffer_type b{_rbuf->data(), _buffer_size};
+      OUTCOME_TRY(auto &&filled, adapted_handle_type::_do_read(io_request<buffers_type>(buffers_type(&b, 1), offset), d));
+      for(auto &i : filled)
+      {
+        // Some handles return pointers to elsewhere e.g. into a map
+        if(i.data() != _rbuf->data() + _rlen)
+        {
+          memmove(_rbuf->data() + _rlen, i.data(), i.size());
+        }
+        _rlen += i.size();
+      }
+      return _rlen > 0;
+    }
+
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<buffers_type> _do_read(io_request<buffers_type> reqs, deadline d) noexcept override
+    {
+      LLFIO_LOG_FUNCTION_CALL(this);
+      const size_t bytes = _bytes(reqs.buffers);
+      if(bytes == 0)
+      {
+        return reqs.buffers;
+      }
+      const bool seekable = this->is_seekable();
+      if(seekable && _wend > _wbegin && _overlaps(reqs.offset, bytes, _woffset + _wbegin, _wend - _wbegin))
+      {
+        OUTCOME_TRY(_flush(d));
+      }
+      if(bytes >= _buffer_size && (seekable || _rpos == _rlen))
+      {
+        return adapted_handle_type::_do_read(reqs, d);
+      }
+      extent_type offset = reqs.offset;
+      size_t done = 0;
+      bool eof = false;
+      for(auto &i : reqs.buffers)
+      {
+        size_t thisdone = 0;
+        while(!eof && thisdone < i.size())
+        {
+          if(seekable)
+          {
+            if(offset < _roffset || offset >= _roffset + _rlen)
+            {
+              OUTCOME_TRY(auto &&filled, _fill(offset - (offset % _buffer_size), d));
+              eof = !filled || offset >= _roffset + _rlen;
+              continue;
+            }
+            _rpos = (size_t) (offset - _roffset);
+          }
+          else if(_rpos == _rlen)
+          {
+            if(done + thisdone > 0)
+            {
+              // Don't wait for more data from a stream once we have some
+              eof = true;
+              continue;
+            }
+            OUTCOME_TRY(auto &&filled, _fill(0, d));
+            eof = !filled;
+            continue;
+          }
+          const size_t tocopy = std::min(i.size() - thisdone, _rlen - _rpos);
+          memcpy(i.data() + thisdone, _rbuf->data() + _rpos, tocopy);
+          _rpos += tocopy;
+          thisdone += tocopy;
+          offset += tocopy;
+        }
+        i = {i.data(), thisdone};
+        done += thisdone;
+      }
+      return reqs.buffers;
+    }
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<buffers_type> _do_read(registered_buffer_type base, io_request<buffers_type> reqs, deadline d) noexcept override
+    {
+      (void) base;
+      return buffered_handle_adapter::_do_read(reqs, d);
+    }
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<const_buffers_type> _do_write(io_request<const_buffers_type> reqs, deadline d) noexcept override
+    {
+      LLFIO_LOG_FUNCTION_CALL(this);
+      const size_t bytes = _bytes(reqs.buffers);
+      if(bytes == 0)
+      {
+        return reqs.buffers;
+      }
+      const bool seekable = this->is_seekable();
+      if(seekable && _rlen > 0 && _overlaps(reqs.offset, bytes, _roffset, _rlen))
+      {
+        discard_read_buffer();
+      }
+      if(bytes >= _buffer_size)
+      {
+        OUTCOME_TRY(_flush(d));
+        return adapted_handle_type::_do_write(reqs, d);
+      }
+      extent_type offset = reqs.offset;
+      for(auto &i : reqs.buffers)
+      {
+        const byte *src = i.data();
+        size_t remaining = i.size();
+        while(remaining > 0)
+        {
+          if(!seekable)
+          {
+            if(_wend == _buffer_size)
+            {
+              OUTCOME_TRY(_flush(d));
+            }
+            const size_t tocopy = std::min(remaining, _buffer_size - _wend);
+            memcpy(_wbuf->data() + _wend, src, tocopy);
+            _wend += tocopy;
+            src += tocopy;
+            remaining -= tocopy;
+            continue;
+          }
+          const extent_type block = offset - (offset % _buffer_size);
+          const size_t begin = (size_t) (offset - block), tocopy = std::min(remaining, _buffer_size - begin);
+          if(_wend > _wbegin && (block != _woffset || begin > _wend || begin + tocopy < _wbegin))
+          {
+            OUTCOME_TRY(_flush(d));
+          }
+          if(_wend == _wbegin)
+          {
+            _woffset = block;
+            _wbegin = _wend = begin;
+          }
+          memcpy(_wbuf->data() + begin, src, tocopy);
+          _wbegin = std::min(_wbegin, begin);
+          _wend = std::max(_wend, begin + tocopy);
+          src += tocopy;
+          offset += tocopy;
+          remaining -= tocopy;
+          if(_wbegin == 0 && _wend == _buffer_size)
+          {
+            // A whole aligned block, so write it now
+            OUTCOME_TRY(_flush(d));
+          }
+        }
+      }
+      if(!seekable && _wend == _buffer_size)
+      {
+        OUTCOME_TRY(_flush(d));
+      }
+      return reqs.buffers;
+    }
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<const_buffers_type> _do_write(registered_buffer_type base, io_request<const_buffers_type> reqs, deadline d) noexcept override
+    {
+      (void) base;
+      return buffered_handle_adapter::_do_write(reqs, d);
+    }
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<const_buffers_type> _do_barrier(io_request<const_buffers_type> reqs, barrier_kind kind, deadline d) noexcept override
+    {
+      LLFIO_LOG_FUNCTION_CALL(this);
+      OUTCOME_TRY(_flush(d));
+      return adapted_handle_type::_do_barrier(reqs, kind, d);
+    }
+
+  public:
+    buffered_handle_adapter() = default;
+    buffered_handle_adapter(buffered_handle_adapter &&) = default;  // NOLINT
+    buffered_handle_adapter &operator=(buffered_handle_adapter &&o) noexcept
+    {
+      if(this == &o)
+      {
+        return *this;
+      }
+      this->~buffered_handle_adapter();
+      new(this) buffered_handle_adapter(std::move(o));
+      return *this;
+    }
+    //! Adapts `o`, using buffers of `buffer_size` bytes. If `buffer_size` is zero, it is determined from the device.
+    explicit buffered_handle_adapter(adapted_handle_type &&o, size_t buffer_size = 0)
+        : adapted_handle_type(std::move(o))
+    {
+      _buffer_size = (buffer_size != 0) ? buffer_size : _default_buffer_size();
+      _allocate_buffers().value();
+    }
+    //! Writes out any buffered writes
+    ~buffered_handle_adapter()
+    {
+      if(this->is_valid() && _wend > _wbegin)
+      {
+        if(!_flush(deadline()))
+        {
+          LLFIO_LOG_FATAL(this, "buffered_handle_adapter::~buffered_handle_adapter() flush failed");
+        }
+      }
+    }
+    //! Writes out any buffered writes, then closes the handle.
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<void> close() noexcept override
+    {
+      LLFIO_LOG_FUNCTION_CALL(this);
+      if(this->is_valid())
+      {
+        OUTCOME_TRY(_flush(deadline()));
+      }
+      discard_read_buffer();
+      return adapted_handle_type::close();
+    }
+
+    //! The size of the read and write buffers.
+    size_t buffer_size() const noexcept { return _buffer_size; }
+    //! The number of bytes of buffered writes not yet written out.
+    size_t buffered_write_bytes() const noexcept { return _wend - _wbegin; }
+
+    //! Writes out any buffered writes. Does not issue a write reordering barrier.
+    result<void> flush(deadline d = deadline()) noexcept
+    {
+      LLFIO_LOG_FUNCTION_CALL(this);
+      return _flush(d);
+    }
+    //! Discards any buffered read data, so subsequent reads fetch from the handle. Call this if somebody else may have modified the file.
+    void discard_read_buffer() noexcept
+    {
+      _roffset = 0;
+      _rpos = _rlen = 0;
+    }
+  };
+  /*! \brief Constructs a `T` adapted into an implementation which buffers reads and coalesces small writes.
+
+  This function works via the `construct<T>()` free function framework for which your `handle`
+  implementation must have registered its construction details.
+  */
+  template <class T, class... Args> inline result<buffered_handle_adapter<T>> buffered(size_t buffer_size, Args &&... args) noexcept
+  {
+    try
+    {
+      construct<T> constructor{std::forward<Args>(args)...};
+      OUTCOME_TRY(auto &&h, constructor());
+      return buffered_handle_adapter<T>(std::move(h), buffer_size);
+    }
+    catch(...)
+    {
+      return error_from_exception();
+    }
+  }
+
+}  // namespace algorithm
+
+//! \brief Constructor for `algorithm::buffered_handle_adapter<T>`
+template <class T> struct construct<algorithm::buffered_handle_adapter<T>>
+{
+  construct<T> args;
+  size_t buffer_size{0};
+  result<algorithm::buffered_handle_adapter<T>> operator()() const noexcept
+  {
+    try
+    {
+      OUTCOME_TRY(auto &&h, args());
+      return algorithm::buffered_handle_adapter<T>(std::move(h), buffer_size);
+    }
+    catch(...)
+    {
+      return error_from_exception();
+    }
+  }
+};
+
+LLFIO_V2_NAMESPACE_END
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#endif
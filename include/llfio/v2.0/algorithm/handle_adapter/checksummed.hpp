@@ -0,0 +1,428 @@
+/* A handle adapter which keeps per-block CRC32C checksums of another handle
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#ifndef LLFIO_ALGORITHM_HANDLE_ADAPTER_CHECKSUMMED_H
+#define LLFIO_ALGORITHM_HANDLE_ADAPTER_CHECKSUMMED_H
+
+#include "combining.hpp"
+
+//! \file handle_adapter/checksummed.hpp Provides `checksummed_handle_adapter`.
+
+LLFIO_V2_NAMESPACE_EXPORT_BEGIN
+
+namespace algorithm
+{
+  /*! \brief Returns the CRC32C (Castagnoli) checksum of `bytes` at `data`, continuing
+  from the checksum `crc` of any preceding data.
+
+  The implementation is chosen at runtime for the CPU. On x86, the SSE4.2 `crc32`
+  instruction is used, with three interleaved streams combined using carry-less
+  multiplication if PCLMULQDQ is available. On ARM, the ARMv8 CRC32 instructions are
+  used if the compiler is targeting them. Otherwise a slicing-by-eight table
+  implementation is used.
+  */
+  LLFIO_HEADERS_ONLY_FUNC_SPEC uint32_t crc32c(const byte *data, size_t bytes, uint32_t crc = 0) noexcept;
+  //! \brief Returns the name of the CRC32C implementation chosen for this CPU e.g. "sse4.2+pclmul", "sse4.2", "armv8" or "software".
+  LLFIO_HEADERS_ONLY_FUNC_SPEC const char *crc32c_implementation() noexcept;
+
+  namespace detail
+  {
+    template <class Target, class Source> struct checksummed_handle_adapter_op
+    {
+      static_assert(!std::is_void<Source>::value, "A handle for the checksums is required by checksummed_handle_adapter");
+      static_assert(std::is_base_of<file_handle, Target>::value && std::is_base_of<file_handle, Source>::value,
+                    "checksummed_handle_adapter requires both handles to be file handles");
+
+      using buffer_type = typename Target::buffer_type;
+      using const_buffer_type = typename Target::const_buffer_type;
+      using const_buffers_type = typename Target::const_buffers_type;
+
+      // All i/o is done by the overrides below, so these are never called
+      static result<buffer_type> do_read(buffer_type out, buffer_type /*unused*/, buffer_type /*unused*/) noexcept { return out; }
+      static result<const_buffer_type> do_write(buffer_type t, buffer_type /*unused*/, const_buffer_type in) noexcept { return buffer_type{t.data(), in.size()}; }
+      static result<const_buffers_type> adjust_written_buffers(const_buffers_type out, const_buffer_type /*unused*/, const_buffer_type /*unused*/) noexcept
+      {
+        return out;
+      }
+
+      template <class Base> struct override_ : public Base
+      {
+        using path_type = byte_io_handle::path_type;
+        using extent_type = byte_io_handle::extent_type;
+        using size_type = byte_io_handle::size_type;
+        using mode = byte_io_handle::mode;
+        using creation = byte_io_handle::creation;
+        using caching = byte_io_handle::caching;
+        using flag = byte_io_handle::flag;
+        using barrier_kind = byte_io_handle::barrier_kind;
+        using buffer_type = byte_io_handle::buffer_type;
+        using const_buffer_type = byte_io_handle::const_buffer_type;
+        using buffers_type = byte_io_handle::buffers_type;
+        using const_buffers_type = byte_io_handle::const_buffers_type;
+        template <class T> using io_request = byte_io_handle::io_request<T>;
+        template <class T> using io_result = byte_io_handle::io_result<T>;
+
+      protected:
+        size_type _blocksize{4096};
+
+        // Reads the data in the blocks covering [begin, end), and writes new checksums for them without verification.
+        result<void> _update_checksums(extent_type begin, extent_type end, deadline d) noexcept
+        {
+          const extent_type blocksize = _blocksize;
+          begin &= ~(blocksize - 1);
+          end = (end + blocksize - 1) & ~(blocksize - 1);
+          if(begin >= end)
+          {
+            return success();
+          }
+          const size_type chunk = std::max(blocksize, (extent_type) utils::file_buffer_default_size()) & ~(blocksize - 1);
+          const size_t chunkblocks = (size_t) (chunk / blocksize);
+          OUTCOME_TRY(auto &&bufferh, map_handle::map(chunk + chunkblocks * sizeof(uint32_t)));
+          auto *checksums = (uint32_t *) (bufferh.address() + chunk);
+          for(extent_type offset = begin; offset < end; offset += chunk)
+          {
+            buffer_type b(bufferh.address(), (size_type) std::min((extent_type) chunk, end - offset));
+            OUTCOME_TRY(auto &&filled, this->_target->read(io_request<buffers_type>({&b, 1}, offset), d));
+            const size_type bytesread = filled[0].size();
+            size_t blocks = 0;
+            for(size_type n = 0; n < bytesread; n += blocksize)
+            {
+              checksums[blocks++] = crc32c(bufferh.address() + n, (size_t) std::min((size_type) blocksize, bytesread - n));
+            }
+            if(blocks > 0)
+            {
+              const_buffer_type cb((const byte *) checksums, blocks * sizeof(uint32_t));
+              OUTCOME_TRY(this->_source->write(io_request<const_buffers_type>({&cb, 1}, (offset / blocksize) * sizeof(uint32_t)), d));
+            }
+            if(bytesread < b.size())
+            {
+              break;
+            }
+          }
+          return success();
+        }
+
+      public:
+        override_() = default;
+        /*! Constructor. `blocksize` is the granularity of checksumming, and must be a
+        power of two. It must be the same every time the same files are adapted.
+        */
+        override_(Target *a, Source *b, mode _mode = mode::write, flag flags = flag::none, byte_io_multiplexer *ctx = nullptr, size_type blocksize = 4096)
+            : Base(a, b, _mode, flags, ctx)
+            , _blocksize(blocksize)
+        {
+          assert(blocksize > 0 && (blocksize & (blocksize - 1)) == 0);
+        }
+
+        //! The granularity of checksumming.
+        size_type block_size() const noexcept { return _blocksize; }
+
+        /*! \brief Recalculates all the checksums from the data currently in the target handle.
+
+        This is how checksums are created for a file which already has contents when first
+        adapted, and how to recover from an interrupted write. Obviously it also blesses
+        any corruption currently in the data.
+        */
+        result<void> rebuild_checksums(deadline d = deadline()) noexcept
+        {
+          OUTCOME_TRY(auto &&length, this->_target->maximum_extent());
+          OUTCOME_TRY(this->_source->truncate(((length + _blocksize - 1) / _blocksize) * sizeof(uint32_t)));
+          return _update_checksums(0, length, d);
+        }
+
+      protected:
+        //! \brief Return two fewer than the target's maximum buffers, to leave room for any partial blocks
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC size_t _do_max_buffers() const noexcept override
+        {
+          auto r = this->_target->max_buffers();
+          return (r > 2) ? (r - 2) : 1;
+        }
+
+        /*! Reads the blocks covering the request from the target, reading any parts of
+        partial blocks outside the request into temporary buffers (stack allocated if
+        below a page size), and verifies their checksums. A block whose checksum does not
+        match, or which has no checksum, fails the read with `errc::io_error`.
+        */
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<buffers_type> _do_read(io_request<buffers_type> reqs, deadline d = deadline()) noexcept override
+        {
+          const extent_type blocksize = _blocksize;
+          size_type bytes = 0;
+          for(const auto &b : reqs.buffers)
+          {
+            bytes += b.size();
+          }
+          if(bytes == 0)
+          {
+            return std::move(reqs.buffers);
+          }
+          const extent_type begin = reqs.offset & ~(blocksize - 1), end = (reqs.offset + bytes + blocksize - 1) & ~(blocksize - 1);
+          const auto headbytes = (size_type) (reqs.offset - begin), tailbytes = (size_type) (end - reqs.offset - bytes);
+          const auto blocks = (size_t) ((end - begin) / blocksize);
+          const size_type scratchbytes = blocks * sizeof(uint32_t) + headbytes + tailbytes;
+          // If less than page size, use stack, else use free pages
+          auto *scratch = (byte *) ((scratchbytes <= utils::page_size()) ? alloca(scratchbytes) : nullptr);
+          map_handle scratchh;
+          if(scratch == nullptr)
+          {
+            OUTCOME_TRY(auto &&_, map_handle::map(scratchbytes));
+            scratchh = std::move(_);
+            scratch = scratchh.address();
+          }
+          auto *checksums = (uint32_t *) scratch;
+          byte *head = scratch + blocks * sizeof(uint32_t), *tail = head + headbytes;
+
+          // Fetch the stored checksums
+          size_t checksumsread = 0;
+          {
+            buffer_type b((byte *) checksums, blocks * sizeof(uint32_t));
+            OUTCOME_TRY(auto &&_, this->_source->read(io_request<buffers_type>({&b, 1}, (begin / blocksize) * sizeof(uint32_t)), d));
+            checksumsread = _[0].size() / sizeof(uint32_t);
+          }
+
+          // Fetch the data, including the remainder of any partial blocks
+          auto *buffers = (buffer_type *) alloca(sizeof(buffer_type) * (reqs.buffers.size() + 2));
+          size_t count = 0;
+          if(headbytes > 0)
+          {
+            buffers[count++] = {head, headbytes};
+          }
+          for(auto &b : reqs.buffers)
+          {
+            buffers[count++] = b;
+          }
+          if(tailbytes > 0)
+          {
+            buffers[count++] = {tail, tailbytes};
+          }
+          OUTCOME_TRY(auto &&filled, this->_target->read(io_request<buffers_type>({buffers, count}, begin), d));
+
+          // Verify every block read, including any partial block at the end of the file
+          uint32_t crc = 0;
+          size_type inblock = 0, bytesread = 0;
+          size_t block = 0;
+          for(auto &b : filled)
+          {
+            bytesread += b.size();
+            const byte *p = b.data();
+            size_type len = b.size();
+            while(len > 0)
+            {
+              const auto todo = (size_type) std::min((extent_type) len, blocksize - inblock);
+              crc = crc32c(p, todo, crc);
+              p += todo;
+              len -= todo;
+              inblock += todo;
+              if(inblock == blocksize)
+              {
+                if(block >= checksumsread || checksums[block] != crc)
+                {
+                  return errc::io_error;
+                }
+                block++;
+                crc = 0;
+                inblock = 0;
+              }
+            }
+          }
+          if(inblock > 0 && (block >= checksumsread || checksums[block] != crc))
+          {
+            return errc::io_error;
+          }
+
+          // Adjust the buffers returned to what was read from the request
+          bytesread = (bytesread > headbytes) ? std::min(bytesread - headbytes, bytes) : 0;
+          for(auto &b : reqs.buffers)
+          {
+            const auto len = std::min(b.size(), bytesread);
+            b = {b.data(), len};
+            bytesread -= len;
+          }
+          return std::move(reqs.buffers);
+        }
+
+        /*! Reads and verifies the parts of any partial blocks outside the request, then
+        writes the request to the target, followed by the new checksums of the blocks
+        written to the checksum handle. Writing beyond the end of the file first extends
+        it, which checksums the blocks in between.
+        */
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<const_buffers_type> _do_write(io_request<const_buffers_type> reqs, deadline d = deadline()) noexcept override
+        {
+          const extent_type blocksize = _blocksize;
+          size_type bytes = 0;
+          for(const auto &b : reqs.buffers)
+          {
+            bytes += b.size();
+          }
+          if(bytes == 0)
+          {
+            return std::move(reqs.buffers);
+          }
+          {
+            OUTCOME_TRY(auto &&length, this->_target->maximum_extent());
+            if(reqs.offset > length)
+            {
+              OUTCOME_TRY(override_::truncate(reqs.offset));
+            }
+          }
+          const extent_type begin = reqs.offset & ~(blocksize - 1), end = (reqs.offset + bytes + blocksize - 1) & ~(blocksize - 1);
+          const auto headbytes = (size_type) (reqs.offset - begin), tailbytes = (size_type) (end - reqs.offset - bytes);
+          const auto blocks = (size_t) ((end - begin) / blocksize);
+          const size_type scratchbytes = blocks * sizeof(uint32_t) + headbytes + tailbytes;
+          // If less than page size, use stack, else use free pages
+          auto *scratch = (byte *) ((scratchbytes <= utils::page_size()) ? alloca(scratchbytes) : nullptr);
+          map_handle scratchh;
+          if(scratch == nullptr)
+          {
+            OUTCOME_TRY(auto &&_, map_handle::map(scratchbytes));
+            scratchh = std::move(_);
+            scratch = scratchh.address();
+          }
+          auto *checksums = (uint32_t *) scratch;
+          byte *head = scratch + blocks * sizeof(uint32_t), *tail = head + headbytes;
+
+          // Fetch, and thus verify, the remainder of any partial blocks
+          size_type tailread = 0;
+          if(headbytes > 0)
+          {
+            buffer_type b(head, headbytes);
+            OUTCOME_TRY(override_::_do_read(io_request<buffers_type>({&b, 1}, begin), d));
+          }
+          if(tailbytes > 0)
+          {
+            buffer_type b(tail, tailbytes);
+            OUTCOME_TRY(auto &&_, override_::_do_read(io_request<buffers_type>({&b, 1}, reqs.offset + bytes), d));
+            tailread = _[0].size();
+          }
+
+          // Calculate the new checksums
+          uint32_t crc = 0;
+          size_type inblock = 0;
+          size_t block = 0;
+          auto accumulate = [&](const byte *p, size_type len) {
+            while(len > 0)
+            {
+              const auto todo = (size_type) std::min((extent_type) len, blocksize - inblock);
+              crc = crc32c(p, todo, crc);
+              p += todo;
+              len -= todo;
+              inblock += todo;
+              if(inblock == blocksize)
+              {
+                checksums[block++] = crc;
+                crc = 0;
+                inblock = 0;
+              }
+            }
+          };
+          accumulate(head, headbytes);
+          for(const auto &b : reqs.buffers)
+          {
+            accumulate(b.data(), b.size());
+          }
+          accumulate(tail, tailread);
+          if(inblock > 0)
+          {
+            checksums[block++] = crc;
+          }
+
+          // Write the data, then its checksums
+          OUTCOME_TRY(auto &&written, this->_target->write(reqs, d));
+          {
+            const_buffer_type cb((const byte *) checksums, block * sizeof(uint32_t));
+            OUTCOME_TRY(this->_source->write(io_request<const_buffers_type>({&cb, 1}, (begin / blocksize) * sizeof(uint32_t)), d));
+          }
+          return std::move(written);
+        }
+
+        //! \brief Barriers the target handle with the request, and then the whole of the checksum handle.
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<const_buffers_type> _do_barrier(io_request<const_buffers_type> reqs, barrier_kind kind, deadline d) noexcept override
+        {
+          OUTCOME_TRY(auto &&ret, this->_target->barrier(reqs, kind, d));
+          OUTCOME_TRY(this->_source->barrier({}, kind, d));
+          return std::move(ret);
+        }
+
+      public:
+        //! \brief Return the maximum extent of the target handle
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> maximum_extent() const noexcept override { return this->_target->maximum_extent(); }
+        //! \brief Truncate the target handle, and the checksum handle to match, recalculating the checksums of any blocks which changed
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> truncate(extent_type newsize) noexcept override
+        {
+          OUTCOME_TRY(auto &&length, this->_target->maximum_extent());
+          OUTCOME_TRY(auto &&ret, this->_target->truncate(newsize));
+          OUTCOME_TRY(this->_source->truncate(((newsize + _blocksize - 1) / _blocksize) * sizeof(uint32_t)));
+          if(newsize != length)
+          {
+            OUTCOME_TRY(_update_checksums(std::min(length, newsize), newsize, {}));
+          }
+          return ret;
+        }
+        //! \brief Punches a hole in the target handle, recalculating the checksums of the blocks affected
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> zero(file_handle::extent_pair extent, deadline d = deadline()) noexcept override
+        {
+          OUTCOME_TRY(auto &&ret, this->_target->zero(extent, d));
+          OUTCOME_TRY(_update_checksums(extent.offset, extent.offset + extent.length, d));
+          return ret;
+        }
+      };
+    };
+  }  // namespace detail
+
+  /*! \brief A handle which keeps a CRC32C checksum of every block of a target handle in
+  a side handle, verifying the checksums of blocks read and updating the checksums of
+  blocks written.
+  \tparam Target The type of the handle whose data is checksummed.
+  \tparam Source The type of the handle in which the checksums are stored.
+
+  The checksum handle stores an array of `uint32_t`, in native byte order, one per
+  `block_size()` of the target. The checksum of any partial final block is of the bytes
+  in that block. A checksum file can be created for an existing file by calling
+  `rebuild_checksums()`.
+
+  Reads always read whole blocks from the target, with any parts outside the request
+  read into temporary buffers, so that every block touched can be verified. Reads fail
+  with `errc::io_error` if any block read has a mismatching or missing checksum, like
+  Linux filesystems which checksum data do.
+
+  Writes which do not begin and end on block boundaries need to read, and verify, the
+  remainder of the partial blocks touched first. Prefer block aligned writes.
+
+  \warning Data and checksums are not updated atomically. If a write is interrupted
+  by a crash or power loss, the blocks it touched may fail verification. This adapter
+  is not safe for concurrent writes to the same block.
+  */
+  template <class Target, class Source> using checksummed_handle_adapter = combining_handle_adapter<detail::checksummed_handle_adapter_op, Target, Source>;
+
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
+
+#if LLFIO_HEADERS_ONLY == 1 && !defined(DOXYGEN_SHOULD_SKIP_THIS)
+#define LLFIO_INCLUDED_BY_HEADER 1
+#include "../../detail/impl/checksummed_handle_adapter.ipp"
+#undef LLFIO_INCLUDED_BY_HEADER
+#endif
+
+#endif
@@ -33,6 +33,21 @@ LLFIO_V2_NAMESPACE_EXPORT_BEGIN
 
 namespace algorithm
 {
+  /*! \brief Writes `a[n] ^ b[n]` to `out[n]` for `bytes` bytes.
+
+  This and the other `combine_*()` kernels are for use by `combining_handle_adapter` ops.
+  They choose at runtime between AVX-512, AVX2 and SSE2 implementations on x86, use NEON
+  on ARM, and otherwise use a scalar implementation. None of the pointers need be aligned.
+  `out` may be the same as `a` or `b`, but must not otherwise overlap them.
+  */
+  LLFIO_HEADERS_ONLY_FUNC_SPEC void combine_xor(byte *out, const byte *a, const byte *b, size_t bytes) noexcept;
+  //! \brief Writes `a[n] + b[n]` modulo 256 to `out[n]` for `bytes` bytes.
+  LLFIO_HEADERS_ONLY_FUNC_SPEC void combine_add(byte *out, const byte *a, const byte *b, size_t bytes) noexcept;
+  //! \brief Returns the index of the first byte which differs between `a` and `b`, or `bytes` if none do.
+  LLFIO_HEADERS_ONLY_FUNC_SPEC size_t combine_compare(const byte *a, const byte *b, size_t bytes) noexcept;
+  //! \brief Returns the name of the `combine_*()` kernels chosen for this CPU e.g. "avx512", "avx2", "sse2", "neon" or "scalar".
+  LLFIO_HEADERS_ONLY_FUNC_SPEC const char *combine_kernels_implementation() noexcept;
+
   namespace detail
   {
     // file_handle additional member functions
@@ -433,6 +448,30 @@ namespace algorithm
       }
       //! \brief Always returns a failed matching `errc::operation_not_supported` as the meaning of combined valid extents is hard to discern here.
       LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<std::vector<file_handle::extent_pair>> extents() const noexcept override { return errc::operation_not_supported; }
+      //! \brief Always returns a failed matching `errc::operation_not_supported` as the meaning of combined allocated extents is hard to discern here.
+      LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<std::vector<file_handle::extent_info>> detailed_extents() const noexcept override { return errc::operation_not_supported; }
+      //! \brief Always returns a failed matching `errc::operation_not_supported`.
+      LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> preallocate(file_handle::extent_pair /*unused*/, deadline /*unused*/ = deadline()) noexcept override
+      {
+        return errc::operation_not_supported;
+      }
+      //! \brief Always returns a failed matching `errc::operation_not_supported`.
+      LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> zero_range(file_handle::extent_pair /*unused*/, deadline /*unused*/ = deadline()) noexcept override
+      {
+        return errc::operation_not_supported;
+      }
+      //! \brief Always returns a failed matching `errc::operation_not_supported`.
+      LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> collapse_range(file_handle::extent_pair /*unused*/, deadline /*unused*/ = deadline(),
+                                                                         bool /*unused*/ = true) noexcept override
+      {
+        return errc::operation_not_supported;
+      }
+      //! \brief Always returns a failed matching `errc::operation_not_supported`.
+      LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> insert_range(file_handle::extent_pair /*unused*/, deadline /*unused*/ = deadline(),
+                                                                       bool /*unused*/ = true) noexcept override
+      {
+        return errc::operation_not_supported;
+      }
       //! \brief Punches a hole in one or both attached handles. Note that no combination operation is performed.
       LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> zero(file_handle::extent_pair extent, deadline d = deadline()) noexcept override
       {
@@ -607,4 +646,10 @@ namespace algorithm
 
 LLFIO_V2_NAMESPACE_END
 
+#if LLFIO_HEADERS_ONLY == 1 && !defined(DOXYGEN_SHOULD_SKIP_THIS)
+#define LLFIO_INCLUDED_BY_HEADER 1
+#include "../../detail/impl/combining_kernels.ipp"
+#undef LLFIO_INCLUDED_BY_HEADER
+#endif
+
 #endif
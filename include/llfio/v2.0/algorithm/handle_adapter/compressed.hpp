@@ -0,0 +1,562 @@
+/* A handle adapter storing fixed size blocks compressed in a backing file
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#ifndef LLFIO_ALGORITHM_HANDLE_ADAPTER_COMPRESSED_H
+#define LLFIO_ALGORITHM_HANDLE_ADAPTER_COMPRESSED_H
+
+#include "../../mapped_file_handle.hpp"
+#include "combining.hpp"
+
+#include <cstring>
+#include <vector>
+
+//! \file handle_adapter/compressed.hpp Provides `compressed_handle_adapter`.
+
+LLFIO_V2_NAMESPACE_EXPORT_BEGIN
+
+namespace algorithm
+{
+  /*! \brief A compression codec for `compressed_handle_adapter`.
+
+  Implementations must be thread safe, as blocks are compressed and decompressed
+  concurrently.
+  */
+  class LLFIO_DECL block_codec
+  {
+  public:
+    virtual ~block_codec() = default;
+
+    //! A short name for the codec, which is recorded in the block index and checked on open.
+    virtual const char *name() const noexcept = 0;
+    /*! \brief Compresses `src` into `dest`, returning the number of bytes of `dest` used,
+    or zero if the compressed form would not fit into `dest`.
+    */
+    virtual size_t compress(span<byte> dest, span<const byte> src) const noexcept = 0;
+    /*! \brief Decompresses `src` into `dest`, returning the number of bytes of `dest` filled.
+    Must fail with an error, not crash, if `src` is corrupt.
+    */
+    virtual result<size_t> decompress(span<byte> dest, span<const byte> src) const noexcept = 0;
+  };
+
+  /*! \brief Returns the built in codec, a byte oriented LZ77 in the style of LZ4, named "lz".
+
+  This favours speed over ratio, compressing at hundreds of megabytes per second per core
+  and decompressing several times faster than that.
+  */
+  LLFIO_HEADERS_ONLY_FUNC_SPEC const block_codec &lz_block_codec() noexcept;
+
+  namespace detail
+  {
+    // The start of the index file, which is followed by one uint32_t per block
+    struct compressed_header
+    {
+      uint64_t magic;
+      uint64_t block_size;
+      uint64_t length;       // of the uncompressed file
+      uint64_t index_bytes;  // following the header
+      char codec[32];
+    };
+
+    /* Calls `f(ctx, n, scratch)` for each `n` in `[0, count)`, each call having `scratchbytes`
+    of memory to itself, using the dynamic thread pool if `parallel`. Returns the first failure.
+    */
+    LLFIO_HEADERS_ONLY_FUNC_SPEC result<void> compressed_for_each_block(size_t count, size_t scratchbytes, bool parallel,
+                                                                        result<void> (*f)(void *ctx, size_t n, byte *scratch), void *ctx) noexcept;
+
+    template <class Target, class Source> struct compressed_handle_adapter_op
+    {
+      static_assert(std::is_void<Source>::value, "A second handle is not possible with compressed_handle_adapter");
+      static_assert(std::is_base_of<file_handle, Target>::value, "compressed_handle_adapter requires a file handle");
+
+      using buffer_type = typename Target::buffer_type;
+      using const_buffer_type = typename Target::const_buffer_type;
+      using const_buffers_type = typename Target::const_buffers_type;
+
+      // All i/o is done by the overrides below, so these are never called
+      static result<buffer_type> do_read(buffer_type out, buffer_type /*unused*/, buffer_type /*unused*/) noexcept { return out; }
+      static result<const_buffer_type> do_write(buffer_type t, buffer_type /*unused*/, const_buffer_type in) noexcept { return buffer_type{t.data(), in.size()}; }
+      static result<const_buffers_type> adjust_written_buffers(const_buffers_type out, const_buffer_type /*unused*/, const_buffer_type /*unused*/) noexcept
+      {
+        return out;
+      }
+
+      template <class Base> struct override_ : public Base
+      {
+        using path_type = byte_io_handle::path_type;
+        using extent_type = byte_io_handle::extent_type;
+        using size_type = byte_io_handle::size_type;
+        using mode = byte_io_handle::mode;
+        using creation = byte_io_handle::creation;
+        using caching = byte_io_handle::caching;
+        using flag = byte_io_handle::flag;
+        using barrier_kind = byte_io_handle::barrier_kind;
+        using buffer_type = byte_io_handle::buffer_type;
+        using const_buffer_type = byte_io_handle::const_buffer_type;
+        using buffers_type = byte_io_handle::buffers_type;
+        using const_buffers_type = byte_io_handle::const_buffers_type;
+        template <class T> using io_request = byte_io_handle::io_request<T>;
+        template <class T> using io_result = byte_io_handle::io_result<T>;
+
+      protected:
+        static constexpr uint64_t _magic = 0x504d434f49464c4cULL;  // "LLFIOCMP" in little endian
+        static constexpr extent_type _header_bytes = 64;
+        static constexpr size_t _parallel_blocks = 4;  // the fewest blocks worth using the thread pool for
+
+        mapped_file_handle *_indexh{nullptr};
+        size_type _blocksize{65536};
+        const block_codec *_codec{nullptr};
+
+        compressed_header *_header() const noexcept { return reinterpret_cast<compressed_header *>(_indexh->address()); }
+        uint32_t *_entries() const noexcept { return reinterpret_cast<uint32_t *>(_indexh->address() + _header_bytes); }
+        // The bytes stored for a block, with zero meaning all zeros, and the block size meaning uncompressed
+        uint32_t _entry(const compressed_header *h, extent_type block) const noexcept { return (block < h->index_bytes / 4) ? _entries()[block] : 0; }
+
+        // Initialises the index file if it is empty, else checks it is for this block size and codec
+        result<compressed_header *> _open() const noexcept
+        {
+          if(_indexh->address() == nullptr)
+          {
+            OUTCOME_TRY(auto &&indexlength, _indexh->maximum_extent());
+            if(indexlength == 0)
+            {
+              OUTCOME_TRY(_indexh->truncate(_header_bytes));
+              auto *h = _header();
+              h->magic = _magic;
+              h->block_size = _blocksize;
+              h->length = 0;
+              h->index_bytes = 0;
+              strncpy(h->codec, _codec->name(), sizeof(h->codec) - 1);
+              return h;
+            }
+          }
+          auto *h = _header();
+          if(h == nullptr || h->magic != _magic || h->block_size != _blocksize || strncmp(h->codec, _codec->name(), sizeof(h->codec) - 1) != 0)
+          {
+            return errc::invalid_argument;
+          }
+          return h;
+        }
+        // Ensures the index has room for the first `blocks` blocks
+        result<compressed_header *> _reserve(compressed_header *h, extent_type blocks) noexcept
+        {
+          const extent_type needed = ((blocks + 1) / 2) * 8;
+          if(needed <= h->index_bytes)
+          {
+            return h;
+          }
+          // Grow geometrically, as extending a mapped file is not cheap
+          const extent_type indexbytes = std::max(needed, 2 * h->index_bytes);
+          OUTCOME_TRY(_indexh->truncate(_header_bytes + indexbytes));
+          h = _header();
+          h->index_bytes = indexbytes;
+          return h;
+        }
+        template <class F> result<void> _for_each_block(size_t count, F &f) const noexcept
+        {
+          const bool parallel = count >= _parallel_blocks && !(this->_.flags & flag::disable_parallelism);
+          return compressed_for_each_block(
+          count, 2 * _blocksize, parallel, [](void *ctx, size_t n, byte *scratch) -> result<void> { return (*static_cast<F *>(ctx))(n, scratch); }, &f);
+        }
+
+        // Loads the whole of a block into `image`, using `packed` for the compressed form
+        result<void> _load(const compressed_header *h, extent_type block, byte *image, byte *packed, deadline d) const noexcept
+        {
+          const size_type blocksize = _blocksize;
+          const uint32_t stored = _entry(h, block);
+          size_type got = 0;
+          if(stored == blocksize)
+          {
+            buffer_type b(image, blocksize);
+            OUTCOME_TRY(auto &&filled, this->_target->read(io_request<buffers_type>({&b, 1}, block * blocksize), d));
+            if(filled[0].data() != image)
+            {
+              memmove(image, filled[0].data(), filled[0].size());
+            }
+            got = filled[0].size();
+          }
+          else if(stored > 0)
+          {
+            buffer_type b(packed, stored);
+            OUTCOME_TRY(auto &&filled, this->_target->read(io_request<buffers_type>({&b, 1}, block * blocksize), d));
+            if(filled[0].size() != stored)
+            {
+              return errc::io_error;
+            }
+            OUTCOME_TRY(got, _codec->decompress({image, blocksize}, {filled[0].data(), stored}));
+            if(got != blocksize)
+            {
+              return errc::io_error;
+            }
+          }
+          memset(image + got, 0, blocksize - got);
+          return success();
+        }
+        // Stores the whole of a block from `image`, using `packed` for the compressed form, returning what to put into its index entry
+        result<uint32_t> _store(const compressed_header *h, extent_type block, const byte *image, byte *packed, deadline d) noexcept
+        {
+          const size_type blocksize = _blocksize;
+          const uint32_t old = _entry(h, block);
+          uint32_t stored = 0;
+          const byte *p = image;
+          {
+            uint64_t v = 0;
+            for(size_type n = 0; n < blocksize && v == 0; n += sizeof(v))
+            {
+              memcpy(&v, image + n, sizeof(v));
+            }
+            if(v != 0)
+            {
+              stored = (uint32_t) _codec->compress({packed, blocksize - 1}, {image, blocksize});
+              if(stored == 0)
+              {
+                stored = (uint32_t) blocksize;
+              }
+              else
+              {
+                p = packed;
+              }
+            }
+          }
+          if(stored > 0)
+          {
+            const_buffer_type b(p, stored);
+            OUTCOME_TRY(this->_target->write(io_request<const_buffers_type>({&b, 1}, block * blocksize), d));
+          }
+          if(old > stored)
+          {
+            // Give back the storage no longer used
+            OUTCOME_TRY(this->_target->zero({block * blocksize + stored, old - stored}, d));
+          }
+          return stored;
+        }
+
+      public:
+        override_() = default;
+        /*! Constructor. `indexh` is the mapped file in which the index of blocks is kept,
+        which if empty will be initialised for an empty file. `blocksize` is the granularity
+        of compression, and must be a power of two no larger than 2Gb. `codec` is the
+        compression codec to use, with null meaning `lz_block_codec()`. The block size and
+        codec must be the same every time the same files are adapted.
+        */
+        override_(Target *a, void *b, mode _mode, flag flags, byte_io_multiplexer *ctx, mapped_file_handle *indexh, size_type blocksize = 65536,
+                  const block_codec *codec = nullptr)
+            : Base(a, b, _mode, flags, ctx)
+            , _indexh(indexh)
+            , _blocksize(blocksize)
+            , _codec((codec != nullptr) ? codec : &lz_block_codec())
+        {
+          assert(_indexh != nullptr);
+          assert(blocksize >= 8 && blocksize <= 0x80000000 && (blocksize & (blocksize - 1)) == 0);
+        }
+
+        //! The granularity of compression.
+        size_type block_size() const noexcept { return _blocksize; }
+        //! The compression codec.
+        const block_codec &codec() const noexcept { return *_codec; }
+
+        //! \brief Returns the bytes of the backing file in use, which is less than `maximum_extent()` for compressible data.
+        result<extent_type> stored_bytes() const noexcept
+        {
+          OUTCOME_TRY(auto &&h, _open());
+          const extent_type blocks = (h->length + _blocksize - 1) / _blocksize;
+          extent_type ret = 0;
+          for(extent_type block = 0; block < blocks; block++)
+          {
+            ret += _entry(h, block);
+          }
+          return ret;
+        }
+
+      protected:
+        //! Reads and decompresses the blocks covering the request, concurrently if there are many.
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<buffers_type> _do_read(io_request<buffers_type> reqs, deadline d = deadline()) noexcept override
+        {
+          OUTCOME_TRY(auto &&h, _open());
+          const extent_type blocksize = _blocksize;
+          // Trim the request to the length of the file
+          extent_type left = (reqs.offset < h->length) ? (h->length - reqs.offset) : 0, bytes = 0;
+          for(auto &b : reqs.buffers)
+          {
+            b = {b.data(), (size_type) std::min((extent_type) b.size(), left)};
+            left -= b.size();
+            bytes += b.size();
+          }
+          if(bytes == 0)
+          {
+            return std::move(reqs.buffers);
+          }
+          const extent_type end = reqs.offset + bytes, first = reqs.offset / blocksize;
+          auto task = [&](size_t n, byte *scratch) -> result<void> {
+            const extent_type blockoffset = (first + n) * blocksize;
+            OUTCOME_TRY(_load(h, first + n, scratch, scratch + blocksize, d));
+            // Copy the part wanted into the request buffers
+            const extent_type from = std::max(reqs.offset, blockoffset), to = std::min(end, blockoffset + blocksize);
+            const byte *src = scratch + (from - blockoffset);
+            auto skip = (size_type) (from - reqs.offset), len = (size_type) (to - from);
+            for(auto &b : reqs.buffers)
+            {
+              if(skip >= b.size())
+              {
+                skip -= b.size();
+                continue;
+              }
+              const size_type todo = std::min(b.size() - skip, len);
+              memcpy(b.data() + skip, src, todo);
+              src += todo;
+              len -= todo;
+              skip = 0;
+              if(len == 0)
+              {
+                break;
+              }
+            }
+            return success();
+          };
+          OUTCOME_TRY(_for_each_block((size_t) ((end + blocksize - 1) / blocksize - first), task));
+          return std::move(reqs.buffers);
+        }
+
+        /*! Compresses and writes the blocks covering the request, concurrently if there are
+        many, first loading the existing contents of any partial blocks. Only then is the index
+        updated.
+        */
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<const_buffers_type> _do_write(io_request<const_buffers_type> reqs, deadline d = deadline()) noexcept override
+        {
+          try
+          {
+            OUTCOME_TRY(auto &&h, _open());
+            const extent_type blocksize = _blocksize;
+            size_type bytes = 0;
+            for(const auto &b : reqs.buffers)
+            {
+              bytes += b.size();
+            }
+            if(bytes == 0)
+            {
+              return std::move(reqs.buffers);
+            }
+            const extent_type end = reqs.offset + bytes, first = reqs.offset / blocksize, last = (end + blocksize - 1) / blocksize;
+            {
+              OUTCOME_TRY(auto &&reserved, _reserve(h, last));
+              h = reserved;
+            }
+            std::vector<uint32_t> entries((size_t) (last - first));
+            auto task = [&](size_t n, byte *scratch) -> result<void> {
+              const extent_type blockoffset = (first + n) * blocksize;
+              const extent_type from = std::max(reqs.offset, blockoffset), to = std::min(end, blockoffset + blocksize);
+              if(to - from < blocksize)
+              {
+                OUTCOME_TRY(_load(h, first + n, scratch, scratch + blocksize, d));
+              }
+              // Copy the part written from the request buffers
+              byte *dest = scratch + (from - blockoffset);
+              auto skip = (size_type) (from - reqs.offset), len = (size_type) (to - from);
+              for(const auto &b : reqs.buffers)
+              {
+                if(skip >= b.size())
+                {
+                  skip -= b.size();
+                  continue;
+                }
+                const size_type todo = std::min(b.size() - skip, len);
+                memcpy(dest, b.data() + skip, todo);
+                dest += todo;
+                len -= todo;
+                skip = 0;
+                if(len == 0)
+                {
+                  break;
+                }
+              }
+              OUTCOME_TRY(entries[n], _store(h, first + n, scratch, scratch + blocksize, d));
+              return success();
+            };
+            OUTCOME_TRY(_for_each_block(entries.size(), task));
+            memcpy(_entries() + first, entries.data(), entries.size() * sizeof(uint32_t));
+            h->length = std::max(h->length, end);
+            return std::move(reqs.buffers);
+          }
+          catch(...)
+          {
+            return error_from_exception();
+          }
+        }
+
+        //! \brief Barriers the backing handle with the request, and then the whole of the index.
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<const_buffers_type> _do_barrier(io_request<const_buffers_type> reqs, barrier_kind kind, deadline d) noexcept override
+        {
+          OUTCOME_TRY(auto &&ret, this->_target->barrier(reqs, kind, d));
+          OUTCOME_TRY(_indexh->barrier({}, kind, d));
+          return std::move(ret);
+        }
+
+      public:
+        //! \brief Return the length of the uncompressed file
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> maximum_extent() const noexcept override
+        {
+          OUTCOME_TRY(auto &&h, _open());
+          return h->length;
+        }
+        //! \brief Return the extents of the uncompressed file which are not all zeros, from the index without doing any i/o.
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<std::vector<file_handle::extent_pair>> extents() const noexcept override
+        {
+          try
+          {
+            OUTCOME_TRY(auto &&h, _open());
+            const extent_type blocksize = _blocksize, blocks = (h->length + blocksize - 1) / blocksize;
+            std::vector<file_handle::extent_pair> ret;
+            for(extent_type block = 0; block < blocks; block++)
+            {
+              if(_entry(h, block) == 0)
+              {
+                continue;
+              }
+              const extent_type offset = block * blocksize, length = std::min(blocksize, h->length - offset);
+              if(!ret.empty() && ret.back().offset + ret.back().length == offset)
+              {
+                ret.back().length += length;
+              }
+              else
+              {
+                ret.emplace_back(offset, length);
+              }
+            }
+            return ret;
+          }
+          catch(...)
+          {
+            return error_from_exception();
+          }
+        }
+        /*! \brief Truncate the uncompressed file. When shrinking, any partial last block is
+        rewritten so that anything later extended reads as zeros, and the backing file is
+        truncated to match.
+        */
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> truncate(extent_type newsize) noexcept override
+        {
+          OUTCOME_TRY(auto &&h, _open());
+          if(newsize < h->length)
+          {
+            const extent_type blocksize = _blocksize, keep = (newsize + blocksize - 1) / blocksize;
+            if(newsize % blocksize != 0 && _entry(h, newsize / blocksize) != 0)
+            {
+              uint32_t entry = 0;
+              auto task = [&](size_t /*unused*/, byte *scratch) -> result<void> {
+                OUTCOME_TRY(_load(h, newsize / blocksize, scratch, scratch + blocksize, {}));
+                memset(scratch + newsize % blocksize, 0, (size_t) (blocksize - newsize % blocksize));
+                OUTCOME_TRY(entry, _store(h, newsize / blocksize, scratch, scratch + blocksize, {}));
+                return success();
+              };
+              OUTCOME_TRY(_for_each_block(1, task));
+              _entries()[newsize / blocksize] = entry;
+            }
+            for(extent_type block = keep; block < h->index_bytes / 4; block++)
+            {
+              _entries()[block] = 0;
+            }
+            OUTCOME_TRY(auto &&backinglength, this->_target->maximum_extent());
+            if(backinglength > keep * blocksize)
+            {
+              OUTCOME_TRY(this->_target->truncate(keep * blocksize));
+            }
+          }
+          h->length = newsize;
+          return newsize;
+        }
+        /*! \brief Zeros a range of the uncompressed file, punching a hole in the backing file
+        for the blocks wholly within the range, and rewriting any partial blocks.
+        */
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> zero(file_handle::extent_pair extent, deadline d = deadline()) noexcept override
+        {
+          OUTCOME_TRY(auto &&h, _open());
+          const extent_type blocksize = _blocksize;
+          const extent_type begin = std::min(extent.offset, h->length);
+          const extent_type end = (extent.length > h->length - begin) ? h->length : (begin + extent.length);
+          // [begin, first) and [last, end) are partial blocks, [first, last) whole blocks
+          const extent_type first = std::min(end, (begin + blocksize - 1) & ~(blocksize - 1));
+          const extent_type last = std::max(first, end & ~(blocksize - 1));
+          if(first < last)
+          {
+            for(extent_type block = first / blocksize; block < last / blocksize && block < h->index_bytes / 4; block++)
+            {
+              _entries()[block] = 0;
+            }
+            OUTCOME_TRY(this->_target->zero({first, last - first}, d));
+          }
+          for(auto range : {file_handle::extent_pair(begin, first - begin), file_handle::extent_pair(last, end - last)})
+          {
+            if(range.length > 0)
+            {
+              OUTCOME_TRY(auto &&zeros, map_handle::map((size_type) range.length));
+              const_buffer_type b(zeros.address(), (size_type) range.length);
+              OUTCOME_TRY(override_::_do_write(io_request<const_buffers_type>({&b, 1}, range.offset), d));
+            }
+          }
+          return end - begin;
+        }
+      };
+    };
+  }  // namespace detail
+
+  /*! \brief A handle which stores fixed size blocks of a file compressed in a backing file.
+  \tparam Target The type of the backing handle.
+
+  The file is divided into `block_size()` blocks, each of which is compressed on its own,
+  so random reads only need to decompress the blocks they touch. Each block has a slot of
+  `block_size()` in the backing file, at the same offset as in the file, in which its
+  compressed form is stored from the beginning, with the remainder of the slot punched out
+  using `zero()`. The space saved therefore depends on the backing filing system supporting
+  sparse files, and on the block size being a good multiple of its allocation granularity.
+  Blocks which do not compress are stored uncompressed, and blocks which are all zeros are
+  not stored at all.
+
+  A mapped side file keeps a small header, which records the length of the file and the
+  name of the codec, followed by the bytes stored for each block as a native byte order
+  `uint32_t`. `extents()` returns the blocks which are not all zeros from this, without
+  any i/o. The codec is pluggable by implementing `block_codec`, with `lz_block_codec()`
+  used by default.
+
+  Reads and writes of many blocks compress and decompress them concurrently using
+  a `dynamic_thread_pool_group`, unless `flag::disable_parallelism` is set. Writes
+  which do not begin and end on block boundaries must decompress and recompress the
+  partial blocks. Prefer large block aligned writes.
+
+  \warning Blocks are overwritten in place, and the index is updated after the blocks are
+  written, so an interrupted write may leave the blocks it touched unreadable. This adapter
+  is not safe for concurrent writes.
+  */
+  template <class Target = file_handle> using compressed_handle_adapter = combining_handle_adapter<detail::compressed_handle_adapter_op, Target, void>;
+
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
+
+#if LLFIO_HEADERS_ONLY == 1 && !defined(DOXYGEN_SHOULD_SKIP_THIS)
+#define LLFIO_INCLUDED_BY_HEADER 1
+#include "../../detail/impl/compressed_handle_adapter.ipp"
+#undef LLFIO_INCLUDED_BY_HEADER
+#endif
+
+#endif
@@ -0,0 +1,529 @@
+/* A handle adapter overlaying a read only file with a copy on write delta file
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#ifndef LLFIO_ALGORITHM_HANDLE_ADAPTER_COW_OVERLAY_H
+#define LLFIO_ALGORITHM_HANDLE_ADAPTER_COW_OVERLAY_H
+
+#include "../../mapped_file_handle.hpp"
+#include "combining.hpp"
+
+//! \file handle_adapter/cow_overlay.hpp Provides `cow_overlay_handle_adapter`.
+
+LLFIO_V2_NAMESPACE_EXPORT_BEGIN
+
+namespace algorithm
+{
+  namespace detail
+  {
+    // The start of the bitmap file, which is followed by one bit per block
+    struct cow_overlay_header
+    {
+      uint64_t magic;
+      uint64_t block_size;
+      uint64_t length;        // of the overlaid file
+      uint64_t base_length;   // the base reads as zeros from here, after truncation
+      uint64_t bitmap_bytes;  // following the header
+    };
+
+    template <class Target, class Source> struct cow_overlay_handle_adapter_op
+    {
+      static_assert(!std::is_void<Source>::value, "A base handle is required by cow_overlay_handle_adapter");
+      static_assert(std::is_base_of<file_handle, Target>::value && std::is_base_of<file_handle, Source>::value,
+                    "cow_overlay_handle_adapter requires both handles to be file handles");
+
+      using buffer_type = typename Target::buffer_type;
+      using const_buffer_type = typename Target::const_buffer_type;
+      using const_buffers_type = typename Target::const_buffers_type;
+
+      // All i/o is done by the overrides below, so these are never called
+      static result<buffer_type> do_read(buffer_type out, buffer_type /*unused*/, buffer_type /*unused*/) noexcept { return out; }
+      static result<const_buffer_type> do_write(buffer_type t, buffer_type /*unused*/, const_buffer_type in) noexcept { return buffer_type{t.data(), in.size()}; }
+      static result<const_buffers_type> adjust_written_buffers(const_buffers_type out, const_buffer_type /*unused*/, const_buffer_type /*unused*/) noexcept
+      {
+        return out;
+      }
+
+      template <class Base> struct override_ : public Base
+      {
+        using path_type = byte_io_handle::path_type;
+        using extent_type = byte_io_handle::extent_type;
+        using size_type = byte_io_handle::size_type;
+        using mode = byte_io_handle::mode;
+        using creation = byte_io_handle::creation;
+        using caching = byte_io_handle::caching;
+        using flag = byte_io_handle::flag;
+        using barrier_kind = byte_io_handle::barrier_kind;
+        using buffer_type = byte_io_handle::buffer_type;
+        using const_buffer_type = byte_io_handle::const_buffer_type;
+        using buffers_type = byte_io_handle::buffers_type;
+        using const_buffers_type = byte_io_handle::const_buffers_type;
+        template <class T> using io_request = byte_io_handle::io_request<T>;
+        template <class T> using io_result = byte_io_handle::io_result<T>;
+
+      protected:
+        static constexpr uint64_t _magic = 0x574f434f49464c4cULL;  // "LLFIOCOW" in little endian
+        static constexpr extent_type _header_bytes = 64;
+
+        mapped_file_handle *_bitmaph{nullptr};
+        size_type _blocksize{65536};
+
+        cow_overlay_header *_header() const noexcept { return reinterpret_cast<cow_overlay_header *>(_bitmaph->address()); }
+        uint64_t *_bits() const noexcept { return reinterpret_cast<uint64_t *>(_bitmaph->address() + _header_bytes); }
+
+        // Initialises the bitmap file if it is empty, else checks it is for this block size
+        result<cow_overlay_header *> _open() const noexcept
+        {
+          if(_bitmaph->address() == nullptr)
+          {
+            OUTCOME_TRY(auto &&bitmaplength, _bitmaph->maximum_extent());
+            if(bitmaplength == 0)
+            {
+              OUTCOME_TRY(auto &&baselength, this->_source->maximum_extent());
+              const extent_type bitmapbytes = ((baselength / _blocksize + 64) / 64) * 8;
+              OUTCOME_TRY(_bitmaph->truncate(_header_bytes + bitmapbytes));
+              auto *h = _header();
+              h->magic = _magic;
+              h->block_size = _blocksize;
+              h->length = baselength;
+              h->base_length = baselength;
+              h->bitmap_bytes = bitmapbytes;
+              return h;
+            }
+          }
+          auto *h = _header();
+          if(h == nullptr || h->magic != _magic || h->block_size != _blocksize)
+          {
+            return errc::invalid_argument;
+          }
+          return h;
+        }
+        // Ensures the bitmap has room for the first `blocks` blocks
+        result<cow_overlay_header *> _reserve(cow_overlay_header *h, extent_type blocks) noexcept
+        {
+          const extent_type needed = ((blocks + 63) / 64) * 8;
+          if(needed <= h->bitmap_bytes)
+          {
+            return h;
+          }
+          // Grow geometrically, as extending a mapped file is not cheap
+          const extent_type bitmapbytes = std::max(needed, 2 * h->bitmap_bytes);
+          OUTCOME_TRY(_bitmaph->truncate(_header_bytes + bitmapbytes));
+          h = _header();
+          h->bitmap_bytes = bitmapbytes;
+          return h;
+        }
+        // True if the block is in the delta
+        bool _test(const cow_overlay_header *h, extent_type block) const noexcept
+        {
+          return block / 8 < h->bitmap_bytes && ((_bits()[block / 64] >> (block % 64)) & 1) != 0;
+        }
+        // Sets or clears the bits of blocks [first, last), which must be within the bitmap
+        void _assign(extent_type first, extent_type last, bool set) noexcept
+        {
+          uint64_t *bits = _bits();
+          for(extent_type block = first; block < last;)
+          {
+            const extent_type bit = block % 64, n = std::min(last - block, 64 - bit);
+            const uint64_t mask = ((n == 64) ? ~(uint64_t) 0 : (((uint64_t) 1 << n) - 1)) << bit;
+            if(set)
+            {
+              bits[block / 64] |= mask;
+            }
+            else
+            {
+              bits[block / 64] &= ~mask;
+            }
+            block += n;
+          }
+        }
+        // Returns the first block in [block, last) which is not in the same state as `set`, else `last`
+        extent_type _run_end(const cow_overlay_header *h, extent_type block, extent_type last, bool set) const noexcept
+        {
+          const uint64_t *bits = _bits();
+          const extent_type capacity = h->bitmap_bytes * 8;
+          while(block < last)
+          {
+            if(block >= capacity)
+            {
+              // Blocks beyond the bitmap are not in the delta
+              return set ? block : last;
+            }
+            uint64_t w = (set ? ~bits[block / 64] : bits[block / 64]) >> (block % 64);
+            if(w == 0)
+            {
+              block = (block / 64 + 1) * 64;
+              continue;
+            }
+            while((w & 1) == 0)
+            {
+              w >>= 1;
+              block++;
+            }
+            return std::min(block, last);
+          }
+          return last;
+        }
+        /* Fills `len` bytes from `rel` bytes into `bufs` with what is at `pos` in `h`, reading
+        no more than `avail` bytes from `h` and zeroing the remainder.
+        */
+        template <class H> result<void> _fill(H *h, buffers_type bufs, size_type rel, size_type len, size_type avail, extent_type pos, deadline d) noexcept
+        {
+          // Twice as many, as the reading handle may overwrite the buffers passed to it
+          auto *slices = (buffer_type *) alloca(sizeof(buffer_type) * bufs.size() * 2);
+          auto slice = [&](size_type from, size_type bytes) -> size_t {
+            size_t count = 0;
+            for(auto &b : bufs)
+            {
+              if(bytes == 0)
+              {
+                break;
+              }
+              if(from >= b.size())
+              {
+                from -= b.size();
+                continue;
+              }
+              const size_type n = std::min(b.size() - from, bytes);
+              slices[count++] = {b.data() + from, n};
+              from = 0;
+              bytes -= n;
+            }
+            return count;
+          };
+          size_type got = 0;
+          avail = std::min(avail, len);
+          if(avail > 0)
+          {
+            const size_t count = slice(rel, avail);
+            std::copy(slices, slices + count, slices + count);
+            OUTCOME_TRY(auto &&filled, h->read(io_request<buffers_type>({slices + count, count}, pos), d));
+            for(size_t n = 0; n < filled.size(); n++)
+            {
+              // Some handles e.g. mapped ones return pointers to elsewhere
+              if(filled[n].data() != slices[n].data())
+              {
+                memmove(slices[n].data(), filled[n].data(), filled[n].size());
+              }
+              got += filled[n].size();
+            }
+          }
+          if(got < len)
+          {
+            const size_t count = slice(rel + got, len - got);
+            for(size_t n = 0; n < count; n++)
+            {
+              memset(slices[n].data(), 0, slices[n].size());
+            }
+          }
+          return success();
+        }
+        // Writes zeros over a range within a single block
+        result<void> _write_zeros(extent_type offset, extent_type bytes, deadline d) noexcept
+        {
+          if(bytes == 0)
+          {
+            return success();
+          }
+          OUTCOME_TRY(auto &&zeros, map_handle::map((size_type) bytes));
+          const_buffer_type b(zeros.address(), (size_type) bytes);
+          OUTCOME_TRY(override_::_do_write(io_request<const_buffers_type>({&b, 1}, offset), d));
+          return success();
+        }
+
+      public:
+        override_() = default;
+        /*! Constructor. `bitmaph` is the mapped file in which the bitmap of the blocks in
+        the delta is kept, which if empty will be initialised for the current contents of
+        the base. `blocksize` is the granularity of copy on write, and must be a power of
+        two. It must be the same every time the same files are adapted.
+        */
+        override_(Target *a, Source *b, mode _mode, flag flags, byte_io_multiplexer *ctx, mapped_file_handle *bitmaph, size_type blocksize = 65536)
+            : Base(a, b, _mode, flags, ctx)
+            , _bitmaph(bitmaph)
+            , _blocksize(blocksize)
+        {
+          assert(_bitmaph != nullptr);
+          assert(blocksize > 0 && (blocksize & (blocksize - 1)) == 0);
+        }
+
+        //! The granularity of copy on write.
+        size_type block_size() const noexcept { return _blocksize; }
+
+        /*! \brief Applies the overlay to `dest`, which must have the same contents as the base.
+
+        `dest` is truncated to match, and then each of `extents()` is cloned into it from the
+        delta using `clone_extents_to()`, so storage is shared rather than copied where the
+        filing system can. `dest` can be the base itself opened for write, after which
+        truncating the delta and bitmap to zero length begins a new snapshot.
+        */
+        result<void> merge_into(file_handle &dest, deadline d = deadline()) noexcept
+        {
+          OUTCOME_TRY(auto &&exts, extents());
+          OUTCOME_TRY(auto &&h, _open());
+          OUTCOME_TRY(dest.truncate(h->base_length));
+          OUTCOME_TRY(dest.truncate(h->length));
+          for(auto &e : exts)
+          {
+            // Holes in the delta are not cloned, so must be zeros beforehand
+            OUTCOME_TRY(dest.zero(e, d));
+            OUTCOME_TRY(this->_target->clone_extents_to(e, dest, e.offset, d));
+          }
+          return success();
+        }
+
+      protected:
+        //! \brief Return two fewer than the target's maximum buffers, to leave room for any partial blocks
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC size_t _do_max_buffers() const noexcept override
+        {
+          auto r = this->_target->max_buffers();
+          return (r > 2) ? (r - 2) : 1;
+        }
+
+        //! Reads each run of blocks from whichever of the delta or base it is in.
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<buffers_type> _do_read(io_request<buffers_type> reqs, deadline d = deadline()) noexcept override
+        {
+          OUTCOME_TRY(auto &&h, _open());
+          const extent_type blocksize = _blocksize;
+          // Trim the request to the length of the overlaid file
+          extent_type left = (reqs.offset < h->length) ? (h->length - reqs.offset) : 0, bytes = 0;
+          for(auto &b : reqs.buffers)
+          {
+            b = {b.data(), (size_type) std::min((extent_type) b.size(), left)};
+            left -= b.size();
+            bytes += b.size();
+          }
+          const extent_type end = reqs.offset + bytes;
+          const extent_type lastblock = (end + blocksize - 1) / blocksize;
+          for(extent_type pos = reqs.offset; pos < end;)
+          {
+            const extent_type block = pos / blocksize;
+            const bool indelta = _test(h, block);
+            const extent_type runend = std::min(end, _run_end(h, block, lastblock, indelta) * blocksize);
+            const auto rel = (size_type) (pos - reqs.offset), len = (size_type) (runend - pos);
+            if(indelta)
+            {
+              OUTCOME_TRY(_fill(this->_target, reqs.buffers, rel, len, len, pos, d));
+            }
+            else
+            {
+              const auto avail = (size_type) ((h->base_length > pos) ? (h->base_length - pos) : 0);
+              OUTCOME_TRY(_fill(this->_source, reqs.buffers, rel, len, avail, pos, d));
+            }
+            pos = runend;
+          }
+          return std::move(reqs.buffers);
+        }
+
+        /*! Writes the request to the delta, preceded and followed by the remainder of any
+        partial blocks which are not yet in the delta, copied from the base. Only then are
+        the blocks written marked as being in the delta.
+        */
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<const_buffers_type> _do_write(io_request<const_buffers_type> reqs, deadline d = deadline()) noexcept override
+        {
+          OUTCOME_TRY(auto &&h, _open());
+          const extent_type blocksize = _blocksize;
+          size_type bytes = 0;
+          for(const auto &b : reqs.buffers)
+          {
+            bytes += b.size();
+          }
+          if(bytes == 0)
+          {
+            return std::move(reqs.buffers);
+          }
+          const extent_type last = reqs.offset + bytes;
+          const extent_type begin = reqs.offset & ~(blocksize - 1), end = (last + blocksize - 1) & ~(blocksize - 1);
+          {
+            OUTCOME_TRY(auto &&_, _reserve(h, end / blocksize));
+            h = _;
+          }
+          const auto headbytes = (size_type) ((reqs.offset > begin && !_test(h, begin / blocksize)) ? (reqs.offset - begin) : 0);
+          size_type tailbytes = 0;
+          if(last < end && !_test(h, last / blocksize))
+          {
+            const extent_type tailend = std::min(end, h->length);
+            tailbytes = (tailend > last) ? (size_type) (tailend - last) : 0;
+          }
+          const size_type scratchbytes = headbytes + tailbytes;
+          // If less than page size, use stack, else use free pages
+          auto *scratch = (byte *) ((scratchbytes <= utils::page_size()) ? alloca(scratchbytes) : nullptr);
+          map_handle scratchh;
+          if(scratch == nullptr)
+          {
+            OUTCOME_TRY(auto &&_, map_handle::map(scratchbytes));
+            scratchh = std::move(_);
+            scratch = scratchh.address();
+          }
+          byte *head = scratch, *tail = scratch + headbytes;
+          auto avail = [&](extent_type pos) { return (size_type) ((h->base_length > pos) ? (h->base_length - pos) : 0); };
+          if(headbytes > 0)
+          {
+            buffer_type b(head, headbytes);
+            OUTCOME_TRY(_fill(this->_source, {&b, 1}, 0, headbytes, avail(begin), begin, d));
+          }
+          if(tailbytes > 0)
+          {
+            buffer_type b(tail, tailbytes);
+            OUTCOME_TRY(_fill(this->_source, {&b, 1}, 0, tailbytes, avail(last), last, d));
+          }
+
+          auto *buffers = (const_buffer_type *) alloca(sizeof(const_buffer_type) * (reqs.buffers.size() + 2));
+          size_t count = 0;
+          if(headbytes > 0)
+          {
+            buffers[count++] = {head, headbytes};
+          }
+          for(auto &b : reqs.buffers)
+          {
+            buffers[count++] = b;
+          }
+          if(tailbytes > 0)
+          {
+            buffers[count++] = {tail, tailbytes};
+          }
+          OUTCOME_TRY(this->_target->write(io_request<const_buffers_type>({buffers, count}, reqs.offset - headbytes), d));
+          _assign(begin / blocksize, end / blocksize, true);
+          h->length = std::max(h->length, last);
+          return std::move(reqs.buffers);
+        }
+
+        //! \brief Barriers the delta handle with the request, and then the whole of the bitmap.
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<const_buffers_type> _do_barrier(io_request<const_buffers_type> reqs, barrier_kind kind, deadline d) noexcept override
+        {
+          OUTCOME_TRY(auto &&ret, this->_target->barrier(reqs, kind, d));
+          OUTCOME_TRY(_bitmaph->barrier({}, kind, d));
+          return std::move(ret);
+        }
+
+      public:
+        //! \brief Return the length of the overlaid file
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> maximum_extent() const noexcept override
+        {
+          OUTCOME_TRY(auto &&h, _open());
+          return h->length;
+        }
+        /*! \brief Return the extents of the overlaid file which are in the delta, and so
+        differ from the base. These come from the bitmap without doing any i/o.
+        */
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<std::vector<file_handle::extent_pair>> extents() const noexcept override
+        {
+          try
+          {
+            OUTCOME_TRY(auto &&h, _open());
+            const extent_type blocksize = _blocksize, lastblock = (h->length + blocksize - 1) / blocksize;
+            std::vector<file_handle::extent_pair> ret;
+            for(extent_type block = _run_end(h, 0, lastblock, false); block < lastblock;)
+            {
+              const extent_type end = _run_end(h, block, lastblock, true);
+              ret.emplace_back(block * blocksize, std::min(h->length, end * blocksize) - block * blocksize);
+              block = _run_end(h, end, lastblock, false);
+            }
+            return ret;
+          }
+          catch(...)
+          {
+            return error_from_exception();
+          }
+        }
+        /*! \brief Truncate the overlaid file. When shrinking, blocks beyond the new length
+        leave the delta, the delta is truncated, and the base is zeros from the new length
+        on, so that anything later extended reads as zeros.
+        */
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> truncate(extent_type newsize) noexcept override
+        {
+          OUTCOME_TRY(auto &&h, _open());
+          if(newsize < h->length)
+          {
+            const extent_type blocksize = _blocksize;
+            const extent_type firstgone = (newsize + blocksize - 1) / blocksize, capacity = h->bitmap_bytes * 8;
+            if(firstgone < capacity)
+            {
+              _assign(firstgone, capacity, false);
+            }
+            OUTCOME_TRY(auto &&deltalength, this->_target->maximum_extent());
+            if(deltalength > newsize)
+            {
+              OUTCOME_TRY(this->_target->truncate(newsize));
+            }
+            h->base_length = std::min(h->base_length, newsize);
+          }
+          h->length = newsize;
+          return newsize;
+        }
+        /*! \brief Zeros a range of the overlaid file, punching a hole in the delta for the
+        blocks wholly within the range, and writing zeros to any partial blocks.
+        */
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> zero(file_handle::extent_pair extent, deadline d = deadline()) noexcept override
+        {
+          OUTCOME_TRY(auto &&h, _open());
+          const extent_type blocksize = _blocksize;
+          const extent_type begin = std::min(extent.offset, h->length);
+          const extent_type end = (extent.length > h->length - begin) ? h->length : (begin + extent.length);
+          // [begin, first) and [last, end) are partial blocks, [first, last) whole blocks
+          const extent_type first = std::min(end, (begin + blocksize - 1) & ~(blocksize - 1));
+          const extent_type last = std::max(first, end & ~(blocksize - 1));
+          if(first < last)
+          {
+            OUTCOME_TRY(_reserve(h, last / blocksize));
+            OUTCOME_TRY(this->_target->zero({first, last - first}, d));
+            _assign(first / blocksize, last / blocksize, true);
+          }
+          OUTCOME_TRY(_write_zeros(begin, first - begin, d));
+          OUTCOME_TRY(_write_zeros(last, end - last, d));
+          return end - begin;
+        }
+      };
+    };
+  }  // namespace detail
+
+  /*! \brief A handle which presents a read only base file overlaid with a sparse delta
+  file, such that writes go to the delta and the base is never modified. This gives
+  instant writable snapshots of large files, including on filing systems without reflink.
+  \tparam Target The type of the handle of the delta.
+  \tparam Source The type of the handle of the base.
+
+  The overlaid file is divided into `block_size()` blocks, each of which is either in the
+  delta, at the same offset as in the overlaid file, or else read from the base. A mapped
+  side file keeps a small header, which records the length of the overlaid file, followed
+  by one bit per block, in native byte order. Writes which do not begin and end on block
+  boundaries, to blocks not yet in the delta, first copy the remainder of those blocks from
+  the base. Prefer block aligned writes.
+
+  `extents()` returns the extents which are in the delta, calculated from the bitmap
+  without any i/o. `merge_into()` clones those with `clone_extents_to()` to apply the
+  overlay to a copy of the base, or to the base itself.
+
+  \warning The delta and bitmap are not updated atomically. As data is written to the delta
+  before its blocks are marked in the bitmap, an interrupted write leaves blocks which were
+  not already in the delta unchanged, but truncation is not crash safe. This adapter is not
+  safe for concurrent writes.
+  */
+  template <class Target, class Source> using cow_overlay_handle_adapter = combining_handle_adapter<detail::cow_overlay_handle_adapter_op, Target, Source>;
+
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
+
+#endif
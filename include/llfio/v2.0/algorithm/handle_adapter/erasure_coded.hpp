@@ -0,0 +1,710 @@
+/* A handle adapter erasure coding one logical file across many file handles
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#ifndef LLFIO_ALGORITHM_HANDLE_ADAPTER_ERASURE_CODED_H
+#define LLFIO_ALGORITHM_HANDLE_ADAPTER_ERASURE_CODED_H
+
+#include "striped.hpp"
+
+#include <array>
+
+//! \file handle_adapter/erasure_coded.hpp Provides `erasure_coded_handle_adapter`.
+
+LLFIO_V2_NAMESPACE_EXPORT_BEGIN
+
+namespace algorithm
+{
+  //! \brief Returns the product of `a` and `b` in GF(2^8) with the polynomial 0x11d.
+  LLFIO_HEADERS_ONLY_FUNC_SPEC uint8_t gf256_mul(uint8_t a, uint8_t b) noexcept;
+  //! \brief Returns the multiplicative inverse of `a` in GF(2^8) with the polynomial 0x11d, or zero if `a` is zero.
+  LLFIO_HEADERS_ONLY_FUNC_SPEC uint8_t gf256_inverse(uint8_t a) noexcept;
+  /*! \brief Adds the product of `c` and each of the `bytes` at `in` to those at `out` in GF(2^8),
+  i.e. `out[n] ^= c * in[n]`.
+
+  The implementation is chosen at runtime for the CPU, using 16 entry table lookups of
+  the low and high nibbles of each byte with the AVX-512BW, AVX2 or SSSE3 `pshufb`
+  instruction on x86, or `tbl` on AArch64. Multiplication by one uses `combine_xor()`.
+  */
+  LLFIO_HEADERS_ONLY_FUNC_SPEC void gf256_mul_add(byte *out, const byte *in, uint8_t c, size_t bytes) noexcept;
+  //! \brief Returns the name of the GF(2^8) implementation chosen for this CPU e.g. "avx512", "avx2", "ssse3", "neon" or "scalar".
+  LLFIO_HEADERS_ONLY_FUNC_SPEC const char *gf256_implementation() noexcept;
+
+  namespace detail
+  {
+    // Inverts the n x n matrix in place, returning false if it is singular
+    LLFIO_HEADERS_ONLY_FUNC_SPEC bool gf256_invert_matrix(uint8_t *matrix, size_t n) noexcept;
+  }  // namespace detail
+
+  /*! \class erasure_coded_handle_adapter
+  \brief A handle striping one logical file across `k` data handles, with `m` parity handles
+  from which the contents of any `m` failed handles can be reconstructed.
+  \tparam Target The type of the backing handles.
+
+  The data is laid out across the first `k` handles exactly as by `striped_handle_adapter`.
+  Each of the remaining `m` handles stores, at offset `r * chunk_size()`, a parity chunk
+  computed from the `k` data chunks of stripe row `r`. For `m = 1` this is their XOR. For
+  `m > 1` it is a systematic Reed-Solomon code over GF(2^8) using a Cauchy matrix, whose
+  first row is scaled to be all ones so the first parity handle is always the XOR parity.
+  As every square submatrix of a Cauchy matrix is invertible, the data can be recovered
+  from any `k` of the `k + m` handles.
+
+  When all the data handles can be read, reads are exactly those of `striped_handle_adapter`
+  and parity is not touched. If any read fails, the stripe rows read are read again from
+  every handle, and the data of the handles which failed is reconstructed from the parity.
+  Backing handles which fail silently rather than with an error are not detected, however
+  each backing handle can be a `checksummed_handle_adapter`, which turns corruption into
+  read failures.
+
+  Writes update parity, so writes of less than whole stripe rows of `k * chunk_size()`
+  bytes need to read the rest of the rows touched first. Writes, `truncate()` and `zero()`
+  fail if any backing handle fails. Once a failed backing handle has been replaced, call
+  `rebuild()` to reconstruct its contents.
+
+  `lock_file_range()` locks whole stripe rows, as writes to any part of a row modify its
+  parity. Concurrent unlocked writes to the same row will corrupt its parity.
+
+  \note If OpenMP is available, `LLFIO_DISABLE_OPENMP` is not defined, and
+  `flag::disable_parallelism` is not set, the i/o to each backing handle will be
+  done concurrently.
+  */
+  template <class Target = file_handle> class erasure_coded_handle_adapter : public striped_handle_adapter<Target>
+  {
+    using _base = striped_handle_adapter<Target>;
+
+  public:
+    using path_type = byte_io_handle::path_type;
+    using extent_type = byte_io_handle::extent_type;
+    using size_type = byte_io_handle::size_type;
+    using mode = byte_io_handle::mode;
+    using creation = byte_io_handle::creation;
+    using caching = byte_io_handle::caching;
+    using flag = byte_io_handle::flag;
+    using barrier_kind = byte_io_handle::barrier_kind;
+    using buffer_type = byte_io_handle::buffer_type;
+    using const_buffer_type = byte_io_handle::const_buffer_type;
+    using buffers_type = byte_io_handle::buffers_type;
+    using const_buffers_type = byte_io_handle::const_buffers_type;
+    template <class T> using io_request = byte_io_handle::io_request<T>;
+    template <class T> using io_result = byte_io_handle::io_result<T>;
+
+    using target_handle_type = Target;
+    using extent_guard = typename _base::extent_guard;
+
+  protected:
+    span<target_handle_type *> _parity;
+
+    // Stripe rows are processed in batches of about this many bytes of data
+    static constexpr size_type _batch_bytes = 8 * 1024 * 1024;
+
+    size_t _k() const noexcept { return this->_handles.size(); }
+    size_t _m() const noexcept { return _parity.size(); }
+    extent_type _row_bytes() const noexcept { return this->_chunk_size * _k(); }
+    target_handle_type *_handle(size_t n) const noexcept { return (n < _k()) ? this->_handles[n] : _parity[n - _k()]; }
+    extent_type _rows_per_batch() const noexcept { return std::max((extent_type) 1, (extent_type) _batch_bytes / _row_bytes()); }
+
+    //! The coefficient of data handle `i` in parity handle `j`
+    uint8_t _coefficient(size_t j, size_t i) const noexcept
+    {
+      const auto x0 = (uint8_t) _k(), x = (uint8_t) (_k() + j), y = (uint8_t) i;
+      return gf256_mul(gf256_inverse(x ^ y), x0 ^ y);
+    }
+
+    //! The logical extent, treating the handles set in `excluded` and any which fail as lost
+    result<extent_type> _maximum_extent(uint64_t excluded) const noexcept
+    {
+      const size_t k = _k();
+      extent_type parity_length = 0;
+      size_t parity_available = 0;
+      for(size_t j = 0; j < _m(); j++)
+      {
+        if(((excluded >> (k + j)) & 1) == 0)
+        {
+          auto r = _parity[j]->maximum_extent();
+          if(r)
+          {
+            parity_length = std::max(parity_length, r.value());
+            parity_available++;
+          }
+        }
+      }
+      extent_type length = 0;
+      size_t lost = 0;
+      for(size_t n = 0; n < k; n++)
+      {
+        extent_type hlength = parity_length;
+        if(((excluded >> n) & 1) == 0)
+        {
+          auto r = this->_handles[n]->maximum_extent();
+          if(r)
+          {
+            hlength = r.value();
+          }
+          else
+          {
+            lost++;
+          }
+        }
+        else
+        {
+          lost++;
+        }
+        if(hlength > 0)
+        {
+          length = std::max(length, this->_logical_offset(n, hlength - 1) + 1);
+        }
+      }
+      if(lost > parity_available)
+      {
+        return errc::io_error;
+      }
+      return length;
+    }
+
+    //! Reads `bytes` at `offset` into `buf`, zero filling anything past the end of the handle
+    static result<void> _read_fully(target_handle_type *h, extent_type offset, byte *buf, size_type bytes, deadline d) noexcept
+    {
+      size_type done = 0;
+      while(done < bytes)
+      {
+        buffer_type b(buf + done, bytes - done);
+        OUTCOME_TRY(auto &&filled, h->read(io_request<buffers_type>({&b, 1}, offset + done), d));
+        const size_type got = filled.empty() ? 0 : filled[0].size();
+        if(got == 0)
+        {
+          break;
+        }
+        if(filled[0].data() != buf + done)
+        {
+          memmove(buf + done, filled[0].data(), got);
+        }
+        done += got;
+      }
+      memset(buf + done, 0, bytes - done);
+      return success();
+    }
+
+    //! A buffer of a batch of stripe rows for every handle, each handle's rows being contiguous
+    struct _batch
+    {
+      map_handle mem;
+      extent_type row_begin{0}, rows{0};
+      size_type chunk_size{0};
+
+      byte *region(size_t n) const noexcept { return mem.address() + n * rows * chunk_size; }
+      byte *chunk(size_t n, extent_type row) const noexcept { return region(n) + (row - row_begin) * chunk_size; }
+    };
+    result<_batch> _make_batch(extent_type row_begin, extent_type rows) const noexcept
+    {
+      _batch ret;
+      ret.row_begin = row_begin;
+      ret.rows = rows;
+      ret.chunk_size = (size_type) this->_chunk_size;
+      OUTCOME_TRY(auto &&mem, map_handle::map((size_type) ((_k() + _m()) * rows * this->_chunk_size)));
+      ret.mem = std::move(mem);
+      return {std::move(ret)};
+    }
+
+    /*! Reads stripe rows `[row_begin, row_end)` of the batch, reconstructing the data of any
+    data handle which fails to read, or which is set in `erased`. The parity rows are only
+    filled if reconstruction was needed.
+    */
+    result<void> _read_rows(const _batch &b, extent_type row_begin, extent_type row_end, uint64_t erased, deadline d) const noexcept
+    {
+      const size_t k = _k(), m = _m();
+      const auto bytes = (size_type) ((row_end - row_begin) * this->_chunk_size);
+      const extent_type offset = row_begin * this->_chunk_size;
+      auto *failed = reinterpret_cast<bool *>(alloca(k + m));
+      for(size_t n = 0; n < k + m; n++)
+      {
+        failed[n] = ((erased >> n) & 1) != 0;
+      }
+      auto readresult = this->_parallel_for(k, true, [&](size_t n) -> result<void> {
+        if(failed[n])
+        {
+          return success();
+        }
+        auto r = _read_fully(_handle(n), offset, b.chunk(n, row_begin), bytes, d);
+        if(!r)
+        {
+          failed[n] = true;
+        }
+        return r;
+      });
+      // Which data handles need reconstructing, and from which parity handles
+      auto *lost = reinterpret_cast<size_t *>(alloca(sizeof(size_t) * (k + m)));
+      auto *using_ = reinterpret_cast<size_t *>(alloca(sizeof(size_t) * (k + m)));
+      size_t lostcount = 0, usingcount = 0;
+      for(size_t n = 0; n < k; n++)
+      {
+        if(failed[n])
+        {
+          lost[lostcount++] = n;
+        }
+      }
+      if(lostcount == 0)
+      {
+        return success();
+      }
+      for(size_t j = 0; j < m && usingcount < lostcount; j++)
+      {
+        if(!failed[k + j] && _read_fully(_parity[j], offset, b.chunk(k + j, row_begin), bytes, d))
+        {
+          using_[usingcount++] = j;
+        }
+      }
+      if(usingcount < lostcount)
+      {
+        if(!readresult)
+        {
+          return readresult;
+        }
+        return errc::io_error;
+      }
+      // Remove the contribution of the surviving data from each parity row used, leaving
+      // a linear combination of the lost data
+      for(size_t u = 0; u < usingcount; u++)
+      {
+        byte *p = b.chunk(k + using_[u], row_begin);
+        for(size_t i = 0; i < k; i++)
+        {
+          if(!failed[i])
+          {
+            gf256_mul_add(p, b.chunk(i, row_begin), _coefficient(using_[u], i), bytes);
+          }
+        }
+      }
+      // Invert the coefficients of the lost data, and solve for it
+      auto *matrix = reinterpret_cast<uint8_t *>(alloca(lostcount * lostcount));
+      for(size_t u = 0; u < lostcount; u++)
+      {
+        for(size_t e = 0; e < lostcount; e++)
+        {
+          matrix[u * lostcount + e] = _coefficient(using_[u], lost[e]);
+        }
+      }
+      if(!detail::gf256_invert_matrix(matrix, lostcount))
+      {
+        return errc::io_error;
+      }
+      for(size_t e = 0; e < lostcount; e++)
+      {
+        byte *out = b.chunk(lost[e], row_begin);
+        memset(out, 0, bytes);
+        for(size_t u = 0; u < lostcount; u++)
+        {
+          gf256_mul_add(out, b.chunk(k + using_[u], row_begin), matrix[e * lostcount + u], bytes);
+        }
+      }
+      return success();
+    }
+
+    //! Computes the parity of stripe rows `[row_begin, row_end)` of the batch from its data
+    void _encode_rows(const _batch &b, extent_type row_begin, extent_type row_end) const noexcept
+    {
+      const size_t k = _k(), m = _m();
+      const auto bytes = (size_type) ((row_end - row_begin) * this->_chunk_size);
+      (void) this->_parallel_for(m, true, [&](size_t j) -> result<void> {
+        byte *p = b.chunk(k + j, row_begin);
+        memset(p, 0, bytes);
+        for(size_t i = 0; i < k; i++)
+        {
+          gf256_mul_add(p, b.chunk(i, row_begin), _coefficient(j, i), bytes);
+        }
+        return success();
+      });
+    }
+
+    //! Writes the parity of stripe rows `[row_begin, row_end)` of the batch
+    result<void> _write_parity(const _batch &b, extent_type row_begin, extent_type row_end, deadline d) const noexcept
+    {
+      const size_t k = _k();
+      return this->_parallel_for(_m(), true, [&](size_t j) -> result<void> {
+        const_buffer_type cb(b.chunk(k + j, row_begin), (size_type) ((row_end - row_begin) * this->_chunk_size));
+        OUTCOME_TRY(_parity[j]->write(io_request<const_buffers_type>({&cb, 1}, row_begin * this->_chunk_size), d));
+        return success();
+      });
+    }
+
+    //! Recalculates the parity of stripe rows `[row_begin, row_end)`
+    result<void> _update_parity(extent_type row_begin, extent_type row_end, deadline d) const noexcept
+    {
+      for(extent_type row = row_begin; row < row_end;)
+      {
+        const extent_type rows = std::min(row_end - row, _rows_per_batch());
+        OUTCOME_TRY(auto &&b, _make_batch(row, rows));
+        OUTCOME_TRY(_read_rows(b, row, row + rows, 0, d));
+        _encode_rows(b, row, row + rows);
+        OUTCOME_TRY(_write_parity(b, row, row + rows, d));
+        row += rows;
+      }
+      return success();
+    }
+
+    //! Visits the pieces of the buffers at logical `offset` with the data chunk of the batch which holds each
+    template <class BuffersType, class F> void _walk(const _batch &b, extent_type offset, const BuffersType &buffers, F &&f) const noexcept
+    {
+      const extent_type chunk = this->_chunk_size, rowbytes = _row_bytes();
+      extent_type pos = offset;
+      for(const auto &buffer : buffers)
+      {
+        auto *p = buffer.data();
+        size_type left = buffer.size();
+        while(left > 0)
+        {
+          const auto inchunk = (size_type) std::min((extent_type) left, chunk - pos % chunk);
+          f(b.chunk((size_t) ((pos / chunk) % _k()), pos / rowbytes) + pos % chunk, p, inchunk);
+          p += inchunk;
+          left -= inchunk;
+          pos += inchunk;
+        }
+      }
+    }
+
+  public:
+    //! Default constructor
+    erasure_coded_handle_adapter() = default;
+    /*! Constructs an instance striping across the first `data_handles` of `handles` in chunks
+    of `chunk_size` bytes, with the remainder of `handles` storing parity. There can be at
+    most 64 handles.
+    */
+    erasure_coded_handle_adapter(span<target_handle_type *> handles, size_t data_handles, extent_type chunk_size, mode _mode = mode::write,
+                                 flag flags = flag::none, byte_io_multiplexer *ctx = nullptr)
+        : _base(span<target_handle_type *>(handles.data(), data_handles), chunk_size, _mode, flags, ctx)
+        , _parity(handles.data() + data_handles, handles.size() - data_handles)
+    {
+      assert(data_handles > 0 && data_handles < handles.size());
+      assert(handles.size() <= 64);
+    }
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC ~erasure_coded_handle_adapter() override
+    {
+      // ignore
+    }
+
+    //! The parity handles. `handles()` returns the data handles.
+    span<target_handle_type *> parity_handles() const noexcept { return _parity; }
+
+    //! \brief Close all the backing handles.
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<void> close() noexcept override
+    {
+      auto ret = _base::close();
+      for(auto *h : _parity)
+      {
+        auto r = h->close();
+        if(!r && ret)
+        {
+          ret = std::move(r);
+        }
+      }
+      return ret;
+    }
+
+    /*! \brief Reconstructs the contents of backing handle `n`, where the data handles are
+    numbered from zero followed by the parity handles, from the other backing handles.
+    Use this after replacing a failed backing handle.
+
+    The length of a failed data handle cannot be known exactly, so it is taken to be the
+    greater of that implied by the other data handles, and the end of the last non-zero
+    byte reconstructed for it. If the logical file ended in zero bytes stored by the
+    failed handle, it may shrink by those bytes.
+    */
+    result<void> rebuild(size_t n, deadline d = deadline()) noexcept
+    {
+      const size_t k = _k();
+      if(n >= k + _m())
+      {
+        return errc::invalid_argument;
+      }
+      // The rows covered by the surviving handles
+      OUTCOME_TRY(auto &&surviving_length, _maximum_extent(uint64_t(1) << n));
+      extent_type row_end = (surviving_length + _row_bytes() - 1) / _row_bytes();
+      extent_type handle_length = row_end * this->_chunk_size;
+      if(n < k)
+      {
+        handle_length = 0;
+        for(size_t i = 0; i < k; i++)
+        {
+          // Other handles may also have failed and be awaiting rebuild
+          auto length = (i != n) ? this->_handles[i]->maximum_extent() : result<extent_type>(0);
+          if(length && length.value() > 0)
+          {
+            handle_length = std::max(handle_length, this->_backing_offset(n, this->_logical_offset(i, length.value() - 1) + 1));
+          }
+        }
+      }
+      OUTCOME_TRY(_handle(n)->truncate(0));
+      for(extent_type row = 0; row < row_end;)
+      {
+        const extent_type rows = std::min(row_end - row, _rows_per_batch());
+        OUTCOME_TRY(auto &&b, _make_batch(row, rows));
+        OUTCOME_TRY(_read_rows(b, row, row + rows, (n < k) ? (uint64_t(1) << n) : 0, d));
+        const extent_type begin = row * this->_chunk_size;
+        extent_type end = (row + rows) * this->_chunk_size;
+        if(n < k)
+        {
+          // Trailing zeros beyond what the other handles imply are assumed to be past the end
+          while(end > std::max(begin, handle_length) && b.region(n)[end - begin - 1] == (byte) 0)
+          {
+            end--;
+          }
+          handle_length = std::max(handle_length, end);
+        }
+        else
+        {
+          _encode_rows(b, row, row + rows);
+        }
+        if(begin < end)
+        {
+          const_buffer_type cb(b.region(n), (size_type) (end - begin));
+          OUTCOME_TRY(_handle(n)->write(io_request<const_buffers_type>({&cb, 1}, begin), d));
+        }
+        row += rows;
+      }
+      OUTCOME_TRY(_handle(n)->truncate(handle_length));
+      return success();
+    }
+    //! \brief Recalculates all the parity from the data handles e.g. after adopting existing striped data.
+    result<void> rebuild_parity(deadline d = deadline()) noexcept
+    {
+      OUTCOME_TRY(auto &&length, maximum_extent());
+      const extent_type row_end = (length + _row_bytes() - 1) / _row_bytes();
+      for(auto *h : _parity)
+      {
+        OUTCOME_TRY(h->truncate(row_end * this->_chunk_size));
+      }
+      return _update_parity(0, row_end, d);
+    }
+
+  protected:
+    /*! \brief Reads the data handles as `striped_handle_adapter` does, and if that fails,
+    reads whole stripe rows from every handle, reconstructing the data of the handles which failed.
+    */
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<buffers_type> _do_read(io_request<buffers_type> reqs, deadline d = deadline()) noexcept override
+    {
+      auto ret = this->_do_striped_io(reqs, d);
+      if(ret)
+      {
+        return ret;
+      }
+      OUTCOME_TRY(auto &&length, maximum_extent());
+      size_type bytes = 0;
+      for(const auto &b : reqs.buffers)
+      {
+        bytes += b.size();
+      }
+      const extent_type end = std::min(reqs.offset + bytes, length);
+      if(reqs.offset >= end)
+      {
+        for(auto &b : reqs.buffers)
+        {
+          b = buffer_type(b.data(), 0);
+        }
+        return std::move(reqs.buffers);
+      }
+      const extent_type rowbytes = _row_bytes();
+      for(extent_type row = reqs.offset / rowbytes, row_end = (end + rowbytes - 1) / rowbytes; row < row_end;)
+      {
+        const extent_type rows = std::min(row_end - row, _rows_per_batch());
+        OUTCOME_TRY(auto &&b, _make_batch(row, rows));
+        OUTCOME_TRY(_read_rows(b, row, row + rows, 0, d));
+        // Copy out whatever of the request lies within these rows
+        const extent_type batch_begin = row * rowbytes, batch_end = (row + rows) * rowbytes;
+        extent_type pos = reqs.offset;
+        for(auto &buffer : reqs.buffers)
+        {
+          const extent_type begin = std::max(pos, batch_begin), finish = std::min(pos + buffer.size(), std::min(batch_end, end));
+          if(begin < finish)
+          {
+            _walk(b, begin, std::array<buffer_type, 1>{buffer_type(buffer.data() + (begin - pos), (size_type) (finish - begin))},
+                  [](byte *chunk, byte *p, size_type n) { memcpy(p, chunk, n); });
+          }
+          pos += buffer.size();
+        }
+        row += rows;
+      }
+      // Trim the buffers to the logical length
+      size_type transferred = (size_type) (end - reqs.offset);
+      for(auto &b : reqs.buffers)
+      {
+        const auto n = std::min(b.size(), transferred);
+        b = buffer_type(b.data(), n);
+        transferred -= n;
+      }
+      return std::move(reqs.buffers);
+    }
+    /*! \brief Writes the data handles as `striped_handle_adapter` does, reading any parts of
+    the stripe rows touched not being written, and updating the parity of those rows.
+    */
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<const_buffers_type> _do_write(io_request<const_buffers_type> reqs, deadline d = deadline()) noexcept override
+    {
+      const size_t k = _k();
+      size_type bytes = 0;
+      for(const auto &b : reqs.buffers)
+      {
+        bytes += b.size();
+      }
+      if(bytes == 0)
+      {
+        return std::move(reqs.buffers);
+      }
+      const extent_type rowbytes = _row_bytes(), end = reqs.offset + bytes;
+      for(extent_type row = reqs.offset / rowbytes, row_end = (end + rowbytes - 1) / rowbytes; row < row_end;)
+      {
+        const extent_type rows = std::min(row_end - row, _rows_per_batch());
+        OUTCOME_TRY(auto &&b, _make_batch(row, rows));
+        const extent_type batch_begin = std::max(row * rowbytes, reqs.offset), batch_end = std::min((row + rows) * rowbytes, end);
+        // Rows only partially written need their existing contents
+        if(batch_begin % rowbytes != 0)
+        {
+          OUTCOME_TRY(_read_rows(b, row, row + 1, 0, d));
+        }
+        if(batch_end % rowbytes != 0 && (batch_end / rowbytes != row || batch_begin % rowbytes == 0))
+        {
+          OUTCOME_TRY(_read_rows(b, batch_end / rowbytes, batch_end / rowbytes + 1, 0, d));
+        }
+        // Copy in whatever of the request lies within these rows
+        extent_type pos = reqs.offset;
+        for(const auto &buffer : reqs.buffers)
+        {
+          const extent_type begin = std::max(pos, batch_begin), finish = std::min(pos + buffer.size(), batch_end);
+          if(begin < finish)
+          {
+            _walk(b, begin, std::array<const_buffer_type, 1>{const_buffer_type(buffer.data() + (begin - pos), (size_type) (finish - begin))},
+                  [](byte *chunk, const byte *p, size_type n) { memcpy(chunk, p, n); });
+          }
+          pos += buffer.size();
+        }
+        _encode_rows(b, row, row + rows);
+        // Write the data which changed and all the parity of these rows
+        OUTCOME_TRY(this->_parallel_for(k + _m(), true, [&](size_t n) -> result<void> {
+          extent_type hbegin = row * this->_chunk_size, hend = (row + rows) * this->_chunk_size;
+          if(n < k)
+          {
+            hbegin = this->_backing_offset(n, batch_begin);
+            hend = this->_backing_offset(n, batch_end);
+          }
+          if(hbegin < hend)
+          {
+            const_buffer_type cb(b.region(n) + (hbegin - row * this->_chunk_size), (size_type) (hend - hbegin));
+            OUTCOME_TRY(_handle(n)->write(io_request<const_buffers_type>({&cb, 1}, hbegin), d));
+          }
+          return success();
+        }));
+        row += rows;
+      }
+      return std::move(reqs.buffers);
+    }
+    //! \brief Barriers the data handles as `striped_handle_adapter` does, and all of each parity handle.
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<const_buffers_type> _do_barrier(io_request<const_buffers_type> reqs, barrier_kind kind, deadline d) noexcept override
+    {
+      OUTCOME_TRY(auto &&ret, _base::_do_barrier(reqs, kind, d));
+      OUTCOME_TRY(this->_parallel_for(_m(), true, [&](size_t j) -> result<void> {
+        OUTCOME_TRY(_parity[j]->barrier({}, kind, d));
+        return success();
+      }));
+      return std::move(ret);
+    }
+
+  public:
+    //! \brief Lock the whole stripe rows containing the given extent in the data handles.
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_guard> lock_file_range(extent_type offset, extent_type bytes, lock_kind kind,
+                                                                         deadline d = deadline()) noexcept override
+    {
+      if(offset == 0 && bytes == 0)
+      {
+        return _base::lock_file_range(offset, bytes, kind, d);
+      }
+      const extent_type rowbytes = _row_bytes(), end = (offset + bytes < offset) ? (extent_type) -1 : offset + bytes;
+      const extent_type begin = offset - offset % rowbytes, rounded_end = (end % rowbytes == 0 || end > (extent_type) -1 - rowbytes) ? end : end - end % rowbytes + rowbytes;
+      OUTCOME_TRY(auto &&g, _base::lock_file_range(begin, rounded_end - begin, kind, d));
+      g.release();
+      return typename _base::_extent_guard(this, offset, bytes, kind);
+    }
+    //! \brief Unlock the whole stripe rows containing the given extent in the data handles.
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC void unlock_file_range(extent_type offset, extent_type bytes) noexcept override
+    {
+      if(offset == 0 && bytes == 0)
+      {
+        _base::unlock_file_range(offset, bytes);
+        return;
+      }
+      const extent_type rowbytes = _row_bytes(), end = (offset + bytes < offset) ? (extent_type) -1 : offset + bytes;
+      const extent_type begin = offset - offset % rowbytes, rounded_end = (end % rowbytes == 0 || end > (extent_type) -1 - rowbytes) ? end : end - end % rowbytes + rowbytes;
+      _base::unlock_file_range(begin, rounded_end - begin);
+    }
+
+    /*! \brief Return the logical extent implied by the maximum extents of the data handles.
+    If up to `m` data handles fail, they are assumed to be as long as the longest parity
+    handle, which may over report the logical extent by up to a stripe row.
+    */
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> maximum_extent() const noexcept override
+    {
+      auto ret = _base::maximum_extent();
+      if(ret)
+      {
+        return ret;
+      }
+      auto degraded = _maximum_extent(0);
+      if(!degraded)
+      {
+        return ret;
+      }
+      return degraded;
+    }
+    //! \brief Truncate the data handles as `striped_handle_adapter` does, and the parity handles to match, recalculating the parity of any partial final row.
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> truncate(extent_type newsize) noexcept override
+    {
+      OUTCOME_TRY(_base::truncate(newsize));
+      const extent_type rowbytes = _row_bytes(), row_end = (newsize + rowbytes - 1) / rowbytes;
+      OUTCOME_TRY(this->_parallel_for(_m(), true, [&](size_t j) -> result<void> {
+        OUTCOME_TRY(_parity[j]->truncate(row_end * this->_chunk_size));
+        return success();
+      }));
+      if(newsize % rowbytes != 0)
+      {
+        OUTCOME_TRY(_update_parity(newsize / rowbytes, row_end, {}));
+      }
+      return newsize;
+    }
+    //! \brief Zeros the data handles as `striped_handle_adapter` does, recalculating the parity of the rows touched.
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> zero(file_handle::extent_pair extent, deadline d = deadline()) noexcept override
+    {
+      OUTCOME_TRY(auto &&ret, _base::zero(extent, d));
+      const extent_type rowbytes = _row_bytes();
+      OUTCOME_TRY(_update_parity(extent.offset / rowbytes, (extent.offset + extent.length + rowbytes - 1) / rowbytes, d));
+      return ret;
+    }
+  };
+
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
+
+#if LLFIO_HEADERS_ONLY == 1 && !defined(DOXYGEN_SHOULD_SKIP_THIS)
+#define LLFIO_INCLUDED_BY_HEADER 1
+#include "../../detail/impl/erasure_coded_handle_adapter.ipp"
+#undef LLFIO_INCLUDED_BY_HEADER
+#endif
+
+#endif
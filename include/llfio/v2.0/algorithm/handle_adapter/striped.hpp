@@ -0,0 +1,611 @@
+/* A handle adapter striping one logical file across many file handles
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#ifndef LLFIO_ALGORITHM_HANDLE_ADAPTER_STRIPED_H
+#define LLFIO_ALGORITHM_HANDLE_ADAPTER_STRIPED_H
+
+#include "combining.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+//! \file handle_adapter/striped.hpp Provides `striped_handle_adapter`.
+
+LLFIO_V2_NAMESPACE_EXPORT_BEGIN
+
+namespace algorithm
+{
+  /*! \class striped_handle_adapter
+  \brief A handle presenting many file handles, usually on different devices, as one
+  logical file striped across them in chunks of a fixed size (RAID-0).
+  \tparam Target The type of the backing handles.
+
+  Logical chunk `k` is stored in backing handle `k % N` at offset `(k / N) * chunk_size()`,
+  where `N` is the number of backing handles. Each backing handle thus stores a
+  contiguous run of its chunks, and any logical i/o maps onto a single contiguous i/o
+  per backing handle. That i/o is issued as scatter-gather, split into batches of
+  `max_buffers()` for that handle.
+
+  The logical maximum extent is derived from the maximum extents of the backing
+  handles, and `truncate()` truncates each backing handle to the portion of the new
+  size it stores. Backing handles shorter than the logical maximum extent read as
+  zeros, as would a hole in a single file. `extents()` maps the valid extents of each
+  backing handle back onto the logical file. `lock_file_range()` locks the portion
+  of the range stored in each backing handle, in backing handle order, so two adapters
+  over the same handles cannot deadlock one another.
+
+  \note If OpenMP is available, `LLFIO_DISABLE_OPENMP` is not defined, and
+  `flag::disable_parallelism` is not set, the i/o to each backing handle will be
+  done concurrently if more than one backing handle is involved.
+
+  The span of backing handles, and the handles themselves, must outlive this adapter.
+  Deadlines are passed through unadjusted to each backing handle.
+  */
+  template <class Target = file_handle> class striped_handle_adapter : public detail::file_handle_wrapper
+  {
+    static_assert(std::is_base_of<file_handle, Target>::value, "striped_handle_adapter requires the backing handles to be file handles");
+
+  public:
+    using path_type = byte_io_handle::path_type;
+    using extent_type = byte_io_handle::extent_type;
+    using size_type = byte_io_handle::size_type;
+    using mode = byte_io_handle::mode;
+    using creation = byte_io_handle::creation;
+    using caching = byte_io_handle::caching;
+    using flag = byte_io_handle::flag;
+    using barrier_kind = byte_io_handle::barrier_kind;
+    using buffer_type = byte_io_handle::buffer_type;
+    using const_buffer_type = byte_io_handle::const_buffer_type;
+    using buffers_type = byte_io_handle::buffers_type;
+    using const_buffers_type = byte_io_handle::const_buffers_type;
+    template <class T> using io_request = byte_io_handle::io_request<T>;
+    template <class T> using io_result = byte_io_handle::io_result<T>;
+
+    using target_handle_type = Target;
+    using extent_guard = file_handle::extent_guard;
+
+  protected:
+    span<target_handle_type *> _handles;
+    extent_type _chunk_size{0};
+
+  private:
+    static native_handle_type _native_handle(mode _mode, span<target_handle_type *> handles) noexcept
+    {
+      native_handle_type nativeh;
+      nativeh.behaviour |= native_handle_type::disposition::file;
+      nativeh.behaviour |= native_handle_type::disposition::seekable | native_handle_type::disposition::readable;
+      if(_mode == mode::write)
+      {
+        nativeh.behaviour |= native_handle_type::disposition::writable;
+      }
+      auto cachebits = native_handle_type::disposition::_cache_bits;
+      for(auto *h : handles)
+      {
+        cachebits = cachebits & (h->native_handle().behaviour & native_handle_type::disposition::_cache_bits);
+      }
+      nativeh.behaviour |= cachebits;
+      return nativeh;
+    }
+
+    // The portion of a logical i/o going to one backing handle
+    template <class BufferType> struct _stripe_io
+    {
+      BufferType *pieces{nullptr};   // the pieces of the caller's buffers stored by this handle, in order
+      BufferType *scratch{nullptr};  // a copy of the pieces handed to the backing handle, which may modify them
+      size_t count{0};
+      extent_type offset{0};
+      size_type bytes{0}, transferred{0};
+    };
+
+    static io_result<buffers_type> _backing_io(target_handle_type *h, io_request<buffers_type> req, deadline d) noexcept { return h->read(req, d); }
+    static io_result<const_buffers_type> _backing_io(target_handle_type *h, io_request<const_buffers_type> req, deadline d) noexcept
+    {
+      return h->write(req, d);
+    }
+    // Handles may return buffers other than those supplied for reads, e.g. mapped_file_handle
+    static void _fill(buffer_type piece, buffer_type filled) noexcept
+    {
+      if(filled.data() != piece.data() && filled.size() > 0)
+      {
+        memmove(piece.data(), filled.data(), filled.size());
+      }
+    }
+    static void _fill(const_buffer_type /*unused*/, const_buffer_type /*unused*/) noexcept {}
+    // Zero the pieces of a short read past the end of the backing handle
+    static void _zero_tail(_stripe_io<buffer_type> &s) noexcept
+    {
+      size_type skip = s.transferred;
+      for(size_t n = 0; n < s.count; n++)
+      {
+        auto &piece = s.pieces[n];
+        if(skip >= piece.size())
+        {
+          skip -= piece.size();
+          continue;
+        }
+        memset(piece.data() + skip, 0, piece.size() - skip);
+        skip = 0;
+      }
+    }
+    static void _zero_tail(_stripe_io<const_buffer_type> & /*unused*/) noexcept {}
+
+  protected:
+    struct _extent_guard : public extent_guard
+    {
+      _extent_guard() = default;
+      constexpr _extent_guard(file_handle *h, extent_type offset, extent_type length, lock_kind kind)
+          : extent_guard(h, offset, length, kind)
+      {
+      }
+    };
+
+    //! The first offset in backing handle `n` at or after the logical offset `offset`
+    extent_type _backing_offset(size_t n, extent_type offset) const noexcept
+    {
+      const extent_type stripe = _chunk_size * _handles.size();
+      const extent_type row = offset / stripe, inrow = offset % stripe, begin = n * _chunk_size;
+      if(inrow < begin)
+      {
+        return row * _chunk_size;
+      }
+      if(inrow < begin + _chunk_size)
+      {
+        return row * _chunk_size + inrow - begin;
+      }
+      return (row + 1) * _chunk_size;
+    }
+    //! The logical offset of offset `offset` in backing handle `n`
+    extent_type _logical_offset(size_t n, extent_type offset) const noexcept
+    {
+      return ((offset / _chunk_size) * _handles.size() + n) * _chunk_size + offset % _chunk_size;
+    }
+
+    //! Calls `f(n)` for each backing handle, concurrently if `parallel`, returning the first failure
+    template <class F> result<void> _for_each_handle(bool parallel, F &&f) const noexcept { return _parallel_for(_handles.size(), parallel, f); }
+    //! Calls `f(n)` for each `n` in `[0, count)`, concurrently if `parallel`, returning the first failure
+    template <class F> result<void> _parallel_for(size_t count, bool parallel, F &&f) const noexcept
+    {
+      using result_type = result<void>;
+      auto *rs = reinterpret_cast<result_type *>(alloca(sizeof(result_type) * count));
+      for(size_t n = 0; n < count; n++)
+      {
+        new(rs + n) result_type(success());
+      }
+      auto unrs = make_scope_exit([&]() noexcept {
+        for(size_t n = 0; n < count; n++)
+        {
+          rs[n].~result_type();
+        }
+      });
+      (void) parallel;
+#if !defined(LLFIO_DISABLE_OPENMP) && defined(_OPENMP)
+#pragma omp parallel for if(parallel && count > 1 && (this->_.flags & flag::disable_parallelism) == 0)
+#endif
+      for(size_t n = 0; n < count; n++)
+      {
+        rs[n] = f(n);
+      }
+      for(size_t n = 0; n < count; n++)
+      {
+        OUTCOME_TRY(std::move(rs[n]));
+      }
+      return success();
+    }
+
+    //! Splits a logical i/o into one scatter-gather i/o per backing handle, and issues them
+    template <class BuffersType> io_result<BuffersType> _do_striped_io(io_request<BuffersType> reqs, deadline d) noexcept
+    {
+      using buffer_type_ = typename BuffersType::value_type;
+      const size_t count = _handles.size();
+      size_type bytes = 0;
+      for(const auto &b : reqs.buffers)
+      {
+        bytes += b.size();
+      }
+      if(bytes == 0)
+      {
+        return std::move(reqs.buffers);
+      }
+      // Visits every piece of the caller's buffers which lies within a single chunk
+      auto walk = [&](auto &&f) {
+        extent_type pos = reqs.offset;
+        for(const auto &b : reqs.buffers)
+        {
+          auto *p = b.data();
+          size_type left = b.size();
+          while(left > 0)
+          {
+            const auto inchunk = (size_type) std::min((extent_type) left, _chunk_size - pos % _chunk_size);
+            f((size_t) ((pos / _chunk_size) % count), buffer_type_(p, inchunk));
+            p += inchunk;
+            left -= inchunk;
+            pos += inchunk;
+          }
+        }
+      };
+      size_t pieces = 0;
+      walk([&](size_t /*unused*/, buffer_type_ /*unused*/) { pieces++; });
+
+      // If small, use the stack, else the heap
+      const size_t bytesneeded = count * sizeof(_stripe_io<buffer_type_>) + 2 * pieces * sizeof(buffer_type_);
+      std::unique_ptr<byte[]> _mem;
+      byte *mem = (bytesneeded <= utils::page_size()) ? reinterpret_cast<byte *>(alloca(bytesneeded)) : nullptr;
+      if(mem == nullptr)
+      {
+        _mem.reset(new(std::nothrow) byte[bytesneeded]);
+        if(!_mem)
+        {
+          return errc::not_enough_memory;
+        }
+        mem = _mem.get();
+      }
+      auto *ios = reinterpret_cast<_stripe_io<buffer_type_> *>(mem);
+      auto *piecemem = reinterpret_cast<buffer_type_ *>(mem + count * sizeof(_stripe_io<buffer_type_>));
+      for(size_t n = 0; n < count; n++)
+      {
+        new(ios + n) _stripe_io<buffer_type_>;
+        ios[n].offset = _backing_offset(n, reqs.offset);
+        ios[n].bytes = (size_type) (_backing_offset(n, reqs.offset + bytes) - ios[n].offset);
+      }
+      walk([&](size_t n, buffer_type_ /*unused*/) { ios[n].count++; });
+      size_t handles_involved = 0;
+      for(size_t n = 0, idx = 0; n < count; n++)
+      {
+        ios[n].pieces = piecemem + idx;
+        ios[n].scratch = piecemem + pieces + idx;
+        idx += ios[n].count;
+        ios[n].count = 0;
+        handles_involved += (ios[n].bytes > 0);
+      }
+      walk([&](size_t n, buffer_type_ piece) { ios[n].pieces[ios[n].count++] = piece; });
+
+      OUTCOME_TRY(_for_each_handle(handles_involved > 1, [&](size_t n) -> result<void> {
+        auto &s = ios[n];
+        if(s.bytes == 0)
+        {
+          return success();
+        }
+        auto *h = _handles[n];
+        const size_t maxbufs = (h->max_buffers() == 0) ? s.count : h->max_buffers();
+        for(size_t idx = 0; idx < s.count;)
+        {
+          const size_t batch = std::min(maxbufs, s.count - idx);
+          size_type want = 0;
+          for(size_t k = 0; k < batch; k++)
+          {
+            s.scratch[idx + k] = s.pieces[idx + k];
+            want += s.pieces[idx + k].size();
+          }
+          OUTCOME_TRY(auto &&done, _backing_io(h, io_request<BuffersType>({s.scratch + idx, batch}, s.offset + s.transferred), d));
+          size_type got = 0;
+          for(size_t k = 0; k < done.size(); k++)
+          {
+            _fill(s.pieces[idx + k], done[k]);
+            got += done[k].size();
+          }
+          s.transferred += got;
+          if(got < want)
+          {
+            break;
+          }
+          idx += batch;
+        }
+        return success();
+      }));
+
+      // Work out how much of the logical i/o was done
+      size_type transferred = bytes;
+      bool is_short = false;
+      for(size_t n = 0; n < count; n++)
+      {
+        if(ios[n].transferred < ios[n].bytes)
+        {
+          is_short = true;
+          const auto end = (size_type) (_logical_offset(n, ios[n].offset + ios[n].transferred) - reqs.offset);
+          transferred = std::min(transferred, end);
+        }
+      }
+      if(is_short && std::is_same<buffer_type_, buffer_type>::value)
+      {
+        // A short read from a backing handle may be a hole in the logical file
+        OUTCOME_TRY(auto &&length, maximum_extent());
+        for(size_t n = 0; n < count; n++)
+        {
+          _zero_tail(ios[n]);
+        }
+        transferred = (length > reqs.offset) ? (size_type) std::min((extent_type) bytes, length - reqs.offset) : 0;
+      }
+      if(transferred < bytes)
+      {
+        for(size_t i = 0; i < reqs.buffers.size(); i++)
+        {
+          auto &b = reqs.buffers[i];
+          if(b.size() >= transferred)
+          {
+            b = buffer_type_(b.data(), transferred);
+            reqs.buffers = BuffersType(reqs.buffers.data(), i + 1);
+            break;
+          }
+          transferred -= b.size();
+        }
+      }
+      return std::move(reqs.buffers);
+    }
+
+  public:
+    //! Default constructor
+    striped_handle_adapter() = default;
+    /*! Constructs an instance striping across `handles` in chunks of `chunk_size` bytes.
+    `chunk_size` should be a multiple of the backing handles' request alignment if any
+    of those are direct i/o.
+    */
+    striped_handle_adapter(span<target_handle_type *> handles, extent_type chunk_size, mode _mode = mode::write, flag flags = flag::none,
+                           byte_io_multiplexer *ctx = nullptr)
+        : detail::file_handle_wrapper(_native_handle(_mode, handles), flags, ctx)
+        , _handles(handles)
+        , _chunk_size(chunk_size)
+    {
+      assert(!handles.empty());
+      assert(chunk_size > 0);
+    }
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC ~striped_handle_adapter() override
+    {
+      // ignore
+    }
+
+    //! The backing handles.
+    span<target_handle_type *> handles() const noexcept { return _handles; }
+    //! The size of chunk in which data is striped across the backing handles.
+    extent_type chunk_size() const noexcept { return _chunk_size; }
+
+    //! \brief Close all the backing handles.
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<void> close() noexcept override
+    {
+      result<void> ret(success());
+      for(auto *h : _handles)
+      {
+        auto r = h->close();
+        if(!r && ret)
+        {
+          ret = std::move(r);
+        }
+      }
+      return ret;
+    }
+
+  protected:
+    //! \brief Return the lowest of the backing handles' maximum buffers
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC size_t _do_max_buffers() const noexcept override
+    {
+      size_t r = (size_t) -1;
+      for(auto *h : _handles)
+      {
+        auto x = h->max_buffers();
+        if(x != 0 && x < r)
+          r = x;
+      }
+      return (r == (size_t) -1) ? 0 : r;
+    }
+    //! \brief Reads the portion of the request stored by each backing handle into the request's buffers.
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<buffers_type> _do_read(io_request<buffers_type> reqs, deadline d = deadline()) noexcept override
+    {
+      return _do_striped_io(reqs, d);
+    }
+    //! \brief Writes the portion of the request stored by each backing handle from the request's buffers.
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<const_buffers_type> _do_write(io_request<const_buffers_type> reqs, deadline d = deadline()) noexcept override
+    {
+      return _do_striped_io(reqs, d);
+    }
+    //! \brief Barriers the portion of the request stored by each backing handle, or all of each backing handle if the request is empty.
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<const_buffers_type> _do_barrier(io_request<const_buffers_type> reqs, barrier_kind kind, deadline d) noexcept override
+    {
+      extent_type bytes = 0;
+      for(const auto &b : reqs.buffers)
+      {
+        bytes += b.size();
+      }
+      OUTCOME_TRY(_for_each_handle(true, [&](size_t n) -> result<void> {
+        if(bytes == 0)
+        {
+          OUTCOME_TRY(_handles[n]->barrier({}, kind, d));
+          return success();
+        }
+        const extent_type begin = _backing_offset(n, reqs.offset), end = _backing_offset(n, reqs.offset + bytes);
+        if(begin < end)
+        {
+          const_buffer_type b((const byte *) nullptr, (size_type) (end - begin));
+          OUTCOME_TRY(_handles[n]->barrier(io_request<const_buffers_type>({&b, 1}, begin), kind, d));
+        }
+        return success();
+      }));
+      return std::move(reqs.buffers);
+    }
+
+  public:
+    /*! \brief Lock the portion of the given extent stored in each backing handle, in
+    backing handle order. If any lock fails, those already taken are released.
+    */
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_guard> lock_file_range(extent_type offset, extent_type bytes, lock_kind kind,
+                                                                         deadline d = deadline()) noexcept override
+    {
+      const bool whole = (offset == 0 && bytes == 0);
+      const extent_type end = (offset + bytes < offset) ? (extent_type) -1 : offset + bytes;
+      for(size_t n = 0; n < _handles.size(); n++)
+      {
+        const extent_type hbegin = whole ? 0 : _backing_offset(n, offset), hend = whole ? 0 : _backing_offset(n, end);
+        if(!whole && hbegin == hend)
+        {
+          continue;
+        }
+        auto r = _handles[n]->lock_file_range(hbegin, hend - hbegin, kind, d);
+        if(!r)
+        {
+          for(size_t m = 0; m < n; m++)
+          {
+            const extent_type mbegin = whole ? 0 : _backing_offset(m, offset), mend = whole ? 0 : _backing_offset(m, end);
+            if(whole || mbegin != mend)
+            {
+              _handles[m]->unlock_file_range(mbegin, mend - mbegin);
+            }
+          }
+          return std::move(r).error();
+        }
+        r.value().release();
+      }
+      return _extent_guard(this, offset, bytes, kind);
+    }
+    //! \brief Unlock the portion of the given extent stored in each backing handle.
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC void unlock_file_range(extent_type offset, extent_type bytes) noexcept override
+    {
+      const bool whole = (offset == 0 && bytes == 0);
+      const extent_type end = (offset + bytes < offset) ? (extent_type) -1 : offset + bytes;
+      for(size_t n = 0; n < _handles.size(); n++)
+      {
+        const extent_type hbegin = whole ? 0 : _backing_offset(n, offset), hend = whole ? 0 : _backing_offset(n, end);
+        if(whole || hbegin != hend)
+        {
+          _handles[n]->unlock_file_range(hbegin, hend - hbegin);
+        }
+      }
+    }
+
+    //! \brief Return the logical extent implied by the maximum extents of the backing handles
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> maximum_extent() const noexcept override
+    {
+      extent_type ret = 0;
+      for(size_t n = 0; n < _handles.size(); n++)
+      {
+        OUTCOME_TRY(auto &&length, _handles[n]->maximum_extent());
+        if(length > 0)
+        {
+          ret = std::max(ret, _logical_offset(n, length - 1) + 1);
+        }
+      }
+      return ret;
+    }
+    //! \brief Truncate each backing handle to the portion of `newsize` which it stores
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> truncate(extent_type newsize) noexcept override
+    {
+      OUTCOME_TRY(_for_each_handle(true, [&](size_t n) -> result<void> {
+        OUTCOME_TRY(_handles[n]->truncate(_backing_offset(n, newsize)));
+        return success();
+      }));
+      return newsize;
+    }
+    /*! \brief Returns the valid extents of each backing handle mapped onto the logical file.
+    \mallocs One allocation per logical chunk spanned by a valid extent, before coalescing.
+    */
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<std::vector<file_handle::extent_pair>> extents() const noexcept override
+    {
+      try
+      {
+        std::vector<file_handle::extent_pair> ret;
+        for(size_t n = 0; n < _handles.size(); n++)
+        {
+          OUTCOME_TRY(auto &&exts, _handles[n]->extents());
+          for(const auto &e : exts)
+          {
+            for(extent_type pos = e.offset, end = e.offset + e.length; pos < end;)
+            {
+              const extent_type inchunk = std::min(end, (pos / _chunk_size + 1) * _chunk_size) - pos;
+              ret.emplace_back(_logical_offset(n, pos), inchunk);
+              pos += inchunk;
+            }
+          }
+        }
+        std::sort(ret.begin(), ret.end(), [](const file_handle::extent_pair &a, const file_handle::extent_pair &b) { return a.offset < b.offset; });
+        size_t out = 0;
+        for(size_t n = 0; n < ret.size(); n++)
+        {
+          if(out > 0 && ret[out - 1].offset + ret[out - 1].length == ret[n].offset)
+          {
+            ret[out - 1].length += ret[n].length;
+          }
+          else
+          {
+            ret[out++] = ret[n];
+          }
+        }
+        ret.resize(out);
+        return {std::move(ret)};
+      }
+      catch(...)
+      {
+        return error_from_exception();
+      }
+    }
+    //! \brief Always returns a failed matching `errc::operation_not_supported`.
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<std::vector<file_handle::extent_info>> detailed_extents() const noexcept override { return errc::operation_not_supported; }
+    //! \brief Always returns a failed matching `errc::operation_not_supported`.
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> preallocate(file_handle::extent_pair /*unused*/, deadline /*unused*/ = deadline()) noexcept override
+    {
+      return errc::operation_not_supported;
+    }
+    //! \brief Always returns a failed matching `errc::operation_not_supported`.
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> zero_range(file_handle::extent_pair /*unused*/, deadline /*unused*/ = deadline()) noexcept override
+    {
+      return errc::operation_not_supported;
+    }
+    //! \brief Always returns a failed matching `errc::operation_not_supported`.
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> collapse_range(file_handle::extent_pair /*unused*/, deadline /*unused*/ = deadline(),
+                                                                       bool /*unused*/ = true) noexcept override
+    {
+      return errc::operation_not_supported;
+    }
+    //! \brief Always returns a failed matching `errc::operation_not_supported`.
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> insert_range(file_handle::extent_pair /*unused*/, deadline /*unused*/ = deadline(),
+                                                                     bool /*unused*/ = true) noexcept override
+    {
+      return errc::operation_not_supported;
+    }
+    //! \brief Zeros the portion of the extent stored in each backing handle, returning the total bytes zeroed.
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> zero(file_handle::extent_pair extent, deadline d = deadline()) noexcept override
+    {
+      auto *zeroed = reinterpret_cast<extent_type *>(alloca(sizeof(extent_type) * _handles.size()));
+      OUTCOME_TRY(_for_each_handle(true, [&](size_t n) -> result<void> {
+        zeroed[n] = 0;
+        const extent_type begin = _backing_offset(n, extent.offset), end = _backing_offset(n, extent.offset + extent.length);
+        if(begin < end)
+        {
+          OUTCOME_TRY(auto &&_, _handles[n]->zero({begin, end - begin}, d));
+          zeroed[n] = _;
+        }
+        return success();
+      }));
+      extent_type ret = 0;
+      for(size_t n = 0; n < _handles.size(); n++)
+      {
+        ret += zeroed[n];
+      }
+      return ret;
+    }
+  };
+
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
+
+#endif
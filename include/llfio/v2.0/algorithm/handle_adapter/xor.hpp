@@ -55,118 +55,14 @@ namespace algorithm
         {
           out = buffer_type(out.data(), s.size());
         }
-        for(size_t idx = 0; idx < out.size();)
-        {
-          {
-            // If addresses happen to align to SIMD, hint very strongly to use SIMD
-            uintptr_t remain1 = ((uintptr_t) out.data() + idx) & 63;
-            uintptr_t remain2 = ((uintptr_t) t.data() + idx) & 63;
-            uintptr_t remain3 = ((uintptr_t) s.data() + idx) & 63;
-            if(remain1 == 0 && remain2 == 0 && remain3 == 0)
-            {
-              while(out.size() - idx >= 64)
-              {
-                uint64_t *a = (uint64_t *) (out.data() + idx);
-                const uint64_t *b = (const uint64_t *) (t.data() + idx);
-                const uint64_t *c = (const uint64_t *) (s.data() + idx);
-                a[0] = b[0] ^ c[0];
-                a[1] = b[1] ^ c[1];
-                a[2] = b[2] ^ c[2];
-                a[3] = b[3] ^ c[3];
-                a[4] = b[4] ^ c[4];
-                a[5] = b[5] ^ c[5];
-                a[6] = b[6] ^ c[6];
-                a[7] = b[7] ^ c[7];
-                idx += 64;
-              }
-            }
-          }
-          {
-            // If addresses happen to align to registers, use that
-            uintptr_t remain1 = ((uintptr_t) out.data() + idx) & (sizeof(uintptr_t) - 1);
-            uintptr_t remain2 = ((uintptr_t) t.data() + idx) & (sizeof(uintptr_t) - 1);
-            uintptr_t remain3 = ((uintptr_t) s.data() + idx) & (sizeof(uintptr_t) - 1);
-            if(remain1 == 0 && remain2 == 0 && remain3 == 0)
-            {
-              while(out.size() - idx >= sizeof(uintptr_t))
-              {
-                uintptr_t *a = (uintptr_t *) (out.data() + idx);
-                const uintptr_t *b = (const uintptr_t *) (t.data() + idx);
-                const uintptr_t *c = (const uintptr_t *) (s.data() + idx);
-                a[0] = b[0] ^ c[0];
-                idx += sizeof(uintptr_t);
-              }
-            }
-          }
-          // Otherwise byte work
-          while(out.size() - idx > 0)
-          {
-            uint8_t *a = (uint8_t *) (out.data() + idx);
-            const uint8_t *b = (const uint8_t *) (t.data() + idx);
-            const uint8_t *c = (const uint8_t *) (s.data() + idx);
-            a[0] = b[0] ^ c[0];
-            idx += 1;
-          }
-        }
+        combine_xor(out.data(), t.data(), s.data(), out.size());
         return out;
       }
 
       static result<const_buffer_type> do_write(buffer_type t, buffer_type s, const_buffer_type in) noexcept
       {
         // in is the constraint here
-        for(size_t idx = 0; idx < in.size();)
-        {
-          {
-            // If addresses happen to align to SIMD, hint very strongly to use SIMD
-            uintptr_t remain1 = ((uintptr_t) t.data() + idx) & 63;
-            uintptr_t remain2 = ((uintptr_t) s.data() + idx) & 63;
-            uintptr_t remain3 = ((uintptr_t) in.data() + idx) & 63;
-            if(remain1 == 0 && remain2 == 0 && remain3 == 0)
-            {
-              while(in.size() - idx >= 64)
-              {
-                uint64_t *a = (uint64_t *) (t.data() + idx);
-                const uint64_t *b = (const uint64_t *) (s.data() + idx);
-                const uint64_t *c = (const uint64_t *) (in.data() + idx);
-                a[0] = b[0] ^ c[0];
-                a[1] = b[1] ^ c[1];
-                a[2] = b[2] ^ c[2];
-                a[3] = b[3] ^ c[3];
-                a[4] = b[4] ^ c[4];
-                a[5] = b[5] ^ c[5];
-                a[6] = b[6] ^ c[6];
-                a[7] = b[7] ^ c[7];
-                idx += 64;
-              }
-            }
-          }
-          {
-            // If addresses happen to align to registers, use that
-            uintptr_t remain1 = ((uintptr_t) t.data() + idx) & (sizeof(uintptr_t) - 1);
-            uintptr_t remain2 = ((uintptr_t) s.data() + idx) & (sizeof(uintptr_t) - 1);
-            uintptr_t remain3 = ((uintptr_t) in.data() + idx) & (sizeof(uintptr_t) - 1);
-            if(remain1 == 0 && remain2 == 0 && remain3 == 0)
-            {
-              while(in.size() - idx >= sizeof(uintptr_t))
-              {
-                uintptr_t *a = (uintptr_t *) (t.data() + idx);
-                const uintptr_t *b = (const uintptr_t *) (s.data() + idx);
-                const uintptr_t *c = (const uintptr_t *) (in.data() + idx);
-                a[0] = b[0] ^ c[0];
-                idx += sizeof(uintptr_t);
-              }
-            }
-          }
-          // Otherwise byte work
-          while(in.size() - idx > 0)
-          {
-            uint8_t *a = (uint8_t *) (t.data() + idx);
-            const uint8_t *b = (const uint8_t *) (s.data() + idx);
-            const uint8_t *c = (const uint8_t *) (in.data() + idx);
-            a[0] = b[0] ^ c[0];
-            idx += 1;
-          }
-        }
+        combine_xor(t.data(), s.data(), in.data(), in.size());
         // Adjust buffers returned to bytes read from in!
         t = {t.data(), in.size()};
         return t;
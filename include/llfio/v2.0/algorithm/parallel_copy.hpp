@@ -0,0 +1,104 @@
+/* A parallel chunked copy engine for single large files
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#ifndef LLFIO_ALGORITHM_PARALLEL_COPY_HPP
+#define LLFIO_ALGORITHM_PARALLEL_COPY_HPP
+
+#include "../dynamic_thread_pool_group.hpp"
+#include "../file_handle.hpp"
+
+//! \file parallel_copy.hpp Provides a parallel chunked copy engine for single large files.
+
+LLFIO_V2_NAMESPACE_BEGIN
+
+namespace algorithm
+{
+  //! Configuration for `parallel_copy()`.
+  struct parallel_copy_config
+  {
+    //! The size of chunk into which the valid extents of the source are split. Zero means 64Mb.
+    file_handle::extent_type chunk_size{0};
+    //! The maximum number of chunks copied concurrently. Zero means the hardware concurrency.
+    size_t concurrency{0};
+    //! The size of buffer each concurrent copy reads into and writes from. Zero means `utils::file_buffer_default_size()`.
+    size_t buffer_size{0};
+    //! Whether to first try cloning or kernel copying each chunk using `file_handle::clone_extents_to()`.
+    bool use_kernel_copy{true};
+    //! Parameter to pass to `file_handle::clone_extents_to()` to force extents to be copied now, not copy-on-write lazily later.
+    bool force_copy_now{false};
+    //! Whether to read and write bypassing the kernel page cache, if chunks need to be read and written.
+    bool direct_io{false};
+    //! Whether to pace the copy according to congestion of the storage devices using `dynamic_thread_pool_group::io_aware_work_item`.
+    bool pace_io{true};
+  };
+
+  /*! \brief Copies the content of `src` into `dest` using many concurrent streams.
+
+  \return The maximum extent of the source, which becomes the maximum extent of the destination.
+  \param src The file to copy.
+  \param dest The file to replace the content of. Its existing content is discarded.
+  \param c Configuration of the copy.
+  \param d Deadline by which to complete the copy.
+  \param method If not null, the methods by which the content was transferred are OR-ed into it.
+
+  Copying a single file is usually done by a single kernel thread, which cannot
+  keep enough i/o in flight to saturate a modern NVMe device, let alone an array of them.
+  This splits the valid extents of the source into chunks of `parallel_copy_config::chunk_size`
+  aligned to offsets which are a multiple of the chunk size, and copies up to
+  `parallel_copy_config::concurrency` chunks at a time using work items in a private
+  `dynamic_thread_pool_group`. Holes in the source remain holes in the destination,
+  which is first truncated to zero and then extended to the length of the source.
+
+  If `parallel_copy_config::use_kernel_copy` is true, each chunk is first passed to
+  `file_handle::clone_extents_to()` with `emulate_if_unsupported = false`, so chunks are
+  reflinked or copied within the kernel where the filesystem and kernel allow. The first
+  time that fails, all remaining chunks are read and written instead into a registered
+  i/o buffer per work item.
+
+  If `parallel_copy_config::direct_io` is true, the source and destination are reopened
+  with `caching::none` for reading and writing, which avoids evicting everything else in the
+  page cache when copying files larger than memory. Any i/o not aligned to 4Kb uses the
+  original handles.
+
+  If `parallel_copy_config::pace_io` is true and the platform can report the congestion
+  of the storage devices, each work item is a `dynamic_thread_pool_group::io_aware_work_item`,
+  so concurrency is reduced if the storage devices become congested.
+
+  \errors Any of the values which `make_dynamic_thread_pool_group()`, `file_handle::extents()`,
+  `file_handle::truncate()`, `file_handle::read()` or `file_handle::write()` can return.
+  */
+  LLFIO_HEADERS_ONLY_FUNC_SPEC result<file_handle::extent_type> parallel_copy(file_handle &src, file_handle &dest, parallel_copy_config c = {},
+                                                                              deadline d = {}, file_handle::clone_method *method = nullptr) noexcept;
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
+
+#if LLFIO_HEADERS_ONLY == 1 && !defined(DOXYGEN_SHOULD_SKIP_THIS)
+#define LLFIO_INCLUDED_BY_HEADER 1
+#include "../detail/impl/parallel_copy.ipp"
+#undef LLFIO_INCLUDED_BY_HEADER
+#endif
+
+#endif
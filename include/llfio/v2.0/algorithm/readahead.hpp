@@ -0,0 +1,162 @@
+/* A read-ahead prefetching stream reader
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#ifndef LLFIO_ALGORITHM_READAHEAD_HPP
+#define LLFIO_ALGORITHM_READAHEAD_HPP
+
+#include "../byte_io_handle.hpp"
+#include "../dynamic_thread_pool_group.hpp"
+
+#include <memory>
+
+//! \file readahead.hpp Provides a read-ahead prefetching stream reader.
+
+LLFIO_V2_NAMESPACE_BEGIN
+
+namespace algorithm
+{
+  namespace detail
+  {
+    struct readahead_stream_impl;
+  }
+
+  /*! \class readahead_stream
+  \brief Reads a seekable `byte_io_handle` using asynchronous read-ahead into a ring
+  of registered i/o buffers, delivering zero-copy views of the data read.
+
+  `file_handle` performs no buffering of its own, and the kernel's read-ahead heuristics
+  are defeated both by large strided reads and by handles opened with `caching::none`
+  (i.e. `O_DIRECT`). This class watches the offsets passed to `read()`, and if they
+  form a sequential or constant stride pattern, it issues reads of the predicted next
+  blocks into a ring of `config::buffers` buffers, each `config::buffer_size` bytes,
+  using `config::concurrency` work items in a private `dynamic_thread_pool_group`.
+  Hence up to `config::concurrency` reads may be in flight at any one time. The work
+  items are only submitted when `read()` queues read aheads, and retire once there
+  are none left, so an idle stream consumes no CPU.
+
+  A sequential pattern is detected immediately, as is any read following on from
+  where the previous one ended. A strided pattern needs two reads with the same
+  stride before prefetching begins. If a read is not within any buffer in the ring,
+  it is read synchronously into the least recently used buffer.
+
+  Buffers are allocated using `byte_io_handle::allocate_registered_buffer()`, so they are
+  page aligned, and block offsets are always rounded down to the page size, which
+  means that the reads issued are always suitable for handles requiring aligned i/o.
+  If the handle returns buffers pointing elsewhere (e.g. `mapped_file_handle` returns
+  views into its map), those are what is delivered.
+
+  \note The view returned by `read()` remains valid until the next call to `read()`,
+  or the destruction of this object. It may be shorter than requested if the request
+  spans the end of a buffer, or the end of the file, in which case simply call `read()`
+  again for the remainder. An empty view is returned when reading at or after the end
+  of the file.
+
+  \note Only one thread may call `read()` at a time.
+  */
+  class LLFIO_DECL readahead_stream
+  {
+  public:
+    using extent_type = byte_io_handle::extent_type;
+    using size_type = byte_io_handle::size_type;
+
+    //! Configuration for the read ahead stream.
+    struct config
+    {
+      //! The size of each buffer in the ring. Zero means `utils::file_buffer_default_size()`.
+      size_t buffer_size{0};
+      //! The number of buffers in the ring. One is always the buffer last returned by `read()`.
+      size_t buffers{8};
+      //! The maximum number of reads in flight at once.
+      size_t concurrency{2};
+    };
+
+    //! Statistics about the read ahead stream.
+    struct statistics
+    {
+      //! The number of calls to `read()` which found their data already read.
+      uint64_t hits{0};
+      //! The number of calls to `read()` which had to wait for a read ahead to complete.
+      uint64_t waits{0};
+      //! The number of calls to `read()` which had to read synchronously.
+      uint64_t misses{0};
+      //! The number of read aheads issued.
+      uint64_t prefetches{0};
+    };
+
+  private:
+    std::unique_ptr<detail::readahead_stream_impl> _p;
+
+    explicit readahead_stream(std::unique_ptr<detail::readahead_stream_impl> p) noexcept
+        : _p(std::move(p))
+    {
+    }
+
+  public:
+    //! Default constructor
+    readahead_stream() = default;
+    readahead_stream(const readahead_stream &) = delete;
+    readahead_stream &operator=(const readahead_stream &) = delete;
+    //! Move constructor
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC readahead_stream(readahead_stream &&o) noexcept;
+    //! Move assignment
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC readahead_stream &operator=(readahead_stream &&o) noexcept;
+    //! Destructor. Cancels and waits for any read aheads in flight.
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC ~readahead_stream();
+
+    /*! \brief Creates a read ahead stream for `h`, which must outlive the stream and
+    must be seekable.
+
+    \errors Any of the values which `make_dynamic_thread_pool_group()` or
+    `byte_io_handle::allocate_registered_buffer()` can return, or
+    `errc::invalid_argument` if `h` is not seekable.
+    */
+    static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<readahead_stream> create(byte_io_handle &h, config c) noexcept;
+    //! \overload
+    static result<readahead_stream> create(byte_io_handle &h) noexcept { return create(h, config()); }
+
+    //! True if this stream is valid.
+    bool is_valid() const noexcept { return _p != nullptr; }
+    //! The handle being read from.
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC byte_io_handle *handle() const noexcept;
+    //! Statistics about the effectiveness of read ahead so far.
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC statistics stats() const noexcept;
+
+    /*! \brief Returns a view of up to `bytes` of the data at `offset`, then schedules
+    read ahead of any predicted subsequent reads.
+
+    \errors Any of the values the handle's `read()` can return.
+    */
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<span<const byte>> read(extent_type offset, size_type bytes) noexcept;
+  };
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
+
+#if LLFIO_HEADERS_ONLY == 1 && !defined(DOXYGEN_SHOULD_SKIP_THIS)
+#define LLFIO_INCLUDED_BY_HEADER 1
+#include "../detail/impl/readahead.ipp"
+#undef LLFIO_INCLUDED_BY_HEADER
+#endif
+
+#endif
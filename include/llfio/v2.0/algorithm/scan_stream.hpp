@@ -0,0 +1,236 @@
+/* A page cache pollution free streaming reader for file handles
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#ifndef LLFIO_ALGORITHM_SCAN_STREAM_HPP
+#define LLFIO_ALGORITHM_SCAN_STREAM_HPP
+
+#include "../mapped_file_handle.hpp"
+
+#include <vector>
+
+//! \file scan_stream.hpp Provides a page cache pollution free streaming reader.
+
+LLFIO_V2_NAMESPACE_BEGIN
+
+namespace algorithm
+{
+  /*! \class scan_stream
+  \brief Reads a file sequentially without evicting everybody else's data from the page cache.
+
+  Backup, checksumming and indexing jobs read whole datasets once. Through the kernel
+  page cache, every page so read displaces a page which some other workload was
+  probably using. This class drops the pages which the scan brought into the page
+  cache once the read cursor has moved past them.
+
+  It is careful to only drop pages which were not already in the page cache before
+  the scan got to them, as those pages are likely being used by somebody else. To
+  achieve this, before any read the residency of the pages in the next
+  `config::lookahead_chunks` chunks is sampled using `mincore()`. Sampling ahead of
+  the read cursor means that the pages the kernel's own read-ahead brings in on our
+  behalf are not mistaken for pages somebody else is using. Once the cursor passes
+  the end of a chunk, the pages in that chunk which were not resident when sampled
+  are dropped with `POSIX_FADV_DONTNEED`. For a `mapped_file_handle`, the pages are
+  first unmapped from this process with `MADV_DONTNEED` as the kernel will not drop
+  pages which are mapped.
+
+  Optionally `POSIX_FADV_NOREUSE` is also applied, which on recent Linux kernels
+  prevents pages read by this handle from being promoted to the active list. Note
+  that this is a property of the open file description, so it persists for the
+  lifetime of the handle, not this object.
+
+  Reads which are not at or after the read cursor are read normally, and nothing
+  is dropped for them.
+
+  \note On Microsoft Windows, there is no way of dropping individual pages of a
+  file from the cache, and this class simply reads.
+  */
+  class LLFIO_DECL scan_stream
+  {
+  public:
+    using extent_type = file_handle::extent_type;
+    using size_type = file_handle::size_type;
+    using buffer_type = file_handle::buffer_type;
+    using buffers_type = file_handle::buffers_type;
+    template <class T> using io_request = file_handle::io_request<T>;
+    template <class T> using io_result = file_handle::io_result<T>;
+
+    //! Configuration for the scan stream.
+    struct config
+    {
+      //! The size of chunk in which residency is sampled and pages dropped. Zero means `utils::file_buffer_default_size()`.
+      extent_type chunk_size{0};
+      //! How many chunks ahead of the read cursor to sample residency. This needs to exceed the kernel's read-ahead.
+      size_t lookahead_chunks{2};
+      //! Whether to drop pages which were already resident before the scan reached them.
+      bool drop_preexisting_pages{false};
+      //! Whether to also apply `POSIX_FADV_NOREUSE` to the handle.
+      bool use_noreuse{true};
+    };
+
+    //! Statistics about the scan stream.
+    struct statistics
+    {
+      //! The number of pages which were dropped.
+      uint64_t pages_dropped{0};
+      //! The number of pages which were left in the page cache because they were already resident.
+      uint64_t pages_preserved{0};
+    };
+
+  private:
+    struct _chunk_residency
+    {
+      extent_type offset{0};
+      std::vector<unsigned char> resident;  // one byte per page, as returned by mincore()
+    };
+    file_handle *_h{nullptr};
+    mapped_file_handle *_mh{nullptr};
+    extent_type _chunk_size{0};
+    size_t _lookahead_chunks{0};
+    bool _drop_preexisting_pages{false};
+    extent_type _cursor{0};       // The furthest byte consumed
+    extent_type _pending_end{0};  // The furthest byte returned from a map, but not yet consumed
+    extent_type _sampled_to{0};   // Residency has been sampled up to here
+    std::vector<_chunk_residency> _chunks;  // ordered by offset
+    statistics _stats;
+
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void _init(extent_type offset, config c) noexcept;
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<void> _sample(extent_type offset, extent_type bytes) noexcept;
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void _drop(const _chunk_residency &chunk, extent_type bytes) noexcept;
+
+  public:
+    //! Default constructor
+    scan_stream() = default;
+    /*! Constructs an instance reading from `h`, with the read cursor starting at `offset`.
+    `h` must outlive this object.
+    */
+    scan_stream(file_handle &h, extent_type offset, config c)
+        : _h(&h)
+    {
+      _init(offset, c);
+    }
+    //! \overload
+    explicit scan_stream(file_handle &h, extent_type offset = 0)
+        : scan_stream(h, offset, config())
+    {
+    }
+    /*! Constructs an instance reading from the map of `h`, with the read cursor starting
+    at `offset`. `h` must outlive this object.
+    */
+    scan_stream(mapped_file_handle &h, extent_type offset, config c)
+        : _h(&h)
+        , _mh(&h)
+    {
+      _init(offset, c);
+    }
+    //! \overload
+    explicit scan_stream(mapped_file_handle &h, extent_type offset = 0)
+        : scan_stream(h, offset, config())
+    {
+    }
+    scan_stream(const scan_stream &) = delete;
+    scan_stream &operator=(const scan_stream &) = delete;
+    //! Move constructor
+    scan_stream(scan_stream &&o) noexcept
+        : _h(o._h)
+        , _mh(o._mh)
+        , _chunk_size(o._chunk_size)
+        , _lookahead_chunks(o._lookahead_chunks)
+        , _drop_preexisting_pages(o._drop_preexisting_pages)
+        , _cursor(o._cursor)
+        , _pending_end(o._pending_end)
+        , _sampled_to(o._sampled_to)
+        , _chunks(std::move(o._chunks))
+        , _stats(o._stats)
+    {
+      o._h = nullptr;
+      o._mh = nullptr;
+    }
+    //! Move assignment
+    scan_stream &operator=(scan_stream &&o) noexcept
+    {
+      if(this == &o)
+      {
+        return *this;
+      }
+      this->~scan_stream();
+      new(this) scan_stream(std::move(o));
+      return *this;
+    }
+    //! Destructor. Does NOT drop pages for any partially consumed chunk, call `finish()` for that.
+    ~scan_stream() = default;
+
+    //! The handle being read from.
+    file_handle *handle() const noexcept { return _h; }
+    //! The furthest offset consumed.
+    extent_type consumed_offset() const noexcept { return _cursor; }
+    //! Statistics about the pages dropped and preserved so far.
+    statistics stats() const noexcept { return _stats; }
+
+    /*! \brief Samples residency ahead of the read, reads from the handle, then drops
+    any pages brought in by the scan which are now behind the read cursor.
+
+    For a `mapped_file_handle`, the buffers returned will point into the map, and
+    the pages are faulted in when you access them. They are not dropped until a
+    subsequent read or `finish()`.
+    */
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC io_result<buffers_type> read(io_request<buffers_type> reqs, deadline d = deadline()) noexcept;
+    //! \overload
+    io_result<size_type> read(extent_type offset, std::initializer_list<buffer_type> lst, deadline d = deadline()) noexcept
+    {
+      buffer_type *_reqs = reinterpret_cast<buffer_type *>(alloca(sizeof(buffer_type) * lst.size()));
+      memcpy(_reqs, lst.begin(), sizeof(buffer_type) * lst.size());
+      io_request<buffers_type> reqs(buffers_type(_reqs, lst.size()), offset);
+      auto ret = read(reqs, d);
+      if(ret)
+      {
+        return ret.bytes_transferred();
+      }
+      return std::move(ret).error();
+    }
+
+    /*! \brief Informs the scan stream that `bytes` at `offset` are about to be read
+    by some other means, for example by directly accessing a map of the file. This
+    samples residency ahead of the read.
+    */
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<void> about_to_consume(extent_type offset, extent_type bytes) noexcept;
+
+    /*! \brief Informs the scan stream that `bytes` at `offset` have been consumed,
+    dropping any chunks now wholly behind the read cursor.
+    */
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<void> consumed(extent_type offset, extent_type bytes) noexcept;
+
+    //! Drops the pages brought in by the scan for all data consumed so far, including any partially consumed chunk.
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<void> finish() noexcept;
+  };
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
+
+#if LLFIO_HEADERS_ONLY == 1 && !defined(DOXYGEN_SHOULD_SKIP_THIS)
+#define LLFIO_INCLUDED_BY_HEADER 1
+#include "../detail/impl/scan_stream.ipp"
+#undef LLFIO_INCLUDED_BY_HEADER
+#endif
+
+#endif
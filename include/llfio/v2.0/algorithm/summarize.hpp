@@ -28,8 +28,11 @@ Distributed under the Boost Software License, Version 1.0.
 #include "traverse.hpp"
 
 #include "../stat.hpp"
+#include "../symlink_handle.hpp"
 
+#include <memory>
 #include <unordered_map>
+#include <vector>
 
 //! \file summarize.hpp Provides a directory tree summary algorithm.
 
@@ -37,6 +40,83 @@ LLFIO_V2_NAMESPACE_BEGIN
 
 namespace algorithm
 {
+  namespace detail
+  {
+    /* A minimal open addressing hash map of small integral keys to counts. Unlike
+    std::unordered_map, incrementing a count never allocates once the key is present,
+    and the whole map is a single contiguous allocation.
+    */
+    template <class T> class summarize_flat_counts
+    {
+      struct _slot
+      {
+        T key;
+        size_t count;
+        bool used;
+      };
+      std::vector<_slot> _slots;
+      size_t _size{0};
+
+      static size_t _hash(const T &key, size_t mask) noexcept
+      {
+        const uint64_t x = (uint64_t) key * 0x9e3779b97f4a7c15ULL;
+        return (size_t) (x ^ (x >> 32)) & mask;
+      }
+      void _grow()
+      {
+        std::vector<_slot> old(std::move(_slots));
+        _slots.assign(old.empty() ? 16 : old.size() * 2, _slot{T(), 0, false});
+        const size_t mask = _slots.size() - 1;
+        for(auto &i : old)
+        {
+          if(i.used)
+          {
+            size_t idx = _hash(i.key, mask);
+            while(_slots[idx].used)
+            {
+              idx = (idx + 1) & mask;
+            }
+            _slots[idx] = i;
+          }
+        }
+      }
+
+    public:
+      //! Returns a reference to the count for `key`, inserting a zero count if needed
+      size_t &operator[](const T &key)
+      {
+        if((_size + 1) * 2 > _slots.size())
+        {
+          _grow();
+        }
+        const size_t mask = _slots.size() - 1;
+        size_t idx = _hash(key, mask);
+        while(_slots[idx].used)
+        {
+          if(_slots[idx].key == key)
+          {
+            return _slots[idx].count;
+          }
+          idx = (idx + 1) & mask;
+        }
+        _slots[idx] = _slot{key, 0, true};
+        _size++;
+        return _slots[idx].count;
+      }
+      //! Calls `f(key, count)` for every item
+      template <class F> void for_each(F &&f) const
+      {
+        for(auto &i : _slots)
+        {
+          if(i.used)
+          {
+            f(i.key, i.count);
+          }
+        }
+      }
+    };
+  }  // namespace detail
+
   /*! \brief A summary of a directory tree
    */
   struct traversal_summary
@@ -60,9 +140,27 @@ namespace algorithm
     handle::extent_type directory_blocks{0};  //!< The sum of directory allocated blocks.
     size_t max_depth{0};                      //!< The maximum depth of the hierarchy
 
+    /* Each thread accumulates into its own instance of this during traversal,
+    which are all merged into the summary once the traversal finishes.
+    */
+    struct _thread_state
+    {
+      size_t stats_failed{0};
+      size_t directory_opens_failed{0};
+      detail::summarize_flat_counts<uint64_t> devs;
+      detail::summarize_flat_counts<filesystem::file_type> types;
+      handle::extent_type size{0};
+      handle::extent_type allocated{0};
+      handle::extent_type file_blocks{0};
+      handle::extent_type directory_blocks{0};
+      size_t max_depth{0};
+    };
+    std::vector<std::shared_ptr<_thread_state>> _thread_states;  // protected by _lock
+
     traversal_summary() {}
     traversal_summary(const traversal_summary &o)
-        : directory_opens_failed(o.directory_opens_failed)
+        : stats_failed(o.stats_failed)
+        , directory_opens_failed(o.directory_opens_failed)
         , want(o.want)
         , devs(o.devs)
         , types(o.types)
@@ -75,7 +173,8 @@ namespace algorithm
       assert(!is_lockable_locked(o._lock));
     }
     traversal_summary(traversal_summary &&o) noexcept
-        : directory_opens_failed(o.directory_opens_failed)
+        : stats_failed(o.stats_failed)
+        , directory_opens_failed(o.directory_opens_failed)
         , want(o.want)
         , devs(std::move(o.devs))
         , types(std::move(o.types))
@@ -91,6 +190,7 @@ namespace algorithm
     {
       if(this != &o)
       {
+        stats_failed = o.stats_failed;
         directory_opens_failed = o.directory_opens_failed;
         want = o.want;
         devs = o.devs;
@@ -107,6 +207,7 @@ namespace algorithm
     {
       if(this != &o)
       {
+        stats_failed = o.stats_failed;
         directory_opens_failed = o.directory_opens_failed;
         want = o.want;
         devs = std::move(o.devs);
@@ -123,6 +224,7 @@ namespace algorithm
     traversal_summary &operator+=(const traversal_summary &o)
     {
       lock_guard<spinlock> g(_lock);
+      stats_failed += o.stats_failed;
       directory_opens_failed += o.directory_opens_failed;
       for(auto &i : o.devs)
       {
@@ -139,6 +241,27 @@ namespace algorithm
       max_depth = std::max(max_depth, o.max_depth);
       return *this;
     }
+    //! Merges all the per thread states into this
+    void _merge_thread_states()
+    {
+      std::vector<std::shared_ptr<_thread_state>> states;
+      {
+        lock_guard<spinlock> g(_lock);
+        states.swap(_thread_states);
+      }
+      for(auto &o : states)
+      {
+        stats_failed += o->stats_failed;
+        directory_opens_failed += o->directory_opens_failed;
+        o->devs.for_each([this](uint64_t key, size_t count) { devs[key] += count; });
+        o->types.for_each([this](filesystem::file_type key, size_t count) { types[key] += count; });
+        size += o->size;
+        allocated += o->allocated;
+        file_blocks += o->file_blocks;
+        directory_blocks += o->directory_blocks;
+        max_depth = std::max(max_depth, o->max_depth);
+      }
+    }
   };
 
   /*! \brief A visitor for the filesystem traversal and summary algorithm.
@@ -152,8 +275,37 @@ namespace algorithm
   */
   struct summarize_visitor : public traverse_visitor
   {
-    static void accumulate(traversal_summary &acc, traversal_summary *state, const directory_handle *dirh, directory_entry &entry,
-                           stat_t::want already_have_metadata)
+  protected:
+    // Returns the calling thread's state for the summary `state`, creating it if needed
+    static traversal_summary::_thread_state *_thread_summary(traversal_summary *state)
+    {
+      struct mine_type
+      {
+        traversal_summary *owner{nullptr};
+        std::weak_ptr<traversal_summary::_thread_state> ptr;
+      };
+      static thread_local mine_type mine;
+      if(mine.owner == state)
+      {
+        if(auto ret = mine.ptr.lock())
+        {
+          return ret.get();  // kept alive by state->_thread_states
+        }
+      }
+      auto ret = std::make_shared<traversal_summary::_thread_state>();
+      {
+        lock_guard<spinlock> g(state->_lock);
+        state->_thread_states.push_back(ret);
+      }
+      mine.owner = state;
+      mine.ptr = ret;
+      return ret.get();
+    }
+
+  public:
+    //! Accumulates `entry` into `acc`, which may be a `traversal_summary` or a per thread state.
+    template <class Acc>
+    static void accumulate(Acc &acc, traversal_summary *state, const directory_handle *dirh, directory_entry &entry, stat_t::want already_have_metadata)
     {
       if((state->want & already_have_metadata) != state->want)
       {
@@ -174,6 +326,23 @@ namespace algorithm
             return;
           }
         }
+        else if(entry.stat.st_type == filesystem::file_type::symlink)
+        {
+          // Stat the link rather than its target, as fill_metadata() does
+          if(auto fh = symlink_handle::symlink(*dirh, entry.leafname))
+          {
+            if(!entry.stat.fill(fh.assume_value(), state->want & ~already_have_metadata))
+            {
+              acc.stats_failed++;
+              return;
+            }
+          }
+          else
+          {
+            acc.stats_failed++;
+            return;
+          }
+        }
         else
         {
           if(auto fh = file_handle::file(*dirh, entry.leafname, file_handle::mode::attr_read))
@@ -228,10 +397,15 @@ namespace algorithm
       (void) dirh;
       (void) leaf;
       (void) depth;
-      auto *state = (traversal_summary *) data;
-      lock_guard<spinlock> g(state->_lock);
-      state->directory_opens_failed++;
-      return success();  // ignore failure to enter
+      try
+      {
+        _thread_summary((traversal_summary *) data)->directory_opens_failed++;
+        return success();  // ignore failure to enter
+      }
+      catch(...)
+      {
+        return error_from_exception();
+      }
     }
     //! This override implements the summary
     virtual result<void> post_enumeration(void *data, const directory_handle &dirh, directory_handle::buffers_type &contents, size_t depth) noexcept override
@@ -239,13 +413,24 @@ namespace algorithm
       try
       {
         auto *state = (traversal_summary *) data;
-        traversal_summary acc;
-        acc.max_depth = depth;
-        for(auto &entry : contents)
+        auto &acc = *_thread_summary(state);
+        acc.max_depth = std::max(acc.max_depth, depth);
+        size_t count = contents.size();
+        if((state->want & contents.metadata()) != state->want)
+        {
+          // Fetch the missing metadata for all entries in a single batch. Entries which
+          // can't be stat'd are moved to the end. If batching fails entirely, accumulate()
+          // will fetch the metadata for each entry in turn.
+          if(auto failed = dirh.fill_metadata(contents, state->want))
+          {
+            count -= failed.value();
+            acc.stats_failed += failed.value();
+          }
+        }
+        for(size_t n = 0; n < count; n++)
         {
-          accumulate(acc, state, &dirh, entry, contents.metadata());
+          accumulate(acc, state, &dirh, contents[n], contents.metadata());
         }
-        state->operator+=(acc);
         return success();
       }
       catch(...)
@@ -253,6 +438,21 @@ namespace algorithm
         return error_from_exception();
       }
     }
+    /*! \brief This override merges all the per thread states into the summary,
+    and deallocates them.
+    */
+    virtual result<size_t> finished(void *data, result<size_t> result) noexcept override
+    {
+      try
+      {
+        ((traversal_summary *) data)->_merge_thread_states();
+        return result;
+      }
+      catch(...)
+      {
+        return error_from_exception();
+      }
+    }
   };
 
   /*! \brief Summarise the directory identified `topdirh`, and everything therein.
@@ -261,11 +461,18 @@ namespace algorithm
   much storage it occupies, but also how many mounted filesystems it straddles etc.
   You should specify what metadata you wish to summarise, if this is a subset of
   what metadata `directory_handle::read()` returns, performance will be considerably
-  better. The default summarises all possible metadata.
+  better. Otherwise the missing metadata is fetched for each directory's entries as a
+  single batch using `directory_handle::fill_metadata()`, which does not follow
+  symbolic links. The default summarises all possible metadata.
 
   Most errors during summary are accumulated into `stats_failed` and `directory_opens_failed`,
   rather than failing the summary.
 
+  Each thread accumulates into its own state, using flat open addressing maps for the
+  per device and per type counts, and the states of all the threads are merged into the
+  summary once by `summarize_visitor::finished()`. Hence threads never contend with one
+  another whilst summarising.
+
   This is a trivial implementation on top of `algorithm::traverse()`, indeed it is
   implemented entirely as header code. You should review the documentation for
   `algorithm::traverse()`, as this algorithm is entirely implemented using that algorithm.
@@ -26,6 +26,9 @@ Distributed under the Boost Software License, Version 1.0.
 #define LLFIO_ALGORITHM_TRAVERSE_HPP
 
 #include "../directory_handle.hpp"
+#ifndef LLFIO_EXCLUDE_DYNAMIC_THREAD_POOL_GROUP
+#include "../dynamic_thread_pool_group.hpp"
+#endif
 
 
 //! \file traverse.hpp Provides a directory tree traversal algorithm.
@@ -148,13 +151,21 @@ namespace algorithm
 
   5. Loop, using the least deep available item in the stack, until the stack is empty.
 
-  If `known_dirs_remaining` exceeds four, a threadpool of not more than `threads` threads
-  is spun up in order to traverse the hierarchy more quickly.
+  If directories remain after the first four, `threads` work items (default is half the
+  hardware concurrency, but no fewer than four) are submitted to a `dynamic_thread_pool_group`
+  in order to traverse the hierarchy more quickly. As the global dynamic thread pool
+  only runs as many kernel threads as are not blocked, concurrent traversals share
+  the CPUs rather than oversubscribe them. Each work item has its own stack of lists,
+  into which it appends the directories it finds, and when its own stack is empty it
+  steals the least deep directory from the stack of another work item.
 
   This algorithm is therefore primarily a breadth-first algorithm, in that we proceed from
   root, level by level, to the tips. The number returned is the total number of directories
   traversed.
 
+  If `LLFIO_EXCLUDE_DYNAMIC_THREAD_POOL_GROUP` is defined, `threads` kernel threads are
+  created for the work items instead.
+
   ## Notes
 
   The implementation tries hard to not open too many file descriptors at a time in order to
@@ -184,6 +195,19 @@ namespace algorithm
   */
   LLFIO_HEADERS_ONLY_FUNC_SPEC result<size_t> traverse(const path_handle &dirh, traverse_visitor *visitor, size_t threads = 0, void *data = nullptr, bool force_slow_path = false) noexcept;
 
+#ifndef LLFIO_EXCLUDE_DYNAMIC_THREAD_POOL_GROUP
+  /*! \brief \copybrief traverse()
+
+  As for the other overload, but the work items are submitted to `group`, which may be
+  a group nested within some other work. The traversal can be cancelled by calling
+  `group.stop()`, upon which this returns `errc::operation_canceled`. `group` must not
+  have other work submitted to it during the traversal, as this waits for the group to
+  complete.
+  */
+  LLFIO_HEADERS_ONLY_FUNC_SPEC result<size_t> traverse(dynamic_thread_pool_group &group, const path_handle &dirh, traverse_visitor *visitor, size_t threads = 0,
+                                                       void *data = nullptr, bool force_slow_path = false) noexcept;
+#endif
+
 }  // namespace algorithm
 
 LLFIO_V2_NAMESPACE_END
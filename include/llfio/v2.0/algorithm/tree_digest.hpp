@@ -0,0 +1,132 @@
+/* A filesystem algorithm which calculates a Merkle tree digest of a directory tree
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#ifndef LLFIO_ALGORITHM_TREE_DIGEST_HPP
+#define LLFIO_ALGORITHM_TREE_DIGEST_HPP
+
+#include "contents.hpp"
+
+#include "quickcpplib/uint128.hpp"
+
+#include <vector>
+
+//! \file tree_digest.hpp Provides a directory tree content digest algorithm.
+
+LLFIO_V2_NAMESPACE_BEGIN
+
+namespace algorithm
+{
+  //! \brief The 128 bit hash used by `tree_digest()`.
+  using tree_digest_hash = QUICKCPPLIB_NAMESPACE::integers128::uint128;
+
+  /*! \brief The digest of a single file, as returned by `tree_digest()`, and as
+  persisted into the digest store.
+  */
+  struct tree_digest_record
+  {
+    tree_digest_hash path_hash;     //!< The hash of the path relative to the root of the tree
+    tree_digest_hash content_hash;  //!< The root of the Merkle tree of the content of the file
+    uint64_t st_ino{0};             //!< The inode of the file when hashed
+    int64_t st_mtim{0};             //!< The modified timestamp of the file when hashed, in nanoseconds since the epoch
+    uint64_t st_size{0};            //!< The maximum extent of the file when hashed
+    uint64_t _reserved{0};
+  };
+  static_assert(sizeof(tree_digest_record) == 64, "tree_digest_record is not 64 bytes long!");
+
+  //! \brief Configuration for `tree_digest()`.
+  struct tree_digest_config
+  {
+    //! The size of the chunks into which file content is split for hashing in parallel.
+    size_t chunk_size{4 * 1024 * 1024};
+    //! The number of threads to use for traversal and hashing, zero means the default.
+    size_t threads{0};
+    //! Passed through to `traverse()`.
+    bool force_slow_path{false};
+  };
+
+  //! \brief The result of `tree_digest()`.
+  struct tree_digest_result
+  {
+    //! The root of the Merkle tree of the whole directory tree.
+    tree_digest_hash root;
+    //! The digest of every file in the tree, sorted by path.
+    std::vector<std::pair<filesystem::path, tree_digest_record>> files;
+    //! The number of files whose content was hashed.
+    size_t files_hashed{0};
+    //! The number of files whose digest was reused from the digest store.
+    size_t files_reused{0};
+    //! The number of files which disappeared before they could be hashed, and so are not in the digest.
+    size_t files_failed{0};
+    //! The number of bytes of content hashed.
+    uint64_t bytes_hashed{0};
+  };
+
+  /*! \brief Calculate a Merkle tree digest of the content of all the files within
+  and under `dirh`, reusing and updating the digest persisted in the store at `storepath`.
+
+  The tree is enumerated using `contents()`. Each regular file is then split into
+  `config.chunk_size` chunks, and all the chunks of all the files are read and hashed
+  with the 128 bit SpookyHash `fast_hash` in parallel across the dynamic thread pool.
+  A file's digest is the hash of its chunk hashes, a directory's digest is the hash of
+  the leafnames, types and digests of its children sorted by leafname, and the root of
+  the whole Merkle tree is the digest of `dirh`. Symbolic links are not followed, nor
+  included in the digest. Hence two trees have the same root if and only if they have
+  the same files with the same content in the same directories, to within the
+  probability of a hash collision.
+
+  If the store exists, and was written using the same chunk size, it is mapped into
+  memory, and any file whose inode, modified timestamp and maximum extent match those
+  recorded in the store has its digest reused instead of rehashed. This makes re-runs
+  over trees of millions of files, of which few have changed, very quick. Thereafter
+  the store is atomically replaced with the new digest. As with any timestamp based
+  change detection, a modification which changes neither the maximum extent nor, due to
+  the granularity of the filing system's timestamps, the modified timestamp is missed.
+  The store has a 64 byte header followed by the 64 byte `tree_digest_record` of each
+  file sorted by path hash. It should not be placed inside the tree being digested,
+  otherwise it will digest itself.
+
+  Files which disappear before they can be hashed are left out of the digest. If a
+  file is modified whilst being hashed, the digest will be of neither version, so
+  callers wanting a reproducible digest of a live tree should digest a snapshot of it.
+  */
+  LLFIO_HEADERS_ONLY_FUNC_SPEC result<tree_digest_result> tree_digest(const path_handle &dirh, const path_handle &storebase, path_view storepath,
+                                                                      const tree_digest_config &config = {}) noexcept;
+
+  /*! \brief Calculate a Merkle tree digest of the content of all the files within
+  and under `dirh`, hashing every file.
+  */
+  LLFIO_HEADERS_ONLY_FUNC_SPEC result<tree_digest_result> tree_digest(const path_handle &dirh, const tree_digest_config &config = {}) noexcept;
+
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
+
+#if LLFIO_HEADERS_ONLY == 1 && !defined(DOXYGEN_SHOULD_SKIP_THIS)
+#define LLFIO_INCLUDED_BY_HEADER 1
+#include "../detail/impl/tree_digest.ipp"
+#undef LLFIO_INCLUDED_BY_HEADER
+#endif
+
+#endif
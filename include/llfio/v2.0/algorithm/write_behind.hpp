@@ -0,0 +1,197 @@
+/* A bounded write-behind streaming writer for file handles
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#ifndef LLFIO_ALGORITHM_WRITE_BEHIND_HPP
+#define LLFIO_ALGORITHM_WRITE_BEHIND_HPP
+
+#include "../file_handle.hpp"
+
+//! \file write_behind.hpp Provides a bounded write-behind streaming writer.
+
+LLFIO_V2_NAMESPACE_BEGIN
+
+namespace algorithm
+{
+  /*! \class write_behind_stream
+  \brief Bounds the dirty page cache generated by a streaming writer to a `file_handle`.
+
+  When you write a large file sequentially through the kernel page cache, the
+  kernel lets dirty pages accumulate until some global threshold is hit, at
+  which point writeback gets forced upon whichever unlucky `write()` happened
+  to trip the threshold. This produces excellent average write latency, but
+  terrible tail latency, and it also evicts everybody else's cached data.
+
+  This class tracks a window of dirty chunks behind the write cursor. As soon
+  as a chunk has been completely written, writeback of it is initiated
+  without waiting (`barrier_kind::nowait_data_only`, which is `sync_file_range(SYNC_FILE_RANGE_WRITE)`
+  on Linux). Once more than `config::dirty_chunks` chunks are in flight, the
+  oldest chunks are waited upon (`barrier_kind::wait_data_only`) which, because
+  their writeback was started long ago, is usually instant. The total dirty
+  data for this file therefore never exceeds approximately `chunk_size * (dirty_chunks + 1)`,
+  and writeback proceeds smoothly in parallel with the writer rather than in bursts.
+
+  Optionally, once a chunk is known to be on storage, its pages can be
+  dropped from the page cache with `POSIX_FADV_DONTNEED`. This is appropriate
+  for files which will not be read back soon, as it avoids pushing other
+  useful data out of the page cache.
+
+  Writes which land behind the window are written normally and left for the
+  kernel to write back in its own time. Writes which jump ahead cause all the
+  chunks in between to be considered complete.
+
+  \note On Linux only the named byte ranges are affected. On other platforms
+  `barrier()` may flush the entire file's dirty data, so you may wish to use a
+  larger `chunk_size` there.
+
+  \note This class does nothing useful for handles opened with `caching::none`
+  or `caching::reads`, as they generate no dirty pages.
+  */
+  class LLFIO_DECL write_behind_stream
+  {
+  public:
+    using extent_type = file_handle::extent_type;
+    using size_type = file_handle::size_type;
+    using const_buffer_type = file_handle::const_buffer_type;
+    using const_buffers_type = file_handle::const_buffers_type;
+    template <class T> using io_request = file_handle::io_request<T>;
+    template <class T> using io_result = file_handle::io_result<T>;
+
+    //! Configuration for the write behind stream.
+    struct config
+    {
+      //! The size of chunk in which writeback is initiated. Zero means `utils::file_buffer_default_size()`.
+      extent_type chunk_size{0};
+      //! The number of chunks which may be under writeback before the oldest is waited upon.
+      size_t dirty_chunks{4};
+      //! Whether to drop pages from the page cache once they have been written to storage.
+      bool drop_written_pages{false};
+    };
+
+  private:
+    file_handle *_h{nullptr};
+    extent_type _chunk_size{0};
+    size_t _dirty_chunks{0};
+    bool _drop_written_pages{false};
+    extent_type _retired{0};    // Everything before this is known to be on storage
+    extent_type _submitted{0};  // Everything before this has had writeback initiated
+    extent_type _high{0};       // The furthest byte written
+
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<void> _submit(extent_type offset, extent_type bytes) noexcept;
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<void> _retire(extent_type offset, extent_type bytes) noexcept;
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<void> _advance() noexcept;
+
+  public:
+    //! Default constructor
+    constexpr write_behind_stream() {}
+    /*! Constructs an instance writing to `h`, with the write cursor starting at `offset`.
+    `h` must outlive this object.
+    */
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC write_behind_stream(file_handle &h, extent_type offset, config c);
+    //! \overload
+    explicit write_behind_stream(file_handle &h, extent_type offset = 0)
+        : write_behind_stream(h, offset, config())
+    {
+    }
+    write_behind_stream(const write_behind_stream &) = delete;
+    write_behind_stream &operator=(const write_behind_stream &) = delete;
+    //! Move constructor
+    write_behind_stream(write_behind_stream &&o) noexcept
+        : _h(o._h)
+        , _chunk_size(o._chunk_size)
+        , _dirty_chunks(o._dirty_chunks)
+        , _drop_written_pages(o._drop_written_pages)
+        , _retired(o._retired)
+        , _submitted(o._submitted)
+        , _high(o._high)
+    {
+      o._h = nullptr;
+    }
+    //! Move assignment
+    write_behind_stream &operator=(write_behind_stream &&o) noexcept
+    {
+      if(this == &o)
+      {
+        return *this;
+      }
+      this->~write_behind_stream();
+      new(this) write_behind_stream(std::move(o));
+      return *this;
+    }
+    //! Destructor. Does NOT flush, call `flush()` yourself if you want that.
+    ~write_behind_stream() = default;
+
+    //! The handle being written to.
+    file_handle *handle() const noexcept { return _h; }
+    //! The chunk size in use.
+    extent_type chunk_size() const noexcept { return _chunk_size; }
+    //! The offset before which all data written through this object is known to be on storage.
+    extent_type retired_offset() const noexcept { return _retired; }
+    //! The offset before which writeback has been initiated.
+    extent_type submitted_offset() const noexcept { return _submitted; }
+    //! The furthest offset written through this object.
+    extent_type written_offset() const noexcept { return _high; }
+    //! The number of bytes which may currently be dirty in the page cache due to this object.
+    extent_type dirty_bytes() const noexcept { return _high - _retired; }
+
+    /*! \brief Write to the handle, then update the dirty window, initiating or
+    waiting upon writeback as necessary.
+    */
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC io_result<const_buffers_type> write(io_request<const_buffers_type> reqs, deadline d = deadline()) noexcept;
+    //! \overload
+    io_result<size_type> write(extent_type offset, std::initializer_list<const_buffer_type> lst, deadline d = deadline()) noexcept
+    {
+      const_buffer_type *_reqs = reinterpret_cast<const_buffer_type *>(alloca(sizeof(const_buffer_type) * lst.size()));
+      memcpy(_reqs, lst.begin(), sizeof(const_buffer_type) * lst.size());
+      io_request<const_buffers_type> reqs(const_buffers_type(_reqs, lst.size()), offset);
+      auto ret = write(reqs, d);
+      if(ret)
+      {
+        return ret.bytes_transferred();
+      }
+      return std::move(ret).error();
+    }
+
+    /*! \brief Informs the dirty window that `bytes` at `offset` were written by
+    some other means, for example through a map of the file.
+    */
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<void> written(extent_type offset, extent_type bytes) noexcept;
+
+    /*! \brief Initiates writeback of all data written through this object,
+    including any partially written final chunk. If `wait` is true, also waits
+    for all of it to reach storage, and drops it from the page cache if so
+    configured.
+    */
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<void> flush(bool wait = true) noexcept;
+  };
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
+
+#if LLFIO_HEADERS_ONLY == 1 && !defined(DOXYGEN_SHOULD_SKIP_THIS)
+#define LLFIO_INCLUDED_BY_HEADER 1
+#include "../detail/impl/write_behind.ipp"
+#undef LLFIO_INCLUDED_BY_HEADER
+#endif
+
+#endif
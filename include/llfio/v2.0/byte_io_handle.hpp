@@ -143,6 +143,26 @@ protected:
   //! The virtualised implementation of `barrier()` used if no multiplexer has been set.
   LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<const_buffers_type> _do_barrier(io_request<const_buffers_type> reqs, barrier_kind kind, deadline d) noexcept;
 
+  // Cancels the i/o if it is still in progress and blocks until it finishes, then destroys its state.
+  // Must be done before the storage of an initiated state goes away, including on error returns.
+  void _reap_multiplexer_io_operation(byte_io_multiplexer::io_operation_state *state) noexcept
+  {
+    auto s = state->current_state();
+    if(s != io_operation_state_type::unknown && !is_initialised(s) && !is_finished(s))
+    {
+      s = _ctx->check_io_operation(state);
+      if(!is_completed(s))
+      {
+        (void) _ctx->cancel_io_operation(state);
+      }
+      while(!is_finished(s))
+      {
+        (void) _ctx->check_for_any_completed_io({});
+        s = state->current_state();
+      }
+    }
+    state->~io_operation_state();
+  }
   io_result<buffers_type> _do_multiplexer_read(registered_buffer_type &&base, io_request<buffers_type> reqs, deadline d) noexcept
   {
     LLFIO_DEADLINE_TO_SLEEP_INIT(d);
@@ -155,6 +175,7 @@ protected:
     {
       return errc::resource_unavailable_try_again;
     }
+    auto unstate = make_scope_exit([&]() noexcept { _reap_multiplexer_io_operation(state); });
     OUTCOME_TRY(_ctx->flush_inited_io_operations());
     while(!is_finished(_ctx->check_io_operation(state)))
     {
@@ -163,7 +184,6 @@ protected:
       OUTCOME_TRY(_ctx->check_for_any_completed_io(nd));
     }
     io_result<buffers_type> ret = std::move(*state).get_completed_read();
-    state->~io_operation_state();
     return ret;
   }
   io_result<const_buffers_type> _do_multiplexer_write(registered_buffer_type &&base, io_request<const_buffers_type> reqs, deadline d) noexcept
@@ -178,6 +198,7 @@ protected:
     {
       return errc::resource_unavailable_try_again;
     }
+    auto unstate = make_scope_exit([&]() noexcept { _reap_multiplexer_io_operation(state); });
     OUTCOME_TRY(_ctx->flush_inited_io_operations());
     while(!is_finished(_ctx->check_io_operation(state)))
     {
@@ -186,7 +207,6 @@ protected:
       OUTCOME_TRY(_ctx->check_for_any_completed_io(nd));
     }
     io_result<const_buffers_type> ret = std::move(*state).get_completed_write_or_barrier();
-    state->~io_operation_state();
     return ret;
   }
   io_result<const_buffers_type> _do_multiplexer_barrier(registered_buffer_type &&base, io_request<const_buffers_type> reqs, barrier_kind kind,
@@ -202,6 +222,7 @@ protected:
     {
       return errc::resource_unavailable_try_again;
     }
+    auto unstate = make_scope_exit([&]() noexcept { _reap_multiplexer_io_operation(state); });
     OUTCOME_TRY(_ctx->flush_inited_io_operations());
     while(!is_finished(_ctx->check_io_operation(state)))
     {
@@ -210,9 +231,60 @@ protected:
       OUTCOME_TRY(_ctx->check_for_any_completed_io(nd));
     }
     io_result<const_buffers_type> ret = std::move(*state).get_completed_write_or_barrier();
-    state->~io_operation_state();
     return ret;
   }
+  template <class BuffersType, class F>
+  result<void> _do_multiplexer_multiple(span<const io_request<BuffersType>> reqs, span<io_result<BuffersType>> results, deadline d, F &&get_completed) noexcept
+  {
+    static constexpr size_t batch = 64;
+    LLFIO_DEADLINE_TO_SLEEP_INIT(d);
+    const auto state_reqs = _ctx->io_state_requirements();
+    const auto state_size = (state_reqs.first + state_reqs.second - 1) & ~(state_reqs.second - 1);
+    auto *storage = (byte *) alloca(state_size * batch + state_reqs.second);
+    const auto diff = (uintptr_t) storage & (state_reqs.second - 1);
+    storage += state_reqs.second - diff;
+    byte_io_multiplexer::io_operation_state *states[batch];
+    for(size_t base = 0; base < reqs.size();)
+    {
+      deadline nd;
+      LLFIO_DEADLINE_TO_PARTIAL_DEADLINE(nd, d);
+      // Initiate as many as the multiplexer will accept, then submit them to the system all at once
+      size_t count = 0;
+      for(; count < batch && base + count < reqs.size(); count++)
+      {
+        states[count] = _ctx->construct_and_init_io_operation({storage + count * state_size, state_reqs.first}, this, nullptr, {}, nd, reqs[base + count]);
+        if(states[count] == nullptr)
+        {
+          break;
+        }
+      }
+      if(count == 0)
+      {
+        return errc::resource_unavailable_try_again;
+      }
+      // On any error return, every state not yet reaped is still in progress on the stack
+      size_t reaped = 0;
+      auto unstates = make_scope_exit([&]() noexcept {
+        for(; reaped < count; reaped++)
+        {
+          _reap_multiplexer_io_operation(states[reaped]);
+        }
+      });
+      OUTCOME_TRY(_ctx->flush_inited_io_operations());
+      for(; reaped < count; reaped++)
+      {
+        while(!is_finished(_ctx->check_io_operation(states[reaped])))
+        {
+          LLFIO_DEADLINE_TO_PARTIAL_DEADLINE(nd, d);
+          OUTCOME_TRY(_ctx->check_for_any_completed_io(nd));
+        }
+        results[base + reaped] = get_completed(states[reaped]);
+        states[reaped]->~io_operation_state();
+      }
+      base += count;
+    }
+    return success();
+  }
 
 public:
   /*! \brief The *maximum* number of buffers which a single read or write syscall can (atomically)
@@ -369,6 +441,83 @@ public:
 
   LLFIO_DEADLINE_TRY_FOR_UNTIL(write)
 
+  /*! \brief Read data from many offsets of the open handle in a single call, preferentially
+  using any i/o multiplexer set over the virtually overridable per-class implementation.
+
+  Each item in `reqs` is an independent scatter request, and its outcome is written into the
+  same index in `results`. A failure of one item does not affect the others. If an i/o
+  multiplexer is set, all the requests are initiated and then submitted to the system together
+  (e.g. a single `io_uring_enter()` for a whole batch of reads), which is considerably cheaper
+  than a syscall per request. Otherwise the requests are performed one after another.
+
+  \return Failure only if the batch as a whole could not be performed, in which case the contents
+  of `results` are unspecified.
+  \param reqs The scatter requests, each with its own offset.
+  \param results Where to store the outcome of each request. Must be at least as long as `reqs`.
+  \param d An optional deadline by which all the i/o must complete.
+  \errors `errc::invalid_argument` if `results` is shorter than `reqs`, `errc::resource_unavailable_try_again`
+  if the i/o multiplexer could not initiate any i/o.
+  \mallocs None.
+  */
+  LLFIO_MAKE_FREE_FUNCTION
+  result<void> read_multiple(span<const io_request<buffers_type>> reqs, span<io_result<buffers_type>> results, deadline d = deadline()) noexcept
+  {
+    if(results.size() < reqs.size())
+    {
+      return errc::invalid_argument;
+    }
+    if(_ctx == nullptr)
+    {
+      LLFIO_DEADLINE_TO_SLEEP_INIT(d);
+      for(size_t n = 0; n < reqs.size(); n++)
+      {
+        deadline nd;
+        LLFIO_DEADLINE_TO_PARTIAL_DEADLINE(nd, d);
+        results[n] = _do_read(reqs[n], nd);
+      }
+      return success();
+    }
+    return _do_multiplexer_multiple(reqs, results, d, [](byte_io_multiplexer::io_operation_state *state) { return std::move(*state).get_completed_read(); });
+  }
+
+  /*! \brief Write data to many offsets of the open handle in a single call, preferentially
+  using any i/o multiplexer set over the virtually overridable per-class implementation.
+
+  Each item in `reqs` is an independent gather request, and its outcome is written into the
+  same index in `results`. The order in which the writes reach storage is unspecified, so
+  requests ought not to overlap. See `read_multiple()` for more detail.
+
+  \return Failure only if the batch as a whole could not be performed, in which case the contents
+  of `results` are unspecified.
+  \param reqs The gather requests, each with its own offset.
+  \param results Where to store the outcome of each request. Must be at least as long as `reqs`.
+  \param d An optional deadline by which all the i/o must complete.
+  \errors `errc::invalid_argument` if `results` is shorter than `reqs`, `errc::resource_unavailable_try_again`
+  if the i/o multiplexer could not initiate any i/o.
+  \mallocs None.
+  */
+  LLFIO_MAKE_FREE_FUNCTION
+  result<void> write_multiple(span<const io_request<const_buffers_type>> reqs, span<io_result<const_buffers_type>> results, deadline d = deadline()) noexcept
+  {
+    if(results.size() < reqs.size())
+    {
+      return errc::invalid_argument;
+    }
+    if(_ctx == nullptr)
+    {
+      LLFIO_DEADLINE_TO_SLEEP_INIT(d);
+      for(size_t n = 0; n < reqs.size(); n++)
+      {
+        deadline nd;
+        LLFIO_DEADLINE_TO_PARTIAL_DEADLINE(nd, d);
+        results[n] = _do_write(reqs[n], nd);
+      }
+      return success();
+    }
+    return _do_multiplexer_multiple(reqs, results, d,
+                                    [](byte_io_multiplexer::io_operation_state *state) { return std::move(*state).get_completed_write_or_barrier(); });
+  }
+
   /*! \brief Issue a write reordering barrier such that writes preceding the barrier will reach
   storage before writes after this barrier, preferentially using any i/o multiplexer set over the
   virtually overridable per-class implementation.
@@ -688,6 +837,30 @@ write(byte_io_handle &self, byte_io_handle::extent_type offset, std::initializer
 {
   return self.write(std::forward<decltype(offset)>(offset), std::forward<decltype(lst)>(lst), std::forward<decltype(d)>(d));
 }
+/*! \brief Read data from many offsets of the open handle in a single call.
+
+\param self The object whose member function to call.
+\param reqs The scatter requests, each with its own offset.
+\param results Where to store the outcome of each request. Must be at least as long as `reqs`.
+\param d An optional deadline by which all the i/o must complete.
+*/
+inline result<void> read_multiple(byte_io_handle &self, span<const byte_io_handle::io_request<byte_io_handle::buffers_type>> reqs,
+                                  span<byte_io_handle::io_result<byte_io_handle::buffers_type>> results, deadline d = deadline()) noexcept
+{
+  return self.read_multiple(std::forward<decltype(reqs)>(reqs), std::forward<decltype(results)>(results), std::forward<decltype(d)>(d));
+}
+/*! \brief Write data to many offsets of the open handle in a single call.
+
+\param self The object whose member function to call.
+\param reqs The gather requests, each with its own offset.
+\param results Where to store the outcome of each request. Must be at least as long as `reqs`.
+\param d An optional deadline by which all the i/o must complete.
+*/
+inline result<void> write_multiple(byte_io_handle &self, span<const byte_io_handle::io_request<byte_io_handle::const_buffers_type>> reqs,
+                                   span<byte_io_handle::io_result<byte_io_handle::const_buffers_type>> results, deadline d = deadline()) noexcept
+{
+  return self.write_multiple(std::forward<decltype(reqs)>(reqs), std::forward<decltype(results)>(results), std::forward<decltype(d)>(d));
+}
 // END make_free_functions.py
 
 LLFIO_V2_NAMESPACE_END
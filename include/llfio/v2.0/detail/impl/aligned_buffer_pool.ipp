@@ -0,0 +1,195 @@
+/* A pool of aligned i/o buffers
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#include "../../algorithm/aligned_buffer_pool.hpp"
+#include "../../utils.hpp"
+
+#include <mutex>
+#include <vector>
+
+LLFIO_V2_NAMESPACE_BEGIN
+
+namespace algorithm
+{
+  namespace detail
+  {
+    struct aligned_buffer_pool_impl
+    {
+      map_handle region;
+      byte *base{nullptr};
+      size_t buffer_size{0}, alignment{0}, buffers{0};
+      bool fallback_to_mapping{true};
+      mutable std::mutex lock;
+      std::vector<size_t> free;  // indices of available buffers
+
+      struct pooled_buffer final : byte_io_multiplexer::_registered_buffer_type
+      {
+        std::shared_ptr<aligned_buffer_pool_impl> pool;
+        size_t index;
+        pooled_buffer(std::shared_ptr<aligned_buffer_pool_impl> _pool, size_t _index)
+            : byte_io_multiplexer::_registered_buffer_type(span<byte>(_pool->base + _index * _pool->buffer_size, _pool->buffer_size))
+            , pool(std::move(_pool))
+            , index(_index)
+        {
+        }
+        pooled_buffer(const pooled_buffer &) = delete;
+        pooled_buffer(pooled_buffer &&) = delete;
+        pooled_buffer &operator=(const pooled_buffer &) = delete;
+        pooled_buffer &operator=(pooled_buffer &&) = delete;
+        ~pooled_buffer()
+        {
+          std::lock_guard<std::mutex> g(pool->lock);
+          pool->free.push_back(index);
+        }
+      };
+    };
+  }  // namespace detail
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<aligned_buffer_pool> aligned_buffer_pool::create(config c) noexcept
+  {
+    try
+    {
+      const size_t pagesize = utils::page_size();
+      const size_t alignment = (c.alignment != 0) ? c.alignment : pagesize;
+      if((alignment & (alignment - 1)) != 0 || c.buffers == 0)
+      {
+        return errc::invalid_argument;
+      }
+      auto p = std::make_shared<detail::aligned_buffer_pool_impl>();
+      p->alignment = alignment;
+      p->buffer_size = (c.buffer_size != 0) ? c.buffer_size : utils::file_buffer_default_size();
+      p->buffer_size = (p->buffer_size + alignment - 1) & ~(alignment - 1);
+      p->buffers = c.buffers;
+      p->fallback_to_mapping = c.fallback_to_mapping;
+      // Maps are only page aligned, so overallocate if more alignment than that is needed
+      const size_t slop = (alignment > pagesize) ? alignment : 0;
+      OUTCOME_TRY(auto &&region, map_handle::map(p->buffer_size * p->buffers + slop, false));
+      p->region = std::move(region);
+      p->base = (byte *) (((uintptr_t) p->region.address() + alignment - 1) & ~(uintptr_t) (alignment - 1));
+      p->free.reserve(p->buffers);
+      for(size_t n = p->buffers; n > 0; n--)
+      {
+        p->free.push_back(n - 1);
+      }
+      return aligned_buffer_pool(std::move(p));
+    }
+    catch(...)
+    {
+      return error_from_exception();
+    }
+  }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC size_t aligned_buffer_pool::buffer_size() const noexcept { return (_p != nullptr) ? _p->buffer_size : 0; }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC size_t aligned_buffer_pool::alignment() const noexcept { return (_p != nullptr) ? _p->alignment : 0; }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC size_t aligned_buffer_pool::buffers() const noexcept { return (_p != nullptr) ? _p->buffers : 0; }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC size_t aligned_buffer_pool::available() const noexcept
+  {
+    if(_p == nullptr)
+    {
+      return 0;
+    }
+    std::lock_guard<std::mutex> g(_p->lock);
+    return _p->free.size();
+  }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC span<byte> aligned_buffer_pool::region() const noexcept
+  {
+    if(_p == nullptr)
+    {
+      return {};
+    }
+    return {_p->base, _p->buffer_size * _p->buffers};
+  }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC size_t aligned_buffer_pool::index_of(const registered_buffer_type &b) const noexcept
+  {
+    if(_p == nullptr || b == nullptr)
+    {
+      return (size_t) -1;
+    }
+    // Buffers which came from a fallback mapping can never lie within our region
+    const byte *p = b->data();
+    if(p < _p->base || p >= _p->base + _p->buffer_size * _p->buffers)
+    {
+      return (size_t) -1;
+    }
+    return (size_t) (p - _p->base) / _p->buffer_size;
+  }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<aligned_buffer_pool::registered_buffer_type> aligned_buffer_pool::allocate(size_t bytes) noexcept
+  {
+    if(_p == nullptr)
+    {
+      return errc::invalid_argument;
+    }
+    try
+    {
+      if(bytes <= _p->buffer_size)
+      {
+        size_t index = (size_t) -1;
+        {
+          std::lock_guard<std::mutex> g(_p->lock);
+          if(!_p->free.empty())
+          {
+            index = _p->free.back();
+            _p->free.pop_back();
+          }
+        }
+        if(index != (size_t) -1)
+        {
+          auto undo = make_scope_fail([&]() noexcept {
+            std::lock_guard<std::mutex> g(_p->lock);
+            _p->free.push_back(index);
+          });
+          return registered_buffer_type(std::make_shared<detail::aligned_buffer_pool_impl::pooled_buffer>(_p, index));
+        }
+      }
+      if(!_p->fallback_to_mapping)
+      {
+        return errc::resource_unavailable_try_again;
+      }
+      if(bytes == 0)
+      {
+        bytes = _p->buffer_size;
+      }
+      bytes = (bytes + _p->alignment - 1) & ~(_p->alignment - 1);
+      if(_p->alignment > utils::page_size())
+      {
+        // A fresh map is only page aligned
+        return errc::resource_unavailable_try_again;
+      }
+      return LLFIO_V2_NAMESPACE::detail::map_handle_allocate_registered_buffer(bytes);
+    }
+    catch(...)
+    {
+      return error_from_exception();
+    }
+  }
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
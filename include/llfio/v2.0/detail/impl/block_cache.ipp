@@ -0,0 +1,703 @@
+/* A sharded user space block cache for file handles
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+
+#include "../../algorithm/block_cache.hpp"
+#include "../../utils.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+LLFIO_V2_NAMESPACE_BEGIN
+
+namespace algorithm
+{
+  namespace detail
+  {
+    struct block_cache_impl
+    {
+      using extent_type = block_cache::extent_type;
+      using size_type = block_cache::size_type;
+      using unique_id_type = file_handle::unique_id_type;
+      static constexpr uint32_t nil = (uint32_t) -1;
+
+      struct key
+      {
+        unique_id_type id;
+        extent_type block{0};
+
+        bool operator==(const key &o) const noexcept
+        {
+          return block == o.block && id.as_longlongs[0] == o.id.as_longlongs[0] && id.as_longlongs[1] == o.id.as_longlongs[1];
+        }
+        // Mixes the inode and block index, so consecutive blocks of a file spread across shards
+        uint64_t hash() const noexcept
+        {
+          uint64_t x = (uint64_t) id.as_longlongs[0] * 0x9e3779b97f4a7c15ULL ^ (uint64_t) id.as_longlongs[1];
+          x ^= (uint64_t) block * 0xc2b2ae3d27d4eb4fULL;
+          x ^= x >> 31;
+          x *= 0xbf58476d1ce4e5b9ULL;
+          x ^= x >> 29;
+          return x;
+        }
+      };
+      struct key_hasher
+      {
+        size_t operator()(const key &k) const noexcept { return (size_t) k.hash(); }
+      };
+
+      // The ARC lists. T1 and T2 hold cached blocks used once and more than once
+      // respectively, B1 and B2 the keys of blocks recently evicted from each.
+      enum list_index : uint8_t
+      {
+        T1 = 0,
+        T2 = 1,
+        B1 = 2,
+        B2 = 3,
+        unused = 4
+      };
+      struct node
+      {
+        key k;
+        uint32_t prev{nil}, next{nil};  // towards the most and least recently used ends
+        uint32_t frame{nil};
+        uint8_t list{unused};
+      };
+      struct list_type
+      {
+        uint32_t head{nil}, tail{nil};  // most and least recently used
+        size_t size{0};
+      };
+
+      struct shard
+      {
+        std::mutex lock;
+        byte *frames{nullptr};
+        size_t block_size{0}, capacity{0};  // capacity is in blocks
+        size_t p{0};                        // the ARC target size of T1
+        uint64_t epoch{0};                  // incremented whenever cached blocks may have been changed
+        std::vector<node> nodes;            // enough for a full cache and full ghost lists
+        std::vector<uint32_t> free_nodes, free_frames;
+        list_type lists[4];
+        std::unordered_map<key, uint32_t, key_hasher> index;
+        block_cache::statistics stats;
+
+        void unlink(uint32_t n) noexcept
+        {
+          node &i = nodes[n];
+          list_type &l = lists[i.list];
+          if(i.prev != nil)
+          {
+            nodes[i.prev].next = i.next;
+          }
+          else
+          {
+            l.head = i.next;
+          }
+          if(i.next != nil)
+          {
+            nodes[i.next].prev = i.prev;
+          }
+          else
+          {
+            l.tail = i.prev;
+          }
+          l.size--;
+          i.prev = i.next = nil;
+          i.list = unused;
+        }
+        void push_front(uint8_t list, uint32_t n) noexcept
+        {
+          node &i = nodes[n];
+          list_type &l = lists[list];
+          i.list = list;
+          i.prev = nil;
+          i.next = l.head;
+          if(l.head != nil)
+          {
+            nodes[l.head].prev = n;
+          }
+          else
+          {
+            l.tail = n;
+          }
+          l.head = n;
+          l.size++;
+        }
+        // Forgets a block entirely, freeing its frame if it had one
+        void remove(uint32_t n) noexcept
+        {
+          node &i = nodes[n];
+          unlink(n);
+          if(i.frame != nil)
+          {
+            free_frames.push_back(i.frame);
+            i.frame = nil;
+          }
+          index.erase(i.k);
+          free_nodes.push_back(n);
+        }
+        uint32_t find(const key &k) const noexcept
+        {
+          auto it = index.find(k);
+          return (it == index.end()) ? nil : it->second;
+        }
+        bool resident(const key &k) const noexcept
+        {
+          const uint32_t n = find(k);
+          return n != nil && nodes[n].list <= T2;
+        }
+        byte *frame(uint32_t n) const noexcept { return frames + (size_t) nodes[n].frame * block_size; }
+
+        // Returns the frame of a cached block, marking it as used again, or null if not cached
+        byte *hit(const key &k) noexcept
+        {
+          const uint32_t n = find(k);
+          if(n == nil || nodes[n].list > T2)
+          {
+            return nullptr;
+          }
+          unlink(n);
+          push_front(T2, n);
+          return frame(n);
+        }
+        // Evicts the least recently used block of T1 or T2 into the corresponding ghost list
+        void replace(bool in_b2) noexcept
+        {
+          const size_t t1 = lists[T1].size;
+          uint8_t from = (t1 > 0 && (t1 > p || (in_b2 && t1 == p))) ? T1 : T2;
+          if(lists[from].size == 0)
+          {
+            from = (from == T1) ? T2 : T1;
+          }
+          const uint32_t n = lists[from].tail;
+          unlink(n);
+          free_frames.push_back(nodes[n].frame);
+          nodes[n].frame = nil;
+          push_front((uint8_t) (from + 2), n);
+          stats.evictions++;
+        }
+        /* Makes room for a block which is not cached, returning the frame to fill, or null if
+        somebody else cached it in the meantime. This is the ARC algorithm, except that
+        eviction only occurs when there are no free frames, as after invalidation.
+        */
+        byte *insert(const key &k)
+        {
+          const size_t c = capacity;
+          uint32_t n = find(k);
+          if(n != nil)
+          {
+            const uint8_t list = nodes[n].list;
+            if(list <= T2)
+            {
+              return nullptr;
+            }
+            // A ghost hit adapts the target size of T1 towards whichever list it came from
+            const size_t b1 = lists[B1].size, b2 = lists[B2].size;
+            if(list == B1)
+            {
+              p = std::min(c, p + std::max((size_t) 1, b2 / b1));
+            }
+            else
+            {
+              p -= std::min(p, std::max((size_t) 1, b1 / b2));
+            }
+            stats.ghost_hits++;
+            unlink(n);
+            if(free_frames.empty())
+            {
+              replace(list == B2);
+            }
+            push_front(T2, n);
+          }
+          else
+          {
+            const size_t l1 = lists[T1].size + lists[B1].size, total = l1 + lists[T2].size + lists[B2].size;
+            if(l1 >= c)
+            {
+              if(lists[T1].size < c)
+              {
+                remove(lists[B1].tail);
+              }
+              else
+              {
+                remove(lists[T1].tail);
+                stats.evictions++;
+              }
+            }
+            else if(total >= 2 * c)
+            {
+              remove(lists[B2].tail);
+            }
+            if(free_frames.empty())
+            {
+              replace(false);
+            }
+            if(free_nodes.empty())
+            {
+              remove(lists[(lists[B1].size > 0) ? B1 : B2].tail);
+            }
+            n = free_nodes.back();
+            index.emplace(k, n);
+            free_nodes.pop_back();
+            nodes[n].k = k;
+            push_front(T1, n);
+          }
+          nodes[n].frame = free_frames.back();
+          free_frames.pop_back();
+          return frame(n);
+        }
+      };
+
+      block_cache::config config;
+      map_handle mem;
+      std::unique_ptr<shard[]> shards;
+      size_t max_run{1};  // the most blocks read from a file at once
+
+      shard &shard_for(const key &k) const noexcept { return shards[(size_t) (k.hash() >> 40) & (config.shards - 1)]; }
+
+      // Reads bytes at offset through the cache, copying into out if it is not null
+      result<extent_type> fetch(file_handle &h, extent_type offset, extent_type bytes, block_cache::buffers_type *out, deadline d) noexcept
+      {
+        const auto bs = (extent_type) config.block_size;
+        const auto id = h.unique_id();
+        const extent_type end = offset + bytes;
+        map_handle scratch;
+        auto *epochs = (uint64_t *) alloca(sizeof(uint64_t) * max_run);
+        size_t bi = 0;
+        size_type bo = 0;
+        auto copy_out = [&](const byte *src, size_type len) {
+          while(len > 0)
+          {
+            auto &b = (*out)[bi];
+            const size_type n = std::min(len, b.size() - bo);
+            memcpy(b.data() + bo, src, n);
+            src += n;
+            len -= n;
+            bo += n;
+            if(bo == b.size())
+            {
+              bi++;
+              bo = 0;
+            }
+          }
+        };
+        if(out != nullptr)
+        {
+          // Skip any empty buffers at the front
+          while(bi < out->size() && (*out)[bi].size() == 0)
+          {
+            bi++;
+          }
+        }
+        extent_type pos = offset, done = 0;
+        while(pos < end)
+        {
+          const extent_type block = pos / bs;
+          {
+            const key k{id, block};
+            shard &s = shard_for(k);
+            std::lock_guard<std::mutex> g(s.lock);
+            if(out != nullptr)
+            {
+              if(byte *frame = s.hit(k))
+              {
+                const auto n = (size_type) (std::min(end, (block + 1) * bs) - pos);
+                copy_out(frame + (pos - block * bs), n);
+                s.stats.hits++;
+                pos += n;
+                done += n;
+                continue;
+              }
+            }
+            else if(s.resident(k))
+            {
+              const extent_type n = std::min(end, (block + 1) * bs) - pos;
+              pos += n;
+              done += n;
+              continue;
+            }
+            epochs[0] = s.epoch;
+          }
+          // Read this block, and any following blocks which are also not cached, in one go
+          size_t run = 1;
+          while(run < max_run && (block + run) * bs < end)
+          {
+            const key k{id, block + run};
+            shard &s = shard_for(k);
+            std::lock_guard<std::mutex> g(s.lock);
+            if(s.resident(k))
+            {
+              break;
+            }
+            epochs[run++] = s.epoch;
+          }
+          if(!scratch.is_valid() || scratch.length() < run * bs)
+          {
+            OUTCOME_TRY(auto &&_, map_handle::map((size_type) (run * bs)));
+            scratch = std::move(_);
+          }
+          size_type got = 0;
+          {
+            block_cache::buffer_type b(scratch.address(), (size_type) (run * bs));
+            OUTCOME_TRY(auto &&filled, h.read(block_cache::io_request<block_cache::buffers_type>({&b, 1}, block * bs), d));
+            for(auto &i : filled)
+            {
+              // Some handles return pointers to elsewhere e.g. into a map
+              if(i.data() != scratch.address() + got)
+              {
+                memmove(scratch.address() + got, i.data(), i.size());
+              }
+              got += i.size();
+            }
+          }
+          for(size_t i = 0; i < run; i++)
+          {
+            const extent_type blockoffset = (block + i) * bs;
+            const byte *src = scratch.address() + i * bs;
+            const size_type valid = (got > i * bs) ? std::min((size_type) bs, got - (size_type) (i * bs)) : 0;
+            {
+              const key k{id, block + i};
+              shard &s = shard_for(k);
+              std::lock_guard<std::mutex> g(s.lock);
+              if(out != nullptr)
+              {
+                s.stats.misses++;
+              }
+              // Only whole blocks are cached, and not if they may have been written since being read
+              if(valid == bs && s.epoch == epochs[i])
+              {
+                byte *dest = nullptr;
+                try
+                {
+                  dest = s.insert(k);
+                }
+                catch(...)
+                {
+                  // Serve the read uncached
+                }
+                if(dest != nullptr)
+                {
+                  memcpy(dest, src, (size_t) bs);
+                  if(out == nullptr)
+                  {
+                    s.stats.prefetches++;
+                  }
+                }
+              }
+            }
+            const extent_type from = std::max(pos, blockoffset), to = std::min(end, std::min(blockoffset + valid, blockoffset + bs));
+            if(from < to)
+            {
+              if(out != nullptr)
+              {
+                copy_out(src + (from - blockoffset), (size_type) (to - from));
+              }
+              done += to - from;
+            }
+          }
+          if(got < run * bs)
+          {
+            // The end of the file
+            break;
+          }
+          pos = std::min(end, (block + run) * bs);
+        }
+        return done;
+      }
+
+      // Updates any cached copies of the blocks overlapping the buffers written at offset
+      void update(const unique_id_type &id, extent_type offset, block_cache::const_buffers_type buffers) noexcept
+      {
+        const auto bs = (extent_type) config.block_size;
+        for(const auto &b : buffers)
+        {
+          const byte *src = b.data();
+          extent_type left = b.size();
+          while(left > 0)
+          {
+            const extent_type block = offset / bs, inblock = offset % bs, n = std::min(left, bs - inblock);
+            const key k{id, block};
+            shard &s = shard_for(k);
+            {
+              std::lock_guard<std::mutex> g(s.lock);
+              const uint32_t i = s.find(k);
+              if(i != nil && s.nodes[i].list <= T2)
+              {
+                memcpy(s.frame(i) + inblock, src, (size_t) n);
+              }
+              s.epoch++;
+            }
+            src += n;
+            offset += n;
+            left -= n;
+          }
+        }
+      }
+
+      void invalidate(const unique_id_type &id, extent_type offset, extent_type bytes) noexcept
+      {
+        const auto bs = (extent_type) config.block_size;
+        const extent_type first = offset / bs;
+        const extent_type last = (bytes > (extent_type) -1 - offset - bs) ? (extent_type) -1 : (offset + bytes + bs - 1) / bs;
+        auto drop = [&](shard &s, uint32_t n) {
+          if(s.nodes[n].list <= T2)
+          {
+            s.stats.invalidations++;
+          }
+          s.remove(n);
+        };
+        if(last - first <= config.capacity / bs)
+        {
+          for(extent_type block = first; block < last; block++)
+          {
+            const key k{id, block};
+            shard &s = shard_for(k);
+            std::lock_guard<std::mutex> g(s.lock);
+            const uint32_t n = s.find(k);
+            if(n != nil)
+            {
+              drop(s, n);
+            }
+            s.epoch++;
+          }
+          return;
+        }
+        // Cheaper to look at everything cached
+        const key k{id, 0};
+        for(size_t i = 0; i < config.shards; i++)
+        {
+          shard &s = shards[i];
+          std::lock_guard<std::mutex> g(s.lock);
+          for(uint32_t n = 0; n < (uint32_t) s.nodes.size(); n++)
+          {
+            const key &nk = s.nodes[n].k;
+            if(s.nodes[n].list != unused && nk.block >= first && nk.block < last && key{nk.id, 0} == k)
+            {
+              drop(s, n);
+            }
+          }
+          s.epoch++;
+        }
+      }
+    };
+  }  // namespace detail
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<block_cache> block_cache::create(config c) noexcept
+  {
+    try
+    {
+      const size_t pagesize = utils::page_size();
+      c.block_size = (c.block_size != 0) ? c.block_size : 65536;
+      c.block_size = (c.block_size + pagesize - 1) & ~(pagesize - 1);
+      size_t shards = c.shards;
+      if(shards == 0)
+      {
+        shards = 2 * std::max((size_t) 1, (size_t) std::thread::hardware_concurrency());
+      }
+      c.shards = 1;
+      while(c.shards < shards)
+      {
+        c.shards <<= 1;
+      }
+      const size_t blocks = c.capacity / c.block_size;
+      if(blocks == 0)
+      {
+        return errc::invalid_argument;
+      }
+      // Replacement policy needs a reasonable number of blocks per shard to be meaningful
+      while(c.shards > 1 && blocks / c.shards < 64)
+      {
+        c.shards >>= 1;
+      }
+      const size_t per_shard = std::min(blocks / c.shards, (size_t) (detail::block_cache_impl::nil / 2));
+      c.capacity = per_shard * c.shards * c.block_size;
+
+      auto p = std::make_shared<detail::block_cache_impl>();
+      OUTCOME_TRY(auto &&mem, map_handle::map(c.capacity));
+      p->mem = std::move(mem);
+      p->config = c;
+      p->max_run = std::max((size_t) 1, utils::file_buffer_default_size() / c.block_size);
+      p->shards.reset(new detail::block_cache_impl::shard[c.shards]);
+      for(size_t i = 0; i < c.shards; i++)
+      {
+        auto &s = p->shards[i];
+        s.frames = p->mem.address() + i * per_shard * c.block_size;
+        s.block_size = c.block_size;
+        s.capacity = per_shard;
+        s.nodes.resize(2 * per_shard);
+        s.free_nodes.reserve(2 * per_shard);
+        for(size_t n = 2 * per_shard; n > 0; n--)
+        {
+          s.free_nodes.push_back((uint32_t) (n - 1));
+        }
+        s.free_frames.reserve(per_shard);
+        for(size_t n = per_shard; n > 0; n--)
+        {
+          s.free_frames.push_back((uint32_t) (n - 1));
+        }
+        s.index.reserve(2 * per_shard);
+      }
+      return block_cache(std::move(p));
+    }
+    catch(...)
+    {
+      return error_from_exception();
+    }
+  }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC size_t block_cache::capacity() const noexcept { return (_p != nullptr) ? _p->config.capacity : 0; }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC size_t block_cache::block_size() const noexcept { return (_p != nullptr) ? _p->config.block_size : 0; }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC size_t block_cache::shards() const noexcept { return (_p != nullptr) ? _p->config.shards : 0; }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC block_cache::statistics block_cache::stats() const noexcept
+  {
+    statistics ret;
+    if(_p == nullptr)
+    {
+      return ret;
+    }
+    for(size_t i = 0; i < _p->config.shards; i++)
+    {
+      auto &s = _p->shards[i];
+      std::lock_guard<std::mutex> g(s.lock);
+      ret.hits += s.stats.hits;
+      ret.misses += s.stats.misses;
+      ret.ghost_hits += s.stats.ghost_hits;
+      ret.prefetches += s.stats.prefetches;
+      ret.evictions += s.stats.evictions;
+      ret.invalidations += s.stats.invalidations;
+      ret.resident_blocks += s.lists[detail::block_cache_impl::T1].size + s.lists[detail::block_cache_impl::T2].size;
+    }
+    return ret;
+  }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void block_cache::reset_stats() noexcept
+  {
+    if(_p == nullptr)
+    {
+      return;
+    }
+    for(size_t i = 0; i < _p->config.shards; i++)
+    {
+      auto &s = _p->shards[i];
+      std::lock_guard<std::mutex> g(s.lock);
+      s.stats = {};
+    }
+  }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC block_cache::io_result<block_cache::buffers_type> block_cache::read(file_handle &h, io_request<buffers_type> reqs,
+                                                                                                    deadline d) noexcept
+  {
+    if(_p == nullptr)
+    {
+      return errc::invalid_argument;
+    }
+    size_type bytes = 0;
+    for(const auto &b : reqs.buffers)
+    {
+      bytes += b.size();
+    }
+    OUTCOME_TRY(auto &&done, _p->fetch(h, reqs.offset, bytes, &reqs.buffers, d));
+    // Trim the buffers to what was read
+    for(auto &b : reqs.buffers)
+    {
+      const auto n = (size_type) std::min((extent_type) b.size(), done);
+      b = buffer_type(b.data(), n);
+      done -= n;
+    }
+    return std::move(reqs.buffers);
+  }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC block_cache::io_result<block_cache::const_buffers_type> block_cache::write(file_handle &h, io_request<const_buffers_type> reqs,
+                                                                                                          deadline d) noexcept
+  {
+    if(_p == nullptr)
+    {
+      return errc::invalid_argument;
+    }
+    auto ret = h.write(reqs, d);
+    if(!ret)
+    {
+      // Some of it may have been written
+      size_type bytes = 0;
+      for(const auto &b : reqs.buffers)
+      {
+        bytes += b.size();
+      }
+      _p->invalidate(h.unique_id(), reqs.offset, bytes);
+      return ret;
+    }
+    _p->update(h.unique_id(), reqs.offset, ret.value());
+    return ret;
+  }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<block_cache::extent_type> block_cache::prefetch(file_handle &h, extent_type offset, extent_type bytes, deadline d) noexcept
+  {
+    if(_p == nullptr)
+    {
+      return errc::invalid_argument;
+    }
+    return _p->fetch(h, offset, bytes, nullptr, d);
+  }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void block_cache::invalidate(const file_handle::unique_id_type &id, extent_type offset, extent_type bytes) noexcept
+  {
+    if(_p != nullptr)
+    {
+      _p->invalidate(id, offset, bytes);
+    }
+  }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void block_cache::clear() noexcept
+  {
+    if(_p == nullptr)
+    {
+      return;
+    }
+    for(size_t i = 0; i < _p->config.shards; i++)
+    {
+      auto &s = _p->shards[i];
+      std::lock_guard<std::mutex> g(s.lock);
+      for(uint32_t n = 0; n < (uint32_t) s.nodes.size(); n++)
+      {
+        if(s.nodes[n].list != detail::block_cache_impl::unused)
+        {
+          s.remove(n);
+        }
+      }
+      s.p = 0;
+      s.epoch++;
+    }
+  }
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
@@ -0,0 +1,305 @@
+/* A handle adapter which keeps per-block CRC32C checksums of another handle
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#include "../../algorithm/handle_adapter/checksummed.hpp"
+#include "cpu_features.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define LLFIO_CRC32C_X86 1
+#include <nmmintrin.h>  // for _mm_crc32_*
+#if defined(__x86_64__) || defined(_M_X64)
+#define LLFIO_CRC32C_X64 1
+#include <wmmintrin.h>  // for _mm_clmulepi64_si128
+#endif
+#if defined(__GNUC__) || defined(__clang__)
+#define LLFIO_CRC32C_TARGET_SSE42 __attribute__((target("sse4.2")))
+#define LLFIO_CRC32C_TARGET_SSE42_PCLMUL __attribute__((target("sse4.2,pclmul")))
+#else
+#define LLFIO_CRC32C_TARGET_SSE42
+#define LLFIO_CRC32C_TARGET_SSE42_PCLMUL
+#endif
+#endif
+#if(defined(__aarch64__) || defined(__arm__)) && defined(__ARM_FEATURE_CRC32)
+#define LLFIO_CRC32C_ARMV8 1
+#include <arm_acle.h>
+#endif
+
+LLFIO_V2_NAMESPACE_BEGIN
+
+namespace algorithm
+{
+  namespace detail
+  {
+    // All of these work on the raw CRC register i.e. without the pre and post inversion
+    static constexpr uint32_t crc32c_polynomial = 0x82f63b78;  // Castagnoli, reflected
+
+    struct crc32c_table_t
+    {
+      uint32_t v[8][256];
+      crc32c_table_t() noexcept
+      {
+        for(uint32_t n = 0; n < 256; n++)
+        {
+          uint32_t crc = n;
+          for(int k = 0; k < 8; k++)
+          {
+            crc = (crc & 1) ? ((crc >> 1) ^ crc32c_polynomial) : (crc >> 1);
+          }
+          v[0][n] = crc;
+        }
+        for(uint32_t n = 0; n < 256; n++)
+        {
+          for(int k = 1; k < 8; k++)
+          {
+            v[k][n] = (v[k - 1][n] >> 8) ^ v[0][v[k - 1][n] & 0xff];
+          }
+        }
+      }
+    };
+    inline const crc32c_table_t &crc32c_table() noexcept
+    {
+      static const crc32c_table_t v;
+      return v;
+    }
+
+    // Slicing by eight, about 1.5 bytes per cycle
+    inline uint32_t crc32c_software(uint32_t crc, const byte *p, size_t bytes) noexcept
+    {
+      const auto &t = crc32c_table().v;
+#if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+      while(bytes > 0 && ((uintptr_t) p & 7) != 0)
+      {
+        crc = t[0][(crc ^ (uint8_t) *p++) & 0xff] ^ (crc >> 8);
+        bytes--;
+      }
+      while(bytes >= 8)
+      {
+        uint32_t lo, hi;
+        memcpy(&lo, p, 4);
+        memcpy(&hi, p + 4, 4);
+        lo ^= crc;
+        crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24]  //
+              ^ t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^ t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+        p += 8;
+        bytes -= 8;
+      }
+#endif
+      while(bytes > 0)
+      {
+        crc = t[0][(crc ^ (uint8_t) *p++) & 0xff] ^ (crc >> 8);
+        bytes--;
+      }
+      return crc;
+    }
+
+#ifdef LLFIO_CRC32C_X86
+    // The crc32 instruction does eight bytes per cycle, but has a latency of three cycles
+    LLFIO_CRC32C_TARGET_SSE42 inline uint32_t crc32c_sse42(uint32_t crc, const byte *p, size_t bytes) noexcept
+    {
+      while(bytes > 0 && ((uintptr_t) p & 7) != 0)
+      {
+        crc = _mm_crc32_u8(crc, (uint8_t) *p++);
+        bytes--;
+      }
+#ifdef LLFIO_CRC32C_X64
+      uint64_t crc64 = crc;
+      while(bytes >= 8)
+      {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        crc64 = _mm_crc32_u64(crc64, v);
+        p += 8;
+        bytes -= 8;
+      }
+      crc = (uint32_t) crc64;
+#else
+      while(bytes >= 4)
+      {
+        uint32_t v;
+        memcpy(&v, p, 4);
+        crc = _mm_crc32_u32(crc, v);
+        p += 4;
+        bytes -= 4;
+      }
+#endif
+      while(bytes > 0)
+      {
+        crc = _mm_crc32_u8(crc, (uint8_t) *p++);
+        bytes--;
+      }
+      return crc;
+    }
+
+#ifdef LLFIO_CRC32C_X64
+    /* To hide the latency of the crc32 instruction, three independent streams are
+    checksummed at once and the results combined. Shifting a CRC register over `n`
+    zero bytes is multiplication by x^(8n) modulo the polynomial. Carry-less
+    multiplication by x^(8n-33) followed by a crc32 of the 64 bit product (which
+    multiplies by x^33 and reduces) does that in a few cycles.
+    */
+    struct crc32c_shifts_t
+    {
+      static constexpr size_t long_stream = 8192, short_stream = 256;
+      uint32_t long1{0}, long2{0}, short1{0}, short2{0};
+
+      // Returns x^n modulo the polynomial, reflected
+      static uint32_t xpow(size_t n) noexcept
+      {
+        uint32_t v = 0x80000000;  // x^0
+        while(n-- > 0)
+        {
+          v = (v & 1) ? ((v >> 1) ^ crc32c_polynomial) : (v >> 1);
+        }
+        return v;
+      }
+      crc32c_shifts_t() noexcept
+          : long1(xpow(long_stream * 8 - 33))
+          , long2(xpow(long_stream * 16 - 33))
+          , short1(xpow(short_stream * 8 - 33))
+          , short2(xpow(short_stream * 16 - 33))
+      {
+      }
+    };
+    inline const crc32c_shifts_t &crc32c_shifts() noexcept
+    {
+      static const crc32c_shifts_t v;
+      return v;
+    }
+    LLFIO_CRC32C_TARGET_SSE42_PCLMUL inline uint32_t crc32c_shift(uint32_t crc, uint32_t k) noexcept
+    {
+      const __m128i product = _mm_clmulepi64_si128(_mm_cvtsi32_si128((int) crc), _mm_cvtsi32_si128((int) k), 0);
+      return (uint32_t) _mm_crc32_u64(0, (uint64_t) _mm_cvtsi128_si64(product));
+    }
+    template <size_t stream_bytes>
+    LLFIO_CRC32C_TARGET_SSE42_PCLMUL inline uint32_t crc32c_sse42_pclmul_streams(uint32_t crc, const byte *&p, size_t &bytes, uint32_t k1,
+                                                                                  uint32_t k2) noexcept
+    {
+      while(bytes >= stream_bytes * 3)
+      {
+        uint64_t crc0 = crc, crc1 = 0, crc2 = 0;
+        const byte *end = p + stream_bytes;
+        do
+        {
+          uint64_t v0, v1, v2;
+          memcpy(&v0, p, 8);
+          memcpy(&v1, p + stream_bytes, 8);
+          memcpy(&v2, p + stream_bytes * 2, 8);
+          crc0 = _mm_crc32_u64(crc0, v0);
+          crc1 = _mm_crc32_u64(crc1, v1);
+          crc2 = _mm_crc32_u64(crc2, v2);
+          p += 8;
+        } while(p < end);
+        crc = crc32c_shift((uint32_t) crc0, k2) ^ crc32c_shift((uint32_t) crc1, k1) ^ (uint32_t) crc2;
+        p += stream_bytes * 2;
+        bytes -= stream_bytes * 3;
+      }
+      return crc;
+    }
+    LLFIO_CRC32C_TARGET_SSE42_PCLMUL inline uint32_t crc32c_sse42_pclmul(uint32_t crc, const byte *p, size_t bytes) noexcept
+    {
+      const auto &shifts = crc32c_shifts();
+      while(bytes > 0 && ((uintptr_t) p & 7) != 0)
+      {
+        crc = _mm_crc32_u8(crc, (uint8_t) *p++);
+        bytes--;
+      }
+      crc = crc32c_sse42_pclmul_streams<crc32c_shifts_t::long_stream>(crc, p, bytes, shifts.long1, shifts.long2);
+      crc = crc32c_sse42_pclmul_streams<crc32c_shifts_t::short_stream>(crc, p, bytes, shifts.short1, shifts.short2);
+      return crc32c_sse42(crc, p, bytes);
+    }
+#endif
+#endif
+
+#ifdef LLFIO_CRC32C_ARMV8
+    inline uint32_t crc32c_armv8(uint32_t crc, const byte *p, size_t bytes) noexcept
+    {
+      while(bytes > 0 && ((uintptr_t) p & 7) != 0)
+      {
+        crc = __crc32cb(crc, (uint8_t) *p++);
+        bytes--;
+      }
+      while(bytes >= 8)
+      {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        crc = __crc32cd(crc, v);
+        p += 8;
+        bytes -= 8;
+      }
+      while(bytes > 0)
+      {
+        crc = __crc32cb(crc, (uint8_t) *p++);
+        bytes--;
+      }
+      return crc;
+    }
+#endif
+
+    struct crc32c_implementation_t
+    {
+      uint32_t (*func)(uint32_t crc, const byte *p, size_t bytes);
+      const char *name;
+    };
+    inline const crc32c_implementation_t &crc32c_select() noexcept
+    {
+      static const crc32c_implementation_t v = []() -> crc32c_implementation_t {
+#ifdef LLFIO_CRC32C_X86
+        const auto &features = LLFIO_V2_NAMESPACE::detail::cpu_features();
+#ifdef LLFIO_CRC32C_X64
+        if(features.sse42 && features.pclmul)
+        {
+          return {crc32c_sse42_pclmul, "sse4.2+pclmul"};
+        }
+#endif
+        if(features.sse42)
+        {
+          return {crc32c_sse42, "sse4.2"};
+        }
+#endif
+#ifdef LLFIO_CRC32C_ARMV8
+        return {crc32c_armv8, "armv8"};
+#else
+        return {crc32c_software, "software"};
+#endif
+      }();
+      return v;
+    }
+  }  // namespace detail
+
+  LLFIO_HEADERS_ONLY_FUNC_SPEC uint32_t crc32c(const byte *data, size_t bytes, uint32_t crc) noexcept
+  {
+    return ~detail::crc32c_select().func(~crc, data, bytes);
+  }
+
+  LLFIO_HEADERS_ONLY_FUNC_SPEC const char *crc32c_implementation() noexcept { return detail::crc32c_select().name; }
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
+
+#undef LLFIO_CRC32C_X86
+#undef LLFIO_CRC32C_X64
+#undef LLFIO_CRC32C_ARMV8
+#undef LLFIO_CRC32C_TARGET_SSE42
+#undef LLFIO_CRC32C_TARGET_SSE42_PCLMUL
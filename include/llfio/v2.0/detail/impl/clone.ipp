@@ -23,6 +23,9 @@ Distributed under the Boost Software License, Version 1.0.
 */
 
 #include "../../algorithm/clone.hpp"
+#ifndef LLFIO_EXCLUDE_DYNAMIC_THREAD_POOL_GROUP
+#include "../../algorithm/parallel_copy.hpp"
+#endif
 
 LLFIO_V2_NAMESPACE_BEGIN
 
@@ -30,7 +33,7 @@ namespace algorithm
 {
   LLFIO_HEADERS_ONLY_FUNC_SPEC result<file_handle::extent_type> clone_or_copy(file_handle &src, const path_handle &destdir, path_view destleaf,
                                                                               bool preserve_timestamps, bool force_copy_now, file_handle::creation creation,
-                                                                              deadline d) noexcept
+                                                                              deadline d, file_handle::clone_method *method) noexcept
   {
     LLFIO_LOG_FUNCTION_CALL(&src);
     filesystem::path destleaf_;
@@ -77,12 +80,21 @@ namespace algorithm
       (void) dest.close();
     });
     (void) undest;
+    // Each attempt records its methods locally, so only the attempt which succeeds is reported
+    auto report = [method](file_handle::clone_method used) {
+      if(method != nullptr)
+      {
+        *method |= used;
+      }
+    };
     {
       log_level_guard g(log_level::fatal);
-      auto r = src.clone_extents_to(dest, d, force_copy_now, false);
+      file_handle::clone_method used = file_handle::clone_method::none;
+      auto r = src.clone_extents_to(dest, d, force_copy_now, false, &used);
       if(r)
       {
         failed = false;
+        report(used);
         return r.assume_value().length;
       }
     }
@@ -92,8 +104,23 @@ namespace algorithm
     {
       return errc::no_space_on_device;
     }
-    OUTCOME_TRY(auto &&copied, src.clone_extents_to(dest, d, force_copy_now, true));
+#ifndef LLFIO_EXCLUDE_DYNAMIC_THREAD_POOL_GROUP
+    if(stat.st_size >= parallel_copy_threshold)
+    {
+      parallel_copy_config c;
+      c.use_kernel_copy = false;  // we already know it doesn't work
+      c.force_copy_now = force_copy_now;
+      file_handle::clone_method used = file_handle::clone_method::none;
+      OUTCOME_TRY(auto &&copied, parallel_copy(src, dest, c, d, &used));
+      failed = false;
+      report(used);
+      return copied;
+    }
+#endif
+    file_handle::clone_method used = file_handle::clone_method::none;
+    OUTCOME_TRY(auto &&copied, src.clone_extents_to(dest, d, force_copy_now, true, &used));
     failed = false;
+    report(used);
     return copied.length;
   }
 
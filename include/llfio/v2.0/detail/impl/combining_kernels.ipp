@@ -0,0 +1,310 @@
+/* SIMD kernels for combining the contents of buffers
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#include "../../algorithm/handle_adapter/combining.hpp"
+#include "cpu_features.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define LLFIO_COMBINE_X86 1
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define LLFIO_COMBINE_TARGET_SSE2 __attribute__((target("sse2")))
+#define LLFIO_COMBINE_TARGET_AVX2 __attribute__((target("avx2")))
+#define LLFIO_COMBINE_TARGET_AVX512 __attribute__((target("avx512f,avx512bw")))
+#else
+#define LLFIO_COMBINE_TARGET_SSE2
+#define LLFIO_COMBINE_TARGET_AVX2
+#define LLFIO_COMBINE_TARGET_AVX512
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define LLFIO_COMBINE_NEON 1
+#include <arm_neon.h>
+#endif
+
+LLFIO_V2_NAMESPACE_BEGIN
+
+namespace algorithm
+{
+  namespace detail
+  {
+    // Scalar kernels, which also do the tails of the vector kernels
+    inline void combine_xor_scalar(byte *out, const byte *a, const byte *b, size_t bytes) noexcept
+    {
+      for(; bytes >= 8; out += 8, a += 8, b += 8, bytes -= 8)
+      {
+        uint64_t x, y;
+        memcpy(&x, a, 8);
+        memcpy(&y, b, 8);
+        x ^= y;
+        memcpy(out, &x, 8);
+      }
+      for(; bytes > 0; bytes--)
+      {
+        *out++ = *a++ ^ *b++;
+      }
+    }
+    inline void combine_add_scalar(byte *out, const byte *a, const byte *b, size_t bytes) noexcept
+    {
+      for(; bytes >= 8; out += 8, a += 8, b += 8, bytes -= 8)
+      {
+        uint64_t x, y;
+        memcpy(&x, a, 8);
+        memcpy(&y, b, 8);
+        // Add each byte without carrying into the next
+        x = ((x & 0x7f7f7f7f7f7f7f7fULL) + (y & 0x7f7f7f7f7f7f7f7fULL)) ^ ((x ^ y) & 0x8080808080808080ULL);
+        memcpy(out, &x, 8);
+      }
+      for(; bytes > 0; bytes--)
+      {
+        *out++ = (byte) (uint8_t) ((uint8_t) *a++ + (uint8_t) *b++);
+      }
+    }
+    inline size_t combine_compare_scalar(const byte *a, const byte *b, size_t bytes) noexcept
+    {
+      size_t idx = 0;
+      for(; bytes - idx >= 8; idx += 8)
+      {
+        uint64_t x, y;
+        memcpy(&x, a + idx, 8);
+        memcpy(&y, b + idx, 8);
+        if(x != y)
+        {
+          break;
+        }
+      }
+      for(; idx < bytes; idx++)
+      {
+        if(a[idx] != b[idx])
+        {
+          break;
+        }
+      }
+      return idx;
+    }
+
+#ifdef LLFIO_COMBINE_X86
+    LLFIO_COMBINE_TARGET_SSE2 inline void combine_xor_sse2(byte *out, const byte *a, const byte *b, size_t bytes) noexcept
+    {
+      for(; bytes >= 16; out += 16, a += 16, b += 16, bytes -= 16)
+      {
+        _mm_storeu_si128((__m128i *) out, _mm_xor_si128(_mm_loadu_si128((const __m128i *) a), _mm_loadu_si128((const __m128i *) b)));
+      }
+      combine_xor_scalar(out, a, b, bytes);
+    }
+    LLFIO_COMBINE_TARGET_SSE2 inline void combine_add_sse2(byte *out, const byte *a, const byte *b, size_t bytes) noexcept
+    {
+      for(; bytes >= 16; out += 16, a += 16, b += 16, bytes -= 16)
+      {
+        _mm_storeu_si128((__m128i *) out, _mm_add_epi8(_mm_loadu_si128((const __m128i *) a), _mm_loadu_si128((const __m128i *) b)));
+      }
+      combine_add_scalar(out, a, b, bytes);
+    }
+    LLFIO_COMBINE_TARGET_SSE2 inline size_t combine_compare_sse2(const byte *a, const byte *b, size_t bytes) noexcept
+    {
+      size_t idx = 0;
+      for(; bytes - idx >= 16; idx += 16)
+      {
+        const auto mask =
+        (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) (a + idx)), _mm_loadu_si128((const __m128i *) (b + idx))));
+        if(mask != 0xffff)
+        {
+          return idx + combine_compare_scalar(a + idx, b + idx, 16);
+        }
+      }
+      return idx + combine_compare_scalar(a + idx, b + idx, bytes - idx);
+    }
+
+    LLFIO_COMBINE_TARGET_AVX2 inline void combine_xor_avx2(byte *out, const byte *a, const byte *b, size_t bytes) noexcept
+    {
+      for(; bytes >= 32; out += 32, a += 32, b += 32, bytes -= 32)
+      {
+        _mm256_storeu_si256((__m256i *) out, _mm256_xor_si256(_mm256_loadu_si256((const __m256i *) a), _mm256_loadu_si256((const __m256i *) b)));
+      }
+      combine_xor_scalar(out, a, b, bytes);
+    }
+    LLFIO_COMBINE_TARGET_AVX2 inline void combine_add_avx2(byte *out, const byte *a, const byte *b, size_t bytes) noexcept
+    {
+      for(; bytes >= 32; out += 32, a += 32, b += 32, bytes -= 32)
+      {
+        _mm256_storeu_si256((__m256i *) out, _mm256_add_epi8(_mm256_loadu_si256((const __m256i *) a), _mm256_loadu_si256((const __m256i *) b)));
+      }
+      combine_add_scalar(out, a, b, bytes);
+    }
+    LLFIO_COMBINE_TARGET_AVX2 inline size_t combine_compare_avx2(const byte *a, const byte *b, size_t bytes) noexcept
+    {
+      size_t idx = 0;
+      for(; bytes - idx >= 32; idx += 32)
+      {
+        const auto mask = (unsigned) _mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) (a + idx)), _mm256_loadu_si256((const __m256i *) (b + idx))));
+        if(mask != 0xffffffff)
+        {
+          return idx + combine_compare_scalar(a + idx, b + idx, 32);
+        }
+      }
+      return idx + combine_compare_scalar(a + idx, b + idx, bytes - idx);
+    }
+
+    // AVX-512 does the tail with masked loads and stores
+    LLFIO_COMBINE_TARGET_AVX512 inline void combine_xor_avx512(byte *out, const byte *a, const byte *b, size_t bytes) noexcept
+    {
+      for(; bytes >= 64; out += 64, a += 64, b += 64, bytes -= 64)
+      {
+        _mm512_storeu_si512(out, _mm512_xor_si512(_mm512_loadu_si512(a), _mm512_loadu_si512(b)));
+      }
+      if(bytes > 0)
+      {
+        const __mmask64 m = (__mmask64) -1 >> (64 - bytes);
+        _mm512_mask_storeu_epi8(out, m, _mm512_xor_si512(_mm512_maskz_loadu_epi8(m, a), _mm512_maskz_loadu_epi8(m, b)));
+      }
+    }
+    LLFIO_COMBINE_TARGET_AVX512 inline void combine_add_avx512(byte *out, const byte *a, const byte *b, size_t bytes) noexcept
+    {
+      for(; bytes >= 64; out += 64, a += 64, b += 64, bytes -= 64)
+      {
+        _mm512_storeu_si512(out, _mm512_add_epi8(_mm512_loadu_si512(a), _mm512_loadu_si512(b)));
+      }
+      if(bytes > 0)
+      {
+        const __mmask64 m = (__mmask64) -1 >> (64 - bytes);
+        _mm512_mask_storeu_epi8(out, m, _mm512_add_epi8(_mm512_maskz_loadu_epi8(m, a), _mm512_maskz_loadu_epi8(m, b)));
+      }
+    }
+    LLFIO_COMBINE_TARGET_AVX512 inline size_t combine_compare_avx512(const byte *a, const byte *b, size_t bytes) noexcept
+    {
+      size_t idx = 0;
+      while(idx < bytes)
+      {
+        const size_t remaining = bytes - idx;
+        const __mmask64 m = (remaining >= 64) ? (__mmask64) -1 : ((__mmask64) -1 >> (64 - remaining));
+        const __mmask64 ne = _mm512_mask_cmpneq_epi8_mask(m, _mm512_maskz_loadu_epi8(m, a + idx), _mm512_maskz_loadu_epi8(m, b + idx));
+        if(ne != 0)
+        {
+          for(size_t n = 0; n < 64; n++)
+          {
+            if((ne >> n) & 1)
+            {
+              return idx + n;
+            }
+          }
+        }
+        idx += (remaining >= 64) ? 64 : remaining;
+      }
+      return bytes;
+    }
+#endif
+
+#ifdef LLFIO_COMBINE_NEON
+    inline void combine_xor_neon(byte *out, const byte *a, const byte *b, size_t bytes) noexcept
+    {
+      for(; bytes >= 16; out += 16, a += 16, b += 16, bytes -= 16)
+      {
+        vst1q_u8((uint8_t *) out, veorq_u8(vld1q_u8((const uint8_t *) a), vld1q_u8((const uint8_t *) b)));
+      }
+      combine_xor_scalar(out, a, b, bytes);
+    }
+    inline void combine_add_neon(byte *out, const byte *a, const byte *b, size_t bytes) noexcept
+    {
+      for(; bytes >= 16; out += 16, a += 16, b += 16, bytes -= 16)
+      {
+        vst1q_u8((uint8_t *) out, vaddq_u8(vld1q_u8((const uint8_t *) a), vld1q_u8((const uint8_t *) b)));
+      }
+      combine_add_scalar(out, a, b, bytes);
+    }
+#ifdef __aarch64__
+    inline size_t combine_compare_neon(const byte *a, const byte *b, size_t bytes) noexcept
+    {
+      size_t idx = 0;
+      for(; bytes - idx >= 16; idx += 16)
+      {
+        if(vminvq_u8(vceqq_u8(vld1q_u8((const uint8_t *) (a + idx)), vld1q_u8((const uint8_t *) (b + idx)))) != 0xff)
+        {
+          return idx + combine_compare_scalar(a + idx, b + idx, 16);
+        }
+      }
+      return idx + combine_compare_scalar(a + idx, b + idx, bytes - idx);
+    }
+#else
+    inline size_t combine_compare_neon(const byte *a, const byte *b, size_t bytes) noexcept { return combine_compare_scalar(a, b, bytes); }
+#endif
+#endif
+
+    struct combine_kernels_t
+    {
+      void (*xor_)(byte *out, const byte *a, const byte *b, size_t bytes);
+      void (*add)(byte *out, const byte *a, const byte *b, size_t bytes);
+      size_t (*compare)(const byte *a, const byte *b, size_t bytes);
+      const char *name;
+    };
+    inline const combine_kernels_t &combine_kernels() noexcept
+    {
+      static const combine_kernels_t v = []() -> combine_kernels_t {
+#ifdef LLFIO_COMBINE_X86
+        const auto &features = LLFIO_V2_NAMESPACE::detail::cpu_features();
+        if(features.avx512f && features.avx512bw)
+        {
+          return {combine_xor_avx512, combine_add_avx512, combine_compare_avx512, "avx512"};
+        }
+        if(features.avx2)
+        {
+          return {combine_xor_avx2, combine_add_avx2, combine_compare_avx2, "avx2"};
+        }
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        return {combine_xor_sse2, combine_add_sse2, combine_compare_sse2, "sse2"};
+#else
+        return {combine_xor_scalar, combine_add_scalar, combine_compare_scalar, "scalar"};
+#endif
+#elif defined(LLFIO_COMBINE_NEON)
+        return {combine_xor_neon, combine_add_neon, combine_compare_neon, "neon"};
+#else
+        return {combine_xor_scalar, combine_add_scalar, combine_compare_scalar, "scalar"};
+#endif
+      }();
+      return v;
+    }
+  }  // namespace detail
+
+  LLFIO_HEADERS_ONLY_FUNC_SPEC void combine_xor(byte *out, const byte *a, const byte *b, size_t bytes) noexcept
+  {
+    detail::combine_kernels().xor_(out, a, b, bytes);
+  }
+  LLFIO_HEADERS_ONLY_FUNC_SPEC void combine_add(byte *out, const byte *a, const byte *b, size_t bytes) noexcept
+  {
+    detail::combine_kernels().add(out, a, b, bytes);
+  }
+  LLFIO_HEADERS_ONLY_FUNC_SPEC size_t combine_compare(const byte *a, const byte *b, size_t bytes) noexcept
+  {
+    return detail::combine_kernels().compare(a, b, bytes);
+  }
+  LLFIO_HEADERS_ONLY_FUNC_SPEC const char *combine_kernels_implementation() noexcept { return detail::combine_kernels().name; }
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
+
+#undef LLFIO_COMBINE_X86
+#undef LLFIO_COMBINE_NEON
+#undef LLFIO_COMBINE_TARGET_SSE2
+#undef LLFIO_COMBINE_TARGET_AVX2
+#undef LLFIO_COMBINE_TARGET_AVX512
@@ -0,0 +1,316 @@
+/* A handle adapter storing fixed size blocks compressed in a backing file
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#include "../../algorithm/handle_adapter/compressed.hpp"
+#ifndef LLFIO_EXCLUDE_DYNAMIC_THREAD_POOL_GROUP
+#include "../../dynamic_thread_pool_group.hpp"
+#endif
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+LLFIO_V2_NAMESPACE_BEGIN
+
+namespace algorithm
+{
+  namespace detail
+  {
+    /* A byte oriented LZ77 in the style of LZ4. Each sequence is a token whose high nibble is
+    the count of literals and whose low nibble is the match length less four, either being
+    extended by bytes of 255 and a final byte less than 255 if fifteen. Then come the literals,
+    then a little endian 16 bit offset back to the match. The last sequence is only literals.
+    */
+    class lz_block_codec_impl final : public block_codec
+    {
+      static constexpr unsigned _hash_bits = 12;
+      static constexpr size_t _min_match = 4;
+
+      static uint32_t _read32(const byte *p) noexcept
+      {
+        uint32_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+      }
+
+    public:
+      virtual const char *name() const noexcept override { return "lz"; }
+
+      virtual size_t compress(span<byte> dest, span<const byte> src) const noexcept override
+      {
+        uint32_t table[1U << _hash_bits];
+        memset(table, 0, sizeof(table));
+        const byte *const in = src.data();
+        const size_t inlen = src.size();
+        byte *op = dest.data(), *const oend = dest.data() + dest.size();
+        size_t ip = 0, anchor = 0;
+        auto emit_length = [&](size_t n) -> bool {
+          for(n -= 15; n >= 255; n -= 255)
+          {
+            if(op == oend)
+            {
+              return false;
+            }
+            *op++ = (byte) 255;
+          }
+          if(op == oend)
+          {
+            return false;
+          }
+          *op++ = (byte) n;
+          return true;
+        };
+        // A match length of zero means the final sequence of only literals
+        auto emit = [&](size_t literals, size_t offset, size_t match) -> bool {
+          if(op == oend)
+          {
+            return false;
+          }
+          byte *token = op++;
+          *token = (byte) ((std::min(literals, (size_t) 15) << 4) | ((match != 0) ? std::min(match - _min_match, (size_t) 15) : 0));
+          if(literals >= 15 && !emit_length(literals))
+          {
+            return false;
+          }
+          if((size_t) (oend - op) < literals)
+          {
+            return false;
+          }
+          if(literals > 0)
+          {
+            memcpy(op, in + anchor, literals);
+            op += literals;
+          }
+          if(match != 0)
+          {
+            if(oend - op < 2)
+            {
+              return false;
+            }
+            *op++ = (byte) (offset & 0xff);
+            *op++ = (byte) (offset >> 8);
+            if(match - _min_match >= 15 && !emit_length(match - _min_match))
+            {
+              return false;
+            }
+          }
+          return true;
+        };
+        while(inlen >= _min_match && ip <= inlen - _min_match)
+        {
+          const uint32_t seq = _read32(in + ip);
+          const uint32_t hash = (seq * 2654435761U) >> (32 - _hash_bits);
+          const size_t ref = table[hash];
+          table[hash] = (uint32_t) ip;
+          if(ref < ip && ip - ref <= 65535 && _read32(in + ref) == seq)
+          {
+            size_t match = _min_match;
+            while(ip + match < inlen && in[ref + match] == in[ip + match])
+            {
+              match++;
+            }
+            if(!emit(ip - anchor, ip - ref, match))
+            {
+              return 0;
+            }
+            ip += match;
+            anchor = ip;
+          }
+          else
+          {
+            // Skip ever faster through data which isn't compressing
+            ip += 1 + ((ip - anchor) >> 6);
+          }
+        }
+        if(!emit(inlen - anchor, 0, 0))
+        {
+          return 0;
+        }
+        return (size_t) (op - dest.data());
+      }
+
+      virtual result<size_t> decompress(span<byte> dest, span<const byte> src) const noexcept override
+      {
+        const byte *ip = src.data(), *const iend = src.data() + src.size();
+        byte *op = dest.data(), *const oend = dest.data() + dest.size();
+        auto read_length = [&](size_t &n) -> bool {
+          for(;;)
+          {
+            if(ip == iend)
+            {
+              return false;
+            }
+            const auto v = (size_t) (uint8_t) *ip++;
+            n += v;
+            if(v != 255)
+            {
+              return true;
+            }
+          }
+        };
+        while(ip < iend)
+        {
+          const auto token = (size_t) (uint8_t) *ip++;
+          size_t literals = token >> 4;
+          if(literals == 15 && !read_length(literals))
+          {
+            return errc::illegal_byte_sequence;
+          }
+          if((size_t) (iend - ip) < literals || (size_t) (oend - op) < literals)
+          {
+            return errc::illegal_byte_sequence;
+          }
+          memcpy(op, ip, literals);
+          ip += literals;
+          op += literals;
+          if(ip == iend)
+          {
+            break;
+          }
+          if(iend - ip < 2)
+          {
+            return errc::illegal_byte_sequence;
+          }
+          const size_t offset = (size_t) (uint8_t) ip[0] | ((size_t) (uint8_t) ip[1] << 8);
+          ip += 2;
+          size_t match = token & 15;
+          if(match == 15 && !read_length(match))
+          {
+            return errc::illegal_byte_sequence;
+          }
+          match += _min_match;
+          if(offset == 0 || offset > (size_t) (op - dest.data()) || (size_t) (oend - op) < match)
+          {
+            return errc::illegal_byte_sequence;
+          }
+          const byte *ref = op - offset;
+          if(offset >= match)
+          {
+            memcpy(op, ref, match);
+            op += match;
+          }
+          else
+          {
+            // Overlapping matches repeat the bytes just written
+            for(size_t n = 0; n < match; n++)
+            {
+              *op++ = ref[n];
+            }
+          }
+        }
+        return (size_t) (op - dest.data());
+      }
+    };
+
+    LLFIO_HEADERS_ONLY_FUNC_SPEC result<void> compressed_for_each_block(size_t count, size_t scratchbytes, bool parallel,
+                                                                        result<void> (*f)(void *ctx, size_t n, byte *scratch), void *ctx) noexcept
+    {
+      try
+      {
+#ifndef LLFIO_EXCLUDE_DYNAMIC_THREAD_POOL_GROUP
+        if(parallel && count > 1)
+        {
+          struct state_type
+          {
+            result<void> (*f)(void *ctx, size_t n, byte *scratch);
+            void *ctx;
+            size_t count;
+            std::atomic<size_t> nextblock{0};
+            std::mutex lock;
+            optional<result<void>::error_type> failure;
+          } state;
+          state.f = f;
+          state.ctx = ctx;
+          state.count = count;
+          struct worker final : public dynamic_thread_pool_group::work_item
+          {
+            state_type *state{nullptr};
+            map_handle scratch;
+
+            virtual intptr_t next(deadline & /*unused*/) noexcept override
+            {
+              const size_t n = state->nextblock.fetch_add(1, std::memory_order_relaxed);
+              return (n < state->count) ? (intptr_t) n + 1 : -1;
+            }
+            virtual result<void> operator()(intptr_t work) noexcept override
+            {
+              auto r = state->f(state->ctx, (size_t) work - 1, scratch.address());
+              if(!r)
+              {
+                std::lock_guard<std::mutex> g(state->lock);
+                if(!state->failure)
+                {
+                  state->failure = std::move(r).error();
+                }
+                // Cancel all remaining work
+                return errc::operation_canceled;
+              }
+              return success();
+            }
+          };
+          const size_t concurrency = std::min(count, std::max((size_t) std::thread::hardware_concurrency(), (size_t) 1));
+          std::vector<worker> workers(concurrency);
+          std::vector<dynamic_thread_pool_group::work_item *> items;
+          items.reserve(concurrency);
+          for(auto &i : workers)
+          {
+            i.state = &state;
+            OUTCOME_TRY(i.scratch, map_handle::map(scratchbytes));
+            items.push_back(&i);
+          }
+          OUTCOME_TRY(auto &&group, make_dynamic_thread_pool_group());
+          OUTCOME_TRY(group->submit(items));
+          (void) group->wait();
+          if(state.failure)
+          {
+            return std::move(*state.failure);
+          }
+          return success();
+        }
+#else
+        (void) parallel;
+#endif
+        OUTCOME_TRY(auto &&scratch, map_handle::map(scratchbytes));
+        for(size_t n = 0; n < count; n++)
+        {
+          OUTCOME_TRY(f(ctx, n, scratch.address()));
+        }
+        return success();
+      }
+      catch(...)
+      {
+        return error_from_exception();
+      }
+    }
+  }  // namespace detail
+
+  LLFIO_HEADERS_ONLY_FUNC_SPEC const block_codec &lz_block_codec() noexcept
+  {
+    static const detail::lz_block_codec_impl codec;
+    return codec;
+  }
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
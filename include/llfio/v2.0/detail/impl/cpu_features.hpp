@@ -0,0 +1,100 @@
+/* Runtime detection of CPU features for choosing SIMD kernels
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#ifndef LLFIO_CPU_FEATURES_HPP
+#define LLFIO_CPU_FEATURES_HPP
+
+#include "../../config.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>  // for __cpuid
+#endif
+#endif
+
+LLFIO_V2_NAMESPACE_BEGIN
+
+namespace detail
+{
+  // The features which the SIMD kernels are interested in. The AVX ones are only set if the OS saves their state.
+  struct cpu_features_t
+  {
+    bool sse2{false}, ssse3{false}, sse42{false}, pclmul{false}, avx2{false}, avx512f{false}, avx512bw{false};
+  };
+  /* For testing, if this is set then `cpu_features()` returns it instead of the features
+  detected, so kernels can be selected as if the CPU lacked the others. Selections cached
+  beforehand are unaffected. Never set features which the CPU does not have.
+  */
+  inline const cpu_features_t *&cpu_features_override() noexcept
+  {
+    static const cpu_features_t *v = nullptr;
+    return v;
+  }
+  inline const cpu_features_t &cpu_features() noexcept
+  {
+    if(cpu_features_override() != nullptr)
+    {
+      return *cpu_features_override();
+    }
+    static const cpu_features_t v = []() -> cpu_features_t {
+      cpu_features_t ret;
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#if defined(_MSC_VER) && !defined(__clang__)
+      int info[4];
+      __cpuid(info, 0);
+      const int maxleaf = info[0];
+      __cpuid(info, 1);
+      ret.sse2 = ((info[3] >> 26) & 1) != 0;
+      ret.ssse3 = ((info[2] >> 9) & 1) != 0;
+      ret.sse42 = ((info[2] >> 20) & 1) != 0;
+      ret.pclmul = ((info[2] >> 1) & 1) != 0;
+      if(maxleaf >= 7 && ((info[2] >> 27) & 1) != 0)
+      {
+        const auto xcr0 = _xgetbv(0);
+        __cpuidex(info, 7, 0);
+        ret.avx2 = ((info[1] >> 5) & 1) != 0 && (xcr0 & 6) == 6;
+        ret.avx512f = ((info[1] >> 16) & 1) != 0 && (xcr0 & 0xe6) == 0xe6;
+        ret.avx512bw = ret.avx512f && ((info[1] >> 30) & 1) != 0;
+      }
+#else
+      __builtin_cpu_init();
+      ret.sse2 = __builtin_cpu_supports("sse2") != 0;
+      ret.ssse3 = __builtin_cpu_supports("ssse3") != 0;
+      ret.sse42 = __builtin_cpu_supports("sse4.2") != 0;
+      ret.pclmul = __builtin_cpu_supports("pclmul") != 0;
+      ret.avx2 = __builtin_cpu_supports("avx2") != 0;
+      ret.avx512f = __builtin_cpu_supports("avx512f") != 0;
+      ret.avx512bw = ret.avx512f && __builtin_cpu_supports("avx512bw") != 0;
+#endif
+#endif
+      return ret;
+    }();
+    return v;
+  }
+}  // namespace detail
+
+LLFIO_V2_NAMESPACE_END
+
+#endif
@@ -0,0 +1,397 @@
+/* A filesystem algorithm which deduplicates the content of a directory tree
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#include "../../algorithm/deduplicate.hpp"
+
+#include "parallel_for_each.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef __linux__
+#include <sys/ioctl.h>
+#endif
+
+LLFIO_V2_NAMESPACE_BEGIN
+
+namespace algorithm
+{
+  LLFIO_HEADERS_ONLY_FUNC_SPEC result<file_handle::extent_type> deduplicate_extents(file_handle &src, file_handle::extent_pair extent, file_handle &dest,
+                                                                                    file_handle::extent_type destoffset) noexcept
+  {
+    LLFIO_LOG_FUNCTION_CALL(&src);
+#ifdef __linux__
+    struct file_dedupe_range_t
+    {
+      uint64_t src_offset;
+      uint64_t src_length;
+      uint16_t dest_count;
+      uint16_t reserved1;
+      uint32_t reserved2;
+    };
+    struct file_dedupe_range_info_t
+    {
+      int64_t dest_fd;
+      uint64_t dest_offset;
+      uint64_t bytes_deduped;
+      int32_t status;
+      uint32_t reserved;
+    };
+    // Some filing systems refuse to deduplicate more than 16Mb per call
+    static constexpr file_handle::extent_type max_step = 16 * 1024 * 1024;
+    file_handle::extent_type done = 0;
+    while(done < extent.length)
+    {
+      struct
+      {
+        file_dedupe_range_t range;
+        file_dedupe_range_info_t info;
+      } fdr;
+      memset(&fdr, 0, sizeof(fdr));
+      fdr.range.src_offset = extent.offset + done;
+      fdr.range.src_length = std::min(extent.length - done, max_step);
+      fdr.range.dest_count = 1;
+      fdr.info.dest_fd = dest.native_handle().fd;
+      fdr.info.dest_offset = destoffset + done;
+      if(-1 == ::ioctl(src.native_handle().fd, _IOWR(0x94, 54, file_dedupe_range_t) /*FIDEDUPERANGE*/, &fdr))
+      {
+        if(ENOTTY == errno)
+        {
+          return errc::operation_not_supported;
+        }
+        return posix_error();
+      }
+      if(fdr.info.status < 0)
+      {
+        return posix_error(-fdr.info.status);
+      }
+      if(fdr.info.status > 0 /*FILE_DEDUPE_RANGE_DIFFERS*/ || fdr.info.bytes_deduped == 0)
+      {
+        break;
+      }
+      done += fdr.info.bytes_deduped;
+    }
+    return done;
+#else
+    (void) src;
+    (void) extent;
+    (void) dest;
+    (void) destoffset;
+    return errc::operation_not_supported;
+#endif
+  }
+
+  namespace detail
+  {
+    struct deduplicate_candidate
+    {
+      size_t file;  // index into the files
+      uint64_t st_dev, st_ino, st_size;
+      bool fully_hashed;
+      tree_digest_hash partial, full;
+    };
+
+    // Whether two files share all of their storage
+    inline bool deduplicate_already_shared(const std::vector<file_handle::extent_info> &a, const std::vector<file_handle::extent_info> &b) noexcept
+    {
+      if(a.empty() || a.size() != b.size())
+      {
+        return false;
+      }
+      for(size_t n = 0; n < a.size(); n++)
+      {
+        if((a[n].flags & file_handle::extent_flag::unknown_location) || a[n].offset != b[n].offset || a[n].length != b[n].length ||
+           a[n].physical != b[n].physical)
+        {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    inline result<deduplicate_result> deduplicate(const path_handle &dirh, const deduplicate_config &config)
+    {
+      if(config.chunk_size == 0 || config.partial_hash_bytes == 0)
+      {
+        return errc::invalid_argument;
+      }
+      deduplicate_result ret;
+      contents_visitor visitor(stat_t::want::type | stat_t::want::dev | stat_t::want::ino | stat_t::want::size, true, false, false);
+      OUTCOME_TRY(auto &&entries, contents(dirh, &visitor, config.threads, config.force_slow_path));
+      if(!(entries.metadata & stat_t::want::type) || !(entries.metadata & stat_t::want::size))
+      {
+        return errc::operation_not_supported;
+      }
+      const bool have_inodes = (entries.metadata & stat_t::want::dev) && (entries.metadata & stat_t::want::ino);
+      std::vector<std::pair<filesystem::path, tree_digest_record>> files;
+      std::vector<deduplicate_candidate> candidates;
+      for(auto &entry : entries)
+      {
+        if(entry.second.st_type == filesystem::file_type::regular && entry.second.st_size > 0 && entry.second.st_size >= config.minimum_size)
+        {
+          tree_digest_record record;
+          record.st_ino = entry.second.st_ino;
+          record.st_size = entry.second.st_size;
+          files.emplace_back(std::move(entry.first), record);
+          candidates.push_back({files.size() - 1, have_inodes ? entry.second.st_dev : 0, have_inodes ? entry.second.st_ino : 0, entry.second.st_size,
+                                false, {}, {}});
+        }
+      }
+      entries.clear();
+      entries.shrink_to_fit();
+      auto path_less = [&](const deduplicate_candidate &a, const deduplicate_candidate &b) {
+        return files[a.file].first.native() < files[b.file].first.native();
+      };
+      if(have_inodes)
+      {
+        // Hard links to the same inode already share storage, so keep only the first
+        std::sort(candidates.begin(), candidates.end(), [&](const deduplicate_candidate &a, const deduplicate_candidate &b) {
+          return (a.st_dev != b.st_dev) ? (a.st_dev < b.st_dev) : (a.st_ino != b.st_ino) ? (a.st_ino < b.st_ino) : path_less(a, b);
+        });
+        candidates.erase(std::unique(candidates.begin(), candidates.end(),
+                                     [](const deduplicate_candidate &a, const deduplicate_candidate &b) { return a.st_dev == b.st_dev && a.st_ino == b.st_ino; }),
+                         candidates.end());
+      }
+      // Sort by less, then remove all candidates which are not equal to another
+      auto keep_groups = [&](auto less, auto equal) {
+        std::sort(candidates.begin(), candidates.end(), less);
+        size_t kept = 0;
+        for(size_t n = 0; n < candidates.size();)
+        {
+          size_t m = n + 1;
+          while(m < candidates.size() && equal(candidates[n], candidates[m]))
+          {
+            m++;
+          }
+          if(m - n >= 2)
+          {
+            for(; n < m; n++)
+            {
+              candidates[kept++] = candidates[n];
+            }
+          }
+          n = m;
+        }
+        candidates.erase(candidates.begin() + kept, candidates.end());
+      };
+      auto same_size = [](const deduplicate_candidate &a, const deduplicate_candidate &b) { return a.st_dev == b.st_dev && a.st_size == b.st_size; };
+      auto same_partial = [&](const deduplicate_candidate &a, const deduplicate_candidate &b) {
+        return same_size(a, b) && tree_digest_equal(a.partial, b.partial);
+      };
+      auto same_full = [&](const deduplicate_candidate &a, const deduplicate_candidate &b) { return same_size(a, b) && tree_digest_equal(a.full, b.full); };
+      // Hash the candidates, dropping any which have disappeared
+      auto hash = [&](bool partial) -> result<void> {
+        std::vector<tree_digest_chunk> chunks;
+        std::vector<size_t> chunk_counts(candidates.size(), 0);
+        for(size_t n = 0; n < candidates.size(); n++)
+        {
+          auto &candidate = candidates[n];
+          if(partial && candidate.st_size <= 2 * config.partial_hash_bytes)
+          {
+            candidate.fully_hashed = true;
+            chunks.push_back({candidate.file, 0, (size_t) candidate.st_size, false, {}});
+            chunk_counts[n]++;
+          }
+          else if(partial)
+          {
+            chunks.push_back({candidate.file, 0, config.partial_hash_bytes, false, {}});
+            chunks.push_back({candidate.file, candidate.st_size - config.partial_hash_bytes, config.partial_hash_bytes, false, {}});
+            chunk_counts[n] += 2;
+          }
+          else if(!candidate.fully_hashed)
+          {
+            for(uint64_t offset = 0; offset < candidate.st_size; offset += config.chunk_size)
+            {
+              chunks.push_back({candidate.file, offset, (size_t) std::min((uint64_t) config.chunk_size, candidate.st_size - offset), false, {}});
+              chunk_counts[n]++;
+            }
+          }
+        }
+        for(auto &chunk : chunks)
+        {
+          ret.bytes_hashed += chunk.length;
+        }
+        OUTCOME_TRY(tree_digest_hash_chunks(dirh, files, chunks, config.threads));
+        std::vector<tree_digest_hash> hashes;
+        size_t kept = 0;
+        for(size_t n = 0, c = 0; n < candidates.size(); n++)
+        {
+          auto &candidate = candidates[n];
+          bool failed = false;
+          hashes.clear();
+          for(size_t i = 0; i < chunk_counts[n]; i++, c++)
+          {
+            failed |= chunks[c].failed;
+            hashes.push_back(chunks[c].hash);
+          }
+          if(failed)
+          {
+            ret.files_failed++;
+            continue;
+          }
+          if(chunk_counts[n] > 0)
+          {
+            auto h = tree_digest_hash_bytes(hashes.data(), hashes.size() * sizeof(tree_digest_hash));
+            (partial ? candidate.partial : candidate.full) = h;
+          }
+          if(candidate.fully_hashed)
+          {
+            candidate.full = candidate.partial;
+          }
+          candidates[kept++] = candidate;
+        }
+        candidates.erase(candidates.begin() + kept, candidates.end());
+        return success();
+      };
+      keep_groups(
+      [](const deduplicate_candidate &a, const deduplicate_candidate &b) { return (a.st_dev != b.st_dev) ? (a.st_dev < b.st_dev) : (a.st_size < b.st_size); },
+      same_size);
+      OUTCOME_TRY(hash(true));
+      keep_groups(
+      [&](const deduplicate_candidate &a, const deduplicate_candidate &b) {
+        return !same_size(a, b) ? ((a.st_dev != b.st_dev) ? (a.st_dev < b.st_dev) : (a.st_size < b.st_size)) : tree_digest_less(a.partial, b.partial);
+      },
+      same_partial);
+      OUTCOME_TRY(hash(false));
+      auto full_less = [&](const deduplicate_candidate &a, const deduplicate_candidate &b) {
+        return !same_size(a, b)                         ? ((a.st_dev != b.st_dev) ? (a.st_dev < b.st_dev) : (a.st_size < b.st_size)) :
+               !tree_digest_equal(a.full, b.full) ? tree_digest_less(a.full, b.full) :
+                                                        path_less(a, b);
+      };
+      keep_groups(full_less, same_full);
+
+      // Each run of identical candidates, sorted by path, is a group of duplicates
+      std::vector<std::pair<size_t, size_t>> groups;
+      for(size_t n = 0; n < candidates.size();)
+      {
+        size_t m = n + 1;
+        while(m < candidates.size() && same_full(candidates[n], candidates[m]))
+        {
+          m++;
+        }
+        groups.emplace_back(n, m);
+        ret.duplicates.emplace_back();
+        for(size_t i = n; i < m; i++)
+        {
+          ret.duplicates.back().push_back(files[candidates[i].file].first);
+        }
+        n = m;
+      }
+      if(config.dry_run)
+      {
+        return {std::move(ret)};
+      }
+
+      struct outcome_type
+      {
+        size_t deduplicated{0}, already_shared{0}, failed{0};
+        file_handle::extent_type bytes{0};
+      };
+      std::vector<outcome_type> outcomes(groups.size());
+      auto deduplicate_group = [&](size_t g) -> result<void> {
+        auto &outcome = outcomes[g];
+        const auto &first = candidates[groups[g].first];
+        auto _src = file_handle::file(dirh, files[first.file].first);
+        if(!_src)
+        {
+          outcome.failed += groups[g].second - groups[g].first - 1;
+          return success();
+        }
+        auto &src = _src.value();
+        auto src_extents = src.detailed_extents();
+        for(size_t n = groups[g].first + 1; n < groups[g].second; n++)
+        {
+          const auto &path = files[candidates[n].file].first;
+          auto _dest = file_handle::file(dirh, path, file_handle::mode::write);
+          if(!_dest && _dest.error() == errc::permission_denied)
+          {
+            // Recent kernels permit deduplicating into files we own but cannot write
+            _dest = file_handle::file(dirh, path);
+          }
+          if(!_dest)
+          {
+            outcome.failed++;
+            continue;
+          }
+          auto &dest = _dest.value();
+          if(src_extents)
+          {
+            auto dest_extents = dest.detailed_extents();
+            if(dest_extents && deduplicate_already_shared(src_extents.value(), dest_extents.value()))
+            {
+              outcome.already_shared++;
+              continue;
+            }
+          }
+          auto deduplicated = deduplicate_extents(src, {0, first.st_size}, dest, 0);
+          if(!deduplicated)
+          {
+            if(deduplicated.error() == errc::operation_not_supported)
+            {
+              return std::move(deduplicated).error();
+            }
+            outcome.failed++;
+            continue;
+          }
+          outcome.bytes += deduplicated.value();
+          if(deduplicated.value() == first.st_size)
+          {
+            outcome.deduplicated++;
+          }
+          else
+          {
+            // Changed since it was hashed
+            outcome.failed++;
+          }
+        }
+        return success();
+      };
+      OUTCOME_TRY(parallel_for_each(groups.size(), config.threads, deduplicate_group));
+      for(auto &outcome : outcomes)
+      {
+        ret.files_deduplicated += outcome.deduplicated;
+        ret.files_already_shared += outcome.already_shared;
+        ret.files_failed += outcome.failed;
+        ret.bytes_deduplicated += outcome.bytes;
+      }
+      return {std::move(ret)};
+    }
+  }  // namespace detail
+
+  LLFIO_HEADERS_ONLY_FUNC_SPEC result<deduplicate_result> deduplicate(const path_handle &dirh, const deduplicate_config &config) noexcept
+  {
+    LLFIO_LOG_FUNCTION_CALL(&dirh);
+    try
+    {
+      return detail::deduplicate(dirh, config);
+    }
+    catch(...)
+    {
+      return error_from_exception();
+    }
+  }
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
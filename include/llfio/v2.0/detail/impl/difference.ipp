@@ -0,0 +1,309 @@
+/* A filesystem algorithm which generates the difference between two directory trees
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#include "../../algorithm/difference.hpp"
+#include "../../algorithm/handle_adapter/combining.hpp"
+#include "../../mapped_file_handle.hpp"
+
+#include "parallel_for_each.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+LLFIO_V2_NAMESPACE_BEGIN
+
+namespace algorithm
+{
+  namespace detail
+  {
+    struct difference_content_pair
+    {
+      const filesystem::path *before, *after;
+      difference_item *item;
+    };
+
+    // memcmp() the content of a pair of files. Files which have disappeared compare as unknown.
+    inline result<optional<int8_t>> difference_compare_content(const path_handle &beforeh, const path_handle &afterh,
+                                                               const difference_content_pair &pair) noexcept
+    {
+      auto _a = mapped_file_handle::mapped_file(beforeh, *pair.before);
+      auto _b = mapped_file_handle::mapped_file(afterh, *pair.after);
+      if(!_a || !_b)
+      {
+        const auto &e = !_a ? _a.error() : _b.error();
+        if(e == errc::no_such_file_or_directory)
+        {
+          return optional<int8_t>();
+        }
+        return e;
+      }
+      OUTCOME_TRY(auto &&asize, _a.value().maximum_extent());
+      OUTCOME_TRY(auto &&bsize, _b.value().maximum_extent());
+      const auto tocompare = (size_t) std::min(asize, bsize);
+      if(tocompare > 0)
+      {
+        const byte *a = _a.value().address(), *b = _b.value().address();
+        const size_t idx = combine_compare(a, b, tocompare);
+        if(idx < tocompare)
+        {
+          return optional<int8_t>(((uint8_t) a[idx] < (uint8_t) b[idx]) ? -1 : 1);
+        }
+      }
+      return optional<int8_t>((asize < bsize) ? -1 : (asize > bsize) ? 1 : 0);
+    }
+
+    // Compare the content of all the pairs, in parallel if possible
+    inline result<void> difference_compare_contents(const path_handle &beforeh, const path_handle &afterh, std::vector<difference_content_pair> &pairs,
+                                                    size_t threads) noexcept
+    {
+      auto compare = [&](size_t n) -> result<void> {
+        auto &pair = pairs[n];
+        OUTCOME_TRY(auto &&comparison, difference_compare_content(beforeh, afterh, pair));
+        if(comparison)
+        {
+          pair.item->content_comparison = *comparison;
+          if(pair.item->changed == difference_item::unknown && *comparison != 0)
+          {
+            pair.item->changed = difference_item::content_changed;
+          }
+        }
+        return success();
+      };
+      return parallel_for_each(pairs.size(), threads, compare);
+    }
+
+    // Identifies an inode across devices
+    struct difference_inode
+    {
+      uint64_t st_dev, st_ino;
+
+      bool operator==(const difference_inode &o) const noexcept { return st_dev == o.st_dev && st_ino == o.st_ino; }
+    };
+    struct difference_inode_hasher
+    {
+      size_t operator()(const difference_inode &v) const noexcept { return (size_t) (v.st_ino ^ (v.st_dev * 0x9E3779B97F4A7C15ULL)); }
+    };
+  }  // namespace detail
+
+  LLFIO_HEADERS_ONLY_FUNC_SPEC result<std::vector<difference_item>> difference(const path_handle &before, const path_handle &after, bool compare_content,
+                                                                               compare_visitor *visitor, size_t threads, bool force_slow_path) noexcept
+  {
+    LLFIO_LOG_FUNCTION_CALL(&before);
+    try
+    {
+      compare_visitor default_visitor;
+      if(visitor == nullptr)
+      {
+        visitor = &default_visitor;
+      }
+      // contents() keeps per thread state, so the trees must be enumerated one after the other
+      OUTCOME_TRY(auto &&a, contents(before, visitor, threads, force_slow_path));
+      OUTCOME_TRY(auto &&b, contents(after, visitor, threads, force_slow_path));
+      const stat_t::want metadata = a.metadata & b.metadata;
+      if(!(metadata & stat_t::want::type))
+      {
+        return errc::invalid_argument;
+      }
+      auto bypath = [](const std::pair<filesystem::path, stat_t> &x, const std::pair<filesystem::path, stat_t> &y) { return x.first.native() < y.first.native(); };
+      std::sort(a.begin(), a.end(), bypath);
+      std::sort(b.begin(), b.end(), bypath);
+
+      std::vector<difference_item> ret;
+      std::vector<size_t> removed, added;  // indices into a and b
+      // Match the two trees by path
+      for(size_t i = 0, j = 0; i < a.size() || j < b.size();)
+      {
+        if(j == b.size() || (i < a.size() && a[i].first.native() < b[j].first.native()))
+        {
+          removed.push_back(i++);
+          continue;
+        }
+        if(i == a.size() || b[j].first.native() < a[i].first.native())
+        {
+          added.push_back(j++);
+          continue;
+        }
+        const stat_t &sa = a[i].second, &sb = b[j].second;
+        if(sa.st_type != sb.st_type)
+        {
+          removed.push_back(i++);
+          added.push_back(j++);
+          continue;
+        }
+        difference_item item;
+        item.path = b[j].first;
+        item.before = sa;
+        item.after = sb;
+        if(sa.st_type != filesystem::file_type::directory && (((metadata & stat_t::want::size) && sa.st_size != sb.st_size) ||
+                                                              ((metadata & stat_t::want::mtim) && sa.st_mtim != sb.st_mtim)))
+        {
+          item.changed = difference_item::content_metadata_changed;
+        }
+        else if(((metadata & stat_t::want::perms) && sa.st_perms != sb.st_perms) || ((metadata & stat_t::want::uid) && sa.st_uid != sb.st_uid) ||
+                ((metadata & stat_t::want::gid) && sa.st_gid != sb.st_gid))
+        {
+          item.changed = difference_item::noncontent_metadata_changed;
+        }
+        if(item.changed != difference_item::unknown || (compare_content && sa.st_type == filesystem::file_type::regular))
+        {
+          ret.push_back(std::move(item));
+        }
+        i++;
+        j++;
+      }
+
+      // Match what remains by inode
+      std::vector<char> before_matched(a.size(), 0), after_matched(b.size(), 0);
+      if(metadata & stat_t::want::ino)
+      {
+        auto inode = [&](const stat_t &s) { return detail::difference_inode{(metadata & stat_t::want::dev) ? s.st_dev : 0, s.st_ino}; };
+        std::unordered_map<detail::difference_inode, size_t, detail::difference_inode_hasher> removed_inodes, all_inodes;
+        removed_inodes.reserve(removed.size());
+        all_inodes.reserve(a.size());
+        for(auto i : removed)
+        {
+          removed_inodes.emplace(inode(a[i].second), i);
+        }
+        for(size_t i = 0; i < a.size(); i++)
+        {
+          all_inodes.emplace(inode(a[i].second), i);
+        }
+        std::unordered_map<filesystem::path::string_type, filesystem::path> renamed_directories;  // new path => old path
+        for(auto j : added)
+        {
+          const stat_t &sb = b[j].second;
+          if(sb.st_type == filesystem::file_type::symlink)
+          {
+            continue;
+          }
+          auto it = removed_inodes.find(inode(sb));
+          if(it != removed_inodes.end() && a[it->second].second.st_type == sb.st_type)
+          {
+            const size_t i = it->second;
+            removed_inodes.erase(it);
+            before_matched[i] = 1;
+            after_matched[j] = 1;
+            const stat_t &sa = a[i].second;
+            // Was this renamed only because its parent directory was?
+            auto pit = renamed_directories.find(b[j].first.parent_path().native());
+            const bool implied = (pit != renamed_directories.end() && pit->second / b[j].first.filename() == a[i].first);
+            if(sb.st_type == filesystem::file_type::directory)
+            {
+              renamed_directories.emplace(b[j].first.native(), a[i].first);
+            }
+            if(!implied)
+            {
+              difference_item item;
+              item.changed = (sb.st_type == filesystem::file_type::directory) ? difference_item::directory_renamed : difference_item::file_renamed;
+              item.path = b[j].first;
+              item.previous_path = a[i].first;
+              item.before = sa;
+              item.after = sb;
+              ret.push_back(std::move(item));
+            }
+            const bool content_metadata_changed =
+            ((metadata & stat_t::want::size) && sa.st_size != sb.st_size) || ((metadata & stat_t::want::mtim) && sa.st_mtim != sb.st_mtim);
+            if(sb.st_type != filesystem::file_type::directory &&
+               (content_metadata_changed || (compare_content && sb.st_type == filesystem::file_type::regular)))
+            {
+              difference_item item;
+              item.changed = content_metadata_changed ? difference_item::content_metadata_changed : difference_item::unknown;
+              item.path = b[j].first;
+              item.previous_path = a[i].first;
+              item.before = sa;
+              item.after = sb;
+              ret.push_back(std::move(item));
+            }
+            continue;
+          }
+          if(sb.st_type != filesystem::file_type::directory)
+          {
+            it = all_inodes.find(inode(sb));
+            if(it != all_inodes.end() && before_matched[it->second] == 0 && a[it->second].second.st_type == sb.st_type)
+            {
+              difference_item item;
+              item.changed = difference_item::file_linked;
+              item.path = b[j].first;
+              item.previous_path = a[it->second].first;
+              item.after = sb;
+              ret.push_back(std::move(item));
+              after_matched[j] = 1;
+            }
+          }
+        }
+      }
+      auto kind = [](filesystem::file_type type, difference_item::change_t file, difference_item::change_t directory, difference_item::change_t symlink) {
+        return (type == filesystem::file_type::directory) ? directory : (type == filesystem::file_type::symlink) ? symlink : file;
+      };
+      for(auto i : removed)
+      {
+        if(before_matched[i] == 0)
+        {
+          difference_item item;
+          item.changed =
+          kind(a[i].second.st_type, difference_item::file_removed, difference_item::directory_removed, difference_item::symlink_removed);
+          item.path = a[i].first;
+          item.before = a[i].second;
+          ret.push_back(std::move(item));
+        }
+      }
+      for(auto j : added)
+      {
+        if(after_matched[j] == 0)
+        {
+          difference_item item;
+          item.changed = kind(b[j].second.st_type, difference_item::file_added, difference_item::directory_added, difference_item::symlink_added);
+          item.path = b[j].first;
+          item.after = b[j].second;
+          ret.push_back(std::move(item));
+        }
+      }
+
+      if(compare_content)
+      {
+        std::vector<detail::difference_content_pair> pairs;
+        for(auto &item : ret)
+        {
+          if(item.before.st_type == filesystem::file_type::regular && item.after.st_type == filesystem::file_type::regular &&
+             (item.changed == difference_item::unknown || item.changed == difference_item::content_metadata_changed ||
+              item.changed == difference_item::noncontent_metadata_changed))
+          {
+            pairs.push_back({item.previous_path.empty() ? &item.path : &item.previous_path, &item.path, &item});
+          }
+        }
+        OUTCOME_TRY(detail::difference_compare_contents(before, after, pairs, threads));
+      }
+      ret.erase(std::remove_if(ret.begin(), ret.end(), [](const difference_item &item) { return item.changed == difference_item::unknown; }), ret.end());
+      std::stable_sort(ret.begin(), ret.end(), [](const difference_item &x, const difference_item &y) { return x.path.native() < y.path.native(); });
+      return {std::move(ret)};
+    }
+    catch(...)
+    {
+      return error_from_exception();
+    }
+  }
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
@@ -0,0 +1,292 @@
+/* Galois field kernels for the erasure coding handle adapter
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#include "../../algorithm/handle_adapter/erasure_coded.hpp"
+#include "cpu_features.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define LLFIO_GF256_X86 1
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define LLFIO_GF256_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define LLFIO_GF256_TARGET_AVX2 __attribute__((target("avx2")))
+#define LLFIO_GF256_TARGET_AVX512 __attribute__((target("avx512f,avx512bw")))
+#else
+#define LLFIO_GF256_TARGET_SSSE3
+#define LLFIO_GF256_TARGET_AVX2
+#define LLFIO_GF256_TARGET_AVX512
+#endif
+#elif defined(__aarch64__) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define LLFIO_GF256_NEON 1
+#include <arm_neon.h>
+#endif
+
+LLFIO_V2_NAMESPACE_BEGIN
+
+namespace algorithm
+{
+  namespace detail
+  {
+    // Log and antilog tables for GF(2^8) with the polynomial x^8 + x^4 + x^3 + x^2 + 1 (0x11d)
+    struct gf256_tables_t
+    {
+      uint8_t exp[512];
+      uint8_t log[256];
+    };
+    inline const gf256_tables_t &gf256_tables() noexcept
+    {
+      static const gf256_tables_t v = []() -> gf256_tables_t {
+        gf256_tables_t ret;
+        unsigned x = 1;
+        for(unsigned n = 0; n < 255; n++)
+        {
+          ret.exp[n] = ret.exp[n + 255] = (uint8_t) x;
+          ret.log[x] = (uint8_t) n;
+          x <<= 1;
+          if(x & 0x100)
+          {
+            x ^= 0x11d;
+          }
+        }
+        ret.exp[510] = ret.exp[511] = 0;
+        ret.log[0] = 0;
+        return ret;
+      }();
+      return v;
+    }
+    // The products of c with every low nibble, and with every high nibble
+    inline void gf256_nibble_tables(uint8_t *lo, uint8_t *hi, uint8_t c) noexcept
+    {
+      for(unsigned n = 0; n < 16; n++)
+      {
+        lo[n] = gf256_mul(c, (uint8_t) n);
+        hi[n] = gf256_mul(c, (uint8_t) (n << 4));
+      }
+    }
+
+    // Scalar kernel, which also does the tails of the vector kernels
+    inline void gf256_mul_add_scalar(byte *out, const byte *in, uint8_t c, size_t bytes) noexcept
+    {
+      uint8_t lo[16], hi[16];
+      gf256_nibble_tables(lo, hi, c);
+      for(; bytes > 0; bytes--)
+      {
+        const auto x = (uint8_t) *in++;
+        *out = *out ^ (byte) (lo[x & 15] ^ hi[x >> 4]);
+        out++;
+      }
+    }
+
+#ifdef LLFIO_GF256_X86
+    LLFIO_GF256_TARGET_SSSE3 inline void gf256_mul_add_ssse3(byte *out, const byte *in, uint8_t c, size_t bytes) noexcept
+    {
+      uint8_t lo[16], hi[16];
+      gf256_nibble_tables(lo, hi, c);
+      const __m128i tlo = _mm_loadu_si128((const __m128i *) lo), thi = _mm_loadu_si128((const __m128i *) hi), mask = _mm_set1_epi8(0x0f);
+      for(; bytes >= 16; out += 16, in += 16, bytes -= 16)
+      {
+        const __m128i x = _mm_loadu_si128((const __m128i *) in);
+        const __m128i p = _mm_xor_si128(_mm_shuffle_epi8(tlo, _mm_and_si128(x, mask)), _mm_shuffle_epi8(thi, _mm_and_si128(_mm_srli_epi64(x, 4), mask)));
+        _mm_storeu_si128((__m128i *) out, _mm_xor_si128(_mm_loadu_si128((const __m128i *) out), p));
+      }
+      gf256_mul_add_scalar(out, in, c, bytes);
+    }
+    LLFIO_GF256_TARGET_AVX2 inline void gf256_mul_add_avx2(byte *out, const byte *in, uint8_t c, size_t bytes) noexcept
+    {
+      uint8_t lo[16], hi[16];
+      gf256_nibble_tables(lo, hi, c);
+      const __m256i tlo = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) lo));
+      const __m256i thi = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) hi));
+      const __m256i mask = _mm256_set1_epi8(0x0f);
+      for(; bytes >= 32; out += 32, in += 32, bytes -= 32)
+      {
+        const __m256i x = _mm256_loadu_si256((const __m256i *) in);
+        const __m256i p =
+        _mm256_xor_si256(_mm256_shuffle_epi8(tlo, _mm256_and_si256(x, mask)), _mm256_shuffle_epi8(thi, _mm256_and_si256(_mm256_srli_epi64(x, 4), mask)));
+        _mm256_storeu_si256((__m256i *) out, _mm256_xor_si256(_mm256_loadu_si256((const __m256i *) out), p));
+      }
+      gf256_mul_add_scalar(out, in, c, bytes);
+    }
+    LLFIO_GF256_TARGET_AVX512 inline void gf256_mul_add_avx512(byte *out, const byte *in, uint8_t c, size_t bytes) noexcept
+    {
+      uint8_t lo[16], hi[16];
+      gf256_nibble_tables(lo, hi, c);
+      const __m512i tlo = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *) lo));
+      const __m512i thi = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *) hi));
+      const __m512i mask = _mm512_set1_epi8(0x0f);
+      while(bytes > 0)
+      {
+        const __mmask64 m = (bytes >= 64) ? (__mmask64) -1 : ((__mmask64) -1 >> (64 - bytes));
+        const __m512i x = _mm512_maskz_loadu_epi8(m, in);
+        const __m512i p =
+        _mm512_xor_si512(_mm512_shuffle_epi8(tlo, _mm512_and_si512(x, mask)), _mm512_shuffle_epi8(thi, _mm512_and_si512(_mm512_srli_epi64(x, 4), mask)));
+        _mm512_mask_storeu_epi8(out, m, _mm512_xor_si512(_mm512_maskz_loadu_epi8(m, out), p));
+        const size_t done = (bytes >= 64) ? 64 : bytes;
+        out += done;
+        in += done;
+        bytes -= done;
+      }
+    }
+#endif
+#ifdef LLFIO_GF256_NEON
+    inline void gf256_mul_add_neon(byte *out, const byte *in, uint8_t c, size_t bytes) noexcept
+    {
+      uint8_t lo[16], hi[16];
+      gf256_nibble_tables(lo, hi, c);
+      const uint8x16_t tlo = vld1q_u8(lo), thi = vld1q_u8(hi), mask = vdupq_n_u8(0x0f);
+      for(; bytes >= 16; out += 16, in += 16, bytes -= 16)
+      {
+        const uint8x16_t x = vld1q_u8((const uint8_t *) in);
+        const uint8x16_t p = veorq_u8(vqtbl1q_u8(tlo, vandq_u8(x, mask)), vqtbl1q_u8(thi, vshrq_n_u8(x, 4)));
+        vst1q_u8((uint8_t *) out, veorq_u8(vld1q_u8((const uint8_t *) out), p));
+      }
+      gf256_mul_add_scalar(out, in, c, bytes);
+    }
+#endif
+    struct gf256_kernels_t
+    {
+      void (*mul_add)(byte *out, const byte *in, uint8_t c, size_t bytes);
+      const char *name;
+    };
+    inline const gf256_kernels_t &gf256_kernels() noexcept
+    {
+      static const gf256_kernels_t v = []() -> gf256_kernels_t {
+#ifdef LLFIO_GF256_X86
+        const auto &features = LLFIO_V2_NAMESPACE::detail::cpu_features();
+        if(features.avx512f && features.avx512bw)
+        {
+          return {gf256_mul_add_avx512, "avx512"};
+        }
+        if(features.avx2)
+        {
+          return {gf256_mul_add_avx2, "avx2"};
+        }
+        if(features.ssse3)
+        {
+          return {gf256_mul_add_ssse3, "ssse3"};
+        }
+        return {gf256_mul_add_scalar, "scalar"};
+#elif defined(LLFIO_GF256_NEON)
+        return {gf256_mul_add_neon, "neon"};
+#else
+        return {gf256_mul_add_scalar, "scalar"};
+#endif
+      }();
+      return v;
+    }
+
+    LLFIO_HEADERS_ONLY_FUNC_SPEC bool gf256_invert_matrix(uint8_t *matrix, size_t n) noexcept
+    {
+      // Gauss-Jordan elimination on [matrix | identity]
+      auto *inv = reinterpret_cast<uint8_t *>(alloca(n * n));
+      memset(inv, 0, n * n);
+      for(size_t i = 0; i < n; i++)
+      {
+        inv[i * n + i] = 1;
+      }
+      for(size_t col = 0; col < n; col++)
+      {
+        size_t pivot = col;
+        while(pivot < n && matrix[pivot * n + col] == 0)
+        {
+          pivot++;
+        }
+        if(pivot == n)
+        {
+          return false;
+        }
+        if(pivot != col)
+        {
+          for(size_t k = 0; k < n; k++)
+          {
+            std::swap(matrix[pivot * n + k], matrix[col * n + k]);
+            std::swap(inv[pivot * n + k], inv[col * n + k]);
+          }
+        }
+        const uint8_t scale = gf256_inverse(matrix[col * n + col]);
+        for(size_t k = 0; k < n; k++)
+        {
+          matrix[col * n + k] = gf256_mul(matrix[col * n + k], scale);
+          inv[col * n + k] = gf256_mul(inv[col * n + k], scale);
+        }
+        for(size_t row = 0; row < n; row++)
+        {
+          const uint8_t factor = matrix[row * n + col];
+          if(row != col && factor != 0)
+          {
+            for(size_t k = 0; k < n; k++)
+            {
+              matrix[row * n + k] ^= gf256_mul(factor, matrix[col * n + k]);
+              inv[row * n + k] ^= gf256_mul(factor, inv[col * n + k]);
+            }
+          }
+        }
+      }
+      memcpy(matrix, inv, n * n);
+      return true;
+    }
+  }  // namespace detail
+
+  LLFIO_HEADERS_ONLY_FUNC_SPEC uint8_t gf256_mul(uint8_t a, uint8_t b) noexcept
+  {
+    if(a == 0 || b == 0)
+    {
+      return 0;
+    }
+    const auto &tables = detail::gf256_tables();
+    return tables.exp[tables.log[a] + tables.log[b]];
+  }
+  LLFIO_HEADERS_ONLY_FUNC_SPEC uint8_t gf256_inverse(uint8_t a) noexcept
+  {
+    if(a == 0)
+    {
+      return 0;
+    }
+    const auto &tables = detail::gf256_tables();
+    return tables.exp[255 - tables.log[a]];
+  }
+  LLFIO_HEADERS_ONLY_FUNC_SPEC void gf256_mul_add(byte *out, const byte *in, uint8_t c, size_t bytes) noexcept
+  {
+    if(c == 0)
+    {
+      return;
+    }
+    if(c == 1)
+    {
+      combine_xor(out, out, in, bytes);
+      return;
+    }
+    detail::gf256_kernels().mul_add(out, in, c, bytes);
+  }
+  LLFIO_HEADERS_ONLY_FUNC_SPEC const char *gf256_implementation() noexcept { return detail::gf256_kernels().name; }
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
+
+#undef LLFIO_GF256_X86
+#undef LLFIO_GF256_NEON
+#undef LLFIO_GF256_TARGET_SSSE3
+#undef LLFIO_GF256_TARGET_AVX2
+#undef LLFIO_GF256_TARGET_AVX512
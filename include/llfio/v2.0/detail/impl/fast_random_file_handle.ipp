@@ -23,11 +23,227 @@ Distributed under the Boost Software License, Version 1.0.
 */
 
 #include "../../fast_random_file_handle.hpp"
+#include "cpu_features.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define LLFIO_FAST_RANDOM_X86 1
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define LLFIO_FAST_RANDOM_TARGET_SSE2 __attribute__((target("sse2")))
+#define LLFIO_FAST_RANDOM_TARGET_AVX2 __attribute__((target("avx2")))
+#define LLFIO_FAST_RANDOM_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define LLFIO_FAST_RANDOM_TARGET_SSE2
+#define LLFIO_FAST_RANDOM_TARGET_AVX2
+#define LLFIO_FAST_RANDOM_TARGET_AVX512
+#endif
+#endif
 
 LLFIO_V2_NAMESPACE_EXPORT_BEGIN
 
+namespace detail
+{
+  /* The multi-lane generator. Each 256 byte chunk is sixteen lanes of JSF state, each
+  initialised with the chunk index in `a` and `b`, the seeded `c` plus a multiple of the
+  golden ratio per lane, and the seeded `d`. After four rounds, the next four rounds
+  each output sixteen words, one per lane, to a 64 byte line of the chunk.
+  */
+  static constexpr uint32_t fast_random_multi_lane_golden = 0x9e3779b9;
+  static constexpr int fast_random_multi_lane_warmup = 4;
+
+  inline void fast_random_multi_lane_scalar(byte *out, uint64_t chunk, size_t chunks, uint32_t c0, uint32_t d0) noexcept
+  {
+    auto rot = [](uint32_t x, int k) { return (x << k) | (x >> (32 - k)); };
+    for(; chunks > 0; chunks--, chunk++, out += 256)
+    {
+      uint32_t a[16], b[16], c[16], d[16], words[64];
+      for(uint32_t lane = 0; lane < 16; lane++)
+      {
+        a[lane] = (uint32_t) chunk;
+        b[lane] = (uint32_t) (chunk >> 32);
+        c[lane] = c0 + lane * fast_random_multi_lane_golden;
+        d[lane] = d0;
+      }
+      for(int round = 0; round < fast_random_multi_lane_warmup + 4; round++)
+      {
+        for(size_t lane = 0; lane < 16; lane++)
+        {
+          const uint32_t e = a[lane] - rot(b[lane], 27);
+          a[lane] = b[lane] ^ rot(c[lane], 17);
+          b[lane] = c[lane] + d[lane];
+          c[lane] = d[lane] + e;
+          d[lane] = e + a[lane];
+        }
+        if(round >= fast_random_multi_lane_warmup)
+        {
+          memcpy(words + (round - fast_random_multi_lane_warmup) * 16, d, sizeof(d));
+        }
+      }
+      memcpy(out, words, sizeof(words));
+    }
+  }
+
+#ifdef LLFIO_FAST_RANDOM_X86
+  // Without AVX-512, rotation must be emulated with two shifts and an or
+  LLFIO_FAST_RANDOM_TARGET_SSE2 inline void fast_random_multi_lane_sse2(byte *out, uint64_t chunk, size_t chunks, uint32_t c0, uint32_t d0) noexcept
+  {
+#define LLFIO_FAST_RANDOM_ROT(x, k) _mm_or_si128(_mm_slli_epi32((x), (k)), _mm_srli_epi32((x), 32 - (k)))
+    __m128i cinit[4];
+    for(uint32_t group = 0; group < 4; group++)
+    {
+      cinit[group] = _mm_setr_epi32((int) (c0 + (group * 4 + 0) * fast_random_multi_lane_golden), (int) (c0 + (group * 4 + 1) * fast_random_multi_lane_golden),
+                                    (int) (c0 + (group * 4 + 2) * fast_random_multi_lane_golden), (int) (c0 + (group * 4 + 3) * fast_random_multi_lane_golden));
+    }
+    for(; chunks > 0; chunks--, chunk++, out += 256)
+    {
+      for(int group = 0; group < 4; group++)
+      {
+        __m128i a = _mm_set1_epi32((int) (uint32_t) chunk), b = _mm_set1_epi32((int) (uint32_t) (chunk >> 32)), c = cinit[group], d = _mm_set1_epi32((int) d0);
+        for(int round = 0; round < fast_random_multi_lane_warmup + 4; round++)
+        {
+          const __m128i e = _mm_sub_epi32(a, LLFIO_FAST_RANDOM_ROT(b, 27));
+          a = _mm_xor_si128(b, LLFIO_FAST_RANDOM_ROT(c, 17));
+          b = _mm_add_epi32(c, d);
+          c = _mm_add_epi32(d, e);
+          d = _mm_add_epi32(e, a);
+          if(round >= fast_random_multi_lane_warmup)
+          {
+            _mm_storeu_si128((__m128i *) (out + (round - fast_random_multi_lane_warmup) * 64 + group * 16), d);
+          }
+        }
+      }
+    }
+#undef LLFIO_FAST_RANDOM_ROT
+  }
+  LLFIO_FAST_RANDOM_TARGET_AVX2 inline void fast_random_multi_lane_avx2(byte *out, uint64_t chunk, size_t chunks, uint32_t c0, uint32_t d0) noexcept
+  {
+#define LLFIO_FAST_RANDOM_ROT(x, k) _mm256_or_si256(_mm256_slli_epi32((x), (k)), _mm256_srli_epi32((x), 32 - (k)))
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i cinit[2] = {
+    _mm256_add_epi32(_mm256_set1_epi32((int) c0), _mm256_mullo_epi32(lanes, _mm256_set1_epi32((int) fast_random_multi_lane_golden))),
+    _mm256_add_epi32(_mm256_set1_epi32((int) c0),
+                     _mm256_mullo_epi32(_mm256_add_epi32(lanes, _mm256_set1_epi32(8)), _mm256_set1_epi32((int) fast_random_multi_lane_golden)))};
+    for(; chunks > 0; chunks--, chunk++, out += 256)
+    {
+      for(int group = 0; group < 2; group++)
+      {
+        __m256i a = _mm256_set1_epi32((int) (uint32_t) chunk), b = _mm256_set1_epi32((int) (uint32_t) (chunk >> 32)), c = cinit[group],
+                d = _mm256_set1_epi32((int) d0);
+        for(int round = 0; round < fast_random_multi_lane_warmup + 4; round++)
+        {
+          const __m256i e = _mm256_sub_epi32(a, LLFIO_FAST_RANDOM_ROT(b, 27));
+          a = _mm256_xor_si256(b, LLFIO_FAST_RANDOM_ROT(c, 17));
+          b = _mm256_add_epi32(c, d);
+          c = _mm256_add_epi32(d, e);
+          d = _mm256_add_epi32(e, a);
+          if(round >= fast_random_multi_lane_warmup)
+          {
+            _mm256_storeu_si256((__m256i *) (out + (round - fast_random_multi_lane_warmup) * 64 + group * 32), d);
+          }
+        }
+      }
+    }
+#undef LLFIO_FAST_RANDOM_ROT
+  }
+  LLFIO_FAST_RANDOM_TARGET_AVX512 inline void fast_random_multi_lane_avx512(byte *out, uint64_t chunk, size_t chunks, uint32_t c0, uint32_t d0) noexcept
+  {
+    const __m512i cinit = _mm512_add_epi32(
+    _mm512_set1_epi32((int) c0),
+    _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32((int) fast_random_multi_lane_golden)));
+    for(; chunks > 0; chunks--, chunk++, out += 256)
+    {
+      __m512i a = _mm512_set1_epi32((int) (uint32_t) chunk), b = _mm512_set1_epi32((int) (uint32_t) (chunk >> 32)), c = cinit, d = _mm512_set1_epi32((int) d0);
+      for(int round = 0; round < fast_random_multi_lane_warmup + 4; round++)
+      {
+        const __m512i e = _mm512_sub_epi32(a, _mm512_rol_epi32(b, 27));
+        a = _mm512_xor_si512(b, _mm512_rol_epi32(c, 17));
+        b = _mm512_add_epi32(c, d);
+        c = _mm512_add_epi32(d, e);
+        d = _mm512_add_epi32(e, a);
+        if(round >= fast_random_multi_lane_warmup)
+        {
+          _mm512_storeu_si512(out + (round - fast_random_multi_lane_warmup) * 64, d);
+        }
+      }
+    }
+  }
+#endif
+
+  using fast_random_multi_lane_t = void (*)(byte *out, uint64_t chunk, size_t chunks, uint32_t c0, uint32_t d0);
+  inline fast_random_multi_lane_t fast_random_multi_lane() noexcept
+  {
+    auto select = []() -> fast_random_multi_lane_t {
+#ifdef LLFIO_FAST_RANDOM_X86
+      const auto &features = cpu_features();
+      if(features.avx512f)
+      {
+        return fast_random_multi_lane_avx512;
+      }
+      if(features.avx2)
+      {
+        return fast_random_multi_lane_avx2;
+      }
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+      if(features.sse2)
+      {
+        return fast_random_multi_lane_sse2;
+      }
+#endif
+#endif
+      return fast_random_multi_lane_scalar;
+    };
+    // Reselect every time while the features are overridden, so the test can compare every kernel
+    if(cpu_features_override() != nullptr)
+    {
+      return select();
+    }
+    static const fast_random_multi_lane_t v = select();
+    return v;
+  }
+}  // namespace detail
+
+fast_random_file_handle::io_result<fast_random_file_handle::buffers_type> fast_random_file_handle::_do_read_multi_lane(io_request<buffers_type> reqs) noexcept
+{
+  const auto fill = detail::fast_random_multi_lane();
+  const uint32_t c0 = _prng.lane_c(), d0 = _prng.lane_d();
+  extent_type togo = (reqs.offset < _length) ? (_length - reqs.offset) : 0;
+  for(auto &buffer : reqs.buffers)
+  {
+    const auto len = (size_type) std::min((extent_type) buffer.size(), togo);
+    for(size_type i = 0; i < len;)
+    {
+      const extent_type chunk = reqs.offset / 256;
+      const auto chunkoffset = (size_type) (reqs.offset % 256);
+      size_type thisblocklen;
+      if(chunkoffset == 0 && len - i >= 256)
+      {
+        // Generate whole chunks straight into the buffer
+        const size_t chunks = (len - i) / 256;
+        fill(buffer.data() + i, chunk, chunks, c0, d0);
+        thisblocklen = chunks * 256;
+      }
+      else
+      {
+        byte blk[256];
+        fill(blk, chunk, 1, c0, d0);
+        thisblocklen = std::min(256 - chunkoffset, len - i);
+        memcpy(buffer.data() + i, blk + chunkoffset, thisblocklen);
+      }
+      reqs.offset += thisblocklen;
+      i += thisblocklen;
+    }
+    togo -= len;
+    buffer = {buffer.data(), len};
+  }
+  return std::move(reqs.buffers);
+}
+
 fast_random_file_handle::io_result<fast_random_file_handle::buffers_type> fast_random_file_handle::_do_read(io_request<buffers_type> reqs, deadline /* unused */) noexcept
 {
+  if(_generator == generator::multi_lane)
+  {
+    return _do_read_multi_lane(reqs);
+  }
   if(reqs.offset >= _length)
   {
     // Return null read
@@ -140,3 +356,8 @@ fast_random_file_handle::io_result<fast_random_file_handle::buffers_type> fast_r
 }
 
 LLFIO_V2_NAMESPACE_END
+
+#undef LLFIO_FAST_RANDOM_X86
+#undef LLFIO_FAST_RANDOM_TARGET_SSE2
+#undef LLFIO_FAST_RANDOM_TARGET_AVX2
+#undef LLFIO_FAST_RANDOM_TARGET_AVX512
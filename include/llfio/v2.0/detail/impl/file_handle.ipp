@@ -0,0 +1,152 @@
+/* Platform independent parts of file_handle
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#include "../../file_handle.hpp"
+
+LLFIO_V2_NAMESPACE_BEGIN
+
+namespace detail
+{
+  // Moves bytes within a file through a buffer, in whichever direction is safe for overlapping ranges
+  inline result<void> file_handle_move_bytes(file_handle &h, file_handle::extent_type from, file_handle::extent_type to, file_handle::extent_type bytes,
+                                             deadline d) noexcept
+  {
+    if(from == to || bytes == 0)
+    {
+      return success();
+    }
+    try
+    {
+      const size_t blocksize = utils::file_buffer_default_size();
+      byte *buffer = utils::page_allocator<byte>().allocate(blocksize);
+      auto unbufferh = make_scope_exit([buffer, blocksize]() noexcept { utils::page_allocator<byte>().deallocate(buffer, blocksize); });
+      (void) unbufferh;
+      // Moving down must copy from the front, moving up must copy from the back
+      const bool ascending = to < from;
+      for(file_handle::extent_type done = 0; done < bytes;)
+      {
+        const auto thisblock = (size_t) std::min((file_handle::extent_type) blocksize, bytes - done);
+        const file_handle::extent_type offset = ascending ? done : (bytes - done - thisblock);
+        OUTCOME_TRY(auto &&readed, h.read(from + offset, {{buffer, thisblock}}, d));
+        if(readed != thisblock)
+        {
+          return errc::resource_unavailable_try_again;  // something is wrong
+        }
+        OUTCOME_TRY(auto &&written, h.write(to + offset, {{buffer, thisblock}}, d));
+        if(written != thisblock)
+        {
+          return errc::resource_unavailable_try_again;  // something is wrong
+        }
+        done += thisblock;
+      }
+      return success();
+    }
+    catch(...)
+    {
+      return error_from_exception();
+    }
+  }
+
+  // Writes zeros over the extent, allocating storage for it
+  inline result<file_handle::extent_type> file_handle_write_zeros(file_handle &h, file_handle::extent_pair extent, deadline d) noexcept
+  {
+    try
+    {
+      file_handle::extent_type ret = 0;
+      const size_t blocksize = utils::file_buffer_default_size();
+      // page_allocator returns zeroed pages
+      byte *buffer = utils::page_allocator<byte>().allocate(blocksize);
+      auto unbufferh = make_scope_exit([buffer, blocksize]() noexcept { utils::page_allocator<byte>().deallocate(buffer, blocksize); });
+      (void) unbufferh;
+      while(extent.length > 0)
+      {
+        const auto towrite = (size_t) std::min((file_handle::extent_type) blocksize, extent.length);
+        OUTCOME_TRY(auto &&written, h.write(extent.offset, {{buffer, towrite}}, d));
+        extent.offset += written;
+        extent.length -= written;
+        ret += written;
+      }
+      return ret;
+    }
+    catch(...)
+    {
+      return error_from_exception();
+    }
+  }
+
+  // Allocates storage for any holes in the extent within the maximum extent by writing zeros into them
+  inline result<file_handle::extent_type> file_handle_preallocate_emulated(file_handle &h, file_handle::extent_pair extent, deadline d) noexcept
+  {
+    OUTCOME_TRY(auto &&size, h.maximum_extent());
+    const file_handle::extent_type end = std::min(extent.offset + extent.length, size);
+    if(extent.offset >= end)
+    {
+      return 0;
+    }
+    OUTCOME_TRY(auto &&valid, h.extents());
+    file_handle::extent_type pos = extent.offset;
+    auto fill = [&](file_handle::extent_type until) -> result<void> {
+      if(until > pos)
+      {
+        OUTCOME_TRY(file_handle_write_zeros(h, {pos, until - pos}, d));
+      }
+      return success();
+    };
+    for(auto &i : valid)
+    {
+      if(i.offset + i.length <= pos)
+      {
+        continue;
+      }
+      if(i.offset >= end)
+      {
+        break;
+      }
+      OUTCOME_TRY(fill(i.offset));
+      pos = std::max(pos, i.offset + i.length);
+    }
+    OUTCOME_TRY(fill(end));
+    return end - extent.offset;
+  }
+
+  inline result<file_handle::extent_type> file_handle_collapse_range_emulated(file_handle &h, file_handle::extent_pair extent, file_handle::extent_type size,
+                                                                              deadline d) noexcept
+  {
+    const file_handle::extent_type tail = extent.offset + extent.length;
+    OUTCOME_TRY(file_handle_move_bytes(h, tail, extent.offset, size - tail, d));
+    return h.truncate(size - extent.length);
+  }
+
+  inline result<file_handle::extent_type> file_handle_insert_range_emulated(file_handle &h, file_handle::extent_pair extent, file_handle::extent_type size,
+                                                                            deadline d) noexcept
+  {
+    OUTCOME_TRY(h.truncate(size + extent.length));
+    OUTCOME_TRY(file_handle_move_bytes(h, extent.offset, extent.offset + extent.length, size - extent.offset, d));
+    OUTCOME_TRY(h.zero(extent, d));
+    return size + extent.length;
+  }
+}  // namespace detail
+
+LLFIO_V2_NAMESPACE_END
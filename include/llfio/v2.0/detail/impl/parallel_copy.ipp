@@ -0,0 +1,307 @@
+/* A parallel chunked copy engine for single large files
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#include "../../algorithm/parallel_copy.hpp"
+#include "../../utils.hpp"
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+LLFIO_V2_NAMESPACE_BEGIN
+
+namespace algorithm
+{
+  namespace detail
+  {
+    struct parallel_copy_state
+    {
+      using extent_type = file_handle::extent_type;
+      using extent_pair = file_handle::extent_pair;
+      using clone_method = file_handle::clone_method;
+      using registered_buffer_type = file_handle::registered_buffer_type;
+
+      static constexpr extent_type direct_alignment = 4096;
+
+      file_handle *src{nullptr}, *dest{nullptr};
+      file_handle *direct_src{nullptr}, *direct_dest{nullptr};  // same as src and dest if not doing direct i/o
+      parallel_copy_config c;
+      deadline d;
+      std::chrono::steady_clock::time_point began_steady;
+      std::vector<extent_pair> chunks;
+      std::atomic<size_t> nextchunk{0};
+      std::atomic<bool> kernel_copy{true};
+
+      std::mutex lock;
+      clone_method method{clone_method::none};
+      optional<result<void>::error_type> failure;
+
+      intptr_t next_chunk() noexcept
+      {
+        const size_t n = nextchunk.fetch_add(1, std::memory_order_relaxed);
+        return (n < chunks.size()) ? (intptr_t) n + 1 : -1;
+      }
+
+      void used(clone_method m) noexcept
+      {
+        std::lock_guard<std::mutex> g(lock);
+        method |= m;
+      }
+
+      result<void> copy_chunk(registered_buffer_type &buffer, size_t idx) noexcept
+      {
+        const extent_pair chunk = chunks[idx];
+        deadline nd;
+        LLFIO_DEADLINE_TO_PARTIAL_DEADLINE(nd, d);
+        if(d && ((nd.steady && nd.nsecs == 0) || (!nd.steady && std::chrono::system_clock::now() >= nd.to_time_point())))
+        {
+          return errc::timed_out;
+        }
+        if(kernel_copy.load(std::memory_order_relaxed))
+        {
+          clone_method m = clone_method::none;
+          log_level_guard g(log_level::fatal);
+          if(src->clone_extents_to(chunk, *dest, chunk.offset, nd, c.force_copy_now, false, &m))
+          {
+            used(m);
+            return success();
+          }
+          // Reflinking and kernel copying are not available between these handles
+          kernel_copy.store(false, std::memory_order_relaxed);
+        }
+        extent_type offset = chunk.offset;
+        const extent_type end = chunk.offset + chunk.length;
+        while(offset < end)
+        {
+          extent_type togo = std::min(end - offset, (extent_type) buffer->size());
+          file_handle *rh = direct_src, *wh = direct_dest;
+          if(rh != src)
+          {
+            if((offset & (direct_alignment - 1)) != 0 || togo < direct_alignment)
+            {
+              rh = src;
+              wh = dest;
+            }
+            else
+            {
+              togo &= ~(direct_alignment - 1);
+            }
+          }
+          LLFIO_DEADLINE_TO_PARTIAL_DEADLINE(nd, d);
+          file_handle::buffer_type b(buffer->data(), (size_t) togo);
+          OUTCOME_TRY(auto &&readed, rh->read(buffer, {{&b, 1}, offset}, nd));
+          // No buffers are returned at end of file, such as if the source shrank during the copy
+          if(readed.empty() || readed.front().size() != togo)
+          {
+            return errc::resource_unavailable_try_again;  // something is wrong
+          }
+          LLFIO_DEADLINE_TO_PARTIAL_DEADLINE(nd, d);
+          file_handle::const_buffer_type cb(readed.front().data(), readed.front().size());
+          OUTCOME_TRY(auto &&written, wh->write({{&cb, 1}, offset}, nd));
+          if(written.empty() || written.front().size() != togo)
+          {
+            return errc::resource_unavailable_try_again;  // something is wrong
+          }
+          offset += togo;
+        }
+        used(clone_method::copied);
+        return success();
+      }
+
+      result<void> run(registered_buffer_type &buffer, intptr_t work) noexcept
+      {
+        auto r = copy_chunk(buffer, (size_t) work - 1);
+        if(!r)
+        {
+          std::lock_guard<std::mutex> g(lock);
+          if(!failure)
+          {
+            failure = std::move(r).error();
+          }
+          // Cancel all remaining work
+          return errc::operation_canceled;
+        }
+        return success();
+      }
+    };
+
+    struct parallel_copy_worker final : public dynamic_thread_pool_group::work_item
+    {
+      parallel_copy_state *state{nullptr};
+      file_handle::registered_buffer_type buffer;
+
+      virtual intptr_t next(deadline & /*unused*/) noexcept override { return state->next_chunk(); }
+      virtual result<void> operator()(intptr_t work) noexcept override { return state->run(buffer, work); }
+    };
+
+    struct parallel_copy_paced_worker final : public dynamic_thread_pool_group::io_aware_work_item
+    {
+      parallel_copy_state *state{nullptr};
+      file_handle::registered_buffer_type buffer;
+
+      parallel_copy_paced_worker(parallel_copy_state *_state, span<byte_io_handle_awareness> hs)
+          : io_aware_work_item(hs)
+          , state(_state)
+      {
+      }
+
+      virtual intptr_t io_aware_next(deadline & /*unused*/) noexcept override { return state->next_chunk(); }
+      virtual result<void> operator()(intptr_t work) noexcept override { return state->run(buffer, work); }
+    };
+  }  // namespace detail
+
+  LLFIO_HEADERS_ONLY_FUNC_SPEC result<file_handle::extent_type> parallel_copy(file_handle &src, file_handle &dest, parallel_copy_config c, deadline d,
+                                                                              file_handle::clone_method *method) noexcept
+  {
+    LLFIO_LOG_FUNCTION_CALL(&src);
+    using extent_type = file_handle::extent_type;
+    try
+    {
+      detail::parallel_copy_state state;
+      state.c = c;
+      state.d = d;
+      if(d && d.steady && d.nsecs != 0)
+      {
+        state.began_steady = std::chrono::steady_clock::now();
+      }
+      state.src = state.direct_src = &src;
+      state.dest = state.direct_dest = &dest;
+      const extent_type chunk_size = utils::round_up_to_page_size((c.chunk_size != 0) ? c.chunk_size : (extent_type) 64 * 1024 * 1024, utils::page_size());
+      const size_t buffer_size = utils::round_up_to_page_size((c.buffer_size != 0) ? c.buffer_size : utils::file_buffer_default_size(), utils::page_size());
+
+      // Split the valid extents of the source into chunks
+      OUTCOME_TRY(auto &&length, src.maximum_extent());
+      OUTCOME_TRY(auto &&extents, src.extents());
+      for(auto extent : extents)
+      {
+        if(extent.offset >= length)
+        {
+          break;
+        }
+        extent.length = std::min(extent.length, length - extent.offset);
+        while(extent.length > 0)
+        {
+          const extent_type thislength = std::min(extent.length, chunk_size - (extent.offset % chunk_size));
+          state.chunks.push_back({extent.offset, thislength});
+          extent.offset += thislength;
+          extent.length -= thislength;
+        }
+      }
+      OUTCOME_TRY(dest.truncate(0));
+      OUTCOME_TRY(dest.truncate(length));
+      if(state.chunks.empty())
+      {
+        return length;
+      }
+
+      file_handle direct_src, direct_dest;
+      if(c.direct_io)
+      {
+        auto r1 = src.reopen(file_handle::mode::read, file_handle::caching::none);
+        auto r2 = dest.reopen(file_handle::mode::write, file_handle::caching::none);
+        // If the filesystem doesn't support uncached i/o, use cached i/o
+        if(r1 && r2)
+        {
+          direct_src = std::move(r1).value();
+          direct_dest = std::move(r2).value();
+          state.direct_src = &direct_src;
+          state.direct_dest = &direct_dest;
+        }
+      }
+
+      size_t concurrency = (c.concurrency != 0) ? c.concurrency : std::max((size_t) std::thread::hardware_concurrency(), (size_t) 1);
+      concurrency = std::min(concurrency, state.chunks.size());
+      std::vector<detail::parallel_copy_worker> workers;
+      std::vector<detail::parallel_copy_paced_worker> paced_workers;
+      std::vector<std::array<dynamic_thread_pool_group::io_aware_work_item::byte_io_handle_awareness, 2>> awareness;
+      std::vector<dynamic_thread_pool_group::work_item *> items;
+      items.reserve(concurrency);
+      if(c.pace_io)
+      {
+        awareness.resize(concurrency);
+        paced_workers.reserve(concurrency);
+        try
+        {
+          for(size_t n = 0; n < concurrency; n++)
+          {
+            awareness[n][0].h = state.direct_src;
+            awareness[n][0].reads = 1;
+            awareness[n][1].h = state.direct_dest;
+            awareness[n][1].writes = 1;
+            paced_workers.emplace_back(&state, awareness[n]);
+          }
+        }
+        catch(...)
+        {
+          // This platform cannot retrieve the congestion of the storage devices
+          paced_workers.clear();
+        }
+        for(auto &w : paced_workers)
+        {
+          size_t bytes = buffer_size;
+          OUTCOME_TRY(w.buffer, src.allocate_registered_buffer(bytes));
+          items.push_back(&w);
+        }
+      }
+      if(items.empty())
+      {
+        workers.resize(concurrency);
+        for(auto &w : workers)
+        {
+          w.state = &state;
+          size_t bytes = buffer_size;
+          OUTCOME_TRY(w.buffer, src.allocate_registered_buffer(bytes));
+          items.push_back(&w);
+        }
+      }
+
+      OUTCOME_TRY(auto &&group, make_dynamic_thread_pool_group());
+      OUTCOME_TRY(group->submit(items));
+      // The work items check the deadline themselves, as they must complete before they are destroyed
+      (void) group->wait();
+      if(method != nullptr)
+      {
+        *method |= state.method;
+      }
+      if(state.failure)
+      {
+        return std::move(*state.failure);
+      }
+      if(state.nextchunk.load(std::memory_order_relaxed) < state.chunks.size())
+      {
+        return errc::operation_canceled;
+      }
+      return length;
+    }
+    catch(...)
+    {
+      return error_from_exception();
+    }
+  }
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
@@ -0,0 +1,135 @@
+/* Calling a function for each index in a range on the dynamic thread pool
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+
+#ifndef LLFIO_PARALLEL_FOR_EACH_HPP
+#define LLFIO_PARALLEL_FOR_EACH_HPP
+
+#include "../../config.hpp"
+
+#ifndef LLFIO_EXCLUDE_DYNAMIC_THREAD_POOL_GROUP
+#include "../../dynamic_thread_pool_group.hpp"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+LLFIO_V2_NAMESPACE_BEGIN
+
+namespace algorithm
+{
+  namespace detail
+  {
+    /* Calls `f(n)`, which returns `result<void>`, for every n in [0, count). If there is
+    more than one n, the calls are spread over up to `threads` work items of a dynamic
+    thread pool group, where zero means the hardware concurrency. The first failure
+    cancels all remaining work, and is returned.
+    */
+    template <class F> inline result<void> parallel_for_each(size_t count, size_t threads, F &f) noexcept
+    {
+#ifndef LLFIO_EXCLUDE_DYNAMIC_THREAD_POOL_GROUP
+      if(count > 1)
+      {
+        struct state_type
+        {
+          size_t count;
+          F *f;
+          std::atomic<size_t> next{0};
+          std::mutex lock;
+          optional<result<void>::error_type> failure;
+        } state;
+        state.count = count;
+        state.f = &f;
+        struct worker final : public dynamic_thread_pool_group::work_item
+        {
+          state_type *state{nullptr};
+
+          virtual intptr_t next(deadline & /*unused*/) noexcept override
+          {
+            const size_t n = state->next.fetch_add(1, std::memory_order_relaxed);
+            return (n < state->count) ? (intptr_t) n + 1 : -1;
+          }
+          virtual result<void> operator()(intptr_t work) noexcept override
+          {
+            auto r = (*state->f)((size_t) work - 1);
+            if(!r)
+            {
+              std::lock_guard<std::mutex> g(state->lock);
+              if(!state->failure)
+              {
+                state->failure = std::move(r).error();
+              }
+              // Cancel all remaining work
+              return errc::operation_canceled;
+            }
+            return success();
+          }
+        };
+        if(threads == 0)
+        {
+          threads = std::max((size_t) std::thread::hardware_concurrency(), (size_t) 1);
+        }
+        try
+        {
+          std::vector<worker> workers(std::min(threads, count));
+          std::vector<dynamic_thread_pool_group::work_item *> items;
+          items.reserve(workers.size());
+          for(auto &i : workers)
+          {
+            i.state = &state;
+            items.push_back(&i);
+          }
+          OUTCOME_TRY(auto &&group, make_dynamic_thread_pool_group());
+          OUTCOME_TRY(group->submit(items));
+          (void) group->wait();
+        }
+        catch(...)
+        {
+          return error_from_exception();
+        }
+        if(state.failure)
+        {
+          return std::move(*state.failure);
+        }
+        return success();
+      }
+#else
+      (void) threads;
+#endif
+      for(size_t n = 0; n < count; n++)
+      {
+        OUTCOME_TRY(f(n));
+      }
+      return success();
+    }
+  }  // namespace detail
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
+
+#endif
@@ -32,11 +32,21 @@ http://www.boost.org/LICENSE_1_0.txt)
 #define LLFIO_VALGRIND_MAKE_MEM_DEFINED_IF_ADDRESSABLE(a, b)
 #endif
 
+#ifndef LLFIO_EXCLUDE_DYNAMIC_THREAD_POOL_GROUP
+#include "../../../dynamic_thread_pool_group.hpp"
+#endif
+
 #include <dirent.h> /* Defines DT_* constants */
 #include <fnmatch.h>
 #include <sys/stat.h>
 #include <sys/syscall.h>
 
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#include <vector>
+
 LLFIO_V2_NAMESPACE_BEGIN
 
 result<directory_handle> directory_handle::directory(const path_handle &base, path_view_type path, mode _mode, creation _creation, caching _caching,
@@ -501,4 +511,474 @@ result<directory_handle::buffers_type> directory_handle::read(io_request<buffers
   }
 }
 
+namespace detail
+{
+  // Stat a single directory entry without following symlinks, returning false if it could not be stat'd
+  inline bool directory_entry_stat(int dirfd, directory_entry &entry, stat_t::want wanted) noexcept
+  {
+    directory_handle::path_view_type::zero_terminated_rendered_path<> zpath(entry.leafname);
+#ifdef __linux__
+    statx_buffer sx;
+    memset(&sx, 0, sizeof(sx));
+    if(do_statx(dirfd, zpath.c_str(), AT_NO_AUTOMOUNT | AT_SYMLINK_NOFOLLOW, statx_mask(wanted), &sx) >= 0)
+    {
+      fill_from_statx(entry.stat, sx, wanted);
+      return true;
+    }
+    if(ENOSYS != errno)
+    {
+      return false;
+    }
+#endif
+    struct stat s
+    {
+    };
+    if(-1 == ::fstatat(dirfd, zpath.c_str(), &s, AT_SYMLINK_NOFOLLOW))
+    {
+      return false;
+    }
+    fill_from_stat(entry.stat, s, wanted);
+    return true;
+  }
+
+  // Move the entries which failed to the end, preserving the order of the others. Returns how many failed.
+  inline size_t directory_entries_partition(span<directory_entry> entries, const char *ok)
+  {
+    std::vector<directory_entry> failed;
+    size_t out = 0;
+    for(size_t n = 0; n < entries.size(); n++)
+    {
+      if(ok[n] != 0)
+      {
+        if(out != n)
+        {
+          entries[out] = entries[n];
+        }
+        out++;
+      }
+      else
+      {
+        failed.push_back(entries[n]);
+      }
+    }
+    for(auto &i : failed)
+    {
+      entries[out++] = i;
+    }
+    return failed.size();
+  }
+
+#ifdef __linux__
+  /* A small io_uring used to submit the statx() for many directory entries as
+  a single batch. The kernel ABI structures are defined here, as the system
+  headers may be too old to have them.
+
+  The statx buffers and leafnames are owned by the ring, so if the ring ever
+  fails with operations in flight, we never reuse nor free memory which the
+  kernel may yet write into until this thread exits.
+  */
+  class directory_statx_ring
+  {
+    struct _io_uring_sqe
+    {
+      uint8_t opcode;
+      uint8_t flags;
+      uint16_t ioprio;
+      int32_t fd;
+      uint64_t addr2; /* the statx buffer */
+      uint64_t addr;  /* the path */
+      uint32_t len;   /* the statx mask */
+      uint32_t statx_flags;
+      uint64_t user_data;
+      uint64_t __pad2[3];
+    };
+    struct _io_uring_cqe
+    {
+      uint64_t user_data;
+      int32_t res;
+      uint32_t flags;
+    };
+    struct _io_sqring_offsets
+    {
+      uint32_t head, tail, ring_mask, ring_entries, flags, dropped, array, resv1;
+      uint64_t resv2;
+    };
+    struct _io_cqring_offsets
+    {
+      uint32_t head, tail, ring_mask, ring_entries, overflow, cqes, flags, resv1;
+      uint64_t resv2;
+    };
+    struct _io_uring_params
+    {
+      uint32_t sq_entries, cq_entries, flags, sq_thread_cpu, sq_thread_idle, features, wq_fd, resv[3];
+      _io_sqring_offsets sq_off;
+      _io_cqring_offsets cq_off;
+    };
+    static_assert(sizeof(_io_uring_sqe) == 64, "io_uring_sqe is not 64 bytes");
+    static_assert(sizeof(_io_uring_params) == 120, "io_uring_params is not 120 bytes");
+    static constexpr uint8_t _IORING_OP_STATX = 21;
+    static constexpr uint32_t _IORING_ENTER_GETEVENTS = (1U << 0);
+    static constexpr uint32_t _IORING_FEAT_SINGLE_MMAP = (1U << 0);
+    static constexpr off_t _IORING_OFF_SQ_RING = 0;
+    static constexpr off_t _IORING_OFF_CQ_RING = 0x8000000;
+    static constexpr off_t _IORING_OFF_SQES = 0x10000000;
+
+    static int _io_uring_setup(unsigned entries, _io_uring_params *p) noexcept
+    {
+#ifdef __alpha__
+      return (int) syscall(535 /*__NR_io_uring_setup*/, entries, p);
+#else
+      return (int) syscall(425 /*__NR_io_uring_setup*/, entries, p);
+#endif
+    }
+    static int _io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) noexcept
+    {
+#ifdef __alpha__
+      return (int) syscall(536 /*__NR_io_uring_enter*/, fd, to_submit, min_complete, flags, nullptr, 0);
+#else
+      return (int) syscall(426 /*__NR_io_uring_enter*/, fd, to_submit, min_complete, flags, nullptr, 0);
+#endif
+    }
+
+    int _fd{-1};
+    bool _dead{false};
+    void *_sqring{nullptr}, *_cqring{nullptr};
+    size_t _sqringbytes{0}, _cqringbytes{0};
+    _io_uring_sqe *_sqes{nullptr};
+    size_t _sqesbytes{0};
+    uint32_t *_sqtail{nullptr}, *_sqmask{nullptr}, *_sqarray{nullptr};
+    uint32_t *_cqhead{nullptr}, *_cqtail{nullptr}, *_cqmask{nullptr};
+    _io_uring_cqe *_cqes{nullptr};
+    unsigned _entries{0};
+
+    void _close() noexcept
+    {
+      if(_sqes != nullptr)
+      {
+        (void) ::munmap(_sqes, _sqesbytes);
+        _sqes = nullptr;
+      }
+      if(_cqring != nullptr && _cqring != _sqring)
+      {
+        (void) ::munmap(_cqring, _cqringbytes);
+      }
+      _cqring = nullptr;
+      if(_sqring != nullptr)
+      {
+        (void) ::munmap(_sqring, _sqringbytes);
+        _sqring = nullptr;
+      }
+      if(_fd != -1)
+      {
+        (void) ::close(_fd);
+        _fd = -1;
+      }
+    }
+    bool _open(unsigned entries) noexcept
+    {
+      try
+      {
+        buffers.resize(entries);
+        results.resize(entries);
+      }
+      catch(...)
+      {
+        return false;
+      }
+      _io_uring_params p;
+      memset(&p, 0, sizeof(p));
+      _fd = _io_uring_setup(entries, &p);
+      if(_fd < 0)
+      {
+        _fd = -1;
+        return false;
+      }
+      _entries = std::min(p.sq_entries, entries);
+      _sqringbytes = p.sq_off.array + p.sq_entries * sizeof(uint32_t);
+      _cqringbytes = p.cq_off.cqes + p.cq_entries * sizeof(_io_uring_cqe);
+      if(p.features & _IORING_FEAT_SINGLE_MMAP)
+      {
+        _sqringbytes = _cqringbytes = std::max(_sqringbytes, _cqringbytes);
+      }
+      auto map = [this](size_t bytes, off_t offset) -> void * {
+        void *ret = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, offset);
+        return (MAP_FAILED == ret) ? nullptr : ret;
+      };
+      _sqring = map(_sqringbytes, _IORING_OFF_SQ_RING);
+      if(_sqring == nullptr)
+      {
+        _close();
+        return false;
+      }
+      _cqring = (p.features & _IORING_FEAT_SINGLE_MMAP) ? _sqring : map(_cqringbytes, _IORING_OFF_CQ_RING);
+      _sqesbytes = p.sq_entries * sizeof(_io_uring_sqe);
+      _sqes = (_io_uring_sqe *) map(_sqesbytes, _IORING_OFF_SQES);
+      if(_cqring == nullptr || _sqes == nullptr)
+      {
+        _close();
+        return false;
+      }
+      auto *sq = (char *) _sqring, *cq = (char *) _cqring;
+      _sqtail = (uint32_t *) (sq + p.sq_off.tail);
+      _sqmask = (uint32_t *) (sq + p.sq_off.ring_mask);
+      _sqarray = (uint32_t *) (sq + p.sq_off.array);
+      _cqhead = (uint32_t *) (cq + p.cq_off.head);
+      _cqtail = (uint32_t *) (cq + p.cq_off.tail);
+      _cqmask = (uint32_t *) (cq + p.cq_off.ring_mask);
+      _cqes = (_io_uring_cqe *) (cq + p.cq_off.cqes);
+      return true;
+    }
+    // Kernels from 5.1 to 5.5 have io_uring, but not IORING_OP_STATX
+    bool _probe() noexcept
+    {
+      names.assign({'/', 0});
+      const char *path = names.data();
+      return submit(AT_FDCWD, &path, 1, 0, 0x0001U /*STATX_TYPE*/) && results[0] >= 0;
+    }
+
+  public:
+    //! The statx buffers filled by `submit()`
+    std::vector<statx_buffer> buffers;
+    //! Zero or the negated errno for each statx submitted
+    std::vector<int> results;
+    //! Storage for the zero terminated leafnames being stat'd
+    std::vector<char> names;
+
+    directory_statx_ring() = default;
+    directory_statx_ring(const directory_statx_ring &) = delete;
+    directory_statx_ring &operator=(const directory_statx_ring &) = delete;
+    ~directory_statx_ring() { _close(); }
+
+    //! The maximum number of statx which can be submitted at once
+    unsigned entries() const noexcept { return _entries; }
+
+    //! Returns the ring for the calling thread, or null if `io_uring` with `IORING_OP_STATX` is unavailable.
+    static directory_statx_ring *get() noexcept
+    {
+      static std::atomic<int> available{0};  // 0 unknown, 1 available, -1 unavailable
+      if(available.load(std::memory_order_relaxed) < 0)
+      {
+        return nullptr;
+      }
+      try
+      {
+        static thread_local directory_statx_ring ring;
+        if(ring._fd == -1 && !ring._dead)
+        {
+          if(!ring._open(256) || !ring._probe())
+          {
+            ring._close();
+            ring._dead = true;
+            int expected = 0;
+            (void) available.compare_exchange_strong(expected, -1, std::memory_order_relaxed);
+            return nullptr;
+          }
+          available.store(1, std::memory_order_relaxed);
+        }
+        return ring._dead ? nullptr : &ring;
+      }
+      catch(...)
+      {
+        return nullptr;
+      }
+    }
+
+    /*! Submit a statx() for each of `count <= entries()` paths relative to `dirfd` as a single
+    batch, and wait for them all to complete. Returns false if the ring failed, in which case it
+    is never used again on this thread.
+    */
+    bool submit(int dirfd, const char *const *paths, size_t count, int flags, unsigned mask) noexcept
+    {
+      assert(count <= _entries);
+      uint32_t tail = *_sqtail;
+      for(size_t n = 0; n < count; n++, tail++)
+      {
+        const uint32_t idx = tail & *_sqmask;
+        _io_uring_sqe &sqe = _sqes[idx];
+        memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = _IORING_OP_STATX;
+        sqe.fd = dirfd;
+        sqe.addr = (uint64_t) (uintptr_t) paths[n];
+        sqe.addr2 = (uint64_t) (uintptr_t) &buffers[n];
+        sqe.len = mask;
+        sqe.statx_flags = (uint32_t) flags;
+        sqe.user_data = n;
+        _sqarray[idx] = idx;
+      }
+      reinterpret_cast<std::atomic<uint32_t> *>(_sqtail)->store(tail, std::memory_order_release);
+      size_t unsubmitted = count, completed = 0;
+      bool failed = false;
+      while(completed < count - unsubmitted || (!failed && unsubmitted > 0))
+      {
+        const int ret = _io_uring_enter(_fd, failed ? 0 : (unsigned) unsubmitted, 1, _IORING_ENTER_GETEVENTS);
+        if(ret < 0)
+        {
+          if(EINTR == errno || EAGAIN == errno || EBUSY == errno)
+          {
+            continue;
+          }
+          if(failed || completed == count - unsubmitted)
+          {
+            // Nothing more can be done, so abandon this ring
+            break;
+          }
+          // Stop submitting, but reap what is in flight
+          failed = true;
+          continue;
+        }
+        if(!failed)
+        {
+          unsubmitted -= (size_t) ret;
+        }
+        uint32_t head = *_cqhead;
+        const uint32_t cqtail = reinterpret_cast<std::atomic<uint32_t> *>(_cqtail)->load(std::memory_order_acquire);
+        for(; head != cqtail; head++)
+        {
+          const _io_uring_cqe &cqe = _cqes[head & *_cqmask];
+          results[(size_t) cqe.user_data] = cqe.res;
+          completed++;
+        }
+        reinterpret_cast<std::atomic<uint32_t> *>(_cqhead)->store(head, std::memory_order_release);
+      }
+      if(failed || completed < count)
+      {
+        _close();
+        _dead = true;
+        return false;
+      }
+      return true;
+    }
+  };
+#endif
+}  // namespace detail
+
+LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<size_t> directory_handle::fill_metadata(buffers_type &buffers, stat_t::want wanted) const noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+  try
+  {
+    const stat_t::want missing = wanted & ~buffers._metadata;
+    if(!missing || buffers.empty())
+    {
+      buffers._metadata |= wanted;
+      return 0;
+    }
+    std::vector<char> ok(buffers.size(), 0);
+    bool done = false;
+#ifdef __linux__
+    if(buffers.size() > 1)
+    {
+      if(auto *ring = detail::directory_statx_ring::get())
+      {
+        const unsigned mask = detail::statx_mask(missing);
+        std::vector<const char *> paths;
+        size_t n = 0;
+        for(; n < buffers.size();)
+        {
+          const size_t count = std::min(buffers.size() - n, (size_t) ring->entries());
+          ring->names.clear();
+          std::vector<size_t> offsets(count);
+          for(size_t i = 0; i < count; i++)
+          {
+            path_view_type::zero_terminated_rendered_path<> zpath(buffers[n + i].leafname);
+            offsets[i] = ring->names.size();
+            ring->names.insert(ring->names.end(), zpath.c_str(), zpath.c_str() + zpath.size());
+            ring->names.push_back(0);
+          }
+          paths.resize(count);
+          for(size_t i = 0; i < count; i++)
+          {
+            paths[i] = ring->names.data() + offsets[i];
+          }
+          if(!ring->submit(_v.fd, paths.data(), count, AT_NO_AUTOMOUNT | AT_SYMLINK_NOFOLLOW, mask))
+          {
+            // Do the rest some other way
+            break;
+          }
+          for(size_t i = 0; i < count; i++)
+          {
+            if(ring->results[i] >= 0)
+            {
+              detail::fill_from_statx(buffers[n + i].stat, ring->buffers[i], missing);
+              ok[n + i] = 1;
+            }
+          }
+          n += count;
+        }
+        done = (n == buffers.size());
+        if(!done)
+        {
+          // Don't leave half filled entries behind
+          std::fill(ok.begin(), ok.end(), 0);
+        }
+      }
+    }
+#endif
+#ifndef LLFIO_EXCLUDE_DYNAMIC_THREAD_POOL_GROUP
+    static constexpr size_t entries_per_work_item = 16;
+    if(!done && buffers.size() >= 4 * entries_per_work_item)
+    {
+      struct state_type
+      {
+        int dirfd;
+        span<directory_entry> entries;
+        stat_t::want wanted;
+        char *ok;
+        std::atomic<size_t> next{0};
+      } state;
+      state.dirfd = _v.fd;
+      state.entries = buffers;
+      state.wanted = missing;
+      state.ok = ok.data();
+      struct worker final : public dynamic_thread_pool_group::work_item
+      {
+        state_type *state{nullptr};
+
+        virtual intptr_t next(deadline & /*unused*/) noexcept override
+        {
+          const size_t n = state->next.fetch_add(entries_per_work_item, std::memory_order_relaxed);
+          return (n < state->entries.size()) ? (intptr_t) n + 1 : -1;
+        }
+        virtual result<void> operator()(intptr_t work) noexcept override
+        {
+          const size_t begin = (size_t) work - 1, end = std::min(begin + entries_per_work_item, state->entries.size());
+          for(size_t n = begin; n < end; n++)
+          {
+            state->ok[n] = detail::directory_entry_stat(state->dirfd, state->entries[n], state->wanted);
+          }
+          return success();
+        }
+      };
+      const size_t concurrency =
+      std::min(buffers.size() / entries_per_work_item, std::max((size_t) std::thread::hardware_concurrency(), (size_t) 1));
+      std::vector<worker> workers(concurrency);
+      std::vector<dynamic_thread_pool_group::work_item *> items;
+      items.reserve(concurrency);
+      for(auto &i : workers)
+      {
+        i.state = &state;
+        items.push_back(&i);
+      }
+      OUTCOME_TRY(auto &&group, make_dynamic_thread_pool_group());
+      OUTCOME_TRY(group->submit(items));
+      OUTCOME_TRY(group->wait());
+      done = true;
+    }
+#endif
+    if(!done)
+    {
+      for(size_t n = 0; n < buffers.size(); n++)
+      {
+        ok[n] = detail::directory_entry_stat(_v.fd, buffers[n], missing);
+      }
+    }
+    buffers._metadata |= wanted;
+    return detail::directory_entries_partition(buffers, ok.data());
+  }
+  catch(...)
+  {
+    return error_from_exception();
+  }
+}
+
 LLFIO_V2_NAMESPACE_END
@@ -33,6 +33,7 @@ Distributed under the Boost Software License, Version 1.0.
 #endif
 
 #ifdef __linux__
+#include <sys/ioctl.h>
 #include <sys/syscall.h>
 #include <sys/sysmacros.h>
 #endif
@@ -348,12 +349,185 @@ result<file_handle::extent_type> file_handle::truncate(file_handle::extent_type
   return newsize;
 }
 
+#ifdef __linux__
+namespace detail
+{
+  /* Enumerates the extents overlapping [offset, offset + length) using FS_IOC_FIEMAP.
+  Returns false if the filing system does not support FIEMAP. If `coalesce` is set,
+  logically contiguous extents are merged, and only offset and length are meaningful.
+  If `sync` is set, dirty and delayed allocation data is flushed before the extents are
+  mapped, without which FIEMAP can omit recently written data. This must be set whenever
+  the extents decide which bytes get copied.
+  */
+  inline result<bool> fiemap_extents(std::vector<file_handle::extent_info> &out, int fd, file_handle::extent_type offset, file_handle::extent_type length,
+                                     bool coalesce, bool sync) noexcept
+  {
+    struct fiemap_extent_t
+    {
+      uint64_t fe_logical;
+      uint64_t fe_physical;
+      uint64_t fe_length;
+      uint64_t fe_reserved64[2];
+      uint32_t fe_flags;
+      uint32_t fe_reserved[3];
+    };
+    struct fiemap_t
+    {
+      uint64_t fm_start;
+      uint64_t fm_length;
+      uint32_t fm_flags;
+      uint32_t fm_mapped_extents;
+      uint32_t fm_extent_count;
+      uint32_t fm_reserved;
+      // followed by fm_extent_count fiemap_extent_t
+    };
+    static_assert(sizeof(fiemap_extent_t) == 56, "fiemap_extent_t is not the size of struct fiemap_extent");
+    static_assert(sizeof(fiemap_t) == 32, "fiemap_t is not the size of struct fiemap");
+    static constexpr uint32_t FIEMAP_EXTENT_LAST_ = 0x00000001, FIEMAP_EXTENT_UNKNOWN_ = 0x00000002, FIEMAP_EXTENT_DELALLOC_ = 0x00000004,
+                              FIEMAP_EXTENT_ENCODED_ = 0x00000008, FIEMAP_EXTENT_DATA_ENCRYPTED_ = 0x00000080, FIEMAP_EXTENT_DATA_INLINE_ = 0x00000200,
+                              FIEMAP_EXTENT_UNWRITTEN_ = 0x00000800, FIEMAP_EXTENT_SHARED_ = 0x00002000;
+    // Enough for 1024 extents per syscall
+    static constexpr size_t batch = 1024;
+    try
+    {
+      std::vector<uint64_t> buffer((sizeof(fiemap_t) + batch * sizeof(fiemap_extent_t)) / sizeof(uint64_t));
+      auto *fm = reinterpret_cast<fiemap_t *>(buffer.data());
+      auto *fe = reinterpret_cast<fiemap_extent_t *>(fm + 1);
+      const file_handle::extent_type end = (offset + length < offset) ? (file_handle::extent_type) -1 : (offset + length);
+      file_handle::extent_type pos = offset;
+      while(pos < end)
+      {
+        memset(fm, 0, sizeof(fiemap_t));
+        fm->fm_start = pos;
+        fm->fm_length = end - pos;
+        fm->fm_flags = sync ? 0x00000001 /*FIEMAP_FLAG_SYNC*/ : 0;
+        fm->fm_extent_count = batch;
+        if(-1 == ::ioctl(fd, _IOWR('f', 11, fiemap_t) /*FS_IOC_FIEMAP*/, fm))
+        {
+          if(EOPNOTSUPP == errno || ENOTTY == errno || ENOSYS == errno || EINVAL == errno)
+          {
+            if(out.empty() && pos == offset)
+            {
+              return false;
+            }
+          }
+          return posix_error();
+        }
+        if(fm->fm_mapped_extents == 0)
+        {
+          break;
+        }
+        bool last = false;
+        for(uint32_t n = 0; n < fm->fm_mapped_extents; n++)
+        {
+          const auto &e = fe[n];
+          last = last || (e.fe_flags & FIEMAP_EXTENT_LAST_) != 0;
+          if(e.fe_length == 0)
+          {
+            continue;
+          }
+          if(coalesce && !out.empty() && out.back().offset + out.back().length >= e.fe_logical)
+          {
+            out.back().length = std::max(out.back().offset + out.back().length, e.fe_logical + e.fe_length) - out.back().offset;
+            continue;
+          }
+          file_handle::extent_flag flags(file_handle::extent_flag::none);
+          if(e.fe_flags & FIEMAP_EXTENT_UNKNOWN_)
+          {
+            flags |= file_handle::extent_flag::unknown_location;
+          }
+          if(e.fe_flags & FIEMAP_EXTENT_DELALLOC_)
+          {
+            flags |= file_handle::extent_flag::delayed_allocation;
+          }
+          if(e.fe_flags & (FIEMAP_EXTENT_ENCODED_ | FIEMAP_EXTENT_DATA_ENCRYPTED_))
+          {
+            flags |= file_handle::extent_flag::encoded;
+          }
+          if(e.fe_flags & FIEMAP_EXTENT_DATA_INLINE_)
+          {
+            flags |= file_handle::extent_flag::inline_data;
+          }
+          if(e.fe_flags & FIEMAP_EXTENT_UNWRITTEN_)
+          {
+            flags |= file_handle::extent_flag::unwritten;
+          }
+          if(e.fe_flags & FIEMAP_EXTENT_SHARED_)
+          {
+            flags |= file_handle::extent_flag::shared;
+          }
+          out.emplace_back(e.fe_logical, e.fe_length, (e.fe_flags & FIEMAP_EXTENT_UNKNOWN_) ? (file_handle::extent_type) -1 : e.fe_physical, flags);
+        }
+        const auto &e = fe[fm->fm_mapped_extents - 1];
+        if(last || e.fe_logical + e.fe_length <= pos)
+        {
+          break;
+        }
+        pos = e.fe_logical + e.fe_length;
+      }
+      return true;
+    }
+    catch(...)
+    {
+      return error_from_exception();
+    }
+  }
+}  // namespace detail
+#endif
+
+result<std::vector<file_handle::extent_info>> file_handle::detailed_extents() const noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+  try
+  {
+    std::vector<file_handle::extent_info> out;
+#ifdef __linux__
+    OUTCOME_TRY(auto &&supported, detail::fiemap_extents(out, _v.fd, 0, (extent_type) -1, false, false));
+    if(supported)
+    {
+      return out;
+    }
+#endif
+    OUTCOME_TRY(auto &&valid, file_handle::extents());
+    out.reserve(valid.size());
+    for(auto &i : valid)
+    {
+      out.emplace_back(i.offset, i.length, (extent_type) -1, extent_flag::unknown_location);
+    }
+    return out;
+  }
+  catch(...)
+  {
+    return error_from_exception();
+  }
+}
+
 result<std::vector<file_handle::extent_pair>> file_handle::extents() const noexcept
 {
   LLFIO_LOG_FUNCTION_CALL(this);
   try
   {
     std::vector<file_handle::extent_pair> out;
+#ifdef __linux__
+    {
+      std::vector<file_handle::extent_info> infos;
+      OUTCOME_TRY(auto &&supported, detail::fiemap_extents(infos, _v.fd, 0, (extent_type) -1, true, true));
+      if(supported)
+      {
+        // Extents preallocated beyond the end of the file are not valid data
+        OUTCOME_TRY(auto &&size, file_handle::maximum_extent());
+        out.reserve(infos.size());
+        for(auto &i : infos)
+        {
+          if(i.offset < size)
+          {
+            out.emplace_back(i.offset, std::min(i.length, size - i.offset));
+          }
+        }
+        return out;
+      }
+    }
+#endif
     out.reserve(64);
     extent_type start = 0, end = 0;
     for(;;)
@@ -434,7 +608,7 @@ result<std::vector<file_handle::extent_pair>> file_handle::extents() const noexc
 }
 
 result<file_handle::extent_pair> file_handle::clone_extents_to(file_handle::extent_pair extent, byte_io_handle &dest_, byte_io_handle::extent_type destoffset, deadline d,
-                                                               bool force_copy_now, bool emulate_if_unsupported) noexcept
+                                                               bool force_copy_now, bool emulate_if_unsupported, file_handle::clone_method *method) noexcept
 {
   try
   {
@@ -443,6 +617,12 @@ result<file_handle::extent_pair> file_handle::clone_extents_to(file_handle::exte
     {
       return errc::bad_file_descriptor;
     }
+    auto used = [&](clone_method m) {
+      if(method != nullptr)
+      {
+        *method |= m;
+      }
+    };
     OUTCOME_TRY(auto &&mycurrentlength, maximum_extent());
     if(extent.offset == (extent_type) -1 && extent.length == (extent_type) -1)
     {
@@ -508,6 +688,7 @@ result<file_handle::extent_pair> file_handle::clone_extents_to(file_handle::exte
         destoffset += written;
         extent.length -= written;
         ret.length += written;
+        used(clone_method::kernel_copied);
         if(extent.length == 0)
         {
           break;
@@ -552,6 +733,7 @@ result<file_handle::extent_pair> file_handle::clone_extents_to(file_handle::exte
         destoffset += written;
         extent.length -= written;
         ret.length += written;
+        used(clone_method::copied);
       }
       return ret;
     }
@@ -572,13 +754,45 @@ result<file_handle::extent_pair> file_handle::clone_extents_to(file_handle::exte
     todo.reserve(8);
     // Firstly fill todo with the list of allocated and non-allocated extents
     {
+      bool enumerated = false;
+#ifdef __linux__
+      {
+        // FIEMAP returns up to a thousand extents per syscall, rather than two syscalls per extent
+        std::vector<extent_info> valid;
+        OUTCOME_TRY(enumerated, detail::fiemap_extents(valid, _v.fd, extent.offset, extent.length, true, true));
+        if(enumerated)
+        {
+          const extent_type endpos = extent.offset + extent.length;
+          extent_type pos = extent.offset;
+          for(auto &i : valid)
+          {
+            const auto clampedstart = std::max(i.offset, pos);
+            const auto clampedend = std::min(i.offset + i.length, endpos);
+            if(clampedend <= clampedstart)
+            {
+              continue;
+            }
+            if(clampedstart > pos)
+            {
+              todo.push_back(workitem{extent_pair(pos, clampedstart - pos), workitem::delete_extents});
+            }
+            todo.push_back(workitem{extent_pair(clampedstart, clampedend - clampedstart), workitem::clone_extents});
+            pos = clampedend;
+          }
+          if(pos < endpos)
+          {
+            todo.push_back(workitem{extent_pair(pos, endpos - pos), workitem::delete_extents});
+          }
+        }
+      }
+#endif
 #if defined(SEEK_DATA) && !defined(__APPLE__)
       /* Apple's SEEK_HOLE implementation is basically unusable. I discovered this the
       hard way :). There is lots of useful detail as to why at
       https://lists.gnu.org/archive/html/bug-gnulib/2018-09/msg00054.html
       */
       extent_type start = 0, end = 0;
-      for(;;)
+      while(!enumerated)
       {
 #ifdef __linux__
         if(1)
@@ -663,7 +877,10 @@ result<file_handle::extent_pair> file_handle::clone_extents_to(file_handle::exte
         }
       }
 #else
-      todo.push_back(workitem{{extent.offset, extent.length}, workitem::clone_extents});
+      if(!enumerated)
+      {
+        todo.push_back(workitem{{extent.offset, extent.length}, workitem::clone_extents});
+      }
 #endif
     }
     // Handle there being insufficient source to fill dest
@@ -801,9 +1018,66 @@ result<file_handle::extent_pair> file_handle::clone_extents_to(file_handle::exte
       return -1;
 #endif
     };
+#ifdef __linux__
+    /* FICLONERANGE always clones by reference, or fails. copy_file_range() may or may
+    not clone by reference depending on kernel version and filesystem, and may silently
+    copy bytes instead, so prefer the former where the offsets are block aligned.
+    */
+    struct file_clone_range_t
+    {
+      int64_t src_fd;
+      uint64_t src_offset;
+      uint64_t src_length;
+      uint64_t dest_offset;
+    };
+    bool reflink_extents = duplicate_extents && dest.unique_id() != unique_id();
+    extent_type reflink_blocksize = 0;
+    if(reflink_extents)
+    {
+      struct stat s;
+      memset(&s, 0, sizeof(s));
+      if(-1 == ::fstat(dest.native_handle().fd, &s) || s.st_blksize <= 0 || (s.st_blksize & (s.st_blksize - 1)) != 0 ||
+         (destoffset & (s.st_blksize - 1)) != (extent.offset & (s.st_blksize - 1)))
+      {
+        reflink_extents = false;
+      }
+      else
+      {
+        reflink_blocksize = s.st_blksize;
+      }
+    }
+#endif
     for(const workitem &item : todo)
     {
-      for(extent_type thisoffset = 0; thisoffset < item.src.length; thisoffset += blocksize)
+      extent_type thisoffset = 0;
+#ifdef __linux__
+      if(reflink_extents && item.op == workitem::clone_extents && (item.src.offset & (reflink_blocksize - 1)) == 0)
+      {
+        // The length must be block aligned, unless the range ends at the end of the source
+        const extent_type tocopy = (item.src.offset + item.src.length == mycurrentlength) ? item.src.length : (item.src.length & ~(reflink_blocksize - 1));
+        if(tocopy > 0)
+        {
+          file_clone_range_t fcr{_v.fd, item.src.offset, tocopy, item.src.offset + destoffsetdiff};
+          if(-1 == ::ioctl(dest.native_handle().fd, _IOW(0x94, 13, file_clone_range_t) /*FICLONERANGE*/, &fcr))
+          {
+            // EINVAL means this particular range could not be cloned, anything else means no range can be
+            if(EINVAL != errno)
+            {
+              reflink_extents = false;
+            }
+          }
+          else
+          {
+            thisoffset = tocopy;
+            dest_length = destoffset + extent.length;
+            truncate_back_on_failure = false;
+            ret.length += tocopy;
+            used(clone_method::reflinked);
+          }
+        }
+      }
+#endif
+      for(; thisoffset < item.src.length; thisoffset += blocksize)
       {
       retry_clone:
         bool done = false;
@@ -822,10 +1096,12 @@ result<file_handle::extent_pair> file_handle::clone_extents_to(file_handle::exte
           }
           else if((size_t) bytes_cloned == thisblock)
           {
+            used(clone_method::kernel_copied);
             done = true;
           }
           else
           {
+            used(clone_method::kernel_copied);
             thisoffset += bytes_cloned;
             goto retry_clone;
           }
@@ -893,6 +1169,7 @@ result<file_handle::extent_pair> file_handle::clone_extents_to(file_handle::exte
               return errc::resource_unavailable_try_again;  // something is wrong
             }
           }
+          used(clone_method::copied);
           done = true;
         }
         if(!done && !item.destination_extents_are_new && (zero_extents && item.op == workitem::delete_extents))
@@ -993,4 +1270,128 @@ result<file_handle::extent_type> file_handle::zero(file_handle::extent_pair exte
   }
 }
 
+result<file_handle::extent_type> file_handle::preallocate(file_handle::extent_pair extent, deadline d) noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+  if(extent.offset + extent.length < extent.offset)
+  {
+    return errc::value_too_large;
+  }
+  if(extent.length == 0)
+  {
+    return 0;
+  }
+#if defined(__linux__)
+  if(-1 != fallocate(_v.fd, 0x01 /*FALLOC_FL_KEEP_SIZE*/, extent.offset, extent.length))
+  {
+    return extent.length;
+  }
+  if(EOPNOTSUPP != errno)
+  {
+    return posix_error();
+  }
+#endif
+  /* FreeBSD's posix_fallocate() always extends the file, and Apple's F_PREALLOCATE
+  allocates relative to the physical end of file rather than at an offset, so
+  neither can honour this contract.
+  */
+  return detail::file_handle_preallocate_emulated(*this, extent, d);
+}
+
+result<file_handle::extent_type> file_handle::zero_range(file_handle::extent_pair extent, deadline d) noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+  if(extent.offset + extent.length < extent.offset)
+  {
+    return errc::value_too_large;
+  }
+  if(extent.length == 0)
+  {
+    return 0;
+  }
+#if defined(__linux__)
+  if(-1 != fallocate(_v.fd, 0x10 /*FALLOC_FL_ZERO_RANGE*/, extent.offset, extent.length))
+  {
+    return extent.length;
+  }
+  if(EOPNOTSUPP != errno)
+  {
+    return posix_error();
+  }
+#endif
+  return detail::file_handle_write_zeros(*this, extent, d);
+}
+
+result<file_handle::extent_type> file_handle::collapse_range(file_handle::extent_pair extent, deadline d, bool emulate_if_unsupported) noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+  if(extent.offset + extent.length < extent.offset)
+  {
+    return errc::value_too_large;
+  }
+  OUTCOME_TRY(auto &&size, maximum_extent());
+  if(extent.offset >= size || extent.length == 0)
+  {
+    return size;
+  }
+  if(extent.offset + extent.length >= size)
+  {
+    return truncate(extent.offset);
+  }
+#if defined(__linux__)
+  if(-1 != fallocate(_v.fd, 0x08 /*FALLOC_FL_COLLAPSE_RANGE*/, extent.offset, extent.length))
+  {
+    return size - extent.length;
+  }
+  // EINVAL means the range is not block aligned
+  if(EOPNOTSUPP != errno && EINVAL != errno)
+  {
+    return posix_error();
+  }
+#endif
+  if(!emulate_if_unsupported)
+  {
+    return errc::operation_not_supported;
+  }
+  return detail::file_handle_collapse_range_emulated(*this, extent, size, d);
+}
+
+result<file_handle::extent_type> file_handle::insert_range(file_handle::extent_pair extent, deadline d, bool emulate_if_unsupported) noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+  OUTCOME_TRY(auto &&size, maximum_extent());
+  if(size + extent.length < size)
+  {
+    return errc::value_too_large;
+  }
+  if(extent.offset > size)
+  {
+    return errc::invalid_argument;
+  }
+  if(extent.length == 0)
+  {
+    return size;
+  }
+  if(extent.offset == size)
+  {
+    return truncate(size + extent.length);
+  }
+#if defined(__linux__)
+  if(-1 != fallocate(_v.fd, 0x20 /*FALLOC_FL_INSERT_RANGE*/, extent.offset, extent.length))
+  {
+    return size + extent.length;
+  }
+  // EINVAL means the range is not block aligned
+  if(EOPNOTSUPP != errno && EINVAL != errno)
+  {
+    return posix_error();
+  }
+#endif
+  if(!emulate_if_unsupported)
+  {
+    return errc::operation_not_supported;
+  }
+  return detail::file_handle_insert_range_emulated(*this, extent, size, d);
+}
+
 LLFIO_V2_NAMESPACE_END
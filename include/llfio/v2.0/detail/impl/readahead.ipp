@@ -0,0 +1,479 @@
+/* A read-ahead prefetching stream reader
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../../algorithm/readahead.hpp"
+#include "../../utils.hpp"
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+LLFIO_V2_NAMESPACE_BEGIN
+
+namespace algorithm
+{
+  namespace detail
+  {
+    struct readahead_stream_impl
+    {
+      using extent_type = byte_io_handle::extent_type;
+      using size_type = byte_io_handle::size_type;
+      using buffer_type = byte_io_handle::buffer_type;
+      using registered_buffer_type = byte_io_handle::registered_buffer_type;
+
+      enum class slot_state
+      {
+        free,     // holds nothing
+        queued,   // awaiting a filler
+        reading,  // being read by a filler or the consumer
+        ready     // holds data or an error
+      };
+      struct slot_t
+      {
+        slot_state state{slot_state::free};
+        extent_type offset{0};
+        registered_buffer_type buffer;
+        span<const byte> data;
+        result<void> error{success()};
+        uint64_t lastused{0};
+      };
+      struct filler_t final : public dynamic_thread_pool_group::work_item
+      {
+        readahead_stream_impl *parent{nullptr};
+
+        virtual intptr_t next(deadline & /*unused*/) noexcept override
+        {
+          std::lock_guard<std::mutex> g(parent->lock);
+          if(!parent->stopping)
+          {
+            for(size_t n = 0; n < parent->slots.size(); n++)
+            {
+              if(parent->slots[n].state == slot_state::queued)
+              {
+                parent->slots[n].state = slot_state::reading;
+                return (intptr_t) n + 1;
+              }
+            }
+          }
+          // Nothing left to read ahead, so retire until the consumer queues more
+          return -1;
+        }
+        virtual result<void> operator()(intptr_t work) noexcept override
+        {
+          parent->fill(parent->slots[(size_t) work - 1]);
+          return success();
+        }
+        virtual void group_complete(const result<void> & /*unused*/) noexcept override
+        {
+          std::unique_lock<std::mutex> g(parent->lock);
+          if(++parent->completed < parent->concurrency)
+          {
+            return;
+          }
+          // All the fillers have retired, but the consumer may have queued more
+          // read aheads after they last looked
+          parent->running = false;
+          parent->changed.notify_all();
+          parent->kick(g);
+        }
+      };
+      byte_io_handle *h{nullptr};
+      size_t buffer_size{0}, alignment{0};
+      std::mutex lock;
+      std::condition_variable changed;
+      std::vector<slot_t> slots;
+      std::unique_ptr<filler_t[]> fillers;
+      size_t concurrency{0};
+      dynamic_thread_pool_group_ptr group;
+      bool stopping{false};
+      bool running{false};  // fillers are submitted and not all have completed
+      size_t completed{0};  // fillers which have completed since last submitted
+      slot_t *current{nullptr};
+      uint64_t tick{0};
+      extent_type eof{(extent_type) -1};
+
+      // Pattern detection
+      bool have_last{false};
+      extent_type last_offset{0}, last_end{0};
+      int64_t stride{0};
+      unsigned confidence{0};
+
+      readahead_stream::statistics stats;
+
+      readahead_stream_impl() = default;
+      readahead_stream_impl(const readahead_stream_impl &) = delete;
+      readahead_stream_impl(readahead_stream_impl &&) = delete;
+      readahead_stream_impl &operator=(const readahead_stream_impl &) = delete;
+      readahead_stream_impl &operator=(readahead_stream_impl &&) = delete;
+      ~readahead_stream_impl()
+      {
+        if(group)
+        {
+          {
+            std::lock_guard<std::mutex> g(lock);
+            stopping = true;
+          }
+          (void) group->stop();
+          (void) group->wait();
+          std::unique_lock<std::mutex> g(lock);
+          while(running)
+          {
+            changed.wait(g);
+          }
+        }
+      }
+
+      // Submits the fillers if there are read aheads queued and they are not
+      // already running. Must be called with the lock held, which may be released.
+      void kick(std::unique_lock<std::mutex> &g) noexcept
+      {
+        if(running || stopping)
+        {
+          return;
+        }
+        bool queued = false;
+        for(auto &s : slots)
+        {
+          if(s.state == slot_state::queued)
+          {
+            queued = true;
+            break;
+          }
+        }
+        if(!queued)
+        {
+          return;
+        }
+        running = true;
+        completed = 0;
+        g.unlock();
+        auto r = group->submit(span<filler_t>(fillers.get(), concurrency));
+        g.lock();
+        if(!r)
+        {
+          // The consumer reads any queued slots itself
+          running = false;
+          changed.notify_all();
+        }
+      }
+
+      extent_type align(extent_type offset) const noexcept { return offset & ~(extent_type) (alignment - 1); }
+
+      // Must be called with the slot in the reading state and the lock NOT held
+      void fill(slot_t &s) noexcept
+      {
+        const extent_type offset = s.offset;
+        buffer_type b(s.buffer->data(), buffer_size);
+        auto r = h->read(s.buffer, {{&b, 1}, offset});
+        std::lock_guard<std::mutex> g(lock);
+        if(r)
+        {
+          s.data = r.value().empty() ? span<const byte>() : span<const byte>(r.value()[0].data(), r.value()[0].size());
+          s.error = success();
+          if(s.data.size() < buffer_size)
+          {
+            if(offset + s.data.size() < eof)
+            {
+              eof = offset + s.data.size();
+            }
+          }
+          else if(offset + s.data.size() > eof)
+          {
+            eof = (extent_type) -1;  // file has grown
+          }
+        }
+        else
+        {
+          s.data = {};
+          s.error = std::move(r).error();
+        }
+        s.state = slot_state::ready;
+        changed.notify_all();
+      }
+
+      slot_t *find(extent_type offset) noexcept
+      {
+        for(auto &s : slots)
+        {
+          if(s.state != slot_state::free && offset >= s.offset && offset < s.offset + buffer_size)
+          {
+            return &s;
+          }
+        }
+        return nullptr;
+      }
+
+      slot_t *free_slot() noexcept
+      {
+        for(auto &s : slots)
+        {
+          if(s.state == slot_state::free)
+          {
+            return &s;
+          }
+        }
+        return nullptr;
+      }
+
+      // Chooses a slot for a synchronous read, preferring free, then least recently used, then queued
+      slot_t *victim() noexcept
+      {
+        if(auto *s = free_slot())
+        {
+          return s;
+        }
+        slot_t *ret = nullptr;
+        for(auto &s : slots)
+        {
+          if(&s != current && s.state == slot_state::ready && (ret == nullptr || s.lastused < ret->lastused))
+          {
+            ret = &s;
+          }
+        }
+        if(ret != nullptr)
+        {
+          return ret;
+        }
+        for(auto &s : slots)
+        {
+          if(s.state == slot_state::queued)
+          {
+            return &s;
+          }
+        }
+        return nullptr;
+      }
+    };
+  }  // namespace detail
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC readahead_stream::readahead_stream(readahead_stream &&o) noexcept
+      : _p(std::move(o._p))
+  {
+  }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC readahead_stream &readahead_stream::operator=(readahead_stream &&o) noexcept
+  {
+    _p = std::move(o._p);
+    return *this;
+  }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC readahead_stream::~readahead_stream() = default;
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<readahead_stream> readahead_stream::create(byte_io_handle &h, config c) noexcept
+  {
+    LLFIO_LOG_FUNCTION_CALL(&h);
+    if(!h.is_seekable())
+    {
+      return errc::invalid_argument;
+    }
+    try
+    {
+      auto p = std::make_unique<detail::readahead_stream_impl>();
+      p->h = &h;
+      p->alignment = utils::page_size();
+      p->buffer_size = utils::round_up_to_page_size((c.buffer_size != 0) ? c.buffer_size : utils::file_buffer_default_size(), p->alignment);
+      p->slots.resize(std::max(c.buffers, (size_t) 2));
+      for(auto &s : p->slots)
+      {
+        size_t bytes = p->buffer_size;
+        OUTCOME_TRY(auto &&buffer, h.allocate_registered_buffer(bytes));
+        s.buffer = std::move(buffer);
+      }
+      OUTCOME_TRY(auto &&group, make_dynamic_thread_pool_group());
+      p->group = std::move(group);
+      // The fillers are only submitted when there is something to read ahead
+      p->concurrency = std::max(c.concurrency, (size_t) 1);
+      p->fillers.reset(new detail::readahead_stream_impl::filler_t[p->concurrency]);
+      for(size_t n = 0; n < p->concurrency; n++)
+      {
+        p->fillers[n].parent = p.get();
+      }
+      return readahead_stream(std::move(p));
+    }
+    catch(...)
+    {
+      return error_from_exception();
+    }
+  }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC byte_io_handle *readahead_stream::handle() const noexcept { return (_p != nullptr) ? _p->h : nullptr; }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC readahead_stream::statistics readahead_stream::stats() const noexcept
+  {
+    if(_p == nullptr)
+    {
+      return {};
+    }
+    std::lock_guard<std::mutex> g(_p->lock);
+    return _p->stats;
+  }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<span<const byte>> readahead_stream::read(extent_type offset, size_type bytes) noexcept
+  {
+    using slot_state = detail::readahead_stream_impl::slot_state;
+    using slot_t = detail::readahead_stream_impl::slot_t;
+    if(_p == nullptr)
+    {
+      return errc::bad_file_descriptor;
+    }
+    auto &p = *_p;
+    LLFIO_LOG_FUNCTION_CALL(p.h);
+    std::unique_lock<std::mutex> g(p.lock);
+
+    // Update the access pattern
+    const bool sequential = !p.have_last || offset == p.last_end;
+    if(p.have_last)
+    {
+      const auto thisstride = (int64_t) (offset - p.last_offset);
+      if(thisstride == p.stride)
+      {
+        if(p.confidence < 4)
+        {
+          p.confidence++;
+        }
+      }
+      else
+      {
+        p.stride = thisstride;
+        p.confidence = 0;
+      }
+    }
+    p.have_last = true;
+    p.last_offset = offset;
+    p.last_end = offset;
+    const bool predictable = sequential || p.confidence >= 1;
+    if(!predictable)
+    {
+      // Cancel any read aheads not yet begun, they are no longer likely to be wanted
+      for(auto &i : p.slots)
+      {
+        if(i.state == slot_state::queued)
+        {
+          i.state = slot_state::free;
+        }
+      }
+    }
+
+    // Find or fetch the data
+    slot_t *s = p.find(offset);
+    if(s == nullptr)
+    {
+      while(nullptr == (s = p.victim()))
+      {
+        p.changed.wait(g);
+      }
+      s->state = slot_state::reading;
+      s->offset = p.align(offset);
+      p.stats.misses++;
+      g.unlock();
+      p.fill(*s);
+      g.lock();
+    }
+    else if(s->state == slot_state::queued)
+    {
+      // Rather than wait for a filler to get round to it, read it now
+      s->state = slot_state::reading;
+      p.stats.misses++;
+      g.unlock();
+      p.fill(*s);
+      g.lock();
+    }
+    else if(s->state == slot_state::reading)
+    {
+      p.stats.waits++;
+      while(s->state != slot_state::ready)
+      {
+        p.changed.wait(g);
+      }
+    }
+    else
+    {
+      p.stats.hits++;
+    }
+    if(!s->error)
+    {
+      result<void> ret(std::move(s->error));
+      s->error = success();
+      s->state = slot_state::free;
+      return std::move(ret).error();
+    }
+    s->lastused = ++p.tick;
+    p.current = s;
+
+    if(predictable)
+    {
+      // Release buffers behind the direction of travel
+      for(auto &i : p.slots)
+      {
+        if(&i != s && i.state == slot_state::ready && ((p.stride >= 0 && i.offset + p.buffer_size <= offset) || (p.stride < 0 && i.offset > offset)))
+        {
+          i.state = slot_state::free;
+        }
+      }
+      // Queue read aheads of the predicted next blocks into whatever buffers are free
+      const bool contiguous = sequential || (uint64_t) (p.stride < 0 ? -p.stride : p.stride) <= p.buffer_size;
+      const int64_t step = contiguous ? ((p.stride < 0 && !sequential) ? -(int64_t) p.buffer_size : (int64_t) p.buffer_size) : p.stride;
+      const int64_t base = contiguous ? (int64_t) s->offset : (int64_t) offset;
+      for(size_t k = 1; k < p.slots.size(); k++)
+      {
+        const int64_t next = base + step * (int64_t) k;
+        if(next < 0)
+        {
+          break;
+        }
+        const extent_type o = p.align((extent_type) next);
+        if(o >= p.eof)
+        {
+          break;
+        }
+        if(p.find(o) != nullptr)
+        {
+          continue;
+        }
+        slot_t *f = p.free_slot();
+        if(f == nullptr)
+        {
+          break;
+        }
+        f->state = slot_state::queued;
+        f->offset = o;
+        f->data = {};
+        p.stats.prefetches++;
+      }
+      p.kick(g);
+    }
+
+    const extent_type rel = offset - s->offset;
+    if(rel >= s->data.size())
+    {
+      return span<const byte>();
+    }
+    auto ret = s->data.subspan((size_t) rel, (size_t) std::min((extent_type) bytes, (extent_type) s->data.size() - rel));
+    // A short view means the next read will probably be for the remainder
+    p.last_end = offset + ret.size();
+    return ret;
+  }
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
@@ -0,0 +1,257 @@
+/* A page cache pollution free streaming reader for file handles
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../../algorithm/scan_stream.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
+
+LLFIO_V2_NAMESPACE_BEGIN
+
+namespace algorithm
+{
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void scan_stream::_init(extent_type offset, config c) noexcept
+  {
+    const auto pagesize = (extent_type) utils::page_size();
+    _chunk_size = (c.chunk_size != 0) ? c.chunk_size : (extent_type) utils::file_buffer_default_size();
+    _chunk_size = (_chunk_size + pagesize - 1) & ~(pagesize - 1);
+    _lookahead_chunks = (c.lookahead_chunks != 0) ? c.lookahead_chunks : 1;
+    _drop_preexisting_pages = c.drop_preexisting_pages;
+    _cursor = _pending_end = offset;
+    _sampled_to = offset - (offset % _chunk_size);
+#if !defined(_WIN32) && defined(POSIX_FADV_NOREUSE)
+    if(c.use_noreuse)
+    {
+      (void) ::posix_fadvise(_h->native_handle().fd, 0, 0, POSIX_FADV_NOREUSE);
+    }
+#else
+    (void) c.use_noreuse;
+#endif
+  }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<void> scan_stream::_sample(extent_type offset, extent_type bytes) noexcept
+  {
+    try
+    {
+      const auto pagesize = (extent_type) utils::page_size();
+      _chunk_residency chunk;
+      chunk.offset = offset;
+      chunk.resident.resize((size_t) (bytes / pagesize));
+#ifndef _WIN32
+#ifdef __linux__
+      using mincore_vec_type = unsigned char;
+#else
+      using mincore_vec_type = char;
+#endif
+      if(_mh != nullptr)
+      {
+        const extent_type maplength = _mh->map().length();
+        if(offset < maplength)
+        {
+          const auto tosample = (size_t) std::min(bytes, maplength - offset);
+          if(-1 == ::mincore(_mh->address() + offset, tosample, reinterpret_cast<mincore_vec_type *>(chunk.resident.data())))
+          {
+            return posix_error();
+          }
+        }
+      }
+      else
+      {
+        // Mapping the file without touching it faults nothing in, so we see the residency
+        // of the page cache as it is.
+        void *addr = ::mmap(nullptr, (size_t) bytes, PROT_READ, MAP_SHARED, _h->native_handle().fd, (off_t) offset);
+        if(MAP_FAILED == addr)
+        {
+          // If we can't tell, be conservative and assume somebody else is using everything
+          memset(chunk.resident.data(), 1, chunk.resident.size());
+        }
+        else
+        {
+          auto unaddr = make_scope_exit([&]() noexcept { ::munmap(addr, (size_t) bytes); });
+          if(-1 == ::mincore(addr, (size_t) bytes, reinterpret_cast<mincore_vec_type *>(chunk.resident.data())))
+          {
+            return posix_error();
+          }
+        }
+      }
+#endif
+      _chunks.push_back(std::move(chunk));
+      return success();
+    }
+    catch(...)
+    {
+      return error_from_exception();
+    }
+  }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void scan_stream::_drop(const _chunk_residency &chunk, extent_type bytes) noexcept
+  {
+    const auto pagesize = (extent_type) utils::page_size();
+    const auto pages = std::min((size_t) ((bytes + pagesize - 1) / pagesize), chunk.resident.size());
+    auto drop = [&](size_t begin, size_t end) {
+      if(begin == end)
+      {
+        return;
+      }
+      const extent_type offset = chunk.offset + begin * pagesize, length = (end - begin) * pagesize;
+#ifndef _WIN32
+      if(_mh != nullptr)
+      {
+        // The kernel won't drop pages which are mapped, so unmap them from ourselves first
+        const extent_type maplength = _mh->map().length();
+        if(offset < maplength)
+        {
+          (void) ::madvise(_mh->address() + offset, (size_t) std::min(length, maplength - offset), MADV_DONTNEED);
+        }
+      }
+#ifdef POSIX_FADV_DONTNEED
+      (void) ::posix_fadvise(_h->native_handle().fd, (off_t) offset, (off_t) length, POSIX_FADV_DONTNEED);
+#endif
+      _stats.pages_dropped += end - begin;
+#else
+      (void) offset;
+      (void) length;
+#endif
+    };
+    size_t runbegin = 0;
+    for(size_t n = 0; n < pages; n++)
+    {
+      if(!_drop_preexisting_pages && (chunk.resident[n] & 1) != 0)
+      {
+        drop(runbegin, n);
+        runbegin = n + 1;
+        _stats.pages_preserved++;
+      }
+    }
+    drop(runbegin, pages);
+  }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC scan_stream::io_result<scan_stream::buffers_type> scan_stream::read(io_request<buffers_type> reqs, deadline d) noexcept
+  {
+    LLFIO_LOG_FUNCTION_CALL(_h);
+    if(_h == nullptr)
+    {
+      return errc::bad_file_descriptor;
+    }
+    if(_pending_end > _cursor)
+    {
+      // Whatever was returned from the map last time is now consumed
+      OUTCOME_TRY(consumed(_cursor, _pending_end - _cursor));
+    }
+    extent_type bytes = 0;
+    for(auto &b : reqs.buffers)
+    {
+      bytes += b.size();
+    }
+    OUTCOME_TRY(about_to_consume(reqs.offset, bytes));
+    OUTCOME_TRY(auto &&ret, _h->read(reqs, d));
+    extent_type bytesread = 0;
+    for(auto &b : ret)
+    {
+      bytesread += b.size();
+    }
+    if(_mh != nullptr)
+    {
+      _pending_end = std::max(_pending_end, reqs.offset + bytesread);
+    }
+    else
+    {
+      OUTCOME_TRY(consumed(reqs.offset, bytesread));
+    }
+    return std::move(ret);
+  }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<void> scan_stream::about_to_consume(extent_type offset, extent_type bytes) noexcept
+  {
+    if(_h == nullptr)
+    {
+      return errc::bad_file_descriptor;
+    }
+    if(offset + bytes <= _cursor)
+    {
+      return success();
+    }
+    if(offset > _sampled_to)
+    {
+      // A jump forwards. Chunks in between are never sampled, and so never dropped.
+      _sampled_to = offset - (offset % _chunk_size);
+    }
+    const extent_type end = offset + bytes;
+    const extent_type want = end - (end % _chunk_size) + _chunk_size * (extent_type) (1 + _lookahead_chunks);
+    while(_sampled_to < want)
+    {
+      OUTCOME_TRY(_sample(_sampled_to, _chunk_size));
+      _sampled_to += _chunk_size;
+    }
+    return success();
+  }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<void> scan_stream::consumed(extent_type offset, extent_type bytes) noexcept
+  {
+    if(_h == nullptr)
+    {
+      return errc::bad_file_descriptor;
+    }
+    const extent_type end = offset + bytes;
+    if(end <= _cursor)
+    {
+      return success();
+    }
+    _cursor = end;
+    size_t n = 0;
+    for(; n < _chunks.size() && _chunks[n].offset + _chunk_size <= _cursor; n++)
+    {
+      _drop(_chunks[n], _chunk_size);
+    }
+    _chunks.erase(_chunks.begin(), _chunks.begin() + n);
+    return success();
+  }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<void> scan_stream::finish() noexcept
+  {
+    LLFIO_LOG_FUNCTION_CALL(_h);
+    if(_h == nullptr)
+    {
+      return errc::bad_file_descriptor;
+    }
+    if(_pending_end > _cursor)
+    {
+      OUTCOME_TRY(consumed(_cursor, _pending_end - _cursor));
+    }
+    for(auto &chunk : _chunks)
+    {
+      if(chunk.offset < _cursor)
+      {
+        _drop(chunk, _cursor - chunk.offset);
+      }
+    }
+    _chunks.clear();
+    _sampled_to = _cursor - (_cursor % _chunk_size);
+    return success();
+  }
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
@@ -22,10 +22,10 @@ Distributed under the Boost Software License, Version 1.0.
           http://www.boost.org/LICENSE_1_0.txt)
 */
 
+
 #include "../../algorithm/traverse.hpp"
 
 #include <atomic>
-#include <condition_variable>
 #include <iostream>
 #include <list>
 #include <memory>
@@ -43,418 +43,529 @@ Distributed under the Boost Software License, Version 1.0.
 
 LLFIO_V2_NAMESPACE_BEGIN
 
+#ifdef LLFIO_EXCLUDE_DYNAMIC_THREAD_POOL_GROUP
+class dynamic_thread_pool_group;
+#endif
+
 namespace algorithm
 {
-  LLFIO_HEADERS_ONLY_FUNC_SPEC result<size_t> traverse(const path_handle &_topdirh, traverse_visitor *visitor, size_t threads, void *data,
-                                                       bool force_slow_path) noexcept
+  namespace detail
   {
-    return visitor->finished(
-    data,
-    [&]() -> result<size_t>
+#ifndef _WIN32
+    inline size_t traverse_rlimit_maxfd() noexcept
     {
-      try
+      static const size_t v = []() -> size_t
       {
-        LLFIO_LOG_FUNCTION_CALL(&_topdirh);
-        std::shared_ptr<directory_handle> topdirh;
-        {
-          OUTCOME_TRY(auto &&dirh, directory_handle::directory(_topdirh, {}));
-          topdirh = std::make_shared<directory_handle>(std::move(dirh));
-        }
-        bool use_slow_path = force_slow_path;
-#ifndef _WIN32
-        static const size_t rlimit_maxfd = []() -> size_t
-        {
-          struct rlimit r;
-          if(getrlimit(RLIMIT_NOFILE, &r) >= 0)
-          {
-            return size_t(r.rlim_cur);
-          }
-          return 0;
-        }();
-        if(!use_slow_path)
+        struct rlimit r;
+        if(getrlimit(RLIMIT_NOFILE, &r) >= 0)
         {
-          if(rlimit_maxfd > 0 && rlimit_maxfd - topdirh->native_handle().fd < 65536)
-          {
-            use_slow_path = true;
-#ifndef NDEBUG
-            std::cerr << "WARNING: llfio::traverse() is using slow path due to " << (rlimit_maxfd - topdirh->native_handle().fd)
-                      << " unused file descriptors remaining! Raise the limit using setrlimit(RLIMIT_NOFILE) if your application is > 1024 fd count safe."
-                      << std::endl;
-#endif
-          }
+          return size_t(r.rlim_cur);
         }
+        return 0;
+      }();
+      return v;
+    }
 #endif
-        struct state_t
-        {
-          std::mutex lock;
-          size_t max_sso_path_size;
-          traverse_visitor *visitor{nullptr};
+
+    struct traverse_state
+    {
+      std::atomic<size_t> max_sso_path_size;
+      traverse_visitor *visitor{nullptr};
+      void *data{nullptr};
 #if 0
-        struct workitem
+    struct workitem
+    {
+      std::shared_ptr<directory_handle> dirh;
+      filesystem::path _leaf;
+      workitem() {}
+      workitem(std::shared_ptr<directory_handle> _dirh, path_view leaf)
+          : dirh(std::move(_dirh))
+          , _leaf(leaf.path())
+      {
+      }
+      path_view leaf() const noexcept { return _leaf; } 
+    };
+#else
+      struct workitem
+      {
+        std::shared_ptr<directory_handle> dirh;
+        bool using_sso{true};
+        uint8_t _sso_length{0};
+        union
         {
-          std::shared_ptr<directory_handle> dirh;
-          filesystem::path _leaf;
-          workitem() {}
-          workitem(std::shared_ptr<directory_handle> _dirh, path_view leaf)
-              : dirh(std::move(_dirh))
-              , _leaf(leaf.path())
-          {
-          }
-          path_view leaf() const noexcept { return _leaf; } 
+          filesystem::path::value_type _sso[LLFIO_ALGORITHM_TRAVERSE_MAX_SSO_PATH_SIZE];
+          filesystem::path _alloc;
         };
-#else
-          struct workitem
+        workitem() {}
+        workitem(std::shared_ptr<directory_handle> _dirh, path_view stem, path_view leaf = {})
+            : dirh(std::move(_dirh))
+        {
+          _sso[0] = 0;
+          if(!stem.empty())
           {
-            std::shared_ptr<directory_handle> dirh;
-            bool using_sso{true};
-            uint8_t _sso_length{0};
-            union
-            {
-              filesystem::path::value_type _sso[LLFIO_ALGORITHM_TRAVERSE_MAX_SSO_PATH_SIZE];
-              filesystem::path _alloc;
-            };
-            workitem() {}
-            workitem(std::shared_ptr<directory_handle> _dirh, path_view stem, path_view leaf = {})
-                : dirh(std::move(_dirh))
+            size_t bytes = (1 + stem.native_size()) * sizeof(filesystem::path::value_type);
+            if(!leaf.empty())
             {
-              _sso[0] = 0;
-              if(!stem.empty())
-              {
-                size_t bytes = (1 + stem.native_size()) * sizeof(filesystem::path::value_type);
-                if(!leaf.empty())
-                {
-                  bytes += (1 + leaf.native_size()) * sizeof(filesystem::path::value_type);
-                }
-                if(bytes <= sizeof(_sso))
-                {
-                  using_sso = true;
-                  visit(stem,
-                        [&](auto sv)
-                        {
-                          memcpy(_sso, sv.data(), sv.size() * sizeof(filesystem::path::value_type));
-                          _sso_length = (uint8_t) sv.size();
-                        });
-                  if(!leaf.empty())
-                  {
-                    _sso[_sso_length++] = filesystem::path::preferred_separator;
-                    visit(leaf,
-                          [&](auto sv)
-                          {
-                            memcpy(_sso + _sso_length, sv.data(), sv.size() * sizeof(filesystem::path::value_type));
-                            _sso_length += (uint8_t) sv.size();
-                          });
-                  }
-                  _sso[_sso_length] = 0;
-                  assert(_sso_length < LLFIO_ALGORITHM_TRAVERSE_MAX_SSO_PATH_SIZE);
-                }
-                else
-                {
-                  new(&_alloc) filesystem::path(stem / leaf);
-                  using_sso = false;
-                }
-              }
+              bytes += (1 + leaf.native_size()) * sizeof(filesystem::path::value_type);
             }
-            ~workitem()
+            if(bytes <= sizeof(_sso))
             {
-              if(!using_sso)
+              using_sso = true;
+              visit(stem,
+                    [&](auto sv)
+                    {
+                      memcpy(_sso, sv.data(), sv.size() * sizeof(filesystem::path::value_type));
+                      _sso_length = (uint8_t) sv.size();
+                    });
+              if(!leaf.empty())
               {
-                _alloc.~path();
-                using_sso = true;
+                _sso[_sso_length++] = filesystem::path::preferred_separator;
+                visit(leaf,
+                      [&](auto sv)
+                      {
+                        memcpy(_sso + _sso_length, sv.data(), sv.size() * sizeof(filesystem::path::value_type));
+                        _sso_length += (uint8_t) sv.size();
+                      });
               }
+              _sso[_sso_length] = 0;
+              assert(_sso_length < LLFIO_ALGORITHM_TRAVERSE_MAX_SSO_PATH_SIZE);
             }
-#if _MSC_VER < 1933  // <= VS2022.2
-            // MSVC's list::splice() always copies :(
-            workitem(const workitem &o) noexcept
-                : workitem(const_cast<workitem &&>(std::move(o)))
+            else
             {
+              new(&_alloc) filesystem::path(stem / leaf);
+              using_sso = false;
             }
+          }
+        }
+        ~workitem()
+        {
+          if(!using_sso)
+          {
+            _alloc.~path();
+            using_sso = true;
+          }
+        }
+#if _MSC_VER < 1933  // <= VS2022.2
+        // MSVC's list::splice() always copies :(
+        workitem(const workitem &o) noexcept
+            : workitem(const_cast<workitem &&>(std::move(o)))
+        {
+        }
 #else
-            workitem(const workitem &) = delete;
+        workitem(const workitem &) = delete;
 #endif
-            workitem &operator=(const workitem &) = delete;
-            workitem(workitem &&o) noexcept
-                : dirh(std::move(o.dirh))
-                , using_sso(o.using_sso)
-                , _sso_length(o._sso_length)
-            {
-              if(using_sso)
-              {
-                memcpy(_sso, o._sso, (1 + _sso_length) * sizeof(filesystem::path::value_type));
-                o._sso_length = 0;
-              }
-              else
-              {
-                new(&_alloc) filesystem::path(std::move(o._alloc));
-                o._alloc.~path();
-                o.using_sso = true;
-              }
-            }
-            workitem &operator=(workitem &&o) noexcept
-            {
-              if(this == &o)
-              {
-                return *this;
-              }
-              this->~workitem();
-              new(this) workitem(std::move(o));
-              return *this;
-            }
-            path_view leaf() const noexcept { return using_sso ? path_view(_sso, _sso_length, path_view::zero_terminated) : path_view(_alloc); }
-          };
+        workitem &operator=(const workitem &) = delete;
+        workitem(workitem &&o) noexcept
+            : dirh(std::move(o.dirh))
+            , using_sso(o.using_sso)
+            , _sso_length(o._sso_length)
+        {
+          if(using_sso)
+          {
+            memcpy(_sso, o._sso, (1 + _sso_length) * sizeof(filesystem::path::value_type));
+            o._sso_length = 0;
+          }
+          else
+          {
+            new(&_alloc) filesystem::path(std::move(o._alloc));
+            o._alloc.~path();
+            o.using_sso = true;
+          }
+        }
+        workitem &operator=(workitem &&o) noexcept
+        {
+          if(this == &o)
+          {
+            return *this;
+          }
+          this->~workitem();
+          new(this) workitem(std::move(o));
+          return *this;
+        }
+        path_view leaf() const noexcept { return using_sso ? path_view(_sso, _sso_length, path_view::zero_terminated) : path_view(_alloc); }
+      };
 #endif
-          std::vector<std::list<workitem>> workqueue;
-          size_t workqueue_base{0};
-          size_t dirs_processed{0}, known_dirs_remaining{0}, depth_processed{0}, threads_sleeping{0}, threads_running{0};
 
-          explicit state_t(size_t _max_sso_path_size, traverse_visitor *_visitor)
-              : max_sso_path_size(_max_sso_path_size)
-              , visitor(_visitor)
+      // Each worker has its own queue of directories to enumerate, stealing from the others when it runs dry
+      struct queue_t
+      {
+        std::mutex lock;
+        std::vector<std::list<workitem>> levels;  // by depth
+        size_t base{0};                           // the least deep level which may be non-empty
+        std::atomic<size_t> count{0};
+      };
+      std::vector<queue_t> queues;
+      std::atomic<size_t> dirs_processed{0}, known_dirs_remaining{0}, depth_processed{0}, known_depth_remaining{0};
+      std::atomic<size_t> outstanding{0};  // directories queued or being enumerated
+      std::atomic<bool> failed{false};
+      std::mutex lock;
+      optional<result<void>::error_type> failure;
+
+      traverse_state(size_t _max_sso_path_size, traverse_visitor *_visitor, void *_data, size_t workers)
+          : max_sso_path_size(_max_sso_path_size)
+          , visitor(_visitor)
+          , data(_data)
+          , queues(workers)
+      {
+      }
+
+      void push(size_t idx, size_t level, std::list<workitem> &&items)
+      {
+        for(size_t depth = known_depth_remaining.load(std::memory_order_relaxed);
+            depth < level + 1 && !known_depth_remaining.compare_exchange_weak(depth, level + 1, std::memory_order_relaxed);)
+        {
+        }
+        const size_t count = items.size();
+        if(count == 0)
+        {
+          return;
+        }
+        // Count the items before another worker can pop them, else known_dirs_remaining could wrap
+        outstanding.fetch_add(count, std::memory_order_relaxed);
+        known_dirs_remaining.fetch_add(count, std::memory_order_release);
+        {
+          auto &q = queues[idx];
+          std::lock_guard<std::mutex> g(q.lock);
+          if(q.levels.size() < level + 1)
           {
+            q.levels.resize(level + 1);
           }
-        } state(use_slow_path ? size_t(-1) : LLFIO_ALGORITHM_TRAVERSE_MAX_SSO_PATH_SIZE, visitor);
-        struct worker
+          q.levels[level].splice(q.levels[level].end(), std::move(items));
+          if(level < q.base)
+          {
+            q.base = level;
+          }
+          q.count.fetch_add(count, std::memory_order_relaxed);
+        }
+      }
+
+      // Takes the least deep directory from our own queue, else from the first other queue with any
+      bool pop(size_t idx, workitem &item, size_t &level)
+      {
+        for(size_t n = 0; n < queues.size(); n++)
         {
-          state_t *state{nullptr};
-          std::vector<directory_handle::buffer_type> entries{4096};
-          directory_handle::buffers_type buffers;
+          auto &q = queues[(idx + n) % queues.size()];
+          if(q.count.load(std::memory_order_relaxed) == 0)
+          {
+            continue;
+          }
+          std::lock_guard<std::mutex> g(q.lock);
+          for(; q.base < q.levels.size(); q.base++)
+          {
+            if(!q.levels[q.base].empty())
+            {
+              item = std::move(q.levels[q.base].front());
+              q.levels[q.base].pop_front();
+              level = q.base;
+              q.count.fetch_sub(1, std::memory_order_relaxed);
+              known_dirs_remaining.fetch_sub(1, std::memory_order_relaxed);
+              depth_processed.store(level, std::memory_order_relaxed);
+              return true;
+            }
+          }
+        }
+        return false;
+      }
 
-          explicit worker(state_t *_state)
-              : state(_state)
+      void fail(result<void>::error_type &&error)
+      {
+        std::lock_guard<std::mutex> g(lock);
+        if(!failure)
+        {
+          failure = std::move(error);
+        }
+        failed.store(true, std::memory_order_release);
+      }
+    };
+
+    struct traverse_worker
+    {
+      traverse_state *state{nullptr};
+      size_t idx{0};
+      std::vector<directory_handle::buffer_type> entries{4096};
+      directory_handle::buffers_type buffers;
+
+      traverse_worker(traverse_state *_state, size_t _idx)
+          : state(_state)
+          , idx(_idx)
+      {
+      }
+
+      //! -1 if the traversal is done, 0 if no work is available right now, else 1
+      intptr_t next() const noexcept
+      {
+        if(state->failed.load(std::memory_order_acquire))
+        {
+          return -1;
+        }
+        if(state->known_dirs_remaining.load(std::memory_order_acquire) > 0)
+        {
+          return 1;
+        }
+        // Other workers may yet find more directories
+        return (state->outstanding.load(std::memory_order_acquire) > 0) ? 0 : -1;
+      }
+
+      //! Enumerates the next available directory, if any, recording any failure into the state
+      result<void> run() noexcept
+      {
+        try
+        {
+          traverse_state::workitem mywork;
+          size_t mylevel = 0;
+          if(!state->pop(idx, mywork, mylevel))
+          {
+            return success();
+          }
+          state->dirs_processed.fetch_add(1, std::memory_order_relaxed);
+          auto r = _enumerate(mywork, mylevel);
+          // Only now can the directories found be counted, else the traversal might appear done
+          state->outstanding.fetch_sub(1, std::memory_order_release);
+          if(!r)
           {
+            state->fail(std::move(r).error());
+            // Cancel all remaining work
+            return errc::operation_canceled;
           }
+          return success();
+        }
+        catch(...)
+        {
+          state->fail(error_from_exception());
+          return errc::operation_canceled;
+        }
+      }
 
-          result<void> run(std::unique_lock<std::mutex> &g, void *data)
+    private:
+      result<void> _enumerate(traverse_state::workitem &mywork, size_t mylevel)
+      {
+        void *data = state->data;
+        const auto max_sso_path_size = state->max_sso_path_size.load(std::memory_order_relaxed);
+        std::shared_ptr<directory_handle> mydirh;
+        if(mywork.leaf().empty())
+        {
+          mydirh = mywork.dirh;
+        }
+        else
+        {
+          log_level_guard gg(log_level::fatal);
+          auto r = directory_handle::directory(*mywork.dirh, mywork.leaf());
+          if(!r)
           {
-            typename state_t::workitem mywork;
-            size_t mylevel = 0;
-            assert(g.owns_lock());
-            for(size_t n = state->workqueue_base; n < state->workqueue.size(); n++)
+            OUTCOME_TRY(auto &&replacementh, state->visitor->directory_open_failed(data, std::move(r).error(), *mywork.dirh, mywork.leaf(), mylevel));
+            mydirh = std::make_shared<directory_handle>(std::move(replacementh));
+          }
+          else
+          {
+            mydirh = std::make_shared<directory_handle>(std::move(r).value());
+          }
+        }
+        if(mydirh->is_valid())
+        {
+          OUTCOME_TRY(auto &&do_enumerate, state->visitor->pre_enumeration(data, *mydirh, mylevel));
+          if(do_enumerate)
+          {
+            for(;;)
             {
-              if(!state->workqueue[n].empty())
+              buffers = {entries, std::move(buffers)};
+              OUTCOME_TRY(buffers, mydirh->read({std::move(buffers), {}, directory_handle::filter::none}));
+              if(buffers.done())
               {
-                mywork = std::move(state->workqueue[n].front());
-                state->workqueue[n].pop_front();
-                mylevel = n;
-                if(mylevel != state->depth_processed)
-                {
-                  state->depth_processed = mylevel;
-                }
                 break;
               }
+              entries.resize(entries.size() << 1);
             }
-            if(!mywork.dirh)
-            {
-              return success();
-            }
-            if(mylevel > state->workqueue_base)
-            {
-              state->workqueue_base = mylevel;
-            }
-            state->dirs_processed++;
-            state->known_dirs_remaining--;
-            const auto max_sso_path_size = state->max_sso_path_size;
-            g.unlock();
-            std::shared_ptr<directory_handle> mydirh;
-            if(mywork.leaf().empty())
+            if(!(buffers.metadata() & stat_t::want::type))
             {
-              mydirh = mywork.dirh;
+#ifdef _WIN32
+              abort();  // this should never occur on Windows
+#else
+              for(auto &entry : buffers)
+              {
+                struct ::stat stat;
+                memset(&stat, 0, sizeof(stat));
+                path_view::zero_terminated_rendered_path<> zpath(entry.leafname);
+                if(::fstatat(mydirh->native_handle().fd, zpath.data(), &stat, AT_SYMLINK_NOFOLLOW) >= 0)
+                {
+                  entry.stat.st_type = [](uint16_t mode)
+                  {
+                    switch(mode & S_IFMT)
+                    {
+                    case S_IFBLK:
+                      return filesystem::file_type::block;
+                    case S_IFCHR:
+                      return filesystem::file_type::character;
+                    case S_IFDIR:
+                      return filesystem::file_type::directory;
+                    case S_IFIFO:
+                      return filesystem::file_type::fifo;
+                    case S_IFLNK:
+                      return filesystem::file_type::symlink;
+                    case S_IFREG:
+                      return filesystem::file_type::regular;
+                    case S_IFSOCK:
+                      return filesystem::file_type::socket;
+                    default:
+                      return filesystem::file_type::unknown;
+                    }
+                  }(stat.st_mode);
+                }
+                else
+                {
+                  return posix_error();
+                }
+              }
+#endif
             }
-            else
+            OUTCOME_TRY(state->visitor->post_enumeration(data, *mydirh, buffers, mylevel));
+            std::list<traverse_state::workitem> newwork;
+            size_t maxpathsize = 0;
+            for(auto &entry : buffers)
             {
-              log_level_guard gg(log_level::fatal);
-              auto r = directory_handle::directory(*mywork.dirh, mywork.leaf());
-              if(!r)
+              int entry_type = 0;  // 0 = unknown, 1 = file, 2 = directory
+              switch(entry.stat.st_type)
               {
-                OUTCOME_TRY(auto &&replacementh, state->visitor->directory_open_failed(data, std::move(r).error(), *mywork.dirh, mywork.leaf(), mylevel));
-                mydirh = std::make_shared<directory_handle>(std::move(replacementh));
+              case filesystem::file_type::directory:
+                entry_type = 2;
+                break;
+              case filesystem::file_type::regular:
+              case filesystem::file_type::symlink:
+              case filesystem::file_type::block:
+              case filesystem::file_type::character:
+              case filesystem::file_type::fifo:
+              case filesystem::file_type::socket:
+                entry_type = 1;
+                break;
+              default:
+                break;
               }
-              else
+              if(2 == entry_type)
               {
-                mydirh = std::make_shared<directory_handle>(std::move(r).value());
+                size_t pathsize = mywork.leaf().native_size() + entry.leafname.native_size() + 2;
+                if(pathsize > maxpathsize)
+                {
+                  maxpathsize = pathsize;
+                }
               }
             }
-            if(mydirh->is_valid())
+            for(auto &entry : buffers)
             {
-              OUTCOME_TRY(auto &&do_enumerate, state->visitor->pre_enumeration(data, *mydirh, mylevel));
-              if(do_enumerate)
+              int entry_type = 0;  // 0 = unknown, 1 = file, 2 = directory
+              switch(entry.stat.st_type)
               {
-                for(;;)
-                {
-                  buffers = {entries, std::move(buffers)};
-                  OUTCOME_TRY(buffers, mydirh->read({std::move(buffers), {}, directory_handle::filter::none}));
-                  if(buffers.done())
-                  {
-                    break;
-                  }
-                  entries.resize(entries.size() << 1);
-                }
-                if(!(buffers.metadata() & stat_t::want::type))
-                {
-#ifdef _WIN32
-                  abort();  // this should never occur on Windows
-#else
-                  for(auto &entry : buffers)
-                  {
-                    struct ::stat stat;
-                    memset(&stat, 0, sizeof(stat));
-                    path_view::zero_terminated_rendered_path<> zpath(entry.leafname);
-                    if(::fstatat(mydirh->native_handle().fd, zpath.data(), &stat, AT_SYMLINK_NOFOLLOW) >= 0)
-                    {
-                      entry.stat.st_type = [](uint16_t mode)
-                      {
-                        switch(mode & S_IFMT)
-                        {
-                        case S_IFBLK:
-                          return filesystem::file_type::block;
-                        case S_IFCHR:
-                          return filesystem::file_type::character;
-                        case S_IFDIR:
-                          return filesystem::file_type::directory;
-                        case S_IFIFO:
-                          return filesystem::file_type::fifo;
-                        case S_IFLNK:
-                          return filesystem::file_type::symlink;
-                        case S_IFREG:
-                          return filesystem::file_type::regular;
-                        case S_IFSOCK:
-                          return filesystem::file_type::socket;
-                        default:
-                          return filesystem::file_type::unknown;
-                        }
-                      }(stat.st_mode);
-                    }
-                    else
-                    {
-                      return posix_error();
-                    }
-                  }
-#endif
-                }
-                OUTCOME_TRY(state->visitor->post_enumeration(data, *mydirh, buffers, mylevel));
-                std::list<state_t::workitem> newwork;
-                size_t maxpathsize = 0;
-                for(auto &entry : buffers)
-                {
-                  int entry_type = 0;  // 0 = unknown, 1 = file, 2 = directory
-                  switch(entry.stat.st_type)
-                  {
-                  case filesystem::file_type::directory:
-                    entry_type = 2;
-                    break;
-                  case filesystem::file_type::regular:
-                  case filesystem::file_type::symlink:
-                  case filesystem::file_type::block:
-                  case filesystem::file_type::character:
-                  case filesystem::file_type::fifo:
-                  case filesystem::file_type::socket:
-                    entry_type = 1;
-                    break;
-                  default:
-                    break;
-                  }
-                  if(2 == entry_type)
-                  {
-                    size_t pathsize = mywork.leaf().native_size() + entry.leafname.native_size() + 2;
-                    if(pathsize > maxpathsize)
-                    {
-                      maxpathsize = pathsize;
-                    }
-                  }
-                }
-                for(auto &entry : buffers)
+              case filesystem::file_type::directory:
+                entry_type = 2;
+                break;
+              case filesystem::file_type::regular:
+              case filesystem::file_type::symlink:
+              case filesystem::file_type::block:
+              case filesystem::file_type::character:
+              case filesystem::file_type::fifo:
+              case filesystem::file_type::socket:
+                entry_type = 1;
+                break;
+              default:
+                break;
+              }
+              if(2 == entry_type)
+              {
+                if(maxpathsize <= max_sso_path_size)
                 {
-                  int entry_type = 0;  // 0 = unknown, 1 = file, 2 = directory
-                  switch(entry.stat.st_type)
+                  // Reuse existing base directory handle, but with a longer path fragment
+                  // Note that "slow path" is defined as this branch always being taken
+                  // no matter what, so if pathsize exceeds LLFIO_ALGORITHM_TRAVERSE_MAX_SSO_PATH_SIZE
+                  // then a filesystem::path will be constructed per work item, and that has
+                  // a marked effect on performance. It does, however, avoid opening any
+                  // directory handles above minimum possible.
+                  if(!mywork.leaf().empty())
                   {
-                  case filesystem::file_type::directory:
-                    entry_type = 2;
-                    break;
-                  case filesystem::file_type::regular:
-                  case filesystem::file_type::symlink:
-                  case filesystem::file_type::block:
-                  case filesystem::file_type::character:
-                  case filesystem::file_type::fifo:
-                  case filesystem::file_type::socket:
-                    entry_type = 1;
-                    break;
-                  default:
-                    break;
+                    newwork.push_back(traverse_state::workitem(mywork.dirh, mywork.leaf(), entry.leafname));
                   }
-                  if(2 == entry_type)
+                  else
                   {
-                    if(maxpathsize <= max_sso_path_size)
-                    {
-                      // Reuse existing base directory handle, but with a longer path fragment
-                      // Note that "slow path" is defined as this branch always being taken
-                      // no matter what, so if pathsize exceeds LLFIO_ALGORITHM_TRAVERSE_MAX_SSO_PATH_SIZE
-                      // then a filesystem::path will be constructed per work item, and that has
-                      // a marked effect on performance. It does, however, avoid opening any
-                      // directory handles above minimum possible.
-                      if(!mywork.leaf().empty())
-                      {
-                        newwork.push_back(state_t::workitem(mywork.dirh, mywork.leaf(), entry.leafname));
-                      }
-                      else
-                      {
-                        newwork.push_back(state_t::workitem(mywork.dirh, entry.leafname));
-                      }
-                    }
-                    else
-                    {
-                      // Use a new base directory handle with a single leaf
-                      newwork.push_back(state_t::workitem(mydirh, entry.leafname));
-                    }
+                    newwork.push_back(traverse_state::workitem(mywork.dirh, entry.leafname));
                   }
                 }
-                g.lock();
-                state->known_dirs_remaining += newwork.size();
-                if(state->workqueue.size() < mylevel + 2)
-                {
-                  state->workqueue.emplace_back();
-                }
-                state->workqueue[mylevel + 1].splice(state->workqueue[mylevel + 1].end(), std::move(newwork));
-                if(mylevel + 1 < state->workqueue_base)
+                else
                 {
-                  state->workqueue_base = mylevel + 1;
+                  // Use a new base directory handle with a single leaf
+                  newwork.push_back(traverse_state::workitem(mydirh, entry.leafname));
                 }
-                size_t dirs_processed = state->dirs_processed, known_dirs_remaining = state->known_dirs_remaining, depth_processed = state->depth_processed,
-                       known_depth_remaining = state->workqueue.size();
+              }
+            }
+            state->push(idx, mylevel + 1, std::move(newwork));
 #ifndef _WIN32
-                if(max_sso_path_size < size_t(-1) && rlimit_maxfd > 0 && rlimit_maxfd - mydirh->native_handle().fd < 65536)
-                {
-                  state->max_sso_path_size = size_t(-1);
+            const size_t rlimit_maxfd = traverse_rlimit_maxfd();
+            if(max_sso_path_size < size_t(-1) && rlimit_maxfd > 0 && rlimit_maxfd - mydirh->native_handle().fd < 65536)
+            {
+              state->max_sso_path_size.store(size_t(-1), std::memory_order_relaxed);
 #ifndef NDEBUG
-                  std::cerr << "WARNING: llfio::traverse() is falling back to slow path due to " << (rlimit_maxfd - mydirh->native_handle().fd)
-                            << " unused file descriptors remaining! Raise the limit using setrlimit(RLIMIT_NOFILE) if your application is > 1024 fd count safe."
-                            << std::endl;
+              std::cerr << "WARNING: llfio::traverse() is falling back to slow path due to " << (rlimit_maxfd - mydirh->native_handle().fd)
+                        << " unused file descriptors remaining! Raise the limit using setrlimit(RLIMIT_NOFILE) if your application is > 1024 fd count safe."
+                        << std::endl;
 #endif
-                }
-#endif
-                g.unlock();
-                OUTCOME_TRY(state->visitor->stack_updated(data, dirs_processed, known_dirs_remaining, depth_processed, known_depth_remaining));
-              }
             }
-            return success();
+#endif
+            OUTCOME_TRY(state->visitor->stack_updated(data, state->dirs_processed.load(std::memory_order_relaxed),
+                                                      state->known_dirs_remaining.load(std::memory_order_relaxed),
+                                                      state->depth_processed.load(std::memory_order_relaxed),
+                                                      state->known_depth_remaining.load(std::memory_order_relaxed)));
           }
-        };
-        state.workqueue.emplace_back();
-        state.workqueue.front().push_back(state_t::workitem(topdirh, {}));
-        state.known_dirs_remaining = 1;
-        worker firstworker(&state);
+        }
+        return success();
+      }
+    };
+
+#ifndef LLFIO_EXCLUDE_DYNAMIC_THREAD_POOL_GROUP
+    struct traverse_work_item final : public dynamic_thread_pool_group::work_item
+    {
+      traverse_worker *worker{nullptr};
+
+      virtual intptr_t next(deadline &d) noexcept override
+      {
+        const auto ret = worker->next();
+        if(ret == 0)
         {
-          std::unique_lock<std::mutex> g(state.lock);
-          for(size_t n = 0; state.known_dirs_remaining > 0 && (threads == 1 || n < 4); n++)
+          // Don't spin while the other work items enumerate
+          d = deadline(std::chrono::milliseconds(1));
+        }
+        return ret;
+      }
+      virtual result<void> operator()(intptr_t /*unused*/) noexcept override { return worker->run(); }
+    };
+#endif
+
+    inline result<size_t> traverse(const path_handle &_topdirh, traverse_visitor *visitor, size_t threads, void *data, bool force_slow_path,
+                                   dynamic_thread_pool_group *group) noexcept
+    {
+      return visitor->finished(
+      data,
+      [&]() -> result<size_t>
+      {
+        try
+        {
+          LLFIO_LOG_FUNCTION_CALL(&_topdirh);
+          std::shared_ptr<directory_handle> topdirh;
           {
-            if(!g.owns_lock())
+            OUTCOME_TRY(auto &&dirh, directory_handle::directory(_topdirh, {}));
+            topdirh = std::make_shared<directory_handle>(std::move(dirh));
+          }
+          bool use_slow_path = force_slow_path;
+#ifndef _WIN32
+          const size_t rlimit_maxfd = traverse_rlimit_maxfd();
+          if(!use_slow_path)
+          {
+            if(rlimit_maxfd > 0 && rlimit_maxfd - topdirh->native_handle().fd < 65536)
             {
-              g.lock();
+              use_slow_path = true;
+#ifndef NDEBUG
+              std::cerr << "WARNING: llfio::traverse() is using slow path due to " << (rlimit_maxfd - topdirh->native_handle().fd)
+                        << " unused file descriptors remaining! Raise the limit using setrlimit(RLIMIT_NOFILE) if your application is > 1024 fd count safe."
+                        << std::endl;
+#endif
             }
-            OUTCOME_TRY(firstworker.run(g, data));
           }
-        }
-        if(state.known_dirs_remaining > 0)
-        {
-          // Fire up the threadpool
+#endif
           if(0 == threads)
           {
             // Filesystems are generally only concurrent to the real CPU count
@@ -464,31 +575,55 @@ namespace algorithm
               threads = 4;
             }
           }
-          std::vector<worker> workers;
+          traverse_state state(use_slow_path ? size_t(-1) : LLFIO_ALGORITHM_TRAVERSE_MAX_SSO_PATH_SIZE, visitor, data, threads);
+          {
+            std::list<traverse_state::workitem> topwork;
+            topwork.push_back(traverse_state::workitem(topdirh, {}));
+            state.push(0, 0, std::move(topwork));
+          }
+          std::vector<traverse_worker> workers;
           workers.reserve(threads);
-          workers.push_back(std::move(firstworker));
-          for(size_t n = 1; n < threads; n++)
+          workers.emplace_back(&state, 0);
+          // Do the first few directories on this thread, as most trees are small
+          for(size_t n = 0; state.outstanding.load(std::memory_order_relaxed) > 0 && !state.failed.load(std::memory_order_relaxed) && (threads == 1 || n < 4); n++)
           {
-            workers.push_back(worker(&state));
+            (void) workers.front().run();
           }
-          std::vector<std::thread> workerthreads;
-          workerthreads.reserve(threads);
-          std::condition_variable cond, maincond;
-          bool done = false;
-          optional<result<void>::error_type> run_error;
+          if(state.outstanding.load(std::memory_order_relaxed) > 0 && !state.failed.load(std::memory_order_relaxed))
           {
-            auto handle_failure = make_scope_fail(
+            for(size_t n = 1; n < threads; n++)
+            {
+              workers.emplace_back(&state, n);
+            }
+#ifndef LLFIO_EXCLUDE_DYNAMIC_THREAD_POOL_GROUP
+            dynamic_thread_pool_group_ptr mygroup;
+            if(group == nullptr)
+            {
+              OUTCOME_TRY(mygroup, make_dynamic_thread_pool_group());
+              group = mygroup.get();
+            }
+            std::vector<traverse_work_item> items(threads);
+            std::vector<dynamic_thread_pool_group::work_item *> itemptrs;
+            itemptrs.reserve(threads);
+            for(size_t n = 0; n < threads; n++)
+            {
+              items[n].worker = &workers[n];
+              itemptrs.push_back(&items[n]);
+            }
+            OUTCOME_TRY(group->submit(itemptrs));
+            auto r = group->wait();
+            if(!r && !state.failed.load(std::memory_order_relaxed))
+            {
+              // The group was stopped by somebody else
+              return std::move(r).error();
+            }
+#else
+            (void) group;
+            std::vector<std::thread> workerthreads;
+            workerthreads.reserve(threads);
+            auto join = make_scope_exit(
             [&]() noexcept
             {
-              std::unique_lock<std::mutex> g(state.lock);
-              done = true;
-              while(state.threads_running > 0)
-              {
-                g.unlock();
-                cond.notify_all();
-                g.lock();
-              }
-              g.unlock();
               for(auto &i : workerthreads)
               {
                 i.join();
@@ -497,88 +632,61 @@ namespace algorithm
             for(size_t n = 0; n < threads; n++)
             {
               workerthreads.push_back(std::thread(
-              [&](worker *w)
+              [](traverse_worker *w)
               {
-                std::unique_lock<std::mutex> g(state.lock);
-                state.threads_running++;
-                while(!done)
+                for(intptr_t work; (work = w->next()) != -1;)
                 {
-                  if(state.known_dirs_remaining == 0)
+                  if(work == 0)
                   {
-                    // sleep
-                    state.threads_sleeping++;
-                    maincond.notify_all();
-                    cond.wait(g);
-                    state.threads_sleeping--;
-                    if(done)
-                    {
-                      break;
-                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    continue;
                   }
-                  else
+                  if(!w->run())
                   {
-                    // wake everybody
-                    cond.notify_all();
-                  }
-                  auto r = w->run(g, data);
-                  if(!g.owns_lock())
-                  {
-                    g.lock();
-                  }
-                  if(!r)
-                  {
-                    done = true;
-                    if(!run_error)
-                    {
-                      run_error = std::move(r).error();
-                    }
                     break;
                   }
                 }
-                state.threads_sleeping++;
-                state.threads_running--;
-                maincond.notify_all();
               },
               &workers[n]));
             }
+#endif
           }
+          if(state.failed.load(std::memory_order_acquire))
           {
-            std::unique_lock<std::mutex> g(state.lock);
-            while(state.threads_sleeping < threads && !done)
-            {
-              maincond.wait(g);
-            }
-            done = true;
-            while(state.threads_running > 0)
-            {
-              g.unlock();
-              cond.notify_all();
-              g.lock();
-            }
-          }
-          for(auto &i : workerthreads)
-          {
-            i.join();
+            std::lock_guard<std::mutex> g(state.lock);
+            return std::move(*state.failure);
           }
-          if(run_error)
+#ifndef NDEBUG
+          for(auto &q : state.queues)
           {
-            return std::move(*run_error);
+            for(auto &i : q.levels)
+            {
+              assert(i.empty());
+            }
           }
+#endif
+          return state.dirs_processed.load(std::memory_order_relaxed);
         }
-#ifndef NDEBUG
-        for(auto &i : state.workqueue)
+        catch(...)
         {
-          assert(i.empty());
+          return error_from_exception();
         }
+      }());
+    }
+  }  // namespace detail
+
+  LLFIO_HEADERS_ONLY_FUNC_SPEC result<size_t> traverse(const path_handle &dirh, traverse_visitor *visitor, size_t threads, void *data, bool force_slow_path) noexcept
+  {
+    return detail::traverse(dirh, visitor, threads, data, force_slow_path, nullptr);
+  }
+
+#ifndef LLFIO_EXCLUDE_DYNAMIC_THREAD_POOL_GROUP
+  LLFIO_HEADERS_ONLY_FUNC_SPEC result<size_t> traverse(dynamic_thread_pool_group &group, const path_handle &dirh, traverse_visitor *visitor, size_t threads,
+                                                       void *data, bool force_slow_path) noexcept
+  {
+    return detail::traverse(dirh, visitor, threads, data, force_slow_path, &group);
+  }
 #endif
-        return state.dirs_processed;
-      }
-      catch(...)
-      {
-        return error_from_exception();
-      }
-    }());
-  }  // namespace algorithm
 }  // namespace algorithm
 
 LLFIO_V2_NAMESPACE_END
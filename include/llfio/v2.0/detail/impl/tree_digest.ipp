@@ -0,0 +1,410 @@
+/* A filesystem algorithm which calculates a Merkle tree digest of a directory tree
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#include "../../algorithm/tree_digest.hpp"
+#include "../../mapped_file_handle.hpp"
+
+#include "parallel_for_each.hpp"
+
+#include "quickcpplib/algorithm/hash.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <unordered_map>
+
+LLFIO_V2_NAMESPACE_BEGIN
+
+namespace algorithm
+{
+  namespace detail
+  {
+    struct tree_digest_store_header
+    {
+      char magic[8];  // "llfiotd1"
+      uint64_t chunk_size;
+      uint64_t count;
+      uint64_t _reserved;
+      tree_digest_hash root;
+      tree_digest_hash records_hash;  // so a torn or corrupted store is detected
+    };
+    static_assert(sizeof(tree_digest_store_header) == 64, "tree_digest_store_header is not 64 bytes long!");
+
+    inline tree_digest_hash tree_digest_hash_bytes(const void *data, size_t bytes) noexcept
+    {
+      return QUICKCPPLIB_NAMESPACE::algorithm::hash::fast_hash::hash((const char *) data, bytes);
+    }
+    inline bool tree_digest_less(const tree_digest_hash &a, const tree_digest_hash &b) noexcept
+    {
+      return ((uint64_t) a.as_longlongs[0] != (uint64_t) b.as_longlongs[0]) ? ((uint64_t) a.as_longlongs[0] < (uint64_t) b.as_longlongs[0]) :
+                                                                              ((uint64_t) a.as_longlongs[1] < (uint64_t) b.as_longlongs[1]);
+    }
+    inline bool tree_digest_equal(const tree_digest_hash &a, const tree_digest_hash &b) noexcept
+    {
+      return a.as_longlongs[0] == b.as_longlongs[0] && a.as_longlongs[1] == b.as_longlongs[1];
+    }
+
+    struct tree_digest_chunk
+    {
+      size_t file;  // index into the files
+      uint64_t offset;
+      size_t length;
+      bool failed;
+      tree_digest_hash hash;
+    };
+
+    // The most consecutive chunks of a file hashed by one work item, which opens the file once for them all
+    static constexpr size_t tree_digest_chunks_per_run = 16;
+
+    // Hash a run of chunks of one file. Returns false if the file has disappeared.
+    inline result<bool> tree_digest_hash_run(const path_handle &dirh, const filesystem::path &path, span<tree_digest_chunk> chunks) noexcept
+    {
+      try
+      {
+        file_handle fh;
+        std::unique_ptr<byte[]> buffer;
+        size_t buffersize = 0;
+        for(auto &chunk : chunks)
+        {
+          size_t done = 0;
+          if(chunk.length > 0)
+          {
+            if(!fh.is_valid())
+            {
+              auto _fh = file_handle::file(dirh, path);
+              if(!_fh)
+              {
+                if(_fh.error() == errc::no_such_file_or_directory)
+                {
+                  return false;
+                }
+                return std::move(_fh).error();
+              }
+              fh = std::move(_fh).value();
+            }
+            if(buffersize < chunk.length)
+            {
+              buffer.reset(new byte[chunk.length]);
+              buffersize = chunk.length;
+            }
+            // The file may have shrunk since it was enumerated
+            while(done < chunk.length)
+            {
+              OUTCOME_TRY(auto &&bytes, fh.read(chunk.offset + done, {{buffer.get() + done, chunk.length - done}}));
+              if(bytes == 0)
+              {
+                break;
+              }
+              done += bytes;
+            }
+          }
+          chunk.hash = tree_digest_hash_bytes(buffer.get(), done);
+        }
+        return true;
+      }
+      catch(...)
+      {
+        return error_from_exception();
+      }
+    }
+
+    // Hash all the chunks, in parallel if possible. Consecutive chunks of the same file are hashed in runs.
+    inline result<void> tree_digest_hash_chunks(const path_handle &dirh, const std::vector<std::pair<filesystem::path, tree_digest_record>> &files,
+                                                std::vector<tree_digest_chunk> &chunks, size_t threads) noexcept
+    {
+      try
+      {
+        std::vector<std::pair<size_t, size_t>> runs;  // [begin, end) indices into the chunks
+        for(size_t n = 0; n < chunks.size(); n++)
+        {
+          if(runs.empty() || chunks[runs.back().first].file != chunks[n].file || runs.back().second - runs.back().first == tree_digest_chunks_per_run)
+          {
+            runs.emplace_back(n, n);
+          }
+          runs.back().second++;
+        }
+        auto hash_run = [&](size_t n) -> result<void> {
+          span<tree_digest_chunk> run(chunks.data() + runs[n].first, runs[n].second - runs[n].first);
+          OUTCOME_TRY(auto &&hashed, tree_digest_hash_run(dirh, files[run[0].file].first, run));
+          if(!hashed)
+          {
+            for(auto &chunk : run)
+            {
+              chunk.failed = true;
+            }
+          }
+          return success();
+        };
+        return parallel_for_each(runs.size(), threads, hash_run);
+      }
+      catch(...)
+      {
+        return error_from_exception();
+      }
+    }
+
+    inline result<tree_digest_result> tree_digest(const path_handle &dirh, const path_handle *storebase, path_view storepath, const tree_digest_config &config)
+    {
+      if(config.chunk_size == 0)
+      {
+        return errc::invalid_argument;
+      }
+      tree_digest_result ret;
+      contents_visitor visitor(stat_t::want::type | stat_t::want::ino | stat_t::want::mtim | stat_t::want::size, true, true, false);
+      OUTCOME_TRY(auto &&entries, contents(dirh, &visitor, config.threads, config.force_slow_path));
+      if(!(entries.metadata & stat_t::want::type) || !(entries.metadata & stat_t::want::size))
+      {
+        return errc::operation_not_supported;
+      }
+      const bool can_reuse = (entries.metadata & stat_t::want::ino) && (entries.metadata & stat_t::want::mtim);
+      std::vector<filesystem::path> directories;
+      for(auto &entry : entries)
+      {
+        if(entry.second.st_type == filesystem::file_type::directory)
+        {
+          directories.push_back(std::move(entry.first));
+        }
+        else if(entry.second.st_type == filesystem::file_type::regular)
+        {
+          tree_digest_record record;
+          const auto &native = entry.first.native();
+          record.path_hash = tree_digest_hash_bytes(native.data(), native.size() * sizeof(native[0]));
+          record.st_ino = entry.second.st_ino;
+          record.st_mtim = (entries.metadata & stat_t::want::mtim) ?
+                           (int64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(entry.second.st_mtim.time_since_epoch()).count() :
+                           0;
+          record.st_size = entry.second.st_size;
+          ret.files.emplace_back(std::move(entry.first), record);
+        }
+      }
+      entries.clear();
+      entries.shrink_to_fit();
+      std::sort(ret.files.begin(), ret.files.end(), [](const auto &a, const auto &b) { return a.first.native() < b.first.native(); });
+
+      // Reuse the digest of any file unchanged since the store was written
+      mapped_file_handle storemh;
+      span<const tree_digest_record> previous;
+      if(storebase != nullptr)
+      {
+        auto _storemh = mapped_file_handle::mapped_file(*storebase, storepath);
+        if(_storemh)
+        {
+          storemh = std::move(_storemh).value();
+          OUTCOME_TRY(auto &&length, storemh.maximum_extent());
+          if(length >= sizeof(tree_digest_store_header))
+          {
+            const auto *header = (const tree_digest_store_header *) storemh.address();
+            const auto *records = (const tree_digest_record *) (header + 1);
+            // Check the count against the length before multiplying, as a corrupt count could overflow
+            if(0 == memcmp(header->magic, "llfiotd1", 8) && header->chunk_size == config.chunk_size &&
+               header->count <= (length - sizeof(tree_digest_store_header)) / sizeof(tree_digest_record) &&
+               length == sizeof(tree_digest_store_header) + header->count * sizeof(tree_digest_record) &&
+               tree_digest_equal(header->records_hash, tree_digest_hash_bytes(records, (size_t) header->count * sizeof(tree_digest_record))))
+            {
+              previous = {records, (size_t) header->count};
+            }
+          }
+        }
+        else if(_storemh.error() != errc::no_such_file_or_directory)
+        {
+          return std::move(_storemh).error();
+        }
+      }
+      std::vector<tree_digest_chunk> chunks;
+      for(size_t n = 0; n < ret.files.size(); n++)
+      {
+        auto &record = ret.files[n].second;
+        if(can_reuse && !previous.empty())
+        {
+          auto it = std::lower_bound(previous.begin(), previous.end(), record,
+                                     [](const tree_digest_record &a, const tree_digest_record &b) { return tree_digest_less(a.path_hash, b.path_hash); });
+          if(it != previous.end() && tree_digest_equal(it->path_hash, record.path_hash) && it->st_ino == record.st_ino && it->st_mtim == record.st_mtim &&
+             it->st_size == record.st_size)
+          {
+            record.content_hash = it->content_hash;
+            ret.files_reused++;
+            continue;
+          }
+        }
+        tree_digest_chunk chunk{n, 0, 0, false, {}};
+        do
+        {
+          chunk.length = (size_t) std::min((uint64_t) config.chunk_size, record.st_size - chunk.offset);
+          chunks.push_back(chunk);
+          chunk.offset += chunk.length;
+        } while(chunk.offset < record.st_size);
+        ret.files_hashed++;
+        ret.bytes_hashed += record.st_size;
+      }
+      previous = {};
+      if(storemh.is_valid())
+      {
+        // Windows won't replace a file which is mapped
+        OUTCOME_TRY(storemh.close());
+      }
+      OUTCOME_TRY(tree_digest_hash_chunks(dirh, ret.files, chunks, config.threads));
+
+      // A file's digest is the hash of its chunk hashes
+      std::vector<char> failed(ret.files.size(), 0);
+      for(size_t n = 0; n < chunks.size();)
+      {
+        const size_t file = chunks[n].file;
+        std::vector<tree_digest_hash> hashes;
+        for(; n < chunks.size() && chunks[n].file == file; n++)
+        {
+          failed[file] |= (char) chunks[n].failed;
+          hashes.push_back(chunks[n].hash);
+        }
+        ret.files[file].second.content_hash = tree_digest_hash_bytes(hashes.data(), hashes.size() * sizeof(tree_digest_hash));
+      }
+      chunks.clear();
+      chunks.shrink_to_fit();
+      size_t kept = 0;
+      for(size_t n = 0; n < ret.files.size(); n++)
+      {
+        if(failed[n] == 0)
+        {
+          if(kept != n)
+          {
+            ret.files[kept] = std::move(ret.files[n]);
+          }
+          kept++;
+        }
+      }
+      ret.files.erase(ret.files.begin() + kept, ret.files.end());
+      ret.files_failed = failed.size() - ret.files.size();
+      ret.files_hashed -= ret.files_failed;
+
+      // A directory's digest is the hash of the leafnames, types and digests of its children
+      struct child_type
+      {
+        filesystem::path leafname;
+        filesystem::file_type type;
+        tree_digest_hash hash;
+      };
+      std::unordered_map<filesystem::path::string_type, std::vector<child_type>> children;
+      for(auto &file : ret.files)
+      {
+        children[file.first.parent_path().native()].push_back({file.first.filename(), filesystem::file_type::regular, file.second.content_hash});
+      }
+      std::vector<byte> buffer;
+      auto hash_children = [&](const filesystem::path::string_type &dirpath) {
+        buffer.clear();
+        auto it = children.find(dirpath);
+        if(it != children.end())
+        {
+          std::sort(it->second.begin(), it->second.end(), [](const child_type &a, const child_type &b) { return a.leafname.native() < b.leafname.native(); });
+          for(auto &child : it->second)
+          {
+            const auto &leafname = child.leafname.native();
+            const uint64_t leafnamelen = leafname.size() * sizeof(leafname[0]);
+            const auto type = (uint8_t) child.type;
+            const auto *p = (const byte *) &leafnamelen;
+            buffer.insert(buffer.end(), p, p + sizeof(leafnamelen));
+            p = (const byte *) leafname.data();
+            buffer.insert(buffer.end(), p, p + leafnamelen);
+            p = (const byte *) &type;
+            buffer.insert(buffer.end(), p, p + sizeof(type));
+            p = (const byte *) &child.hash;
+            buffer.insert(buffer.end(), p, p + sizeof(child.hash));
+          }
+          children.erase(it);
+        }
+        return tree_digest_hash_bytes(buffer.data(), buffer.size());
+      };
+      // Children sort after their parents, so in reverse order every directory's children are digested before it
+      std::sort(directories.begin(), directories.end(), [](const filesystem::path &a, const filesystem::path &b) { return a.native() > b.native(); });
+      for(auto &dir : directories)
+      {
+        auto hash = hash_children(dir.native());
+        children[dir.parent_path().native()].push_back({dir.filename(), filesystem::file_type::directory, hash});
+      }
+      ret.root = hash_children({});
+
+      if(storebase != nullptr)
+      {
+        std::vector<tree_digest_record> records;
+        records.reserve(ret.files.size());
+        for(auto &file : ret.files)
+        {
+          records.push_back(file.second);
+        }
+        std::sort(records.begin(), records.end(), [](const tree_digest_record &a, const tree_digest_record &b) { return tree_digest_less(a.path_hash, b.path_hash); });
+        tree_digest_store_header header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, "llfiotd1", 8);
+        header.chunk_size = config.chunk_size;
+        header.count = records.size();
+        header.root = ret.root;
+        header.records_hash = tree_digest_hash_bytes(records.data(), records.size() * sizeof(tree_digest_record));
+        // Write the new store alongside, and atomically replace the old store with it
+        OUTCOME_TRY(auto &&storefh, file_handle::uniquely_named_file(*storebase, file_handle::mode::write, file_handle::caching::all));
+        bool failed_to_write = true;
+        auto unstorefh = make_scope_exit([&]() noexcept {
+          if(failed_to_write)
+          {
+            (void) storefh.unlink();
+          }
+          (void) storefh.close();
+        });
+        (void) unstorefh;
+        OUTCOME_TRY(storefh.write(0, {{(const byte *) &header, sizeof(header)},
+                                      {(const byte *) records.data(), records.size() * sizeof(tree_digest_record)}}));
+        OUTCOME_TRY(storefh.relink(*storebase, storepath));
+        failed_to_write = false;
+      }
+      return {std::move(ret)};
+    }
+  }  // namespace detail
+
+  LLFIO_HEADERS_ONLY_FUNC_SPEC result<tree_digest_result> tree_digest(const path_handle &dirh, const path_handle &storebase, path_view storepath,
+                                                                      const tree_digest_config &config) noexcept
+  {
+    LLFIO_LOG_FUNCTION_CALL(&dirh);
+    try
+    {
+      return detail::tree_digest(dirh, &storebase, storepath, config);
+    }
+    catch(...)
+    {
+      return error_from_exception();
+    }
+  }
+
+  LLFIO_HEADERS_ONLY_FUNC_SPEC result<tree_digest_result> tree_digest(const path_handle &dirh, const tree_digest_config &config) noexcept
+  {
+    LLFIO_LOG_FUNCTION_CALL(&dirh);
+    try
+    {
+      return detail::tree_digest(dirh, nullptr, {}, config);
+    }
+    catch(...)
+    {
+      return error_from_exception();
+    }
+  }
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
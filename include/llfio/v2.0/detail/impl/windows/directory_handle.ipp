@@ -460,4 +460,62 @@ result<directory_handle::buffers_type> directory_handle::read(io_request<buffers
   return std::move(req.buffers);
 }
 
+LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<size_t> directory_handle::fill_metadata(buffers_type &buffers, stat_t::want wanted) const noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+  try
+  {
+    const stat_t::want missing = wanted & ~buffers._metadata;
+    if(!missing || buffers.empty())
+    {
+      buffers._metadata |= wanted;
+      return 0;
+    }
+    // Enumeration returns almost everything on Windows, so simply open each entry in turn
+    std::vector<directory_entry> failed;
+    size_t out = 0;
+    for(size_t n = 0; n < buffers.size(); n++)
+    {
+      directory_entry &entry = buffers[n];
+      bool ok = false;
+      if(entry.stat.st_type == filesystem::file_type::directory)
+      {
+        if(auto h = directory_handle::directory(*this, entry.leafname, mode::attr_read))
+        {
+          ok = !!entry.stat.fill(h.value(), missing);
+        }
+      }
+      else
+      {
+        if(auto h = file_handle::file(*this, entry.leafname, file_handle::mode::attr_read))
+        {
+          ok = !!entry.stat.fill(h.value(), missing);
+        }
+      }
+      if(ok)
+      {
+        if(out != n)
+        {
+          buffers[out] = entry;
+        }
+        out++;
+      }
+      else
+      {
+        failed.push_back(entry);
+      }
+    }
+    for(auto &i : failed)
+    {
+      buffers[out++] = i;
+    }
+    buffers._metadata |= wanted;
+    return failed.size();
+  }
+  catch(...)
+  {
+    return error_from_exception();
+  }
+}
+
 LLFIO_V2_NAMESPACE_END
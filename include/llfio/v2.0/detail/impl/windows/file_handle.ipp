@@ -363,6 +363,27 @@ result<file_handle::extent_type> file_handle::truncate(file_handle::extent_type
   return newsize;
 }
 
+result<std::vector<file_handle::extent_info>> file_handle::detailed_extents() const noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+  try
+  {
+    // FSCTL_GET_RETRIEVAL_POINTERS reports clusters on the volume, not bytes, so don't pretend
+    OUTCOME_TRY(auto &&valid, file_handle::extents());
+    std::vector<file_handle::extent_info> out;
+    out.reserve(valid.size());
+    for(auto &i : valid)
+    {
+      out.emplace_back(i.offset, i.length, (extent_type) -1, extent_flag::unknown_location);
+    }
+    return out;
+  }
+  catch(...)
+  {
+    return error_from_exception();
+  }
+}
+
 result<std::vector<file_handle::extent_pair>> file_handle::extents() const noexcept
 {
   windows_nt_kernel::init();
@@ -408,7 +429,7 @@ result<std::vector<file_handle::extent_pair>> file_handle::extents() const noexc
 }
 
 result<file_handle::extent_pair> file_handle::clone_extents_to(file_handle::extent_pair extent, byte_io_handle &dest_, byte_io_handle::extent_type destoffset, deadline d,
-                                                               bool force_copy_now, bool emulate_if_unsupported) noexcept
+                                                               bool force_copy_now, bool emulate_if_unsupported, file_handle::clone_method *method) noexcept
 {
   try
   {
@@ -419,6 +440,12 @@ result<file_handle::extent_pair> file_handle::clone_extents_to(file_handle::exte
     {
       return errc::bad_file_descriptor;
     }
+    auto used = [&](clone_method m) {
+      if(method != nullptr)
+      {
+        *method |= m;
+      }
+    };
     OUTCOME_TRY(auto &&mycurrentlength, maximum_extent());
     if(extent.offset == (extent_type) -1 && extent.length == (extent_type) -1)
     {
@@ -477,6 +504,7 @@ result<file_handle::extent_pair> file_handle::clone_extents_to(file_handle::exte
         destoffset += written;
         extent.length -= written;
         ret.length += written;
+        used(clone_method::copied);
       }
       return ret;
     }
@@ -708,6 +736,7 @@ result<file_handle::extent_pair> file_handle::clone_extents_to(file_handle::exte
           }
           else
           {
+            used(clone_method::reflinked);
             done = true;
           }
         }
@@ -774,6 +803,7 @@ result<file_handle::extent_pair> file_handle::clone_extents_to(file_handle::exte
               return errc::resource_unavailable_try_again;  // something is wrong
             }
           }
+          used(clone_method::copied);
           done = true;
         }
         if(!done && !item.destination_extents_are_new && (zero_extents && item.op == workitem::delete_extents))
@@ -876,6 +906,105 @@ result<file_handle::extent_type> file_handle::zero(file_handle::extent_pair exte
   return success();
 }
 
+result<file_handle::extent_type> file_handle::preallocate(file_handle::extent_pair extent, deadline d) noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+  if(extent.offset + extent.length < extent.offset)
+  {
+    return errc::value_too_large;
+  }
+  if(extent.length == 0)
+  {
+    return 0;
+  }
+  // Holes within the file can only be allocated by writing zeros into them
+  OUTCOME_TRY(auto &&ret, detail::file_handle_preallocate_emulated(*this, extent, d));
+  // Storage after the end of file can be allocated by raising the allocation size
+  FILE_STANDARD_INFO fsi{};
+  if(GetFileInformationByHandleEx(_v.h, FileStandardInfo, &fsi, sizeof(fsi)) == 0)
+  {
+    return win32_error();
+  }
+  const extent_type end = extent.offset + extent.length;
+  if(end > (extent_type) fsi.EndOfFile.QuadPart)
+  {
+    if(end > (extent_type) fsi.AllocationSize.QuadPart)
+    {
+      FILE_ALLOCATION_INFO fai{};
+      fai.AllocationSize.QuadPart = end;
+      if(SetFileInformationByHandle(_v.h, FileAllocationInfo, &fai, sizeof(fai)) == 0)
+      {
+        return win32_error();
+      }
+    }
+    ret += end - std::max(extent.offset, (extent_type) fsi.EndOfFile.QuadPart);
+  }
+  return ret;
+}
+
+result<file_handle::extent_type> file_handle::zero_range(file_handle::extent_pair extent, deadline d) noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+  if(extent.offset + extent.length < extent.offset)
+  {
+    return errc::value_too_large;
+  }
+  // FSCTL_SET_ZERO_DATA deallocates on sparse files, so write zeros
+  return detail::file_handle_write_zeros(*this, extent, d);
+}
+
+result<file_handle::extent_type> file_handle::collapse_range(file_handle::extent_pair extent, deadline d, bool emulate_if_unsupported) noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+  if(extent.offset + extent.length < extent.offset)
+  {
+    return errc::value_too_large;
+  }
+  OUTCOME_TRY(auto &&size, maximum_extent());
+  if(extent.offset >= size || extent.length == 0)
+  {
+    return size;
+  }
+  if(extent.offset + extent.length >= size)
+  {
+    return truncate(extent.offset);
+  }
+  // No Windows filing system can do this natively
+  if(!emulate_if_unsupported)
+  {
+    return errc::operation_not_supported;
+  }
+  return detail::file_handle_collapse_range_emulated(*this, extent, size, d);
+}
+
+result<file_handle::extent_type> file_handle::insert_range(file_handle::extent_pair extent, deadline d, bool emulate_if_unsupported) noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+  OUTCOME_TRY(auto &&size, maximum_extent());
+  if(size + extent.length < size)
+  {
+    return errc::value_too_large;
+  }
+  if(extent.offset > size)
+  {
+    return errc::invalid_argument;
+  }
+  if(extent.length == 0)
+  {
+    return size;
+  }
+  if(extent.offset == size)
+  {
+    return truncate(size + extent.length);
+  }
+  // No Windows filing system can do this natively
+  if(!emulate_if_unsupported)
+  {
+    return errc::operation_not_supported;
+  }
+  return detail::file_handle_insert_range_emulated(*this, extent, size, d);
+}
+
 
 /******************************************* statfs_t ************************************************/
 
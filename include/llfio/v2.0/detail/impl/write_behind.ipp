@@ -0,0 +1,149 @@
+/* A bounded write-behind streaming writer for file handles
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../../algorithm/write_behind.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#endif
+
+LLFIO_V2_NAMESPACE_BEGIN
+
+namespace algorithm
+{
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC write_behind_stream::write_behind_stream(file_handle &h, extent_type offset, config c)
+      : _h(&h)
+      , _chunk_size((c.chunk_size != 0) ? c.chunk_size : (extent_type) utils::file_buffer_default_size())
+      , _dirty_chunks((c.dirty_chunks != 0) ? c.dirty_chunks : 1)
+      , _drop_written_pages(c.drop_written_pages)
+      , _retired(offset)
+      , _submitted(offset)
+      , _high(offset)
+  {
+  }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<void> write_behind_stream::_submit(extent_type offset, extent_type bytes) noexcept
+  {
+    if(bytes == 0)
+    {
+      return success();
+    }
+    const_buffer_type b{nullptr, (size_type) bytes};
+    OUTCOME_TRY(_h->barrier({{&b, 1}, offset}, file_handle::barrier_kind::nowait_data_only));
+    return success();
+  }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<void> write_behind_stream::_retire(extent_type offset, extent_type bytes) noexcept
+  {
+    if(bytes == 0)
+    {
+      return success();
+    }
+    const_buffer_type b{nullptr, (size_type) bytes};
+    OUTCOME_TRY(_h->barrier({{&b, 1}, offset}, file_handle::barrier_kind::wait_data_only));
+#if !defined(_WIN32) && defined(POSIX_FADV_DONTNEED)
+    if(_drop_written_pages)
+    {
+      // The pages are now clean, so the kernel will actually drop them. Failure is not important.
+      (void) ::posix_fadvise(_h->native_handle().fd, (off_t) offset, (off_t) bytes, POSIX_FADV_DONTNEED);
+    }
+#endif
+    return success();
+  }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<void> write_behind_stream::_advance() noexcept
+  {
+    // Initiate writeback of all newly completed chunks in a single call
+    if(_high - _submitted >= _chunk_size)
+    {
+      const extent_type completed = ((_high - _submitted) / _chunk_size) * _chunk_size;
+      OUTCOME_TRY(_submit(_submitted, completed));
+      _submitted += completed;
+    }
+    // Wait upon the oldest chunks if more than the permitted number are under writeback
+    const extent_type window = _chunk_size * _dirty_chunks;
+    if(_submitted - _retired > window)
+    {
+      const extent_type excess = ((_submitted - _retired - window + _chunk_size - 1) / _chunk_size) * _chunk_size;
+      const extent_type toretire = (excess < _submitted - _retired) ? excess : (_submitted - _retired);
+      OUTCOME_TRY(_retire(_retired, toretire));
+      _retired += toretire;
+    }
+    return success();
+  }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC write_behind_stream::io_result<write_behind_stream::const_buffers_type>
+  write_behind_stream::write(io_request<const_buffers_type> reqs, deadline d) noexcept
+  {
+    LLFIO_LOG_FUNCTION_CALL(_h);
+    if(_h == nullptr)
+    {
+      return errc::bad_file_descriptor;
+    }
+    const extent_type offset = reqs.offset;
+    OUTCOME_TRY(auto &&written_, _h->write(reqs, d));
+    extent_type bytes = 0;
+    for(auto &b : written_)
+    {
+      bytes += b.size();
+    }
+    OUTCOME_TRY(written(offset, bytes));
+    return std::move(written_);
+  }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<void> write_behind_stream::written(extent_type offset, extent_type bytes) noexcept
+  {
+    if(_h == nullptr)
+    {
+      return errc::bad_file_descriptor;
+    }
+    const extent_type end = offset + bytes;
+    if(end <= _high)
+    {
+      // Written behind the cursor, leave it to the kernel
+      return success();
+    }
+    _high = end;
+    return _advance();
+  }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<void> write_behind_stream::flush(bool wait) noexcept
+  {
+    LLFIO_LOG_FUNCTION_CALL(_h);
+    if(_h == nullptr)
+    {
+      return errc::bad_file_descriptor;
+    }
+    OUTCOME_TRY(_submit(_submitted, _high - _submitted));
+    _submitted = _high;
+    if(wait)
+    {
+      OUTCOME_TRY(_retire(_retired, _high - _retired));
+      _retired = _high;
+    }
+    return success();
+  }
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
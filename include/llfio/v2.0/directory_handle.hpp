@@ -344,7 +344,7 @@ public:
 
   \return Returns the buffers filled, what metadata was filled in and whether the entire directory
   was read or not. You should *always* examine `.metadata()` for the metadata you are about to use,
-  fetching it with `stat_t::fill()` if not yet present.
+  fetching it with `fill_metadata()` or `stat_t::fill()` if not yet present.
   \param req A buffer fill (directory enumeration) request.
   \errors todo
   \mallocs If the `kernelbuffer` parameter is set in the request, no memory allocations.
@@ -354,6 +354,34 @@ public:
   */
   LLFIO_MAKE_FREE_FUNCTION
   LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<buffers_type> read(io_request<buffers_type> req, deadline d = std::chrono::seconds(30)) const noexcept;
+
+  /*! Fill in any of the `wanted` metadata not returned by `read()` for all the entries in
+  `buffers`, which must have been filled by `read()` on this directory handle.
+
+  Fetching metadata which the kernel does not return during enumeration usually costs a
+  synchronous stat per entry, which makes enumeration latency bound on networked or cold
+  filesystems. This function instead issues all the stats at once, and waits for them
+  all to complete. Symbolic links are not followed, so their entries describe the link itself.
+
+  Entries which could not be stat'd (e.g. because they were deleted since enumeration)
+  are moved to the end of `buffers`, with the order of all other entries preserved.
+  Upon success, `buffers.metadata()` has the `wanted` metadata added, and that metadata is
+  valid for all but the number of entries at the end returned.
+
+  \return The number of entries at the end of `buffers` whose metadata could not be filled.
+  \param buffers The buffers previously filled by `read()`.
+  \param wanted The metadata wanted.
+  \errors Any of the errors which the batching mechanism can return. Failure to stat any
+  individual entry is not an error.
+  \mallocs On Linux, the first call on each kernel thread sets up a small `io_uring`,
+  which is reused by all subsequent calls on that thread, and statx operations are
+  submitted to it as `IORING_OP_STATX` in a single batch. If `io_uring` is unavailable,
+  large directories are fanned out across the dynamic thread pool, small ones are stat'd
+  in turn. On other POSIX, the fan out across the dynamic thread pool is used. On Windows,
+  which returns most metadata during enumeration anyway, each entry is opened in turn.
+  Some memory allocation will occur on all platforms.
+  */
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<size_t> fill_metadata(buffers_type &buffers, stat_t::want wanted) const noexcept;
 };
 inline std::ostream &operator<<(std::ostream &s, const directory_handle::filter &v)
 {
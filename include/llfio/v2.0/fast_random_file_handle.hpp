@@ -74,10 +74,25 @@ can fill a cache line at a time. The Skylake CPU used to benchmark the code disp
 around four times the throughput with this, however there is likely still performance
 left on the table.
 
-If someone were bothered to rewrite the JSF PRNG into SIMD, it is possible one could
-approach `memcpy()` in performance. One would probably need to use AVX-512 however,
-as the JSF PRNG makes heavy use of bit rotation, which is slow before AVX-512 as it
-must be emulated with copious bit shifting and masking.
+## Multi-lane generator:
+
+Storage benchmarks need synthetic data faster than the storage, so the handle can also
+be created with `generator::multi_lane`. This divides the file into 256 byte chunks,
+each of which is sixteen independent JSF streams (lanes) four words long. Each lane's
+state is initialised from the chunk index, its lane number, and the seed, and is run
+for four rounds before its four words are output, so the output is seekable and
+deterministic for a given seed. The lanes are interleaved such that each round writes
+a whole cache line. The lanes are run in parallel using AVX-512, AVX2 or SSE2 as
+chosen at runtime for the CPU, with a scalar fallback for other CPUs. All produce
+identical output. The content differs from that of the single lane generator, so
+reproducing some content needs both the seed and the generator.
+
+On a recent Intel CPU, the multi-lane generator filling a cache resident buffer does:
+
+- AVX-512: ~14000 Mb/sec
+- AVX2: ~5700 Mb/sec
+- SSE2: ~2300 Mb/sec
+- Scalar: ~1700 Mb/sec
 */
 class LLFIO_DECL fast_random_file_handle : public file_handle
 {
@@ -99,6 +114,13 @@ public:
   template <class T> using io_request = byte_io_handle::io_request<T>;
   template <class T> using io_result = byte_io_handle::io_result<T>;
 
+  //! The generator used to synthesise the contents
+  enum class generator : uint8_t
+  {
+    single_lane,  //!< One JSF round per four bytes (the default)
+    multi_lane    //!< Sixteen JSF lanes per 256 bytes, run in parallel using SIMD
+  };
+
 protected:
   struct prng : public QUICKCPPLIB_NAMESPACE::algorithm::small_prng::small_prng
   {
@@ -120,8 +142,12 @@ protected:
       b = (offset >> 32) & 0xffffffff;
       return _base::operator()();
     }
+    // The part of the state not replaced by the offset, which the multi-lane generator starts each lane from
+    uint32_t lane_c() const noexcept { return c; }
+    uint32_t lane_d() const noexcept { return d; }
   } _prng;
   extent_type _length{0};
+  generator _generator{generator::single_lane};
 
   result<void> _perms_check() const noexcept
   {
@@ -144,6 +170,7 @@ protected:
     return std::move(reqs.buffers);
   }
   LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<buffers_type> _do_read(io_request<buffers_type> reqs, deadline d = deadline()) noexcept override;
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC io_result<buffers_type> _do_read_multi_lane(io_request<buffers_type> reqs) noexcept;
   LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<const_buffers_type> _do_write(io_request<const_buffers_type> reqs, deadline d = deadline()) noexcept override
   {
     (void) d;
@@ -160,14 +187,20 @@ public:
   //! Default constructor
   fast_random_file_handle() = default;
   //! Constructor. Seed is not much use past sixteen bytes.
-  fast_random_file_handle(extent_type length, span<const byte> seed)
+  fast_random_file_handle(extent_type length, span<const byte> seed, generator g = generator::single_lane)
       : _prng(seed)
       , _length(length)
+      , _generator(g)
   {
   }
 
   //! Implicit move construction of fast_random_file_handle permitted
-  fast_random_file_handle(fast_random_file_handle &&o) noexcept : _prng(o._prng), _length(o._length) {}
+  fast_random_file_handle(fast_random_file_handle &&o) noexcept
+      : _prng(o._prng)
+      , _length(o._length)
+      , _generator(o._generator)
+  {
+  }
   //! No copy construction (use `clone()`)
   fast_random_file_handle(const fast_random_file_handle &) = delete;
   //! Move assignment of fast_random_file_handle permitted
@@ -196,9 +229,11 @@ public:
   \param bytes How long the random file ought to report itself being.
   \param _mode How to open the file.
   \param seed Up to 88 bytes with which to seed the randomness. The default means use `utils::random_fill()`.
+  \param g Which generator to use to synthesise the contents.
   */
   LLFIO_MAKE_FREE_FUNCTION
-  static inline result<fast_random_file_handle> fast_random_file(extent_type bytes = (extent_type) -1, mode _mode = mode::read, span<const byte> seed = {}) noexcept
+  static inline result<fast_random_file_handle> fast_random_file(extent_type bytes = (extent_type) -1, mode _mode = mode::read, span<const byte> seed = {},
+                                                                 generator g = generator::single_lane) noexcept
   {
     if(_mode == mode::append)
     {
@@ -210,7 +245,7 @@ public:
       utils::random_fill((char *) _seed, sizeof(_seed));
       seed = _seed;
     }
-    result<fast_random_file_handle> ret(fast_random_file_handle(bytes, seed));
+    result<fast_random_file_handle> ret(fast_random_file_handle(bytes, seed, g));
     native_handle_type &nativeh = ret.value()._v;
     LLFIO_LOG_FUNCTION_CALL(&ret);
     nativeh.behaviour |= native_handle_type::disposition::file;
@@ -252,8 +287,41 @@ public:
     return extent.length;
   }
 
+  //! \brief Preallocate a portion of the random file (does nothing).
+  LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> preallocate(file_handle::extent_pair extent, deadline /*unused*/ = deadline()) noexcept override
+  {
+    OUTCOME_TRY(_perms_check());
+    return extent.length;
+  }
+
+  //! \brief Zero a portion of the random file (does nothing).
+  LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> zero_range(file_handle::extent_pair extent, deadline /*unused*/ = deadline()) noexcept override
+  {
+    OUTCOME_TRY(_perms_check());
+    return extent.length;
+  }
+
+  //! \brief Always returns a failed matching `errc::operation_not_supported`, as the content of the random file is a function of offset.
+  LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> collapse_range(file_handle::extent_pair /*unused*/, deadline /*unused*/ = deadline(),
+                                                                     bool /*unused*/ = true) noexcept override
+  {
+    return errc::operation_not_supported;
+  }
+
+  //! \brief Always returns a failed matching `errc::operation_not_supported`, as the content of the random file is a function of offset.
+  LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> insert_range(file_handle::extent_pair /*unused*/, deadline /*unused*/ = deadline(),
+                                                                   bool /*unused*/ = true) noexcept override
+  {
+    return errc::operation_not_supported;
+  }
+
   //! \brief Return a single extent of the maximum extent
   LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<std::vector<file_handle::extent_pair>> extents() const noexcept override { return std::vector<file_handle::extent_pair>{{0, _length}}; }
+  //! \brief Return a single extent of the maximum extent, whose location is unknown
+  LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<std::vector<file_handle::extent_info>> detailed_extents() const noexcept override
+  {
+    return std::vector<file_handle::extent_info>{{0, _length, (extent_type) -1, extent_flag::unknown_location}};
+  }
 
 #if 0
   /*! \brief Read data from the random file.
@@ -312,7 +380,8 @@ template <> struct construct<fast_random_file_handle>
   fast_random_file_handle::extent_type bytes{(fast_random_file_handle::extent_type) -1};
   fast_random_file_handle::mode _mode{fast_random_file_handle::mode::read};
   span<const byte> seed{};
-  result<fast_random_file_handle> operator()() const noexcept { return fast_random_file_handle::fast_random_file(bytes, _mode, seed); }
+  fast_random_file_handle::generator g{fast_random_file_handle::generator::single_lane};
+  result<fast_random_file_handle> operator()() const noexcept { return fast_random_file_handle::fast_random_file(bytes, _mode, seed, g); }
 };
 
 #ifdef _MSC_VER
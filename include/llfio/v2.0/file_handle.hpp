@@ -304,10 +304,71 @@ public:
   \return A vector of pairs of extent offset + extent length representing the valid extents
   in this file. Filing systems which do not support extents return a single extent matching
   the length of the file rather than returning an error.
+
+  On Linux, where the filing system supports it, this is implemented using `FS_IOC_FIEMAP`
+  in large batches, with logically contiguous extents coalesced. Otherwise it falls back to
+  walking the file with `SEEK_DATA` and `SEEK_HOLE`, which costs two syscalls per extent.
+  Allocated but unwritten extents are reported as valid, as they may have dirty data in
+  the page cache not yet reflected in the extent map.
   */
   LLFIO_MAKE_FREE_FUNCTION
   LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<std::vector<extent_pair>> extents() const noexcept;
 
+  //! \brief Flags describing an allocated extent
+  QUICKCPPLIB_BITFIELD_BEGIN_T(extent_flag, uint8_t){
+  none = uint8_t(0),                         //!< No flags
+  unknown_location = uint8_t(1U << 0U),      //!< The physical location of the extent is not known
+  delayed_allocation = uint8_t(1U << 1U),    //!< The extent has not yet been allocated storage
+  encoded = uint8_t(1U << 2U),               //!< The extent is compressed or encrypted, so its physical storage does not correspond byte for byte
+  inline_data = uint8_t(1U << 3U),           //!< The extent is stored within filesystem metadata
+  unwritten = uint8_t(1U << 4U),             //!< The extent is allocated but unwritten, and so reads as zeros
+  shared = uint8_t(1U << 5U)                 //!< The extent's storage is shared with other files or snapshots
+  } QUICKCPPLIB_BITFIELD_END(extent_flag)
+
+  //! \brief A valid extent with its physical location and flags
+  struct extent_info : public extent_pair
+  {
+    extent_type physical{(extent_type) -1};  //!< The offset of the extent on the storage device, or -1 if unknown
+    extent_flag flags{extent_flag::none};    //!< Flags describing the extent
+
+    constexpr extent_info() {}
+    constexpr extent_info(extent_type _offset, extent_type _length, extent_type _physical = (extent_type) -1, extent_flag _flags = extent_flag::none)
+        : extent_pair(_offset, _length)
+        , physical(_physical)
+        , flags(_flags)
+    {
+    }
+  };
+
+  /*! \brief Returns a list of currently allocated extents for this open file, with their physical
+  location on the storage device and flags. WARNING: racy!
+
+  Unlike `extents()`, logically contiguous extents are not coalesced, so a fragmented
+  file returns one item per fragment. On Linux this uses `FS_IOC_FIEMAP` in large batches,
+  without flushing dirty data first so that `extent_flag::delayed_allocation` can be
+  reported. Do not use this to decide which bytes to copy, use `extents()` for that.
+  Where that is not supported, or on other platforms, this returns `extents()` with
+  every extent marked as `extent_flag::unknown_location`.
+  */
+  LLFIO_MAKE_FREE_FUNCTION
+  LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<std::vector<extent_info>> detailed_extents() const noexcept;
+
+  //! \brief The methods by which `clone_extents_to()` transferred content
+  QUICKCPPLIB_BITFIELD_BEGIN_T(clone_method, uint8_t){
+  none = uint8_t(0),  //!< Nothing was transferred
+  /*! Extents were cloned by reference, sharing storage copy-on-write with the source
+  (`FICLONERANGE` on Linux, `FSCTL_DUPLICATE_EXTENTS_TO_FILE` on Windows). This takes
+  constant time, and consumes no new storage.
+  */
+  reflinked = uint8_t(1U << 0U),
+  /*! Content was copied within the kernel without passing through user space (`copy_file_range()`,
+  `splice()`, `sendfile()`). Some filesystems implement this by cloning by reference,
+  others by copying the bytes.
+  */
+  kernel_copied = uint8_t(1U << 1U),
+  copied = uint8_t(1U << 2U)  //!< Content was copied through a buffer in user space
+  } QUICKCPPLIB_BITFIELD_END(clone_method)
+
   /*! \brief Clones the extents referred to by `extent` to `dest` at `destoffset`. This
   is how you ought to copy file content, including within the same file. This is
   fundamentally a racy call with respect to concurrent modification of the files.
@@ -326,12 +387,18 @@ public:
   copy going over the network. This is usually far more efficient.
 
   This implementation first enumerates the valid extents for the region requested, and
-  only clones extents which are reported as valid. It
-  then iterates the platform specific syscall to cause the extents to be cloned in
+  only clones extents which are reported as valid. On Linux, it then tries to clone by
+  reference the block aligned portion of each valid extent in a single `FICLONERANGE`,
+  which either succeeds completely or not at all. For whatever was not cloned by reference,
+  it then iterates the platform specific syscall to cause the extents to be cloned in
   `utils::page_allocator<T>` sized chunks (i.e. the next large page greater or equal
   to 1Mb). Generally speaking, if the dedicated syscalls fail, the implementation falls
   back to a user space emulation, unless `emulate_if_unsupported` is false.
 
+  If `method` is not null, the methods which were used to transfer the content are
+  OR-ed into it. If `clone_method::reflinked` is the only method set, the clone shares
+  all of its storage with the source.
+
   If the region being cloned does not exist in the source file, the region is truncated
   to what is available. If the destination file is not big enough to receive the cloned
   region, it is extended. If the clone is occurring within the same inode, you should
@@ -352,12 +419,13 @@ public:
   LLFIO_MAKE_FREE_FUNCTION
   LLFIO_HEADERS_ONLY_VIRTUAL_SPEC
   result<extent_pair> clone_extents_to(extent_pair extent, byte_io_handle &dest, byte_io_handle::extent_type destoffset, deadline d = {}, bool force_copy_now = false,
-                                       bool emulate_if_unsupported = true) noexcept;
+                                       bool emulate_if_unsupported = true, clone_method *method = nullptr) noexcept;
   //! \overload
   LLFIO_MAKE_FREE_FUNCTION
-  result<extent_pair> clone_extents_to(byte_io_handle &dest, deadline d = {}, bool force_copy_now = false, bool emulate_if_unsupported = true) noexcept
+  result<extent_pair> clone_extents_to(byte_io_handle &dest, deadline d = {}, bool force_copy_now = false, bool emulate_if_unsupported = true,
+                                       clone_method *method = nullptr) noexcept
   {
-    return clone_extents_to({(extent_type)-1, (extent_type)-1}, dest, 0, d, force_copy_now, emulate_if_unsupported);
+    return clone_extents_to({(extent_type)-1, (extent_type)-1}, dest, 0, d, force_copy_now, emulate_if_unsupported, method);
   }
 
   /*! \brief Efficiently zero, and possibly deallocate, data on storage.
@@ -385,6 +453,86 @@ public:
   result<extent_type> zero(extent_type offset, extent_type bytes, deadline d = deadline()) noexcept { return zero({offset, bytes}, d); }
 
   LLFIO_DEADLINE_TRY_FOR_UNTIL(zero)
+
+  /*! \brief Allocates storage for the extent without changing the maximum extent of the file.
+
+  Writing into preallocated storage does not need to allocate blocks, which removes
+  allocation stalls from append heavy workloads, and tends to reduce fragmentation.
+  On Linux this is `fallocate(FALLOC_FL_KEEP_SIZE)`. On Windows, the allocation size of
+  the file is raised to cover the end of the extent, which works for storage after the
+  maximum extent only.
+
+  Where the filing system does not support preallocation, it is emulated by writing
+  zeros into any holes in the extent which lie within the maximum extent. Storage after
+  the maximum extent cannot be preallocated by emulation. Note that the emulation is
+  racy with respect to concurrent writes into the holes.
+
+  \return The bytes of the extent now having storage allocated.
+  \param extent The offset to start preallocating from and the number of bytes to preallocate.
+  \param d An optional deadline by which the i/o must complete, else it is cancelled.
+  \errors Any of the values POSIX fallocate() or write() can return.
+  */
+  LLFIO_MAKE_FREE_FUNCTION
+  LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> preallocate(extent_pair extent, deadline d = deadline()) noexcept;
+
+  /*! \brief Zeros the extent, keeping or allocating its storage, unlike `zero()` which deallocates it.
+
+  If the extent lies beyond the maximum extent, the file is extended as if zeros had
+  been written. On Linux this is `fallocate(FALLOC_FL_ZERO_RANGE)` which converts the extents
+  to unwritten without writing anything. Elsewhere, or where the filing system does not
+  support it, zeros are written.
+
+  \return The bytes zeroed.
+  \param extent The offset to start zeroing from and the number of bytes to zero.
+  \param d An optional deadline by which the i/o must complete, else it is cancelled.
+  \errors Any of the values POSIX fallocate() or write() can return.
+  */
+  LLFIO_MAKE_FREE_FUNCTION
+  LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> zero_range(extent_pair extent, deadline d = deadline()) noexcept;
+
+  /*! \brief Removes the extent from the file, moving all content after it down to fill the gap.
+
+  This is how to trim the head of a log without rewriting it. On Linux this is
+  `fallocate(FALLOC_FL_COLLAPSE_RANGE)`, which moves extents within the filing system's
+  metadata, and which requires the offset and length to be multiples of the filing system
+  block size. If the extent reaches the end of the file, the file is simply truncated.
+
+  Otherwise, if `emulate_if_unsupported` is true, the content after the extent is read
+  and written down over it, and the file truncated. This costs i/o proportional to the
+  content after the extent. If `emulate_if_unsupported` is false, an error comparing equal
+  to `errc::operation_not_supported` is returned instead.
+
+  \return The new maximum extent of the file.
+  \param extent The offset and length of the range to remove.
+  \param d An optional deadline by which the i/o must complete, else it is cancelled.
+  \param emulate_if_unsupported Whether to move content by reading and writing if the
+  filing system cannot do it.
+  \errors Any of the values POSIX fallocate(), read(), write() or ftruncate() can return.
+  */
+  LLFIO_MAKE_FREE_FUNCTION
+  LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> collapse_range(extent_pair extent, deadline d = deadline(), bool emulate_if_unsupported = true) noexcept;
+
+  /*! \brief Inserts a hole of the extent's length at its offset, moving all content after it up.
+
+  On Linux this is `fallocate(FALLOC_FL_INSERT_RANGE)`, which moves extents within the filing
+  system's metadata, and which requires the offset and length to be multiples of the filing
+  system block size. Inserting at the maximum extent simply extends the file. Inserting after
+  the maximum extent fails with `errc::invalid_argument`.
+
+  Otherwise, if `emulate_if_unsupported` is true, the file is extended, the content after
+  the offset is read and written up, and the inserted range is zeroed with `zero()`. This
+  costs i/o proportional to the content after the offset. If `emulate_if_unsupported` is
+  false, an error comparing equal to `errc::operation_not_supported` is returned instead.
+
+  \return The new maximum extent of the file.
+  \param extent The offset at which to insert, and the length of the hole to insert.
+  \param d An optional deadline by which the i/o must complete, else it is cancelled.
+  \param emulate_if_unsupported Whether to move content by reading and writing if the
+  filing system cannot do it.
+  \errors Any of the values POSIX fallocate(), read(), write() or ftruncate() can return.
+  */
+  LLFIO_MAKE_FREE_FUNCTION
+  LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> insert_range(extent_pair extent, deadline d = deadline(), bool emulate_if_unsupported = true) noexcept;
 };
 
 //! \brief Constructor for `file_handle`
@@ -508,6 +656,13 @@ inline result<std::vector<file_handle::extent_pair>> extents(const file_handle &
 {
   return self.extents();
 }
+/*! \brief Returns a list of currently allocated extents for this open file, with their physical
+location on the storage device and flags. WARNING: racy!
+*/
+inline result<std::vector<file_handle::extent_info>> detailed_extents(const file_handle &self) noexcept
+{
+  return self.detailed_extents();
+}
 /*! \brief Efficiently zero, and possibly deallocate, data on storage.
 
 On most major operating systems and with recent filing systems which are "extents based", one can
@@ -532,12 +687,63 @@ inline result<file_handle::extent_type> zero(file_handle &self, file_handle::ext
 {
   return self.zero(std::forward<decltype(offset)>(offset), std::forward<decltype(bytes)>(bytes), std::forward<decltype(d)>(d));
 }
+/*! \brief Allocates storage for the extent without changing the maximum extent of the file.
+\return The bytes of the extent now having storage allocated.
+\param self The object whose member function to call.
+\param extent The offset to start preallocating from and the number of bytes to preallocate.
+\param d An optional deadline by which the i/o must complete, else it is cancelled.
+\errors Any of the values POSIX fallocate() or write() can return.
+*/
+inline result<file_handle::extent_type> preallocate(file_handle &self, file_handle::extent_pair extent, deadline d = deadline()) noexcept
+{
+  return self.preallocate(std::forward<decltype(extent)>(extent), std::forward<decltype(d)>(d));
+}
+/*! \brief Zeros the extent, keeping or allocating its storage, unlike `zero()` which deallocates it.
+\return The bytes zeroed.
+\param self The object whose member function to call.
+\param extent The offset to start zeroing from and the number of bytes to zero.
+\param d An optional deadline by which the i/o must complete, else it is cancelled.
+\errors Any of the values POSIX fallocate() or write() can return.
+*/
+inline result<file_handle::extent_type> zero_range(file_handle &self, file_handle::extent_pair extent, deadline d = deadline()) noexcept
+{
+  return self.zero_range(std::forward<decltype(extent)>(extent), std::forward<decltype(d)>(d));
+}
+/*! \brief Removes the extent from the file, moving all content after it down to fill the gap.
+\return The new maximum extent of the file.
+\param self The object whose member function to call.
+\param extent The offset and length of the range to remove.
+\param d An optional deadline by which the i/o must complete, else it is cancelled.
+\param emulate_if_unsupported Whether to move content by reading and writing if the
+filing system cannot do it.
+\errors Any of the values POSIX fallocate(), read(), write() or ftruncate() can return.
+*/
+inline result<file_handle::extent_type> collapse_range(file_handle &self, file_handle::extent_pair extent, deadline d = deadline(),
+                                                       bool emulate_if_unsupported = true) noexcept
+{
+  return self.collapse_range(std::forward<decltype(extent)>(extent), std::forward<decltype(d)>(d), std::forward<decltype(emulate_if_unsupported)>(emulate_if_unsupported));
+}
+/*! \brief Inserts a hole of the extent's length at its offset, moving all content after it up.
+\return The new maximum extent of the file.
+\param self The object whose member function to call.
+\param extent The offset at which to insert, and the length of the hole to insert.
+\param d An optional deadline by which the i/o must complete, else it is cancelled.
+\param emulate_if_unsupported Whether to move content by reading and writing if the
+filing system cannot do it.
+\errors Any of the values POSIX fallocate(), read(), write() or ftruncate() can return.
+*/
+inline result<file_handle::extent_type> insert_range(file_handle &self, file_handle::extent_pair extent, deadline d = deadline(),
+                                                     bool emulate_if_unsupported = true) noexcept
+{
+  return self.insert_range(std::forward<decltype(extent)>(extent), std::forward<decltype(d)>(d), std::forward<decltype(emulate_if_unsupported)>(emulate_if_unsupported));
+}
 // END make_free_functions.py
 
 LLFIO_V2_NAMESPACE_END
 
 #if LLFIO_HEADERS_ONLY == 1 && !defined(DOXYGEN_SHOULD_SKIP_THIS)
 #define LLFIO_INCLUDED_BY_HEADER 1
+#include "detail/impl/file_handle.ipp"
 #ifdef _WIN32
 #include "detail/impl/windows/file_handle.ipp"
 #else
@@ -78,8 +78,11 @@ import LLFIO_MODULE_NAME;
 #endif
 #include "symlink_handle.hpp"
 
+#include "algorithm/aligned_buffer_pool.hpp"
 #include "algorithm/clone.hpp"
 #include "algorithm/contents.hpp"
+#include "algorithm/handle_adapter/bounce_buffered.hpp"
+#include "algorithm/handle_adapter/buffered.hpp"
 #include "algorithm/handle_adapter/cached_parent.hpp"
 #include "algorithm/reduce.hpp"
 #include "algorithm/shared_fs_mutex/atomic_append.hpp"
@@ -87,10 +90,27 @@ import LLFIO_MODULE_NAME;
 #include "algorithm/shared_fs_mutex/lock_files.hpp"
 #include "algorithm/shared_fs_mutex/safe_byte_ranges.hpp"
 #include "algorithm/summarize.hpp"
+#include "algorithm/write_behind.hpp"
+
+#ifndef LLFIO_EXCLUDE_DYNAMIC_THREAD_POOL_GROUP
+#include "algorithm/parallel_copy.hpp"
+#include "algorithm/readahead.hpp"
+#endif
 
 #ifndef LLFIO_EXCLUDE_MAPPED_FILE_HANDLE
+#include "algorithm/block_cache.hpp"
+#include "algorithm/deduplicate.hpp"
+#include "algorithm/difference.hpp"
+#include "algorithm/handle_adapter/block_cached.hpp"
+#include "algorithm/handle_adapter/checksummed.hpp"
+#include "algorithm/handle_adapter/compressed.hpp"
+#include "algorithm/handle_adapter/cow_overlay.hpp"
+#include "algorithm/handle_adapter/erasure_coded.hpp"
+#include "algorithm/handle_adapter/striped.hpp"
 #include "algorithm/handle_adapter/xor.hpp"
+#include "algorithm/scan_stream.hpp"
 #include "algorithm/shared_fs_mutex/memory_map.hpp"
+#include "algorithm/tree_digest.hpp"
 #include "algorithm/trivial_vector.hpp"
 #include "mapped.hpp"
 #endif
@@ -641,6 +641,26 @@ public:
     return extent.length;
   }
 
+  //! \brief Zeros the extent keeping its storage, updating the map if the file was extended.
+  LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> zero_range(extent_pair extent, deadline d = deadline()) noexcept override
+  {
+    OUTCOME_TRY(auto &&ret, file_handle::zero_range(extent, d));
+    OUTCOME_TRY(update_map());
+    return ret;
+  }
+  //! \brief Removes the extent from the file, then updates the map to match.
+  LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> collapse_range(extent_pair extent, deadline d = deadline(), bool emulate_if_unsupported = true) noexcept override
+  {
+    OUTCOME_TRY(file_handle::collapse_range(extent, d, emulate_if_unsupported));
+    return update_map();
+  }
+  //! \brief Inserts a hole into the file, then updates the map to match.
+  LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> insert_range(extent_pair extent, deadline d = deadline(), bool emulate_if_unsupported = true) noexcept override
+  {
+    OUTCOME_TRY(file_handle::insert_range(extent, d, emulate_if_unsupported));
+    return update_map();
+  }
+
 
 #if 0
   /*! \brief Read data from the mapped file.
@@ -0,0 +1,99 @@
+/* Test the throughput of the checksummed handle adapter against the raw handle
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#define DEFAULTSIZE (1024ULL * 1024 * 1024)
+#define BLOCKSIZE (1024 * 1024)
+#define CHECKSUMBLOCKSIZE 4096
+#define ITERATIONS 4
+
+#include "../../include/llfio/llfio.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+namespace llfio = LLFIO_V2_NAMESPACE;
+
+int main(int argc, char *argv[])
+{
+  const unsigned long long testsize = (argc > 1) ? strtoull(argv[1], nullptr, 10) * 1024 * 1024 : DEFAULTSIZE;
+  llfio::mapped<llfio::byte> buffer(BLOCKSIZE);
+  {
+    auto src = llfio::fast_random_file_handle::fast_random_file(BLOCKSIZE).value();
+    src.read(0, {{buffer.data(), buffer.size()}}).value();
+  }
+  auto report = [&](const char *name, unsigned long long bytes, std::chrono::high_resolution_clock::time_point begin) {
+    auto end = std::chrono::high_resolution_clock::now();
+    std::cout << "   " << name << ": " << ((double) bytes / 1024.0 / 1024.0 / std::chrono::duration_cast<std::chrono::duration<double>>(end - begin).count())
+              << " Mb/sec" << std::endl;
+  };
+
+  std::cout << "Benchmarking CRC32C implementation " << llfio::algorithm::crc32c_implementation() << " ..." << std::endl;
+  {
+    uint32_t crc = 0;
+    auto begin = std::chrono::high_resolution_clock::now();
+    for(unsigned long long n = 0; n < testsize; n += CHECKSUMBLOCKSIZE)
+    {
+      crc = llfio::algorithm::crc32c(buffer.data() + (n % BLOCKSIZE), CHECKSUMBLOCKSIZE, crc);
+    }
+    report("crc32c() of 4Kb blocks", testsize, begin);
+    if(crc == 78)
+    {
+      std::cout << "(ignore this)" << std::endl;
+    }
+  }
+
+  auto datah = llfio::file_handle::temp_inode().value();
+  auto checksumh = llfio::file_handle::temp_inode().value();
+  llfio::algorithm::checksummed_handle_adapter<llfio::file_handle, llfio::file_handle> h(
+  &datah, &checksumh, llfio::file_handle::mode::write, llfio::file_handle::flag::none, nullptr, CHECKSUMBLOCKSIZE);
+  auto test = [&](const char *name, llfio::file_handle &fh) {
+    std::cout << "Benchmarking " << name << " with " << (testsize / 1024 / 1024) << " Mb in " << (BLOCKSIZE / 1024) << " Kb i/o ..." << std::endl;
+    fh.truncate(0).value();
+    {
+      auto begin = std::chrono::high_resolution_clock::now();
+      for(unsigned long long offset = 0; offset < testsize; offset += BLOCKSIZE)
+      {
+        fh.write(offset, {{buffer.data(), buffer.size()}}).value();
+      }
+      report("Write", testsize, begin);
+    }
+    // Reads are from the page cache, so this measures the overhead of checksumming
+    {
+      auto begin = std::chrono::high_resolution_clock::now();
+      for(int n = 0; n < ITERATIONS; n++)
+      {
+        for(unsigned long long offset = 0; offset < testsize; offset += BLOCKSIZE)
+        {
+          fh.read(offset, {{buffer.data(), buffer.size()}}).value();
+        }
+      }
+      report("Read", testsize * ITERATIONS, begin);
+    }
+  };
+  test("raw file_handle", datah);
+  test("checksummed_handle_adapter", h);
+  return 0;
+}
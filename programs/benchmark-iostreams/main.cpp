@@ -141,6 +141,30 @@ template <class F> inline void run_test(const char *csv, off_t max_extent, F &&f
   }
 }
 
+template <class F> inline void run_sequential_test(const char *csv, off_t max_extent, F &&f)
+{
+  char buffer[MAXBLOCKSIZE];
+  std::vector<unsigned> results;
+  results.reserve(max_extent / MINBLOCKSIZE);
+  memset(buffer, 0, sizeof(buffer));
+  auto begin = nanoclock();
+  for(off_t offset = 0; offset + MAXBLOCKSIZE <= max_extent; offset += MAXBLOCKSIZE)
+  {
+    auto s = nanoclock();
+    f((unsigned) offset, buffer, MAXBLOCKSIZE);
+    auto e = nanoclock();
+    results.push_back((unsigned) (e - s));
+  }
+  auto end = nanoclock();
+  std::cout << "   Sequential read throughput: " << ((double) max_extent / 1024.0 / 1024.0 / ((end - begin) / 1000000000.0)) << " Mb/sec" << std::endl;
+  std::ofstream out(csv);
+  out << "," << MAXBLOCKSIZE << std::endl;
+  for(auto &i : results)
+  {
+    out << "," << i << std::endl;
+  }
+}
+
 int main()
 {
   {
@@ -283,6 +307,109 @@ int main()
 #endif
     });
   }
+#endif
+#if 1
+  {
+    std::cout << "Testing sequential latency of iostreams ..." << std::endl;
+    std::ifstream testfile("testfile");
+    testfile.exceptions(std::ios::failbit | std::ios::badbit);
+    run_sequential_test("iostreams_sequential.csv", REGIONSIZE, [&](unsigned /*unused*/, char *buffer, size_t len) { testfile.read(buffer, len); });
+  }
+  {
+    std::cout << "Testing sequential latency of llfio::file_handle ..." << std::endl;
+    auto th = llfio::file({}, "testfile").value();
+    run_sequential_test("file_handle_sequential.csv", REGIONSIZE,
+                        [&](unsigned offset, char *buffer, size_t len) { th.read(offset, {{(llfio::byte *) buffer, len}}).value(); });
+  }
+  {
+    std::cout << "Testing sequential latency of llfio::algorithm::buffered_handle_adapter ..." << std::endl;
+    auto th = llfio::algorithm::buffered<llfio::file_handle>(0, llfio::path_handle(), "testfile").value();
+    run_sequential_test("buffered_handle_adapter_sequential.csv", REGIONSIZE,
+                        [&](unsigned offset, char *buffer, size_t len) { th.read(offset, {{(llfio::byte *) buffer, len}}).value(); });
+  }
+  {
+    std::cout << "Testing sequential latency of llfio::algorithm::readahead_stream ..." << std::endl;
+    auto th = llfio::file({}, "testfile").value();
+    auto ras = llfio::algorithm::readahead_stream::create(th).value();
+    run_sequential_test("readahead_stream_sequential.csv", REGIONSIZE, [&](unsigned offset, char *buffer, size_t len) {
+      // Consume the zero-copy view. The copy is only to make the comparison fair.
+      while(len > 0)
+      {
+        auto v = ras.read(offset, len).value();
+        if(v.empty())
+        {
+          break;  // end of file
+        }
+        memcpy(buffer, v.data(), v.size());
+        buffer += v.size();
+        offset += (unsigned) v.size();
+        len -= v.size();
+      }
+    });
+    auto stats = ras.stats();
+    std::cout << "   hits = " << stats.hits << " waits = " << stats.waits << " misses = " << stats.misses << " prefetches = " << stats.prefetches << std::endl;
+  }
+  {
+    std::cout << "Testing sequential latency of llfio::algorithm::readahead_stream with caching::none ..." << std::endl;
+    auto th = llfio::file({}, "testfile", llfio::file_handle::mode::read, llfio::file_handle::creation::open_existing, llfio::file_handle::caching::none).value();
+    auto ras = llfio::algorithm::readahead_stream::create(th).value();
+    run_sequential_test("readahead_stream_direct_sequential.csv", REGIONSIZE, [&](unsigned offset, char *buffer, size_t len) {
+      while(len > 0)
+      {
+        auto v = ras.read(offset, len).value();
+        if(v.empty())
+        {
+          break;  // end of file
+        }
+        memcpy(buffer, v.data(), v.size());
+        buffer += v.size();
+        offset += (unsigned) v.size();
+        len -= v.size();
+      }
+    });
+  }
+#endif
+#if 1
+  {
+    static constexpr size_t SMALLWRITE = 64;
+    char buffer[SMALLWRITE];
+    memset(buffer, 'b', sizeof(buffer));
+    auto report = [](const char *name, uint64_t begin) {
+      auto end = nanoclock();
+      std::cout << "   " << name << " wrote " << SMALLWRITE << " byte records at "
+                << ((double) REGIONSIZE / 1024.0 / 1024.0 / ((end - begin) / 1000000000.0)) << " Mb/sec" << std::endl;
+    };
+    std::cout << "Testing sequential small writes ..." << std::endl;
+    {
+      std::ofstream testfile("testfile", std::ios::binary | std::ios::in | std::ios::out);
+      auto begin = nanoclock();
+      for(size_t offset = 0; offset < REGIONSIZE; offset += SMALLWRITE)
+      {
+        testfile.write(buffer, SMALLWRITE);
+      }
+      testfile.flush();
+      report("iostreams", begin);
+    }
+    {
+      auto th = llfio::file({}, "testfile", llfio::file_handle::mode::write).value();
+      auto begin = nanoclock();
+      for(size_t offset = 0; offset < REGIONSIZE; offset += SMALLWRITE)
+      {
+        th.write(offset, {{(const llfio::byte *) buffer, SMALLWRITE}}).value();
+      }
+      report("llfio::file_handle", begin);
+    }
+    {
+      auto th = llfio::algorithm::buffered<llfio::file_handle>(0, llfio::path_handle(), "testfile", llfio::file_handle::mode::write).value();
+      auto begin = nanoclock();
+      for(size_t offset = 0; offset < REGIONSIZE; offset += SMALLWRITE)
+      {
+        th.write(offset, {{(const llfio::byte *) buffer, SMALLWRITE}}).value();
+      }
+      th.flush().value();
+      report("llfio::algorithm::buffered_handle_adapter", begin);
+    }
+  }
 #endif
   llfio::filesystem::remove("testfile");
 }
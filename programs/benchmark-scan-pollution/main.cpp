@@ -0,0 +1,157 @@
+/* Test how much a scan of a large file evicts a neighbouring workload from the page cache
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+/* The effect is only visible if the scanned file is larger than the memory
+available for the page cache. Either pass a scan size in megabytes larger than
+your free RAM, or run this inside a memory limited cgroup, e.g.
+
+systemd-run --scope -p MemoryMax=1G ./benchmark-scan-pollution 4096
+*/
+
+#define HOTSIZE (256ULL * 1024 * 1024)
+#define BLOCKSIZE (1024 * 1024)
+
+#include "../../include/llfio/llfio.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+namespace llfio = LLFIO_V2_NAMESPACE;
+
+#ifndef _WIN32
+// The fraction of the hot file which is in the page cache, which is the hit rate it would see
+static double residency(llfio::file_handle &fh, size_t bytes)
+{
+  const size_t pagesize = llfio::utils::page_size();
+  std::vector<unsigned char> vec(bytes / pagesize);
+  void *addr = ::mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fh.native_handle().fd, 0);
+  if(addr == MAP_FAILED)
+  {
+    abort();
+  }
+#ifdef __linux__
+  ::mincore(addr, bytes, vec.data());
+#else
+  ::mincore(addr, bytes, (char *) vec.data());
+#endif
+  ::munmap(addr, bytes);
+  size_t resident = 0;
+  for(auto &i : vec)
+  {
+    resident += (i & 1);
+  }
+  return (double) resident / vec.size();
+}
+#endif
+
+int main(int argc, char *argv[])
+{
+#ifdef _WIN32
+  (void) argc;
+  (void) argv;
+  std::cerr << "This benchmark requires mincore(), which Windows does not have." << std::endl;
+  return 1;
+#else
+  const unsigned long long scansize = ((argc > 1) ? strtoull(argv[1], nullptr, 10) : 4096ULL) * 1024 * 1024;
+  std::vector<llfio::byte> buffer(BLOCKSIZE, llfio::to_byte(0x5a));
+  std::cout << "Creating " << (HOTSIZE / 1024 / 1024) << " Mb hot file and " << (scansize / 1024 / 1024) << " Mb scan file ..." << std::endl;
+  auto hotfh = llfio::file({}, "hotfile", llfio::file_handle::mode::write, llfio::file_handle::creation::if_needed).value();
+  auto scanfh = llfio::file({}, "scanfile", llfio::file_handle::mode::write, llfio::file_handle::creation::if_needed).value();
+  for(unsigned long long offset = 0; offset < HOTSIZE; offset += BLOCKSIZE)
+  {
+    hotfh.write(offset, {{buffer.data(), buffer.size()}}).value();
+  }
+  for(unsigned long long offset = 0; offset < scansize; offset += BLOCKSIZE)
+  {
+    scanfh.write(offset, {{buffer.data(), buffer.size()}}).value();
+  }
+  hotfh.barrier({}, llfio::file_handle::barrier_kind::wait_data_only).value();
+  scanfh.barrier({}, llfio::file_handle::barrier_kind::wait_data_only).value();
+
+  auto warm_hot = [&] {
+    // The neighbouring workload touches its working set twice, so it is on the active list
+    for(int n = 0; n < 2; n++)
+    {
+      for(unsigned long long offset = 0; offset < HOTSIZE; offset += BLOCKSIZE)
+      {
+        hotfh.read(offset, {{buffer.data(), buffer.size()}}).value();
+      }
+    }
+  };
+  auto drop_scan = [&] {
+    // Evict the scan file so each run starts from the same place
+    llfio::algorithm::scan_stream::config c;
+    c.drop_preexisting_pages = true;
+    llfio::algorithm::scan_stream ss(scanfh, 0, c);
+    ss.consumed(0, scansize).value();
+    ss.finish().value();
+  };
+  auto report = [&](const char *name, std::chrono::high_resolution_clock::time_point begin) {
+    auto end = std::chrono::high_resolution_clock::now();
+    std::cout << "   " << name << " scanned at "
+              << ((double) scansize / 1024.0 / 1024.0 / std::chrono::duration_cast<std::chrono::duration<double>>(end - begin).count())
+              << " Mb/sec. Hot file hit rate afterwards = " << (100.0 * residency(hotfh, HOTSIZE))
+              << "%. Scan file residency afterwards = " << (100.0 * residency(scanfh, (size_t) scansize)) << "%." << std::endl;
+  };
+
+  drop_scan();
+  warm_hot();
+  std::cout << "Hot file hit rate before scanning = " << (100.0 * residency(hotfh, HOTSIZE)) << "%" << std::endl;
+  {
+    auto begin = std::chrono::high_resolution_clock::now();
+    for(unsigned long long offset = 0; offset < scansize; offset += BLOCKSIZE)
+    {
+      scanfh.read(offset, {{buffer.data(), buffer.size()}}).value();
+    }
+    report("Plain file_handle reads", begin);
+  }
+
+  drop_scan();
+  warm_hot();
+  {
+    auto begin = std::chrono::high_resolution_clock::now();
+    llfio::algorithm::scan_stream ss(scanfh);
+    for(unsigned long long offset = 0; offset < scansize; offset += BLOCKSIZE)
+    {
+      ss.read(offset, {{buffer.data(), buffer.size()}}).value();
+    }
+    ss.finish().value();
+    report("algorithm::scan_stream reads", begin);
+    auto stats = ss.stats();
+    std::cout << "   pages dropped = " << stats.pages_dropped << " pages preserved = " << stats.pages_preserved << std::endl;
+  }
+
+  hotfh.close().value();
+  scanfh.close().value();
+  llfio::filesystem::remove("hotfile");
+  llfio::filesystem::remove("scanfile");
+  return 0;
+#endif
+}
@@ -0,0 +1,91 @@
+/* Test the tail latency of streaming writes with and without write behind
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#define BLOCKSIZE (256 * 1024)
+#define REGIONSIZE (4ULL * 1024 * 1024 * 1024)
+
+#include "../../include/llfio/llfio.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace llfio = LLFIO_V2_NAMESPACE;
+
+inline void run_test(const char *name, const char *csv, bool write_behind, bool drop_written_pages = false)
+{
+  std::vector<llfio::byte> buffer(BLOCKSIZE, llfio::to_byte(0x5a));
+  std::vector<unsigned> results(REGIONSIZE / BLOCKSIZE);
+  std::cout << "Testing latency of " << name << " ..." << std::endl;
+  auto fh = llfio::file({}, "testfile", llfio::file_handle::mode::write, llfio::file_handle::creation::if_needed).value();
+  fh.truncate(0).value();
+  llfio::algorithm::write_behind_stream::config c;
+  c.drop_written_pages = drop_written_pages;
+  llfio::algorithm::write_behind_stream wbs(fh, 0, c);
+  auto begin = std::chrono::high_resolution_clock::now();
+  for(size_t n = 0; n < results.size(); n++)
+  {
+    auto s = std::chrono::high_resolution_clock::now();
+    if(write_behind)
+    {
+      wbs.write(n * BLOCKSIZE, {{buffer.data(), buffer.size()}}).value();
+    }
+    else
+    {
+      fh.write(n * BLOCKSIZE, {{buffer.data(), buffer.size()}}).value();
+    }
+    results[n] = (unsigned) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - s).count();
+  }
+  if(write_behind)
+  {
+    wbs.flush().value();
+  }
+  fh.barrier({}, llfio::file_handle::barrier_kind::wait_data_only).value();
+  auto end = std::chrono::high_resolution_clock::now();
+  {
+    std::ofstream out(csv);
+    for(auto &i : results)
+    {
+      out << i << std::endl;
+    }
+  }
+  auto sorted(results);
+  std::sort(sorted.begin(), sorted.end());
+  auto percentile = [&](double p) { return sorted[(size_t) (p * (sorted.size() - 1))] / 1000.0; };
+  std::cout << "   Throughput including final barrier: "
+            << ((double) REGIONSIZE / 1024.0 / 1024.0 / std::chrono::duration_cast<std::chrono::duration<double>>(end - begin).count()) << " Mb/sec\n"
+            << "   p50 = " << percentile(0.5) << " us, p99 = " << percentile(0.99) << " us, p99.9 = " << percentile(0.999)
+            << " us, max = " << sorted.back() / 1000.0 << " us" << std::endl;
+}
+
+int main()
+{
+  run_test("plain file_handle writes", "plain.csv", false);
+  run_test("algorithm::write_behind_stream writes", "write_behind.csv", true);
+  run_test("algorithm::write_behind_stream writes dropping written pages", "write_behind_drop.csv", true, true);
+  llfio::filesystem::remove("testfile");
+  return 0;
+}
@@ -0,0 +1,135 @@
+/* Integration test kernel for the aligned buffer pool and bounce buffered handle adapter
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#include "../test_kernel_decl.hpp"
+
+#include "quickcpplib/algorithm/small_prng.hpp"
+
+static inline void TestAlignedBufferPool()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  llfio::algorithm::aligned_buffer_pool::config c;
+  c.buffer_size = 65536;
+  c.buffers = 4;
+  c.alignment = 4096;
+  c.fallback_to_mapping = false;
+  auto pool = llfio::algorithm::aligned_buffer_pool::create(c).value();
+  BOOST_CHECK(pool.buffer_size() == 65536);
+  BOOST_CHECK(pool.available() == 4);
+  BOOST_CHECK(pool.region().size() == 4 * 65536);
+  {
+    std::vector<llfio::algorithm::aligned_buffer_pool::registered_buffer_type> bufs;
+    for(size_t n = 0; n < 4; n++)
+    {
+      bufs.push_back(pool.allocate().value());
+      BOOST_CHECK((((uintptr_t) bufs.back()->data()) & 4095) == 0);
+      BOOST_CHECK(bufs.back()->size() == 65536);
+      BOOST_CHECK(pool.index_of(bufs.back()) < 4);
+    }
+    BOOST_CHECK(pool.available() == 0);
+    auto r = pool.allocate();
+    BOOST_CHECK(!r);
+    BOOST_CHECK(r.error() == llfio::errc::resource_unavailable_try_again);
+    bufs.pop_back();
+    BOOST_CHECK(pool.available() == 1);
+    BOOST_CHECK(pool.allocate());
+  }
+  BOOST_CHECK(pool.available() == 4);
+  c.fallback_to_mapping = true;
+  auto pool2 = llfio::algorithm::aligned_buffer_pool::create(c).value();
+  auto big = pool2.allocate(1024 * 1024).value();
+  BOOST_CHECK(big->size() >= 1024 * 1024);
+  BOOST_CHECK(pool2.index_of(big) == (size_t) -1);
+}
+
+static inline void TestBounceBufferedHandleAdapter()
+{
+  static constexpr size_t testbytes = 1024 * 1024UL;
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  using llfio::byte;
+  using QUICKCPPLIB_NAMESPACE::algorithm::small_prng::small_prng;
+  auto pool = llfio::algorithm::aligned_buffer_pool::create().value();
+  auto fh = llfio::algorithm::bounce_buffered<llfio::file_handle>(pool, llfio::path_discovery::storage_backed_temporary_files_directory(), "bounce_buffered_test",
+                                                                   llfio::file_handle::mode::write, llfio::file_handle::creation::if_needed,
+                                                                   llfio::file_handle::caching::none, llfio::file_handle::flag::unlink_on_first_close);
+  if(!fh)
+  {
+    // Some filesystems e.g. tmpfs do not support O_DIRECT
+    std::cout << "NOTE: Could not open a file with caching::none due to " << fh.error().message() << ", testing with caching::all" << std::endl;
+    fh = llfio::algorithm::bounce_buffered<llfio::file_handle>(pool, llfio::path_discovery::storage_backed_temporary_files_directory(), "bounce_buffered_test",
+                                                               llfio::file_handle::mode::write, llfio::file_handle::creation::if_needed,
+                                                               llfio::file_handle::caching::all, llfio::file_handle::flag::unlink_on_first_close);
+  }
+  auto &h = fh.value();
+  h.truncate(0).value();
+  std::cout << "Handle requires aligned i/o = " << h.requires_aligned_io() << " alignment = " << h.alignment() << std::endl;
+  std::vector<byte> shadow(testbytes), buffer(testbytes);
+  small_prng rand;
+  llfio::file_handle::extent_type length = 0;
+  for(size_t n = 0; n < 2000; n++)
+  {
+    const size_t offset = rand() % (testbytes - 65536), bytes = 1 + rand() % 65535;
+    if(n % 2 == 0)
+    {
+      for(size_t i = 0; i < bytes; i++)
+      {
+        buffer[i] = (byte) rand();
+      }
+      BOOST_REQUIRE(h.write(offset, {{buffer.data() + 1, bytes - 1}, {buffer.data(), 1}}).value() == bytes);
+      memcpy(shadow.data() + offset, buffer.data() + 1, bytes - 1);
+      shadow[offset + bytes - 1] = buffer[0];
+      length = std::max(length, (llfio::file_handle::extent_type)(offset + bytes));
+      BOOST_REQUIRE(h.maximum_extent().value() == length);
+    }
+    else
+    {
+      const size_t read = h.read(offset, {{buffer.data() + 3, bytes}}).value();
+      const size_t expected = (offset >= length) ? 0 : std::min((size_t) (length - offset), bytes);
+      BOOST_REQUIRE(read == expected);
+      BOOST_CHECK(0 == memcmp(buffer.data() + 3, shadow.data() + offset, read));
+    }
+  }
+
+  std::cout << "Testing small writes within a file whose length is not a multiple of the alignment ..." << std::endl;
+  length = 3 * h.alignment() + 100;
+  h.truncate(0).value();
+  BOOST_REQUIRE(h.write(0, {{shadow.data(), (size_t) length}}).value() == length);
+  BOOST_REQUIRE(h.maximum_extent().value() == length);
+  for(auto offset : {h.alignment() + 7, 3 * h.alignment() + 10, (size_t) length - 5})
+  {
+    for(size_t i = 0; i < 5; i++)
+    {
+      shadow[offset + i] = (byte) rand();
+    }
+    BOOST_REQUIRE(h.write(offset, {{shadow.data() + offset, 5}}).value() == 5);
+    BOOST_CHECK(h.maximum_extent().value() == length);
+    BOOST_REQUIRE(h.read(0, {{buffer.data() + 3, testbytes - 3}}).value() == length);
+    BOOST_CHECK(0 == memcmp(buffer.data() + 3, shadow.data(), (size_t) length));
+  }
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, algorithm, aligned_buffer_pool, "Tests that algorithm::aligned_buffer_pool works as expected", TestAlignedBufferPool())
+KERNELTEST_TEST_KERNEL(integration, llfio, algorithm, bounce_buffered_handle_adapter, "Tests that algorithm::bounce_buffered_handle_adapter works as expected",
+                       TestBounceBufferedHandleAdapter())
@@ -0,0 +1,130 @@
+/* Integration test kernel for the buffered handle adapter
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#include "../test_kernel_decl.hpp"
+
+#include "quickcpplib/algorithm/small_prng.hpp"
+
+static inline void TestBufferedHandleAdapter()
+{
+  static constexpr size_t testbytes = 1024 * 1024UL, buffer_size = 65536;
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  using llfio::byte;
+  using QUICKCPPLIB_NAMESPACE::algorithm::small_prng::small_prng;
+  std::vector<byte> shouldbe(testbytes), check(3 * buffer_size), random(3 * buffer_size);
+  {
+    auto src = llfio::fast_random_file_handle::fast_random_file(random.size()).value();
+    BOOST_REQUIRE(src.read(0, {{random.data(), random.size()}}).value() == random.size());
+  }
+
+  std::cout << "Testing random reads and writes ..." << std::endl;
+  {
+    llfio::algorithm::buffered_handle_adapter<llfio::file_handle> h(llfio::file_handle::temp_inode().value(), buffer_size);
+    BOOST_REQUIRE(h.buffer_size() == buffer_size);
+    h.truncate(testbytes).value();
+    small_prng rand;
+    for(size_t n = 0; n < 100000; n++)
+    {
+      const size_t length = ((n & 255) == 0) ? (rand() % (3 * buffer_size)) : (rand() % 512);
+      const size_t offset = rand() % (testbytes - length);
+      if(rand() & 1)
+      {
+        const size_t from = rand() % (random.size() - length);
+        BOOST_REQUIRE(h.write(offset, {{random.data() + from, length}}).value() == length);
+        memcpy(shouldbe.data() + offset, random.data() + from, length);
+      }
+      else
+      {
+        BOOST_REQUIRE(h.read(offset, {{check.data(), length}}).value() == length);
+        if(0 != memcmp(check.data(), shouldbe.data() + offset, length))
+        {
+          BOOST_REQUIRE(false);
+        }
+      }
+    }
+    h.flush().value();
+    BOOST_CHECK(h.buffered_write_bytes() == 0);
+    auto raw = h.reopen(llfio::file_handle::mode::read).value();
+    std::vector<byte> contents(testbytes);
+    BOOST_REQUIRE(raw.read(0, {{contents.data(), contents.size()}}).value() == testbytes);
+    BOOST_CHECK(0 == memcmp(contents.data(), shouldbe.data(), testbytes));
+  }
+
+  std::cout << "Testing small writes are coalesced ..." << std::endl;
+  {
+    llfio::algorithm::buffered_handle_adapter<llfio::file_handle> h(llfio::file_handle::temp_inode().value(), buffer_size);
+    auto raw = h.reopen(llfio::file_handle::mode::read).value();
+    for(size_t offset = 0; offset < buffer_size - 100; offset += 100)
+    {
+      h.write(offset, {{random.data() + offset, 100}}).value();
+    }
+    BOOST_CHECK(h.buffered_write_bytes() > 0);
+    BOOST_CHECK(raw.maximum_extent().value() == 0);
+    // Completing the block writes it out
+    for(size_t offset = (buffer_size - 100) / 100 * 100; offset < buffer_size; offset += 100)
+    {
+      const size_t length = std::min((size_t) 100, buffer_size - offset);
+      h.write(offset, {{random.data() + offset, length}}).value();
+    }
+    BOOST_CHECK(h.buffered_write_bytes() == 0);
+    BOOST_CHECK(raw.maximum_extent().value() == buffer_size);
+    // Reading what is buffered writes it out first
+    h.write(buffer_size, {{random.data(), 100}}).value();
+    BOOST_CHECK(h.buffered_write_bytes() == 100);
+    BOOST_REQUIRE(h.read(buffer_size - 50, {{check.data(), 100}}).value() == 100);
+    BOOST_CHECK(0 == memcmp(check.data(), random.data() + buffer_size - 50, 50));
+    BOOST_CHECK(0 == memcmp(check.data() + 50, random.data(), 50));
+    BOOST_CHECK(h.buffered_write_bytes() == 0);
+    BOOST_CHECK(raw.maximum_extent().value() == buffer_size + 100);
+    // Reads past the end return nothing
+    BOOST_CHECK(h.read(buffer_size + 100, {{check.data(), 100}}).value() == 0);
+  }
+
+  std::cout << "Testing a pipe ..." << std::endl;
+  {
+    auto pipes = llfio::pipe_handle::anonymous_pipe().value();
+    llfio::algorithm::buffered_handle_adapter<llfio::pipe_handle> reader(std::move(pipes.first), 4096), writer(std::move(pipes.second), 4096);
+    for(size_t offset = 0; offset < 10000; offset += 10)
+    {
+      writer.write(0, {{random.data() + offset, 10}}).value();
+    }
+    writer.close().value();
+    size_t offset = 0;
+    for(;;)
+    {
+      auto bytes = reader.read(0, {{check.data(), 7}}).value();
+      if(bytes == 0)
+      {
+        break;
+      }
+      BOOST_REQUIRE(offset + bytes <= 10000);
+      BOOST_CHECK(0 == memcmp(check.data(), random.data() + offset, bytes));
+      offset += bytes;
+    }
+    BOOST_CHECK(offset == 10000);
+  }
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, algorithm, buffered, "Tests that algorithm::buffered_handle_adapter works as expected", TestBufferedHandleAdapter())
@@ -0,0 +1,109 @@
+/* Integration test kernel for multi-offset reads and writes
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#include "../test_kernel_decl.hpp"
+
+#include "quickcpplib/algorithm/small_prng.hpp"
+
+static inline void TestReadWriteMultiple()
+{
+  static constexpr size_t testbytes = 4 * 1024 * 1024UL, records = 200, recordbytes = 4096;
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  using llfio::byte;
+  using QUICKCPPLIB_NAMESPACE::algorithm::small_prng::small_prng;
+  auto test = [](llfio::file_handle &fh) {
+    llfio::mapped<byte> store(testbytes), check(records * recordbytes);
+    {
+      auto src = llfio::fast_random_file_handle::fast_random_file(testbytes).value();
+      BOOST_REQUIRE(src.read(0, {{store.data(), store.size()}}).value() == testbytes);
+    }
+    small_prng rand;
+    std::vector<size_t> offsets(records);
+    for(auto &i : offsets)
+    {
+      i = (rand() % (testbytes / recordbytes)) * recordbytes;
+    }
+    // Write the whole file as one record per block
+    {
+      std::vector<llfio::file_handle::const_buffer_type> buffers;
+      std::vector<llfio::file_handle::io_request<llfio::file_handle::const_buffers_type>> reqs;
+      std::vector<llfio::file_handle::io_result<llfio::file_handle::const_buffers_type>> results(testbytes / recordbytes);
+      buffers.reserve(testbytes / recordbytes);
+      for(size_t offset = 0; offset < testbytes; offset += recordbytes)
+      {
+        buffers.emplace_back(store.data() + offset, recordbytes);
+        reqs.emplace_back(llfio::file_handle::const_buffers_type(&buffers.back(), 1), offset);
+      }
+      fh.write_multiple(reqs, results).value();
+      for(auto &i : results)
+      {
+        BOOST_CHECK(i.value().size() == 1);
+        BOOST_CHECK(i.bytes_transferred() == recordbytes);
+      }
+    }
+    // Read random records back
+    {
+      std::vector<llfio::file_handle::buffer_type> buffers;
+      std::vector<llfio::file_handle::io_request<llfio::file_handle::buffers_type>> reqs;
+      std::vector<llfio::file_handle::io_result<llfio::file_handle::buffers_type>> results(records + 1);
+      buffers.reserve(records + 1);
+      for(size_t n = 0; n < records; n++)
+      {
+        buffers.emplace_back(check.data() + n * recordbytes, recordbytes);
+        reqs.emplace_back(llfio::file_handle::buffers_type(&buffers.back(), 1), offsets[n]);
+      }
+      // One beyond the end of the file, which reads nothing without affecting the others
+      buffers.emplace_back(check.data(), recordbytes);
+      reqs.emplace_back(llfio::file_handle::buffers_type(&buffers.back(), 1), testbytes);
+      fh.read_multiple(reqs, results).value();
+      for(size_t n = 0; n < records; n++)
+      {
+        BOOST_REQUIRE(results[n].bytes_transferred() == recordbytes);
+        BOOST_CHECK(0 == memcmp(results[n].value()[0].data(), store.data() + offsets[n], recordbytes));
+      }
+      BOOST_CHECK(results[records].bytes_transferred() == 0);
+      BOOST_CHECK(fh.read_multiple(reqs, {results.data(), records}).error() == llfio::errc::invalid_argument);
+    }
+  };
+  std::cout << "Testing without an i/o multiplexer ..." << std::endl;
+  {
+    auto fh = llfio::file_handle::temp_inode().value();
+    test(fh);
+  }
+#if LLFIO_ENABLE_TEST_IO_MULTIPLEXERS
+  std::cout << "Testing with the null i/o multiplexer ..." << std::endl;
+  {
+    auto multiplexer = llfio::test::multiplexer_null(1, false).value();
+    auto fh =
+    llfio::file_handle::temp_inode(llfio::path_discovery::storage_backed_temporary_files_directory(), llfio::file_handle::mode::write, llfio::file_handle::flag::multiplexable)
+    .value();
+    fh.set_multiplexer(multiplexer.get()).value();
+    test(fh);
+  }
+#endif
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, byte_io_handle, multiple, "Tests that byte_io_handle::read_multiple() and write_multiple() work as expected",
+                       TestReadWriteMultiple())
@@ -102,7 +102,11 @@ static inline void TestCloneExtents()
     llfio::mapped_file_handle::extent_pair srcregion{(rand() % (handles[0].maximum_extent / 2)), (rand() % (handles[0].maximum_extent / 2))};
     auto destoffset = rand() % (handles[1].maximum_extent / 2);
     std::cout << "\nRound " << (round + 1) << ": Cloning " << srcregion.offset << "-" << srcregion.length << " to offset " << destoffset << " ..." << std::endl;
-    handles[0].fh.clone_extents_to(srcregion, handles[1].fh, destoffset).value();
+    llfio::file_handle::clone_method method(llfio::file_handle::clone_method::none);
+    handles[0].fh.clone_extents_to(srcregion, handles[1].fh, destoffset, {}, false, true, &method).value();
+    std::cout << "   Reflinked = " << !!(method & llfio::file_handle::clone_method::reflinked)
+              << " kernel copied = " << !!(method & llfio::file_handle::clone_method::kernel_copied)
+              << " copied = " << !!(method & llfio::file_handle::clone_method::copied) << std::endl;
     // Destination will be original maximum extent, or any overlap of extents copied
     auto maxtobecopied = std::min(srcregion.length, handles[0].maximum_extent - srcregion.offset);
     auto destshouldbe = std::max(handles[1].maximum_extent, destoffset + maxtobecopied);
@@ -182,7 +186,11 @@ static inline void TestCloneOrCopyFileWhole()
 
     auto randomname = llfio::utils::random_string(32);
     randomname.append(".random");
-    llfio::algorithm::clone_or_copy(srcfh, tempdirh, randomname).value();
+    llfio::file_handle::clone_method method(llfio::file_handle::clone_method::none);
+    llfio::algorithm::clone_or_copy(srcfh, tempdirh, randomname, true, false, llfio::file_handle::creation::always_new, {}, &method).value();
+    std::cout << "   Reflinked = " << !!(method & llfio::file_handle::clone_method::reflinked)
+              << " kernel copied = " << !!(method & llfio::file_handle::clone_method::kernel_copied)
+              << " copied = " << !!(method & llfio::file_handle::clone_method::copied) << std::endl;
 
     auto destfh =
     llfio::mapped_file_handle::mapped_file(tempdirh, randomname, llfio::mapped_file_handle::mode::write, llfio::mapped_file_handle::creation::open_existing,
@@ -302,7 +310,65 @@ static inline void TestCloneOrCopyTree()
 }
 #endif
 
+static inline void TestExtents()
+{
+  static constexpr size_t extent_count = 2000, extent_size = 65536, stride = 4 * extent_size;
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  auto fh = llfio::file_handle::temp_file().value();
+  // A heavily fragmented sparse file
+  std::vector<llfio::byte> buffer(extent_size, llfio::to_byte(78));
+  for(size_t n = 0; n < extent_count; n++)
+  {
+    fh.write(n * stride, {{buffer.data(), buffer.size()}}).value();
+  }
+  fh.truncate(extent_count * stride).value();
+  auto begin = std::chrono::high_resolution_clock::now();
+  auto extents = fh.extents().value();
+  auto end = std::chrono::high_resolution_clock::now();
+  std::cout << "extents() returned " << extents.size() << " extents in " << (std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count())
+            << " microseconds." << std::endl;
+  BOOST_REQUIRE(!extents.empty());
+  if(extents.size() == 1)
+  {
+    std::cout << "NOTE: This filing system does not support extents enumeration." << std::endl;
+    BOOST_CHECK(extents.front().offset == 0 && extents.front().length == extent_count * stride);
+  }
+  else
+  {
+    // Every written region must be covered by some extent, and extents must be ordered and not overlap
+    for(size_t n = 1; n < extents.size(); n++)
+    {
+      BOOST_CHECK(extents[n - 1].offset + extents[n - 1].length < extents[n].offset);
+    }
+    size_t idx = 0;
+    for(size_t n = 0; n < extent_count; n++)
+    {
+      const llfio::file_handle::extent_type offset = n * stride;
+      while(idx < extents.size() && extents[idx].offset + extents[idx].length <= offset)
+      {
+        idx++;
+      }
+      BOOST_REQUIRE(idx < extents.size());
+      BOOST_CHECK(extents[idx].offset <= offset && extents[idx].offset + extents[idx].length >= offset + extent_size);
+    }
+  }
+  auto detailed = fh.detailed_extents().value();
+  std::cout << "detailed_extents() returned " << detailed.size() << " extents." << std::endl;
+  llfio::file_handle::extent_type detailedbytes = 0, validbytes = 0;
+  for(auto &i : detailed)
+  {
+    detailedbytes += i.length;
+  }
+  for(auto &i : extents)
+  {
+    validbytes += i.length;
+  }
+  BOOST_CHECK(detailed.size() >= extents.size());
+  BOOST_CHECK(detailedbytes >= validbytes);
+}
+
 KERNELTEST_TEST_KERNEL(integration, llfio, algorithm, clone_extents, "Tests that llfio::file_handle::clone_extents() of partial extents works as expected",
                        TestCloneExtents())
 KERNELTEST_TEST_KERNEL(integration, llfio, algorithm, clone_or_copy_file_whole,
                        "Tests that llfio::algorithm::clone_or_copy(file_handle) of whole files works as expected", TestCloneOrCopyFileWhole())
+KERNELTEST_TEST_KERNEL(integration, llfio, file_handle, extents, "Tests that llfio::file_handle::extents() and detailed_extents() work as expected", TestExtents())
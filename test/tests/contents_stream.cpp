@@ -0,0 +1,95 @@
+/* Integration test kernel for algorithm::contents_stream()
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+
+#include "../test_kernel_decl.hpp"
+
+#include <mutex>
+#include <set>
+
+static inline void TestContentsStream()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  auto tempdirh = llfio::directory_handle::temp_directory().value();
+  auto untempdir = llfio::make_scope_exit([&]() noexcept { (void) llfio::algorithm::reduce(std::move(tempdirh)); });
+  auto write = [&](llfio::path_view path, const char *content) {
+    auto fh = llfio::file_handle::file(tempdirh, path, llfio::file_handle::mode::write, llfio::file_handle::creation::always_new).value();
+    fh.write(0, {{(const llfio::byte *) content, strlen(content)}}).value();
+  };
+  llfio::directory_handle::directory(tempdirh, "a", llfio::directory_handle::mode::write, llfio::directory_handle::creation::if_needed).value();
+  llfio::directory_handle::directory(tempdirh, "a/b", llfio::directory_handle::mode::write, llfio::directory_handle::creation::if_needed).value();
+  llfio::directory_handle::directory(tempdirh, "empty", llfio::directory_handle::mode::write, llfio::directory_handle::creation::if_needed).value();
+  write("top", "1");
+  write("a/x", "12");
+  write("a/b/y", "123");
+  write("a/b/z", "1234");
+
+  using entries_type = std::set<std::pair<std::string, llfio::handle::extent_type>>;
+  struct visitor_type final : llfio::algorithm::contents_stream_visitor
+  {
+    std::mutex lock;
+    entries_type entries;
+    std::set<uint64_t> directory_ids;
+
+    using llfio::algorithm::contents_stream_visitor::contents_stream_visitor;
+
+    virtual llfio::result<void> contents_emit(void *data, const llfio::algorithm::contents_batch &batch) noexcept override
+    {
+      (void) data;
+      std::lock_guard<std::mutex> g(lock);
+      BOOST_CHECK(batch.directory.is_relative());
+      BOOST_CHECK(directory_ids.insert(batch.directory_id).second);
+      BOOST_CHECK((batch.metadata & llfio::stat_t::want::size) == llfio::stat_t::want::size);
+      for(auto &entry : batch.entries)
+      {
+        entries.emplace((batch.directory / batch.leafname(entry).path()).generic_string(), entry.stat.st_size);
+      }
+      return llfio::success();
+    }
+  };
+  for(size_t threads : {size_t(1), size_t(0)})
+  {
+    llfio::algorithm::contents_visitor cv(llfio::stat_t::want::size, true, false);
+    auto contents = llfio::algorithm::contents(tempdirh, &cv, threads).value();
+    entries_type expected;
+    for(auto &i : contents)
+    {
+      expected.emplace(i.first.generic_string(), i.second.st_size);
+    }
+    BOOST_CHECK(expected.size() == 4);
+    BOOST_CHECK(expected.count({"top", 1}) == 1);
+    BOOST_CHECK(expected.count({"a/b/z", 4}) == 1);
+
+    visitor_type visitor(llfio::stat_t::want::size, true, false);
+    auto dirs = llfio::algorithm::contents_stream(tempdirh, &visitor, threads).value();
+    std::cout << "   Streamed " << visitor.entries.size() << " entries from " << visitor.directory_ids.size() << " batches of " << dirs
+              << " directories with threads = " << threads << std::endl;
+    BOOST_CHECK(dirs == 4);
+    BOOST_CHECK(visitor.directory_ids.size() == 3);
+    BOOST_CHECK(visitor.entries == expected);
+  }
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, algorithm, contents_stream, "Tests that algorithm::contents_stream() works as expected", TestContentsStream())
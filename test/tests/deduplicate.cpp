@@ -0,0 +1,88 @@
+/* Integration test kernel for algorithm::deduplicate()
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#include "../test_kernel_decl.hpp"
+
+static inline void TestDeduplicate()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  auto tempdirh = llfio::directory_handle::temp_directory().value();
+  auto untempdir = llfio::make_scope_exit([&]() noexcept { (void) llfio::algorithm::reduce(std::move(tempdirh)); });
+  auto write = [&](llfio::path_view path, size_t bytes, int seed, size_t flip = (size_t) -1) {
+    std::vector<llfio::byte> buffer(bytes);
+    for(size_t n = 0; n < bytes; n++)
+    {
+      buffer[n] = (llfio::byte) (n * 31 + seed);
+    }
+    if(flip < bytes)
+    {
+      buffer[flip] ^= llfio::to_byte(1);
+    }
+    auto fh = llfio::file_handle::file(tempdirh, path, llfio::file_handle::mode::write, llfio::file_handle::creation::if_needed).value();
+    fh.write(0, {{buffer.data(), buffer.size()}}).value();
+    return fh;
+  };
+  llfio::directory_handle::directory(tempdirh, "a", llfio::directory_handle::mode::write, llfio::directory_handle::creation::if_needed).value();
+  auto one = write("one", 1024 * 1024, 1);
+  write("a/one_copy", 1024 * 1024, 1);
+  write("a/one_copy2", 1024 * 1024, 1);
+  write("middle_differs", 1024 * 1024, 1, 512 * 1024);  // same partial hash, different full hash
+  write("tail_differs", 1024 * 1024, 1, 1024 * 1024 - 1);
+  write("small1", 100000, 2);
+  write("small2", 100000, 2);
+  write("tiny1", 100, 3);  // below the minimum size
+  write("tiny2", 100, 3);
+  one.link(tempdirh, "one_link").value();  // already shares storage
+
+  llfio::algorithm::deduplicate_config config;
+  config.chunk_size = 65536;
+  config.dry_run = true;
+  auto found = llfio::algorithm::deduplicate(tempdirh, config).value();
+  std::cout << "Found " << found.duplicates.size() << " groups of duplicates, hashing " << found.bytes_hashed << " bytes" << std::endl;
+  BOOST_REQUIRE(found.duplicates.size() == 2);
+  BOOST_REQUIRE(found.duplicates[0].size() == 2);
+  BOOST_CHECK(found.duplicates[0][0] == "small1");
+  BOOST_CHECK(found.duplicates[0][1] == "small2");
+  BOOST_REQUIRE(found.duplicates[1].size() == 3);
+  BOOST_CHECK(found.duplicates[1][0] == llfio::filesystem::path("a") / "one_copy");
+  BOOST_CHECK(found.duplicates[1][1] == llfio::filesystem::path("a") / "one_copy2");
+  BOOST_CHECK(found.duplicates[1][2] == "one");
+  BOOST_CHECK(found.files_deduplicated == 0);
+
+  config.dry_run = false;
+  auto deduplicated = llfio::algorithm::deduplicate(tempdirh, config);
+  if(!deduplicated && deduplicated.error() == llfio::errc::operation_not_supported)
+  {
+    std::cout << "NOTE: This filing system does not support deduplication, skipping the remainder of this test." << std::endl;
+    return;
+  }
+  std::cout << "Deduplicated " << deduplicated.value().files_deduplicated << " files reclaiming " << deduplicated.value().bytes_deduplicated
+            << " bytes" << std::endl;
+  BOOST_CHECK(deduplicated.value().files_deduplicated == 3);
+  BOOST_CHECK(deduplicated.value().bytes_deduplicated == 2 * 1024 * 1024 + 100000);
+  BOOST_CHECK(deduplicated.value().files_failed == 0);
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, algorithm, deduplicate, "Tests that algorithm::deduplicate() works as expected", TestDeduplicate())
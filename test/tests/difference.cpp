@@ -0,0 +1,105 @@
+/* Integration test kernel for algorithm::difference()
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#include "../test_kernel_decl.hpp"
+
+#include <map>
+
+static inline void TestDifference()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  using llfio::algorithm::difference_item;
+  auto beforeh = llfio::directory_handle::temp_directory().value();
+  auto afterh = llfio::directory_handle::temp_directory().value();
+  auto untempdir = llfio::make_scope_exit([&]() noexcept {
+    (void) llfio::algorithm::reduce(std::move(beforeh));
+    (void) llfio::algorithm::reduce(std::move(afterh));
+  });
+  auto write = [](const llfio::path_handle &base, llfio::path_view path, const char *content) {
+    auto fh = llfio::file_handle::file(base, path, llfio::file_handle::mode::write, llfio::file_handle::creation::always_new).value();
+    fh.write(0, {{(const llfio::byte *) content, strlen(content)}}).value();
+    return fh;
+  };
+  // The tree after shares inodes with the tree before via hard links, so renames can be detected
+  llfio::directory_handle::directory(beforeh, "d", llfio::directory_handle::mode::write, llfio::directory_handle::creation::if_needed).value();
+  llfio::directory_handle::directory(afterh, "d", llfio::directory_handle::mode::write, llfio::directory_handle::creation::if_needed).value();
+  auto same = write(beforeh, "same", "hello");
+  same.link(afterh, "same").value();
+  same.link(afterh, "same_link").value();
+  write(beforeh, "renamed_from", "abc").link(afterh, "renamed_to").value();
+  write(beforeh, "d/inner", "i").link(afterh, "d/inner").value();
+  write(beforeh, "removed", "x");
+  write(beforeh, "grown", "1");
+  write(afterh, "grown", "12");
+  write(beforeh, "flipped", "aaaa");
+  write(afterh, "flipped", "aaab");
+  write(afterh, "added", "y");
+
+  llfio::algorithm::compare_visitor visitor(llfio::stat_t::want::type | llfio::stat_t::want::ino | llfio::stat_t::want::size);
+  auto check = [&](bool compare_content) {
+    auto items = llfio::algorithm::difference(beforeh, afterh, compare_content, &visitor).value();
+    std::map<std::string, const difference_item *> bypath;
+    for(auto &item : items)
+    {
+      std::cout << "   " << item.path << " changed = " << (int) item.changed << " previous_path = " << item.previous_path
+                << " content_comparison = " << (int) item.content_comparison << std::endl;
+      bypath[item.path.generic_string()] = &item;
+    }
+    BOOST_CHECK(bypath.count("same") == 0);
+    BOOST_CHECK(bypath.count("d") == 0);
+    BOOST_CHECK(bypath.count("d/inner") == 0);
+    BOOST_REQUIRE(bypath.count("added") == 1);
+    BOOST_CHECK(bypath["added"]->changed == difference_item::file_added);
+    BOOST_REQUIRE(bypath.count("removed") == 1);
+    BOOST_CHECK(bypath["removed"]->changed == difference_item::file_removed);
+    BOOST_REQUIRE(bypath.count("grown") == 1);
+    BOOST_CHECK(bypath["grown"]->changed == difference_item::content_metadata_changed);
+    BOOST_REQUIRE(bypath.count("renamed_to") == 1);
+    BOOST_CHECK(bypath["renamed_to"]->changed == difference_item::file_renamed);
+    BOOST_CHECK(bypath["renamed_to"]->previous_path == "renamed_from");
+    BOOST_REQUIRE(bypath.count("same_link") == 1);
+    BOOST_CHECK(bypath["same_link"]->changed == difference_item::file_linked);
+    BOOST_CHECK(bypath["same_link"]->previous_path == "same");
+    if(compare_content)
+    {
+      BOOST_CHECK(items.size() == 6);
+      BOOST_CHECK(bypath["grown"]->content_comparison == -1);
+      BOOST_REQUIRE(bypath.count("flipped") == 1);
+      BOOST_CHECK(bypath["flipped"]->changed == difference_item::content_changed);
+      BOOST_CHECK(bypath["flipped"]->content_comparison == -1);
+    }
+    else
+    {
+      BOOST_CHECK(items.size() == 5);
+      BOOST_CHECK(bypath.count("flipped") == 0);
+    }
+  };
+  std::cout << "Comparing metadata only ..." << std::endl;
+  check(false);
+  std::cout << "Comparing metadata and content ..." << std::endl;
+  check(true);
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, algorithm, difference, "Tests that algorithm::difference() works as expected", TestDifference())
@@ -0,0 +1,86 @@
+/* Integration test kernel for directory_handle::fill_metadata()
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#include "../test_kernel_decl.hpp"
+
+#include <set>
+
+static inline void TestDirectoryHandleFillMetadata()
+{
+  static constexpr size_t file_count = 1000;
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  auto tempdirh = llfio::directory_handle::temp_directory().value();
+  auto untempdir = llfio::make_scope_exit([&]() noexcept { (void) llfio::algorithm::reduce(std::move(tempdirh)); });
+  for(size_t n = 0; n < file_count; n++)
+  {
+    auto fh = llfio::file_handle::file(tempdirh, std::to_string(n), llfio::file_handle::mode::write, llfio::file_handle::creation::if_needed).value();
+    fh.truncate(n * 7).value();
+  }
+  llfio::directory_handle::directory(tempdirh, "dir", llfio::directory_handle::mode::write, llfio::directory_handle::creation::if_needed).value();
+
+  std::vector<llfio::directory_entry> entries(file_count + 16);
+  auto contents = tempdirh.read({entries}).value();
+  BOOST_REQUIRE(contents.done());
+  BOOST_REQUIRE(contents.size() == file_count + 1);
+  static constexpr llfio::stat_t::want wanted = llfio::stat_t::want::type | llfio::stat_t::want::size | llfio::stat_t::want::allocated;
+  // Remove some entries after enumeration, they should be reported as failing
+  std::set<std::string> removed;
+  for(size_t n = 0; n < file_count; n += 97)
+  {
+    auto fh = llfio::file_handle::file(tempdirh, std::to_string(n), llfio::file_handle::mode::write).value();
+    fh.unlink().value();
+    removed.insert(std::to_string(n));
+  }
+  auto begin = std::chrono::high_resolution_clock::now();
+  auto failed = tempdirh.fill_metadata(contents, wanted).value();
+  auto end = std::chrono::high_resolution_clock::now();
+  std::cout << "Filled metadata for " << contents.size() << " entries in "
+            << (std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count()) << " microseconds, of which " << failed << " failed." << std::endl;
+  BOOST_CHECK(failed == removed.size());
+  BOOST_CHECK((contents.metadata() & wanted) == wanted);
+  for(size_t n = 0; n < contents.size(); n++)
+  {
+    const auto leafname = contents[n].leafname.path().string();
+    if(n >= contents.size() - failed)
+    {
+      BOOST_CHECK(removed.count(leafname) == 1);
+      continue;
+    }
+    BOOST_CHECK(removed.count(leafname) == 0);
+    if(leafname == "dir")
+    {
+      BOOST_CHECK(contents[n].stat.st_type == llfio::filesystem::file_type::directory);
+      continue;
+    }
+    BOOST_CHECK(contents[n].stat.st_type == llfio::filesystem::file_type::regular);
+    BOOST_CHECK(contents[n].stat.st_size == std::stoul(leafname) * 7);
+  }
+
+  // Asking for metadata already present does nothing
+  BOOST_CHECK(tempdirh.fill_metadata(contents, llfio::stat_t::want::size).value() == 0);
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, directory_handle, fill_metadata, "Tests that directory_handle::fill_metadata() works as expected",
+                       TestDirectoryHandleFillMetadata())
@@ -26,14 +26,14 @@ Distributed under the Boost Software License, Version 1.0.
 
 #include "quickcpplib/algorithm/small_prng.hpp"
 
-static inline void TestFastRandomFileHandleWorks()
+static inline void TestFastRandomFileHandleWorks(LLFIO_V2_NAMESPACE::fast_random_file_handle::generator g = LLFIO_V2_NAMESPACE::fast_random_file_handle::generator::single_lane)
 {
   static constexpr size_t testbytes = 1024 * 1024UL;
   using namespace LLFIO_V2_NAMESPACE;
   using LLFIO_V2_NAMESPACE::byte;
   using QUICKCPPLIB_NAMESPACE::algorithm::small_prng::small_prng;
   mapped<byte> store(testbytes);
-  fast_random_file_handle h = fast_random_file_handle::fast_random_file(testbytes).value();
+  fast_random_file_handle h = fast_random_file_handle::fast_random_file(testbytes, fast_random_file_handle::mode::read, {}, g).value();
   // Bulk read
   BOOST_CHECK(h.read(0, {{store.data(), store.size()}}).value() == store.size());
 
@@ -56,6 +56,98 @@ static inline void TestFastRandomFileHandleWorks()
   }
 }
 
+static inline void TestFastRandomFileHandleMultiLane()
+{
+  static constexpr size_t testbytes = 1024 * 1024UL;
+  using namespace LLFIO_V2_NAMESPACE;
+  using LLFIO_V2_NAMESPACE::byte;
+  TestFastRandomFileHandleWorks(fast_random_file_handle::generator::multi_lane);
+
+  // The same seed must always produce the same content, and a different seed different content
+  const byte seed1[16] = {to_byte(1)}, seed2[16] = {to_byte(2)};
+  mapped<byte> store1(testbytes), store2(testbytes), store3(testbytes);
+  auto h1 = fast_random_file_handle::fast_random_file(testbytes, fast_random_file_handle::mode::read, seed1, fast_random_file_handle::generator::multi_lane).value();
+  auto h2 = fast_random_file_handle::fast_random_file(testbytes, fast_random_file_handle::mode::read, seed1, fast_random_file_handle::generator::multi_lane).value();
+  auto h3 = fast_random_file_handle::fast_random_file(testbytes, fast_random_file_handle::mode::read, seed2, fast_random_file_handle::generator::multi_lane).value();
+  BOOST_REQUIRE(h1.read(0, {{store1.data(), testbytes}}).value() == testbytes);
+  BOOST_REQUIRE(h2.read(0, {{store2.data(), testbytes}}).value() == testbytes);
+  BOOST_REQUIRE(h3.read(0, {{store3.data(), testbytes}}).value() == testbytes);
+  BOOST_CHECK(0 == memcmp(store1.data(), store2.data(), testbytes));
+  BOOST_CHECK(0 != memcmp(store1.data(), store3.data(), testbytes));
+
+  // No byte value should be much more common than another, nor should the content repeat every chunk
+  std::vector<size_t> histogram(256);
+  for(size_t n = 0; n < testbytes; n++)
+  {
+    histogram[(uint8_t) store1[n]]++;
+  }
+  for(auto &i : histogram)
+  {
+    BOOST_CHECK(i > testbytes / 256 * 9 / 10);
+    BOOST_CHECK(i < testbytes / 256 * 11 / 10);
+  }
+  BOOST_CHECK(0 != memcmp(store1.data(), store1.data() + 256, testbytes - 256));
+}
+
+static inline void TestFastRandomFileHandleMultiLaneKernels()
+{
+#if LLFIO_HEADERS_ONLY == 1
+  // Only in the header only build do these detail functions share their state with the library
+  static constexpr size_t testbytes = 256 * 1024UL + 123;  // not a multiple of the 256 byte chunk
+  using namespace LLFIO_V2_NAMESPACE;
+  using LLFIO_V2_NAMESPACE::byte;
+  using QUICKCPPLIB_NAMESPACE::algorithm::small_prng::small_prng;
+  const byte seed[16] = {to_byte(78), to_byte(90)};
+  auto h = fast_random_file_handle::fast_random_file(testbytes, fast_random_file_handle::mode::read, seed, fast_random_file_handle::generator::multi_lane).value();
+  const detail::cpu_features_t detected = detail::cpu_features();
+  auto unoverride = make_scope_exit([]() noexcept { detail::cpu_features_override() = nullptr; });
+
+  // The scalar lane is the reference
+  const detail::cpu_features_t scalar{};
+  detail::cpu_features_override() = &scalar;
+  std::vector<byte> expected(testbytes);
+  BOOST_REQUIRE(h.read(0, {{expected.data(), expected.size()}}).value() == testbytes);
+
+  std::vector<std::pair<const char *, detail::cpu_features_t>> kernels;
+  if(detected.sse2)
+  {
+    detail::cpu_features_t f;
+    f.sse2 = true;
+    kernels.emplace_back("SSE2", f);
+  }
+  if(detected.avx2)
+  {
+    detail::cpu_features_t f;
+    f.sse2 = f.avx2 = true;
+    kernels.emplace_back("AVX2", f);
+  }
+  if(detected.avx512f)
+  {
+    detail::cpu_features_t f;
+    f.sse2 = f.avx2 = f.avx512f = true;
+    kernels.emplace_back("AVX-512", f);
+  }
+  for(auto &kernel : kernels)
+  {
+    std::cout << "Comparing the " << kernel.first << " multi-lane kernel with the scalar lane ..." << std::endl;
+    detail::cpu_features_override() = &kernel.second;
+    std::vector<byte> content(testbytes);
+    BOOST_REQUIRE(h.read(0, {{content.data(), content.size()}}).value() == testbytes);
+    BOOST_CHECK(0 == memcmp(content.data(), expected.data(), testbytes));
+    // Unaligned offsets and lengths mix partial and whole chunks
+    small_prng rand;
+    for(size_t n = 0; n < 1000; n++)
+    {
+      byte buffer[2048];
+      const size_t offset = rand() % testbytes, length = rand() % sizeof(buffer);
+      const auto bytesread = h.read(offset, {{buffer, length}}).value();
+      BOOST_CHECK(bytesread == std::min(length, testbytes - offset));
+      BOOST_CHECK(0 == memcmp(buffer, expected.data() + offset, bytesread));
+    }
+  }
+#endif
+}
+
 static inline void TestFastRandomFileHandlePerformance()
 {
   static constexpr size_t testbytes = 1024 * 1024 * 1024UL;
@@ -100,9 +192,22 @@ static inline void TestFastRandomFileHandlePerformance()
   }
   end = std::chrono::high_resolution_clock::now();
   auto diff2 = std::chrono::duration_cast<std::chrono::microseconds>(end - begin);
+  fast_random_file_handle h2 = fast_random_file_handle::fast_random_file(testbytes, fast_random_file_handle::mode::read, {}, fast_random_file_handle::generator::multi_lane).value();
+  begin = std::chrono::high_resolution_clock::now();
+  for(size_t n = 0; n < 10; n++)
+  {
+    h2.read(0, {{store.data(), store.size()}}).value();
+  }
+  end = std::chrono::high_resolution_clock::now();
+  auto diff3 = std::chrono::duration_cast<std::chrono::microseconds>(end - begin);
   std::cout << "small_prng produces randomness at " << ((testbytes / 1024.0 / 1024.0) / (diff1.count() / 10000000.0)) << " Mb/sec" << std::endl;
   std::cout << "fast_random_file_handle produces randomness at " << ((testbytes / 1024.0 / 1024.0) / (diff2.count() / 10000000.0)) << " Mb/sec" << std::endl;
+  std::cout << "multi-lane fast_random_file_handle produces randomness at " << ((testbytes / 1024.0 / 1024.0) / (diff3.count() / 10000000.0)) << " Mb/sec"
+            << std::endl;
 }
 
 KERNELTEST_TEST_KERNEL(integration, llfio, fast_random_file_handle, works, "Tests that fast random file handle works as expected", TestFastRandomFileHandleWorks())
+KERNELTEST_TEST_KERNEL(integration, llfio, fast_random_file_handle, multi_lane, "Tests that the multi-lane fast random file handle works as expected", TestFastRandomFileHandleMultiLane())
+KERNELTEST_TEST_KERNEL(integration, llfio, fast_random_file_handle, multi_lane_kernels,
+                       "Tests that every multi-lane fast random file handle kernel matches the scalar lane", TestFastRandomFileHandleMultiLaneKernels())
 KERNELTEST_TEST_KERNEL(integration, llfio, fast_random_file_handle, performance, "Tests the performance of the fast random file handle", TestFastRandomFileHandlePerformance())
@@ -0,0 +1,89 @@
+/* Integration test kernel for file_handle range manipulation
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#include "../test_kernel_decl.hpp"
+
+static inline void TestFileHandleRanges()
+{
+  static constexpr size_t testbytes = 1024 * 1024UL, blocksize = 65536;
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  using llfio::byte;
+  auto fh = llfio::file_handle::temp_inode().value();
+  std::vector<byte> expected(testbytes), check;
+  {
+    auto src = llfio::fast_random_file_handle::fast_random_file(testbytes).value();
+    BOOST_REQUIRE(src.read(0, {{expected.data(), expected.size()}}).value() == testbytes);
+    BOOST_REQUIRE(fh.write(0, {{expected.data(), expected.size()}}).value() == testbytes);
+  }
+  auto verify = [&] {
+    BOOST_REQUIRE(fh.maximum_extent().value() == expected.size());
+    check.resize(expected.size());
+    BOOST_REQUIRE(fh.read(0, {{check.data(), check.size()}}).value() == check.size());
+    BOOST_CHECK(0 == memcmp(check.data(), expected.data(), expected.size()));
+  };
+
+  std::cout << "Testing preallocate ..." << std::endl;
+  // Within the maximum extent, every implementation allocates the whole extent
+  BOOST_CHECK(fh.preallocate({0, testbytes}).value() == testbytes);
+  verify();
+  // After it, the emulation cannot allocate anything
+  {
+    auto preallocated = fh.preallocate({testbytes, testbytes}).value();
+    std::cout << "   preallocated " << preallocated << " bytes after the maximum extent" << std::endl;
+    BOOST_CHECK(preallocated == testbytes || preallocated == 0);
+  }
+  verify();
+
+  std::cout << "Testing zero_range ..." << std::endl;
+  for(auto &i : {llfio::file_handle::extent_pair(blocksize, blocksize), llfio::file_handle::extent_pair(12345, 6789)})
+  {
+    BOOST_CHECK(fh.zero_range(i).value() == i.length);
+    memset(expected.data() + i.offset, 0, (size_t) i.length);
+    verify();
+  }
+
+  std::cout << "Testing collapse_range ..." << std::endl;
+  for(auto &i : {llfio::file_handle::extent_pair(2 * blocksize, blocksize), llfio::file_handle::extent_pair(1234, 5678)})
+  {
+    BOOST_CHECK(fh.collapse_range(i).value() == expected.size() - i.length);
+    expected.erase(expected.begin() + (ptrdiff_t) i.offset, expected.begin() + (ptrdiff_t) (i.offset + i.length));
+    verify();
+  }
+  // Collapsing up to the end is a truncation
+  BOOST_CHECK(fh.collapse_range({expected.size() - blocksize, blocksize}).value() == expected.size() - blocksize);
+  expected.resize(expected.size() - blocksize);
+  verify();
+
+  std::cout << "Testing insert_range ..." << std::endl;
+  for(auto &i : {llfio::file_handle::extent_pair(3 * blocksize, blocksize), llfio::file_handle::extent_pair(4321, 8765)})
+  {
+    BOOST_CHECK(fh.insert_range(i).value() == expected.size() + i.length);
+    expected.insert(expected.begin() + (ptrdiff_t) i.offset, (size_t) i.length, llfio::to_byte(0));
+    verify();
+  }
+  BOOST_CHECK(fh.insert_range({expected.size() + 1, blocksize}).error() == llfio::errc::invalid_argument);
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, file_handle, ranges, "Tests that file_handle range manipulation works as expected", TestFileHandleRanges())
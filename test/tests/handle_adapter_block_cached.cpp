@@ -0,0 +1,162 @@
+/* Integration test kernel for the block cache and block cached handle adapter
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#include "../test_kernel_decl.hpp"
+
+#include "quickcpplib/algorithm/small_prng.hpp"
+
+static inline void TestBlockCachedHandleAdapter()
+{
+  static constexpr size_t testbytes = 4 * 1024 * 1024UL, blocksize = 65536, capacity = 2 * 1024 * 1024UL;
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  using llfio::byte;
+  using QUICKCPPLIB_NAMESPACE::algorithm::small_prng::small_prng;
+  auto fh = llfio::file_handle::temp_inode().value();
+  llfio::mapped<byte> store(testbytes), check(testbytes);
+  {
+    auto src = llfio::fast_random_file_handle::fast_random_file(testbytes).value();
+    BOOST_REQUIRE(src.read(0, {{store.data(), store.size()}}).value() == testbytes);
+  }
+  llfio::algorithm::block_cache::config c;
+  c.capacity = capacity;
+  c.block_size = blocksize;
+  c.shards = 2;
+  auto cache = llfio::algorithm::block_cache::create(c).value();
+  BOOST_CHECK(cache.capacity() == capacity);
+  BOOST_CHECK(cache.block_size() == blocksize);
+  // Too few blocks per shard for two shards
+  BOOST_CHECK(cache.shards() == 1);
+  llfio::algorithm::block_cached_handle_adapter<> h(&fh, nullptr, llfio::file_handle::mode::write, llfio::file_handle::flag::none, nullptr, cache);
+  BOOST_CHECK(h.is_readable());
+  BOOST_CHECK(h.is_writable());
+
+  std::cout << "Testing writes and reads ..." << std::endl;
+  // Leaves the end of the file within a block, which must not be cached
+  const size_t length = testbytes - 1000;
+  BOOST_CHECK(h.write(0, {{store.data(), length}}).value() == length);
+  BOOST_CHECK(h.maximum_extent().value() == length);
+  BOOST_CHECK(h.read(0, {{check.data(), testbytes}}).value() == length);
+  BOOST_CHECK(0 == memcmp(check.data(), store.data(), length));
+  {
+    auto stats = cache.stats();
+    std::cout << "   hits = " << stats.hits << " misses = " << stats.misses << " resident = " << stats.resident_blocks << std::endl;
+    BOOST_CHECK(stats.misses == testbytes / blocksize);
+    BOOST_CHECK(stats.resident_blocks == capacity / blocksize);
+  }
+  small_prng rand;
+  for(size_t i = 0; i < 2000; i++)
+  {
+    size_t offset = rand() % length, bytes = rand() % (blocksize * 3);
+    if(i % 3 == 0)
+    {
+      bytes = std::min(bytes, length - offset);
+      for(size_t n = 0; n < bytes; n++)
+      {
+        store[offset + n] = (byte) rand();
+      }
+      BOOST_CHECK(h.write(offset, {{store.data() + offset, bytes}}).value() == bytes);
+    }
+    else
+    {
+      // Scatter the read across two buffers
+      const size_t split = bytes / 3;
+      auto bytesread = h.read(offset, {{check.data(), split}, {check.data() + split, bytes - split}}).value();
+      BOOST_CHECK(bytesread == std::min(bytes, length - offset));
+      BOOST_CHECK(0 == memcmp(check.data(), store.data() + offset, bytesread));
+    }
+  }
+  BOOST_CHECK(h.read(length, {{check.data(), 100}}).value() == 0);
+  BOOST_CHECK(cache.stats().hits > 0);
+
+  std::cout << "Testing invalidation ..." << std::endl;
+  {
+    // Modify the file behind the cache's back
+    BOOST_CHECK(h.read(0, {{check.data(), blocksize}}).value() == blocksize);
+    for(size_t n = 0; n < 100; n++)
+    {
+      store[n] = (byte) rand();
+    }
+    BOOST_CHECK(fh.write(0, {{store.data(), 100}}).value() == 100);
+    h.invalidate(0, 100);
+    BOOST_CHECK(h.read(0, {{check.data(), blocksize}}).value() == blocksize);
+    BOOST_CHECK(0 == memcmp(check.data(), store.data(), blocksize));
+  }
+  {
+    BOOST_CHECK(h.truncate(length / 2).value() == length / 2);
+    BOOST_CHECK(h.read(0, {{check.data(), testbytes}}).value() == length / 2);
+    BOOST_CHECK(0 == memcmp(check.data(), store.data(), length / 2));
+    BOOST_CHECK(h.truncate(length).value() == length);
+    BOOST_CHECK(h.read(length / 2, {{check.data(), blocksize}}).value() == blocksize);
+    for(size_t n = 0; n < blocksize; n++)
+    {
+      if(check[n] != (byte) 0)
+      {
+        BOOST_CHECK(check[n] == (byte) 0);
+        break;
+      }
+    }
+  }
+
+  std::cout << "Testing prefetch ..." << std::endl;
+  cache.clear();
+  cache.reset_stats();
+  BOOST_CHECK(h.prefetch(0, blocksize * 4).value() == blocksize * 4);
+  BOOST_CHECK(cache.stats().prefetches == 4);
+  BOOST_CHECK(h.read(blocksize, {{check.data(), blocksize * 2}}).value() == blocksize * 2);
+  BOOST_CHECK(cache.stats().hits == 2);
+  BOOST_CHECK(cache.stats().misses == 0);
+
+  std::cout << "Testing scan resistance ..." << std::endl;
+  {
+    // A hot set used more than once must survive a scan of a file much bigger than the cache
+    auto scanfh = llfio::file_handle::temp_inode().value();
+    BOOST_REQUIRE(scanfh.truncate(capacity * 8).value() == capacity * 8);
+    static constexpr size_t hotblocks = capacity / blocksize / 4;
+    cache.clear();
+    for(size_t pass = 0; pass < 2; pass++)
+    {
+      for(size_t n = 0; n < hotblocks; n++)
+      {
+        BOOST_CHECK(h.read(n * blocksize, {{check.data(), 16}}).value() == 16);
+      }
+    }
+    for(size_t offset = 0; offset < capacity * 8; offset += blocksize)
+    {
+      llfio::algorithm::block_cache::buffer_type b(check.data(), 16);
+      BOOST_CHECK(cache.read(scanfh, llfio::algorithm::block_cache::io_request<llfio::algorithm::block_cache::buffers_type>({&b, 1}, offset)).value()[0].size() == 16);
+    }
+    cache.reset_stats();
+    for(size_t n = 0; n < hotblocks; n++)
+    {
+      BOOST_CHECK(h.read(n * blocksize, {{check.data(), 16}}).value() == 16);
+    }
+    auto stats = cache.stats();
+    std::cout << "   hot set hits after scan = " << stats.hits << " misses = " << stats.misses << std::endl;
+    BOOST_CHECK(stats.hits == hotblocks);
+  }
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, block_cached_handle_adapter, works, "Tests that the block cached handle adapter works as expected",
+                       TestBlockCachedHandleAdapter())
@@ -0,0 +1,158 @@
+/* Integration test kernel for the checksummed handle adapter
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#include "../test_kernel_decl.hpp"
+
+#include "quickcpplib/algorithm/small_prng.hpp"
+
+static inline void TestCrc32c()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  using llfio::byte;
+  // Bit at a time reference implementation
+  auto reference = [](const byte *p, size_t bytes, uint32_t crc) {
+    crc = ~crc;
+    for(size_t n = 0; n < bytes; n++)
+    {
+      crc ^= (uint8_t) p[n];
+      for(int k = 0; k < 8; k++)
+      {
+        crc = (crc & 1) ? ((crc >> 1) ^ 0x82f63b78) : (crc >> 1);
+      }
+    }
+    return ~crc;
+  };
+  std::cout << "Using CRC32C implementation " << llfio::algorithm::crc32c_implementation() << std::endl;
+  BOOST_CHECK(llfio::algorithm::crc32c((const byte *) "123456789", 9) == 0xe3069283);
+  static constexpr size_t testbytes = 256 * 1024UL;
+  llfio::mapped<byte> store(testbytes);
+  {
+    auto src = llfio::fast_random_file_handle::fast_random_file(testbytes).value();
+    BOOST_REQUIRE(src.read(0, {{store.data(), store.size()}}).value() == testbytes);
+  }
+  BOOST_CHECK(llfio::algorithm::crc32c(store.data(), testbytes) == reference(store.data(), testbytes, 0));
+  QUICKCPPLIB_NAMESPACE::algorithm::small_prng::small_prng rand;
+  for(size_t i = 0; i < 1000; i++)
+  {
+    size_t offset = rand() % 64, length = rand() % 65536;
+    uint32_t crc = rand();
+    BOOST_CHECK(llfio::algorithm::crc32c(store.data() + offset, length, crc) == reference(store.data() + offset, length, crc));
+  }
+  // Checksums can be continued
+  BOOST_CHECK(llfio::algorithm::crc32c(store.data() + 1000, testbytes - 1000, llfio::algorithm::crc32c(store.data(), 1000)) ==
+              llfio::algorithm::crc32c(store.data(), testbytes));
+}
+
+static inline void TestChecksummedHandleAdapter()
+{
+  static constexpr size_t testbytes = 1024 * 1024UL, blocksize = 4096;
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  using llfio::byte;
+  using QUICKCPPLIB_NAMESPACE::algorithm::small_prng::small_prng;
+  auto datah = llfio::file_handle::temp_inode().value();
+  auto checksumh = llfio::file_handle::temp_inode().value();
+  llfio::mapped<byte> store(testbytes), check(testbytes);
+  {
+    auto src = llfio::fast_random_file_handle::fast_random_file(testbytes).value();
+    BOOST_REQUIRE(src.read(0, {{store.data(), store.size()}}).value() == testbytes);
+  }
+  llfio::algorithm::checksummed_handle_adapter<llfio::file_handle, llfio::file_handle> h(&datah, &checksumh, llfio::file_handle::mode::write,
+                                                                                         llfio::file_handle::flag::none, nullptr, blocksize);
+  BOOST_CHECK(h.block_size() == blocksize);
+  BOOST_CHECK(h.is_readable());
+  BOOST_CHECK(h.is_writable());
+
+  std::cout << "Testing unaligned writes and reads ..." << std::endl;
+  // Leaves the end of the file within a block
+  const size_t length = testbytes - 1000;
+  BOOST_CHECK(h.write(0, {{store.data(), 12345}}).value() == 12345);
+  BOOST_CHECK(h.write(12345, {{store.data() + 12345, length - 12345}}).value() == length - 12345);
+  BOOST_CHECK(h.maximum_extent().value() == length);
+  BOOST_CHECK(checksumh.maximum_extent().value() == (length + blocksize - 1) / blocksize * sizeof(uint32_t));
+  BOOST_CHECK(h.read(0, {{check.data(), testbytes}}).value() == length);
+  BOOST_CHECK(0 == memcmp(check.data(), store.data(), length));
+  small_prng rand;
+  for(size_t i = 0; i < 1000; i++)
+  {
+    size_t offset = rand() % length, bytes = rand() % 65536;
+    if(i & 1)
+    {
+      bytes = std::min(bytes, length - offset);
+      for(size_t n = 0; n < bytes; n++)
+      {
+        store[offset + n] = (byte) rand();
+      }
+      BOOST_CHECK(h.write(offset, {{store.data() + offset, bytes}}).value() == bytes);
+    }
+    else
+    {
+      auto bytesread = h.read(offset, {{check.data(), bytes}}).value();
+      BOOST_CHECK(bytesread == std::min(bytes, length - offset));
+      BOOST_CHECK(0 == memcmp(check.data(), store.data() + offset, bytesread));
+    }
+  }
+  BOOST_CHECK(h.read(length, {{check.data(), 100}}).value() == 0);
+
+  std::cout << "Testing corruption is detected ..." << std::endl;
+  {
+    byte b = store[blocksize * 10 + 7] ^ (byte) 0xff;
+    BOOST_REQUIRE(datah.write(blocksize * 10 + 7, {{&b, 1}}).value() == 1);
+  }
+  BOOST_CHECK(h.read(blocksize * 10 + 100, {{check.data(), 1}}).error() == llfio::errc::io_error);
+  BOOST_CHECK(h.read(blocksize * 9, {{check.data(), blocksize}}).value() == blocksize);
+  BOOST_CHECK(h.read(blocksize * 11, {{check.data(), blocksize}}).value() == blocksize);
+  // Partial writes must not bless the corruption
+  BOOST_CHECK(h.write(blocksize * 10 + 100, {{store.data(), 1}}).error() == llfio::errc::io_error);
+  // Whole block writes replace it
+  BOOST_CHECK(h.write(blocksize * 10, {{store.data() + blocksize * 10, blocksize}}).value() == blocksize);
+  BOOST_CHECK(h.read(blocksize * 10 + 100, {{check.data(), 1}}).value() == 1);
+
+  std::cout << "Testing extension and truncation ..." << std::endl;
+  BOOST_CHECK(h.write(testbytes + 50000, {{store.data(), 100}}).value() == 100);
+  BOOST_CHECK(h.read(length, {{check.data(), testbytes}}).value() == testbytes + 50100 - length);
+  for(size_t n = 0; n < testbytes + 50000 - length; n++)
+  {
+    if(check[n] != (byte) 0)
+    {
+      BOOST_CHECK(check[n] == (byte) 0);
+      break;
+    }
+  }
+  BOOST_CHECK(0 == memcmp(check.data() + testbytes + 50000 - length, store.data(), 100));
+  BOOST_CHECK(h.truncate(length - 5000).value() == length - 5000);
+  BOOST_CHECK(h.read(0, {{check.data(), testbytes}}).value() == length - 5000);
+  BOOST_CHECK(0 == memcmp(check.data(), store.data(), length - 5000));
+
+  std::cout << "Testing rebuilding checksums ..." << std::endl;
+  BOOST_REQUIRE(checksumh.truncate(0).value() == 0);
+  BOOST_CHECK(!h.read(0, {{check.data(), 1}}));
+  h.rebuild_checksums().value();
+  BOOST_CHECK(h.read(0, {{check.data(), testbytes}}).value() == length - 5000);
+  BOOST_CHECK(0 == memcmp(check.data(), store.data(), length - 5000));
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, checksummed_handle_adapter, crc32c, "Tests that algorithm::crc32c() works as expected", TestCrc32c())
+KERNELTEST_TEST_KERNEL(integration, llfio, checksummed_handle_adapter, works, "Tests that the checksummed handle adapter works as expected",
+                       TestChecksummedHandleAdapter())
@@ -0,0 +1,168 @@
+/* Integration test kernel for the compressed handle adapter
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#include "../test_kernel_decl.hpp"
+
+#include "quickcpplib/algorithm/small_prng.hpp"
+
+static inline void TestCompressedHandleAdapter()
+{
+  static constexpr size_t testbytes = 4 * 1024 * 1024UL, blocksize = 65536;
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  using llfio::byte;
+  using QUICKCPPLIB_NAMESPACE::algorithm::small_prng::small_prng;
+  small_prng rand;
+  // Something like a log file, which compresses well
+  auto compressible = [&](byte *p, size_t bytes) {
+    static const char *words[] = {"INFO ", "WARN ", "request ", "served ", "in ", "ms ", "from ", "cache\n", "disk\n"};
+    size_t n = 0;
+    while(n < bytes)
+    {
+      for(const char *w = words[rand() % 9]; *w != 0 && n < bytes; w++)
+      {
+        p[n++] = (byte) *w;
+      }
+    }
+  };
+  llfio::mapped<byte> store(testbytes * 2), check(testbytes * 2), packed(testbytes * 2);
+
+  std::cout << "Testing the codec ..." << std::endl;
+  {
+    auto &codec = llfio::algorithm::lz_block_codec();
+    compressible(store.data(), testbytes);
+    auto compressedbytes = codec.compress({packed.data(), packed.size()}, {store.data(), testbytes});
+    std::cout << "   compressible data compresses " << ((double) testbytes / compressedbytes) << ":1" << std::endl;
+    BOOST_REQUIRE(compressedbytes > 0);
+    BOOST_CHECK(compressedbytes < testbytes / 2);
+    BOOST_CHECK(codec.decompress({check.data(), testbytes}, {packed.data(), compressedbytes}).value() == testbytes);
+    BOOST_CHECK(0 == memcmp(check.data(), store.data(), testbytes));
+    // Random data doesn't fit into less than itself
+    for(size_t n = 0; n < blocksize; n++)
+    {
+      store[n] = (byte) rand();
+    }
+    BOOST_CHECK(codec.compress({packed.data(), blocksize - 1}, {store.data(), blocksize}) == 0);
+    // Corrupt input fails rather than crashing
+    compressible(store.data(), blocksize);
+    compressedbytes = codec.compress({packed.data(), packed.size()}, {store.data(), blocksize});
+    packed[compressedbytes / 2] = (byte) 0xff;
+    packed[compressedbytes / 2 + 1] = (byte) 0xff;
+    (void) codec.decompress({check.data(), blocksize}, {packed.data(), compressedbytes});
+    auto truncated = codec.decompress({check.data(), blocksize}, {packed.data(), compressedbytes - 1});
+    BOOST_CHECK(!truncated || truncated.value() != blocksize);
+  }
+
+  auto fh = llfio::file_handle::temp_inode().value();
+  auto indexh = llfio::mapped_file_handle::mapped_temp_inode().value();
+  size_t length = 0;
+  memset(store.data(), 0, store.size());
+  {
+    llfio::algorithm::compressed_handle_adapter<> h(&fh, nullptr, llfio::file_handle::mode::write, llfio::file_handle::flag::none, nullptr, &indexh,
+                                                    blocksize);
+    BOOST_CHECK(h.block_size() == blocksize);
+    BOOST_CHECK(h.maximum_extent().value() == 0);
+
+    std::cout << "Testing a large write ..." << std::endl;
+    compressible(store.data(), testbytes);
+    BOOST_CHECK(h.write(0, {{store.data(), testbytes}}).value() == testbytes);
+    length = testbytes;
+    BOOST_CHECK(h.maximum_extent().value() == testbytes);
+    std::cout << "   " << testbytes << " bytes stored in " << h.stored_bytes().value() << " bytes" << std::endl;
+    BOOST_CHECK(h.stored_bytes().value() < testbytes / 2);
+    BOOST_CHECK(h.read(0, {{check.data(), testbytes}}).value() == testbytes);
+    BOOST_CHECK(0 == memcmp(check.data(), store.data(), testbytes));
+
+    std::cout << "Testing writes and reads ..." << std::endl;
+    for(size_t i = 0; i < 1000; i++)
+    {
+      size_t offset = rand() % length, bytes = rand() % (blocksize * 3);
+      if(i % 3 == 0)
+      {
+        if(i % 2 == 0)
+        {
+          offset &= ~(blocksize - 1);
+          bytes = (bytes + blocksize - 1) & ~(blocksize - 1);
+        }
+        bytes = std::min(bytes, testbytes * 2 - offset);
+        if(i % 5 == 0)
+        {
+          // Incompressible data is stored as is
+          for(size_t n = 0; n < bytes; n++)
+          {
+            store[offset + n] = (byte) rand();
+          }
+        }
+        else
+        {
+          compressible(store.data() + offset, bytes);
+        }
+        BOOST_CHECK(h.write(offset, {{store.data() + offset, bytes / 2}, {store.data() + offset + bytes / 2, bytes - bytes / 2}}).value() == bytes);
+        length = std::max(length, offset + bytes);
+      }
+      else
+      {
+        const size_t split = bytes / 3;
+        auto bytesread = h.read(offset, {{check.data(), split}, {check.data() + split, bytes - split}}).value();
+        BOOST_CHECK(bytesread == std::min(bytes, length - offset));
+        BOOST_CHECK(0 == memcmp(check.data(), store.data() + offset, bytesread));
+      }
+    }
+    BOOST_CHECK(h.maximum_extent().value() == length);
+    BOOST_CHECK(h.read(length, {{check.data(), 100}}).value() == 0);
+
+    std::cout << "Testing zeroing, extents and truncation ..." << std::endl;
+    BOOST_CHECK(h.zero({blocksize / 2, blocksize * 4}).value() == blocksize * 4);
+    memset(store.data() + blocksize / 2, 0, blocksize * 4);
+    {
+      auto exts = h.extents().value();
+      // The three whole blocks zeroed are no longer stored
+      BOOST_REQUIRE(exts.size() >= 2);
+      BOOST_CHECK(exts[0].offset == 0);
+      BOOST_CHECK(exts[0].length == blocksize);
+      BOOST_CHECK(exts[1].offset == blocksize * 4);
+    }
+    BOOST_CHECK(h.truncate(length / 2 + 7).value() == length / 2 + 7);
+    BOOST_CHECK(h.truncate(length).value() == length);
+    memset(store.data() + length / 2 + 7, 0, length - length / 2 - 7);
+    BOOST_CHECK(h.read(0, {{check.data(), testbytes * 2}}).value() == length);
+    BOOST_CHECK(0 == memcmp(check.data(), store.data(), length));
+  }
+
+  std::cout << "Testing reopening without parallelism ..." << std::endl;
+  {
+    llfio::algorithm::compressed_handle_adapter<> h(&fh, nullptr, llfio::file_handle::mode::write, llfio::file_handle::flag::disable_parallelism, nullptr,
+                                                    &indexh, blocksize);
+    BOOST_CHECK(h.maximum_extent().value() == length);
+    BOOST_CHECK(h.read(0, {{check.data(), testbytes * 2}}).value() == length);
+    BOOST_CHECK(0 == memcmp(check.data(), store.data(), length));
+    // A different block size is refused
+    llfio::algorithm::compressed_handle_adapter<> h2(&fh, nullptr, llfio::file_handle::mode::write, llfio::file_handle::flag::none, nullptr, &indexh,
+                                                     blocksize * 2);
+    BOOST_CHECK(!h2.maximum_extent());
+  }
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, compressed_handle_adapter, works, "Tests that the compressed handle adapter works as expected",
+                       TestCompressedHandleAdapter())
@@ -0,0 +1,153 @@
+/* Integration test kernel for the copy on write overlay handle adapter
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#include "../test_kernel_decl.hpp"
+
+#include "quickcpplib/algorithm/small_prng.hpp"
+
+static inline void TestCOWOverlayHandleAdapter()
+{
+  static constexpr size_t testbytes = 4 * 1024 * 1024UL, blocksize = 65536;
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  using llfio::byte;
+  using QUICKCPPLIB_NAMESPACE::algorithm::small_prng::small_prng;
+  auto baseh = llfio::file_handle::temp_inode().value();
+  auto deltah = llfio::file_handle::temp_inode().value();
+  auto bitmaph = llfio::mapped_file_handle::mapped_temp_inode().value();
+  // The end of the base is within a block
+  const size_t baselength = testbytes - 1000;
+  llfio::mapped<byte> original(testbytes), store(testbytes * 2), check(testbytes * 2);
+  {
+    auto src = llfio::fast_random_file_handle::fast_random_file(testbytes).value();
+    BOOST_REQUIRE(src.read(0, {{original.data(), original.size()}}).value() == testbytes);
+    BOOST_REQUIRE(baseh.write(0, {{original.data(), baselength}}).value() == baselength);
+    memcpy(store.data(), original.data(), baselength);
+  }
+  std::vector<bool> written(testbytes * 2 / blocksize);
+  auto mark = [&](size_t offset, size_t bytes) {
+    for(size_t n = offset / blocksize; n < (offset + bytes + blocksize - 1) / blocksize; n++)
+    {
+      written[n] = true;
+    }
+  };
+  {
+    llfio::algorithm::cow_overlay_handle_adapter<llfio::file_handle, llfio::file_handle> h(&deltah, &baseh, llfio::file_handle::mode::write,
+                                                                                          llfio::file_handle::flag::none, nullptr, &bitmaph, blocksize);
+    BOOST_CHECK(h.block_size() == blocksize);
+    BOOST_CHECK(h.maximum_extent().value() == baselength);
+    BOOST_CHECK(h.extents().value().empty());
+    BOOST_CHECK(h.read(0, {{check.data(), testbytes}}).value() == baselength);
+    BOOST_CHECK(0 == memcmp(check.data(), store.data(), baselength));
+
+    std::cout << "Testing writes and reads ..." << std::endl;
+    small_prng rand;
+    size_t length = baselength;
+    for(size_t i = 0; i < 1000; i++)
+    {
+      size_t offset = rand() % length, bytes = rand() % (blocksize * 3);
+      if(i % 3 == 0)
+      {
+        if(i % 2 == 0)
+        {
+          // Block aligned writes need nothing copied from the base
+          offset &= ~(blocksize - 1);
+          bytes = (bytes + blocksize - 1) & ~(blocksize - 1);
+        }
+        bytes = std::min(bytes, testbytes - offset);
+        for(size_t n = 0; n < bytes; n++)
+        {
+          store[offset + n] = (byte) rand();
+        }
+        BOOST_CHECK(h.write(offset, {{store.data() + offset, bytes / 2}, {store.data() + offset + bytes / 2, bytes - bytes / 2}}).value() == bytes);
+        mark(offset, bytes);
+        length = std::max(length, offset + bytes);
+      }
+      else
+      {
+        // Scatter the read across two buffers
+        const size_t split = bytes / 3;
+        auto bytesread = h.read(offset, {{check.data(), split}, {check.data() + split, bytes - split}}).value();
+        BOOST_CHECK(bytesread == std::min(bytes, length - offset));
+        BOOST_CHECK(0 == memcmp(check.data(), store.data() + offset, bytesread));
+      }
+    }
+    BOOST_CHECK(h.maximum_extent().value() == length);
+    BOOST_CHECK(h.read(length, {{check.data(), 100}}).value() == 0);
+    // The base must be untouched
+    BOOST_CHECK(baseh.maximum_extent().value() == baselength);
+    BOOST_CHECK(baseh.read(0, {{check.data(), testbytes}}).value() == baselength);
+    BOOST_CHECK(0 == memcmp(check.data(), original.data(), baselength));
+
+    std::cout << "Testing extents ..." << std::endl;
+    {
+      auto exts = h.extents().value();
+      std::vector<bool> inextents(written.size());
+      for(auto &e : exts)
+      {
+        BOOST_CHECK(e.offset % blocksize == 0);
+        BOOST_CHECK(e.offset + e.length <= length);
+        for(size_t n = e.offset / blocksize; n < (e.offset + e.length + blocksize - 1) / blocksize; n++)
+        {
+          inextents[n] = true;
+        }
+      }
+      BOOST_CHECK(inextents == written);
+    }
+
+    std::cout << "Testing truncation and zeroing ..." << std::endl;
+    BOOST_CHECK(h.truncate(length / 2).value() == length / 2);
+    BOOST_CHECK(h.truncate(length).value() == length);
+    memset(store.data() + length / 2, 0, length - length / 2);
+    BOOST_CHECK(h.zero({blocksize / 2, blocksize * 2}).value() == blocksize * 2);
+    memset(store.data() + blocksize / 2, 0, blocksize * 2);
+    mark(blocksize / 2, blocksize * 2);
+    BOOST_CHECK(h.read(0, {{check.data(), testbytes * 2}}).value() == length);
+    BOOST_CHECK(0 == memcmp(check.data(), store.data(), length));
+
+    std::cout << "Testing merging into a copy of the base ..." << std::endl;
+    auto copyh = llfio::file_handle::temp_inode().value();
+    BOOST_REQUIRE(copyh.write(0, {{original.data(), baselength}}).value() == baselength);
+    h.merge_into(copyh).value();
+    BOOST_CHECK(copyh.maximum_extent().value() == length);
+    BOOST_CHECK(copyh.read(0, {{check.data(), testbytes * 2}}).value() == length);
+    BOOST_CHECK(0 == memcmp(check.data(), store.data(), length));
+  }
+
+  std::cout << "Testing reopening the overlay ..." << std::endl;
+  {
+    llfio::algorithm::cow_overlay_handle_adapter<llfio::file_handle, llfio::file_handle> h(&deltah, &baseh, llfio::file_handle::mode::write,
+                                                                                          llfio::file_handle::flag::none, nullptr, &bitmaph, blocksize);
+    const size_t length = (size_t) h.maximum_extent().value();
+    BOOST_CHECK(h.read(0, {{check.data(), testbytes * 2}}).value() == length);
+    BOOST_CHECK(0 == memcmp(check.data(), store.data(), length));
+    // A different block size is refused
+    llfio::algorithm::cow_overlay_handle_adapter<llfio::file_handle, llfio::file_handle> h2(&deltah, &baseh, llfio::file_handle::mode::write,
+                                                                                           llfio::file_handle::flag::none, nullptr, &bitmaph, blocksize * 2);
+    BOOST_CHECK(!h2.maximum_extent());
+  }
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, cow_overlay_handle_adapter, works, "Tests that the copy on write overlay handle adapter works as expected",
+                       TestCOWOverlayHandleAdapter())
@@ -0,0 +1,201 @@
+/* Integration test kernel for the erasure coded handle adapter
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+
+#include "../test_kernel_decl.hpp"
+
+#include "quickcpplib/algorithm/small_prng.hpp"
+
+static inline void TestGF256()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  using llfio::byte;
+  using QUICKCPPLIB_NAMESPACE::algorithm::small_prng::small_prng;
+  std::cout << "GF(2^8) implementation is " << llfio::algorithm::gf256_implementation() << std::endl;
+  // Check multiplication against shift and add
+  auto slowmul = [](uint8_t a, uint8_t b) {
+    uint8_t ret = 0;
+    while(b != 0)
+    {
+      if(b & 1)
+      {
+        ret ^= a;
+      }
+      a = (uint8_t) ((a << 1) ^ ((a & 0x80) ? 0x1d : 0));
+      b >>= 1;
+    }
+    return ret;
+  };
+  for(unsigned a = 0; a < 256; a++)
+  {
+    for(unsigned b = 0; b < 256; b++)
+    {
+      if(llfio::algorithm::gf256_mul((uint8_t) a, (uint8_t) b) != slowmul((uint8_t) a, (uint8_t) b))
+      {
+        BOOST_CHECK(llfio::algorithm::gf256_mul((uint8_t) a, (uint8_t) b) == slowmul((uint8_t) a, (uint8_t) b));
+        break;
+      }
+    }
+    if(a != 0)
+    {
+      BOOST_CHECK(llfio::algorithm::gf256_mul((uint8_t) a, llfio::algorithm::gf256_inverse((uint8_t) a)) == 1);
+    }
+  }
+  // Check the vector kernel at every alignment and length around its block sizes
+  small_prng rand;
+  std::vector<byte> in(4096), out(4096), expected(4096);
+  for(auto &i : in)
+  {
+    i = (byte) rand();
+  }
+  for(size_t i = 0; i < 2000; i++)
+  {
+    const size_t inoffset = rand() % 64, outoffset = rand() % 64, bytes = rand() % 1024;
+    const auto c = (uint8_t) rand();
+    for(auto &o : out)
+    {
+      o = (byte) rand();
+    }
+    expected = out;
+    for(size_t n = 0; n < bytes; n++)
+    {
+      expected[outoffset + n] ^= (byte) slowmul(c, (uint8_t) in[inoffset + n]);
+    }
+    llfio::algorithm::gf256_mul_add(out.data() + outoffset, in.data() + inoffset, c, bytes);
+    if(out != expected)
+    {
+      BOOST_CHECK(out == expected);
+      break;
+    }
+  }
+}
+
+static inline void TestErasureCodedHandleAdapter(size_t data_handles, size_t parity_handles)
+{
+  static constexpr size_t testbytes = 4 * 1024 * 1024UL, chunk_size = 65536;
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  using llfio::byte;
+  using QUICKCPPLIB_NAMESPACE::algorithm::small_prng::small_prng;
+  const size_t handles_count = data_handles + parity_handles;
+  std::cout << "Testing " << data_handles << " data handles with " << parity_handles << " parity handles ..." << std::endl;
+  std::vector<llfio::file_handle> fhs(handles_count);
+  std::vector<llfio::file_handle *> hs(handles_count);
+  for(size_t n = 0; n < handles_count; n++)
+  {
+    fhs[n] = llfio::file_handle::temp_inode().value();
+    hs[n] = &fhs[n];
+  }
+  llfio::mapped<byte> store(testbytes), check(testbytes + chunk_size * data_handles);
+  {
+    auto src = llfio::fast_random_file_handle::fast_random_file(testbytes).value();
+    BOOST_REQUIRE(src.read(0, {{store.data(), store.size()}}).value() == testbytes);
+  }
+  llfio::algorithm::erasure_coded_handle_adapter<> h({hs.data(), handles_count}, data_handles, chunk_size);
+  BOOST_CHECK(h.handles().size() == data_handles);
+  BOOST_CHECK(h.parity_handles().size() == parity_handles);
+
+  // Leaves the end of the file part way through a stripe row
+  size_t length = testbytes - chunk_size * data_handles - 1000;
+  BOOST_CHECK(h.write(0, {{store.data(), 12345}, {store.data() + 12345, length - 12345}}).value() == length);
+  BOOST_CHECK(h.maximum_extent().value() == length);
+  small_prng rand;
+  for(size_t i = 0; i < 200; i++)
+  {
+    size_t offset = rand() % length, bytes = rand() % (chunk_size * (data_handles + 2));
+    if(i & 1)
+    {
+      bytes = std::min(bytes, length - offset);
+      for(size_t n = 0; n < bytes; n++)
+      {
+        store[offset + n] = (byte) rand();
+      }
+      BOOST_CHECK(h.write(offset, {{store.data() + offset, bytes}}).value() == bytes);
+    }
+    else
+    {
+      auto bytesread = h.read(offset, {{check.data(), bytes}}).value();
+      BOOST_CHECK(bytesread == std::min(bytes, length - offset));
+      BOOST_CHECK(0 == memcmp(check.data(), store.data() + offset, bytesread));
+    }
+  }
+  // Extend with a hole, then truncate back into the final row, keeping the end non-zero
+  BOOST_CHECK(h.write(length + 50000, {{store.data(), 100}}).value() == 100);
+  BOOST_CHECK(h.truncate(length).value() == length);
+  BOOST_CHECK(h.zero({12345, 99999}).value() > 0);
+  memset(store.data() + 12345, 0, 99999);
+
+  // A closed handle fails all i/o, which simulates a failed device. Replacing it with a
+  // new empty handle and rebuilding restores redundancy.
+  auto verify = [&](const char *what) {
+    auto bytesread = h.read(0, {{check.data(), check.size()}});
+    BOOST_REQUIRE(bytesread);
+    BOOST_CHECK(bytesread.value() >= length);
+    if(0 != memcmp(check.data(), store.data(), length))
+    {
+      std::cout << "   " << what << " read did not match" << std::endl;
+      BOOST_CHECK(false);
+    }
+  };
+  auto fail = [&](size_t n) { fhs[n].close().value(); };
+  auto replace = [&](size_t n) {
+    fhs[n] = llfio::file_handle::temp_inode().value();
+    h.rebuild(n).value();
+  };
+  verify("healthy");
+  const size_t endholder = ((length - 1) / chunk_size) % data_handles;
+  for(size_t n = 0; n < handles_count; n++)
+  {
+    fail(n);
+    if(parity_handles > 1)
+    {
+      fail((n + 1 == handles_count) ? 0 : n + 1);
+    }
+    verify("degraded");
+    BOOST_CHECK(!h.write(0, {{store.data(), 100}}));
+    replace(n);
+    if(parity_handles > 1)
+    {
+      replace((n + 1 == handles_count) ? 0 : n + 1);
+    }
+    BOOST_CHECK(h.maximum_extent().value() == length);
+    verify("rebuilt");
+  }
+  // The data handle holding the end of the file is rebuilt to the right length, and parity is still consistent
+  fail(endholder);
+  verify("degraded after rebuilds");
+  replace(endholder);
+  // Too many failures is an error
+  for(size_t n = 0; n <= parity_handles; n++)
+  {
+    fail(n);
+  }
+  BOOST_CHECK(!h.read(0, {{check.data(), check.size()}}));
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, erasure_coded_handle_adapter, gf256, "Tests that the GF(2^8) arithmetic works as expected", TestGF256())
+KERNELTEST_TEST_KERNEL(integration, llfio, erasure_coded_handle_adapter, xor, "Tests that the erasure coded handle adapter works as expected with one parity handle",
+                       TestErasureCodedHandleAdapter(3, 1))
+KERNELTEST_TEST_KERNEL(integration, llfio, erasure_coded_handle_adapter, reed_solomon,
+                       "Tests that the erasure coded handle adapter works as expected with several parity handles", TestErasureCodedHandleAdapter(4, 2))
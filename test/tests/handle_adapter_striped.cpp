@@ -0,0 +1,138 @@
+/* Integration test kernel for the striped handle adapter
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#include "../test_kernel_decl.hpp"
+
+#include "quickcpplib/algorithm/small_prng.hpp"
+
+static inline void TestStripedHandleAdapter()
+{
+  static constexpr size_t testbytes = 4 * 1024 * 1024UL, chunk_size = 65536, handles_count = 3;
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  using llfio::byte;
+  using QUICKCPPLIB_NAMESPACE::algorithm::small_prng::small_prng;
+  llfio::file_handle fhs[handles_count];
+  llfio::file_handle *hs[handles_count];
+  for(size_t n = 0; n < handles_count; n++)
+  {
+    fhs[n] = llfio::file_handle::temp_inode().value();
+    hs[n] = &fhs[n];
+  }
+  llfio::mapped<byte> store(testbytes), check(testbytes);
+  {
+    auto src = llfio::fast_random_file_handle::fast_random_file(testbytes).value();
+    BOOST_REQUIRE(src.read(0, {{store.data(), store.size()}}).value() == testbytes);
+  }
+  llfio::algorithm::striped_handle_adapter<> h({hs, handles_count}, chunk_size);
+  BOOST_CHECK(h.chunk_size() == chunk_size);
+  BOOST_CHECK(h.is_readable());
+  BOOST_CHECK(h.is_writable());
+
+  std::cout << "Testing writes and reads ..." << std::endl;
+  // Leaves the end of the file within the second handle's chunk
+  const size_t length = testbytes - chunk_size * 2 + 1000;
+  BOOST_CHECK(h.write(0, {{store.data(), 12345}, {store.data() + 12345, length - 12345}}).value() == length);
+  BOOST_CHECK(h.maximum_extent().value() == length);
+  {
+    const size_t rows = length / (chunk_size * handles_count), rem = length % (chunk_size * handles_count);
+    for(size_t n = 0; n < handles_count; n++)
+    {
+      const size_t expected = rows * chunk_size + std::min(chunk_size, (rem > n * chunk_size) ? rem - n * chunk_size : 0);
+      BOOST_CHECK(fhs[n].maximum_extent().value() == expected);
+    }
+  }
+  // The second chunk of the logical file is the first chunk of the second handle
+  BOOST_CHECK(fhs[1].read(0, {{check.data(), chunk_size}}).value() == chunk_size);
+  BOOST_CHECK(0 == memcmp(check.data(), store.data() + chunk_size, chunk_size));
+  BOOST_CHECK(h.read(0, {{check.data(), testbytes}}).value() == length);
+  BOOST_CHECK(0 == memcmp(check.data(), store.data(), length));
+  small_prng rand;
+  for(size_t i = 0; i < 1000; i++)
+  {
+    size_t offset = rand() % length, bytes = rand() % (chunk_size * 5);
+    if(i & 1)
+    {
+      bytes = std::min(bytes, length - offset);
+      for(size_t n = 0; n < bytes; n++)
+      {
+        store[offset + n] = (byte) rand();
+      }
+      BOOST_CHECK(h.write(offset, {{store.data() + offset, bytes}}).value() == bytes);
+    }
+    else
+    {
+      // Scatter the read across two buffers
+      const size_t split = bytes / 3;
+      auto bytesread = h.read(offset, {{check.data(), split}, {check.data() + split, bytes - split}}).value();
+      BOOST_CHECK(bytesread == std::min(bytes, length - offset));
+      BOOST_CHECK(0 == memcmp(check.data(), store.data() + offset, bytesread));
+    }
+  }
+  BOOST_CHECK(h.read(length, {{check.data(), 100}}).value() == 0);
+
+  std::cout << "Testing holes, extension and truncation ..." << std::endl;
+  // Writing past the end leaves the other handles short, and the gap must read as zeros
+  const size_t holeoffset = testbytes + chunk_size * 2 + 100;
+  BOOST_CHECK(h.write(holeoffset, {{store.data(), 100}}).value() == 100);
+  BOOST_CHECK(h.maximum_extent().value() == holeoffset + 100);
+  BOOST_CHECK(h.read(length, {{check.data(), testbytes}}).value() == holeoffset + 100 - length);
+  for(size_t n = 0; n < holeoffset - length; n++)
+  {
+    if(check[n] != (byte) 0)
+    {
+      BOOST_CHECK(check[n] == (byte) 0);
+      break;
+    }
+  }
+  BOOST_CHECK(0 == memcmp(check.data() + holeoffset - length, store.data(), 100));
+  BOOST_CHECK(h.truncate(length - 5000).value() == length - 5000);
+  BOOST_CHECK(h.maximum_extent().value() == length - 5000);
+  BOOST_CHECK(h.read(0, {{check.data(), testbytes}}).value() == length - 5000);
+  BOOST_CHECK(0 == memcmp(check.data(), store.data(), length - 5000));
+
+  std::cout << "Testing extents ..." << std::endl;
+  {
+    const size_t extentlength = chunk_size * handles_count * 4;
+    BOOST_REQUIRE(h.truncate(extentlength).value() == extentlength);
+    BOOST_REQUIRE(h.write(0, {{store.data(), extentlength}}).value() == extentlength);
+    auto exts = h.extents().value();
+    BOOST_REQUIRE(exts.size() == 1);
+    BOOST_CHECK(exts[0].offset == 0);
+    BOOST_CHECK(exts[0].length == extentlength);
+  }
+
+  std::cout << "Testing byte range locks ..." << std::endl;
+  {
+    auto g = h.lock_file_range(chunk_size / 2, chunk_size * 2, llfio::lock_kind::exclusive).value();
+    BOOST_CHECK(g.handle() == &h);
+    BOOST_CHECK(std::get<0>(g.extent()) == chunk_size / 2);
+    BOOST_CHECK(std::get<1>(g.extent()) == chunk_size * 2);
+  }
+  auto g = h.lock_file_range(0, 0, llfio::lock_kind::shared).value();
+  g.unlock();
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, striped_handle_adapter, works, "Tests that the striped handle adapter works as expected",
+                       TestStripedHandleAdapter())
@@ -86,6 +86,46 @@ static inline void TestXorHandleAdapterWorks()
   // TODO Test writing works
 }
 
+static inline void TestCombiningKernelsWork()
+{
+  static constexpr size_t testbytes = 8192;
+  using namespace LLFIO_V2_NAMESPACE;
+  using LLFIO_V2_NAMESPACE::byte;
+  using QUICKCPPLIB_NAMESPACE::algorithm::small_prng::small_prng;
+  std::cout << "Using combining kernels " << algorithm::combine_kernels_implementation() << std::endl;
+  byte a[testbytes], b[testbytes], out[testbytes], check[testbytes];
+  small_prng rand;
+  for(size_t n = 0; n < testbytes; n++)
+  {
+    a[n] = (byte) rand();
+    b[n] = (byte) rand();
+  }
+  // Every combination of misalignment and tail length must go through the kernels correctly
+  for(size_t i = 0; i < 10000; i++)
+  {
+    size_t offseta = rand() % 64, offsetb = rand() % 64, offsetout = rand() % 64, length = rand() % (testbytes - 64);
+    memset(out, 0, testbytes);
+    memset(check, 0, testbytes);
+    algorithm::combine_xor(out + offsetout, a + offseta, b + offsetb, length);
+    for(size_t n = 0; n < length; n++)
+    {
+      check[offsetout + n] = a[offseta + n] ^ b[offsetb + n];
+    }
+    BOOST_CHECK(0 == memcmp(out, check, testbytes));
+    algorithm::combine_add(out + offsetout, a + offseta, b + offsetb, length);
+    for(size_t n = 0; n < length; n++)
+    {
+      check[offsetout + n] = (byte) (uint8_t) ((uint8_t) a[offseta + n] + (uint8_t) b[offsetb + n]);
+    }
+    BOOST_CHECK(0 == memcmp(out, check, testbytes));
+    memcpy(out, a, testbytes);
+    size_t differs = rand() % testbytes;
+    out[differs] ^= (byte) 1;
+    BOOST_CHECK(algorithm::combine_compare(a + offseta, out + offseta, length) ==
+                ((differs >= offseta && differs - offseta < length) ? (differs - offseta) : length));
+  }
+}
+
 #if 0
 static inline void TestFastRandomFileHandlePerformance()
 {
@@ -137,4 +177,5 @@ static inline void TestFastRandomFileHandlePerformance()
 #endif
 
 KERNELTEST_TEST_KERNEL(integration, llfio, xor_handle_adapter, works, "Tests that the xor handle adapter works as expected", TestXorHandleAdapterWorks())
+KERNELTEST_TEST_KERNEL(integration, llfio, xor_handle_adapter, kernels, "Tests that the combining kernels work as expected", TestCombiningKernelsWork())
 // KERNELTEST_TEST_KERNEL(integration, llfio, fast_random_file_handle, performance, "Tests the performance of the fast random file handle", TestFastRandomFileHandlePerformance())
@@ -0,0 +1,71 @@
+/* Integration test kernel for the parallel copy engine
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#include "../test_kernel_decl.hpp"
+
+static inline void TestParallelCopy()
+{
+  static constexpr size_t testbytes = 24 * 1024 * 1024UL + 12345, holeoffset = 8 * 1024 * 1024UL, holebytes = 4 * 1024 * 1024UL;
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  using llfio::byte;
+  auto src = llfio::file_handle::temp_inode().value();
+  llfio::mapped<byte> store(testbytes), check(testbytes);
+  {
+    auto rnd = llfio::fast_random_file_handle::fast_random_file(testbytes).value();
+    BOOST_REQUIRE(rnd.read(0, {{store.data(), store.size()}}).value() == testbytes);
+    memset(store.data() + holeoffset, 0, holebytes);
+    BOOST_REQUIRE(src.write(0, {{store.data(), holeoffset}}).value() == holeoffset);
+    BOOST_REQUIRE(src.write(holeoffset + holebytes, {{store.data() + holeoffset + holebytes, testbytes - holeoffset - holebytes}}).value() ==
+                  testbytes - holeoffset - holebytes);
+  }
+  auto test = [&](const char *desc, llfio::algorithm::parallel_copy_config c) {
+    std::cout << "Testing " << desc << " ..." << std::endl;
+    auto dest = llfio::file_handle::temp_inode().value();
+    // Existing content in the destination must be replaced
+    BOOST_REQUIRE(dest.write(0, {{check.data(), 65536}}).value() == 65536);
+    llfio::file_handle::clone_method method = llfio::file_handle::clone_method::none;
+    BOOST_REQUIRE(llfio::algorithm::parallel_copy(src, dest, c, {}, &method).value() == testbytes);
+    std::cout << "   reflinked = " << !!(method & llfio::file_handle::clone_method::reflinked)
+              << " kernel copied = " << !!(method & llfio::file_handle::clone_method::kernel_copied)
+              << " copied = " << !!(method & llfio::file_handle::clone_method::copied) << std::endl;
+    BOOST_CHECK(method != llfio::file_handle::clone_method::none);
+    BOOST_REQUIRE(dest.maximum_extent().value() == testbytes);
+    memset(check.data(), 0xff, check.size());
+    BOOST_REQUIRE(dest.read(0, {{check.data(), check.size()}}).value() == testbytes);
+    BOOST_CHECK(0 == memcmp(check.data(), store.data(), testbytes));
+  };
+  llfio::algorithm::parallel_copy_config c;
+  c.chunk_size = 1024 * 1024;
+  c.concurrency = 4;
+  test("kernel copy", c);
+  c.use_kernel_copy = false;
+  test("read and write", c);
+  c.direct_io = true;
+  test("uncached read and write", c);
+  c.pace_io = false;
+  test("unpaced uncached read and write", c);
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, algorithm, parallel_copy, "Tests that algorithm::parallel_copy works as expected", TestParallelCopy())
@@ -0,0 +1,99 @@
+/* Integration test kernel for the read ahead stream
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../test_kernel_decl.hpp"
+
+#include "quickcpplib/algorithm/small_prng.hpp"
+
+static inline void TestReadaheadStream()
+{
+  static constexpr size_t testbytes = 16 * 1024 * 1024UL + 12345, buffer_size = 256 * 1024UL;
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  using llfio::byte;
+  using QUICKCPPLIB_NAMESPACE::algorithm::small_prng::small_prng;
+  auto fh = llfio::file_handle::temp_inode().value();
+  llfio::mapped<byte> store(testbytes);
+  {
+    auto src = llfio::fast_random_file_handle::fast_random_file(testbytes).value();
+    BOOST_REQUIRE(src.read(0, {{store.data(), store.size()}}).value() == testbytes);
+    BOOST_REQUIRE(fh.write(0, {{store.data(), store.size()}}).value() == testbytes);
+  }
+  llfio::algorithm::readahead_stream::config c;
+  c.buffer_size = buffer_size;
+  c.buffers = 8;
+
+  std::cout << "Testing sequential reads ..." << std::endl;
+  {
+    auto ras = llfio::algorithm::readahead_stream::create(fh, c).value();
+    size_t offset = 0;
+    for(;;)
+    {
+      auto v = ras.read(offset, 10000).value();
+      if(v.empty())
+      {
+        break;
+      }
+      BOOST_REQUIRE(offset + v.size() <= testbytes);
+      BOOST_CHECK(0 == memcmp(v.data(), store.data() + offset, v.size()));
+      offset += v.size();
+    }
+    BOOST_CHECK(offset == testbytes);
+    auto stats = ras.stats();
+    std::cout << "   hits = " << stats.hits << " waits = " << stats.waits << " misses = " << stats.misses << " prefetches = " << stats.prefetches << std::endl;
+    BOOST_CHECK(stats.prefetches > 0);
+    BOOST_CHECK(stats.hits + stats.waits > stats.misses);
+  }
+
+  std::cout << "Testing strided reads ..." << std::endl;
+  {
+    auto ras = llfio::algorithm::readahead_stream::create(fh, c).value();
+    static constexpr size_t stride = 1024 * 1024UL;
+    for(size_t offset = 4096; offset + 512 <= testbytes; offset += stride)
+    {
+      auto v = ras.read(offset, 512).value();
+      BOOST_CHECK(v.size() == 512);
+      BOOST_CHECK(0 == memcmp(v.data(), store.data() + offset, v.size()));
+    }
+    auto stats = ras.stats();
+    std::cout << "   hits = " << stats.hits << " waits = " << stats.waits << " misses = " << stats.misses << " prefetches = " << stats.prefetches << std::endl;
+    BOOST_CHECK(stats.prefetches > 0);
+  }
+
+  std::cout << "Testing random reads ..." << std::endl;
+  {
+    auto ras = llfio::algorithm::readahead_stream::create(fh, c).value();
+    small_prng rand;
+    for(size_t n = 0; n < 10000; n++)
+    {
+      size_t offset = rand() % testbytes, length = rand() % 8192;
+      auto v = ras.read(offset, length).value();
+      BOOST_CHECK(v.size() <= length);
+      BOOST_CHECK(offset + v.size() <= testbytes);
+      BOOST_CHECK(0 == memcmp(v.data(), store.data() + offset, v.size()));
+    }
+    BOOST_CHECK(ras.read(testbytes, 100).value().empty());
+  }
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, algorithm, readahead, "Tests that algorithm::readahead_stream works as expected", TestReadaheadStream())
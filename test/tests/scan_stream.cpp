@@ -0,0 +1,109 @@
+/* Integration test kernel for the scan stream
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../test_kernel_decl.hpp"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+static inline void TestScanStream()
+{
+  static constexpr size_t testbytes = 16 * 1024 * 1024UL, hotbytes = 4 * 1024 * 1024UL, chunk_size = 1024 * 1024UL;
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  using llfio::byte;
+  auto fh = llfio::file_handle::temp_inode().value();
+  llfio::mapped<byte> store(testbytes), check(testbytes);
+  {
+    auto src = llfio::fast_random_file_handle::fast_random_file(testbytes).value();
+    BOOST_REQUIRE(src.read(0, {{store.data(), store.size()}}).value() == testbytes);
+    BOOST_REQUIRE(fh.write(0, {{store.data(), store.size()}}).value() == testbytes);
+    // Pages must be clean to be droppable
+    fh.barrier({}, llfio::file_handle::barrier_kind::wait_data_only).value();
+  }
+  auto residency = [&](size_t offset, size_t bytes) -> double {
+#ifndef _WIN32
+    const size_t pagesize = llfio::utils::page_size();
+    std::vector<unsigned char> vec(bytes / pagesize);
+    void *addr = ::mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fh.native_handle().fd, (off_t) offset);
+    BOOST_REQUIRE(addr != MAP_FAILED);
+#ifdef __linux__
+    ::mincore(addr, bytes, vec.data());
+#else
+    ::mincore(addr, bytes, (char *) vec.data());
+#endif
+    ::munmap(addr, bytes);
+    size_t resident = 0;
+    for(auto &i : vec)
+    {
+      resident += (i & 1);
+    }
+    return (double) resident / vec.size();
+#else
+    (void) offset;
+    (void) bytes;
+    return 1.0;
+#endif
+  };
+  auto scan = [&](bool drop_preexisting_pages) {
+    llfio::algorithm::scan_stream::config c;
+    c.chunk_size = chunk_size;
+    c.drop_preexisting_pages = drop_preexisting_pages;
+    llfio::algorithm::scan_stream ss(fh, 0, c);
+    for(size_t offset = 0; offset < testbytes; offset += 65536)
+    {
+      BOOST_CHECK(ss.read(offset, {{check.data() + offset, 65536}}).value() == 65536);
+    }
+    ss.finish().value();
+    BOOST_CHECK(ss.consumed_offset() == testbytes);
+    BOOST_CHECK(0 == memcmp(check.data(), store.data(), testbytes));
+    return ss.stats();
+  };
+
+  std::cout << "Scanning file which is wholly resident ..." << std::endl;
+  auto stats = scan(false);
+  std::cout << "   dropped = " << stats.pages_dropped << " preserved = " << stats.pages_preserved << std::endl;
+  BOOST_CHECK(stats.pages_dropped == 0);
+  BOOST_CHECK(residency(0, testbytes) == 1.0);
+
+  std::cout << "Scanning file dropping all pages ..." << std::endl;
+  stats = scan(true);
+  std::cout << "   dropped = " << stats.pages_dropped << " preserved = " << stats.pages_preserved
+            << " residency afterwards = " << residency(0, testbytes) << std::endl;
+#ifndef _WIN32
+  BOOST_CHECK(stats.pages_dropped == testbytes / llfio::utils::page_size());
+#endif
+
+  std::cout << "Scanning file with a hot region ..." << std::endl;
+  BOOST_REQUIRE(fh.read(0, {{check.data(), hotbytes}}).value() == hotbytes);
+  stats = scan(false);
+  std::cout << "   dropped = " << stats.pages_dropped << " preserved = " << stats.pages_preserved << " hot residency afterwards = " << residency(0, hotbytes)
+            << " cold residency afterwards = " << residency(hotbytes, testbytes - hotbytes) << std::endl;
+  BOOST_CHECK(residency(0, hotbytes) == 1.0);
+#ifndef _WIN32
+  BOOST_CHECK(stats.pages_preserved >= hotbytes / llfio::utils::page_size());
+#endif
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, algorithm, scan_stream, "Tests that algorithm::scan_stream works as expected", TestScanStream())
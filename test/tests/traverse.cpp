@@ -194,6 +194,21 @@ static inline void TestTraverse()
   {
     BOOST_CHECK(visitor_st.max_depth == visitor_mt.max_depth);
   }
+
+#ifndef LLFIO_EXCLUDE_DYNAMIC_THREAD_POOL_GROUP
+  std::cout << "Traversing " << to_traverse_path << " using a supplied dynamic thread pool group ..." << std::endl;
+  {
+    auto group = make_dynamic_thread_pool_group().value();
+    my_traverse_visitor visitor_g;
+    auto items_g = algorithm::traverse(*group, to_traverse, &visitor_g).value();
+    BOOST_CHECK(abs((int) items_st - (int) items_g) < 5);
+    BOOST_CHECK(abs((int) visitor_st.items_enumerated - (int) visitor_g.items_enumerated) < 5);
+    // The group is reusable afterwards
+    my_traverse_visitor visitor_g2;
+    auto items_g2 = algorithm::traverse(*group, to_traverse, &visitor_g2, 4).value();
+    BOOST_CHECK(abs((int) items_g - (int) items_g2) < 5);
+  }
+#endif
 }
 
 KERNELTEST_TEST_KERNEL(integration, llfio, algorithm, traverse, "Tests that llfio::algorithm::traverse() works as expected", TestTraverse())
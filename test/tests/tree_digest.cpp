@@ -0,0 +1,122 @@
+/* Integration test kernel for algorithm::tree_digest()
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#include "../test_kernel_decl.hpp"
+
+#include <thread>
+
+static inline void TestTreeDigest()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  auto treeh = llfio::directory_handle::temp_directory().value();
+  auto storeh = llfio::directory_handle::temp_directory().value();
+  auto untempdir = llfio::make_scope_exit([&]() noexcept {
+    (void) llfio::algorithm::reduce(std::move(treeh));
+    (void) llfio::algorithm::reduce(std::move(storeh));
+  });
+  auto write = [&](llfio::path_view path, size_t bytes, int seed) {
+    std::vector<llfio::byte> buffer(bytes);
+    for(size_t n = 0; n < bytes; n++)
+    {
+      buffer[n] = (llfio::byte) (n * 31 + seed);
+    }
+    auto fh = llfio::file_handle::file(treeh, path, llfio::file_handle::mode::write, llfio::file_handle::creation::if_needed).value();
+    fh.truncate(0).value();
+    fh.write(0, {{buffer.data(), buffer.size()}}).value();
+  };
+  llfio::directory_handle::directory(treeh, "a", llfio::directory_handle::mode::write, llfio::directory_handle::creation::if_needed).value();
+  llfio::directory_handle::directory(treeh, "a/b", llfio::directory_handle::mode::write, llfio::directory_handle::creation::if_needed).value();
+  llfio::directory_handle::directory(treeh, "empty", llfio::directory_handle::mode::write, llfio::directory_handle::creation::if_needed).value();
+  write("empty_file", 0, 1);
+  write("small", 1000, 2);
+  write("a/big", 10000, 3);
+  write("a/b/x", 4096, 4);
+  write("a/b/y", 8192, 5);
+
+  llfio::algorithm::tree_digest_config config;
+  config.chunk_size = 4096;  // so files are split into multiple chunks
+  auto first = llfio::algorithm::tree_digest(treeh, storeh, "digest", config).value();
+  std::cout << "First run hashed " << first.files_hashed << " files, reused " << first.files_reused << std::endl;
+  BOOST_CHECK(first.files.size() == 5);
+  BOOST_CHECK(first.files_hashed == 5);
+  BOOST_CHECK(first.files_reused == 0);
+  BOOST_CHECK(first.files_failed == 0);
+  BOOST_CHECK(first.bytes_hashed == 23288);
+
+  auto second = llfio::algorithm::tree_digest(treeh, storeh, "digest", config).value();
+  std::cout << "Second run hashed " << second.files_hashed << " files, reused " << second.files_reused << std::endl;
+  BOOST_CHECK(second.files_hashed == 0);
+  BOOST_CHECK(second.files_reused == 5);
+  BOOST_CHECK(second.root == first.root);
+
+  // Without a store, and single threaded, the digest must be the same
+  config.threads = 1;
+  auto unstored = llfio::algorithm::tree_digest(treeh, config).value();
+  config.threads = 0;
+  BOOST_CHECK(unstored.files_hashed == 5);
+  BOOST_CHECK(unstored.root == first.root);
+
+  // Timestamps may be as coarse as the kernel tick
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  write("a/b/x", 4096, 9);
+  auto modified = llfio::algorithm::tree_digest(treeh, storeh, "digest", config).value();
+  std::cout << "Modified run hashed " << modified.files_hashed << " files, reused " << modified.files_reused << std::endl;
+  BOOST_CHECK(modified.files_hashed == 1);
+  BOOST_CHECK(modified.files_reused == 4);
+  BOOST_CHECK(modified.root != first.root);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  write("a/b/x", 4096, 4);
+  auto restored = llfio::algorithm::tree_digest(treeh, storeh, "digest", config).value();
+  BOOST_CHECK(restored.files_hashed == 1);
+  BOOST_CHECK(restored.root == first.root);
+
+  // Files at the top of the tree are digested like any other
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  write("small", 1000, 9);
+  auto toplevel = llfio::algorithm::tree_digest(treeh, storeh, "digest", config).value();
+  BOOST_CHECK(toplevel.files_hashed == 1);
+  BOOST_CHECK(toplevel.root != first.root);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  write("small", 1000, 2);
+  auto retoplevel = llfio::algorithm::tree_digest(treeh, storeh, "digest", config).value();
+  BOOST_CHECK(retoplevel.files_hashed == 1);
+  BOOST_CHECK(retoplevel.root == first.root);
+
+  // Directory structure is part of the digest
+  llfio::directory_handle::directory(treeh, "empty2", llfio::directory_handle::mode::write, llfio::directory_handle::creation::if_needed).value();
+  auto restructured = llfio::algorithm::tree_digest(treeh, storeh, "digest", config).value();
+  BOOST_CHECK(restructured.files_hashed == 0);
+  BOOST_CHECK(restructured.root != first.root);
+
+  // A different chunk size invalidates the store
+  config.chunk_size = 8192;
+  auto rechunked = llfio::algorithm::tree_digest(treeh, storeh, "digest", config).value();
+  BOOST_CHECK(rechunked.files_hashed == 5);
+  BOOST_CHECK(rechunked.files_reused == 0);
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, algorithm, tree_digest, "Tests that algorithm::tree_digest() works as expected", TestTreeDigest())
@@ -0,0 +1,68 @@
+/* Integration test kernel for the write behind stream
+(C) 2026 Niall Douglas <http://www.nedproductions.biz/> (1 commit)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../test_kernel_decl.hpp"
+
+static inline void TestWriteBehindStream()
+{
+  static constexpr size_t testbytes = 16 * 1024 * 1024UL, chunk_size = 256 * 1024UL, writesize = 100000;
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  using llfio::byte;
+  auto fh = llfio::file_handle::temp_inode().value();
+  llfio::fast_random_file_handle src = llfio::fast_random_file_handle::fast_random_file(testbytes).value();
+  llfio::mapped<byte> store(testbytes), check(testbytes);
+  BOOST_CHECK(src.read(0, {{store.data(), store.size()}}).value() == testbytes);
+
+  for(bool drop : {false, true})
+  {
+    std::cout << "Testing write behind stream with drop_written_pages = " << drop << std::endl;
+    fh.truncate(0).value();
+    llfio::algorithm::write_behind_stream::config c;
+    c.chunk_size = chunk_size;
+    c.dirty_chunks = 4;
+    c.drop_written_pages = drop;
+    llfio::algorithm::write_behind_stream wbs(fh, 0, c);
+    for(size_t offset = 0; offset < testbytes; offset += writesize)
+    {
+      const size_t towrite = std::min(writesize, testbytes - offset);
+      BOOST_CHECK(wbs.write(offset, {{store.data() + offset, towrite}}).value() == towrite);
+      BOOST_REQUIRE(wbs.written_offset() == offset + towrite);
+      // The dirty window must never exceed the configured bound
+      BOOST_CHECK(wbs.submitted_offset() - wbs.retired_offset() <= chunk_size * c.dirty_chunks);
+      BOOST_CHECK(wbs.dirty_bytes() <= chunk_size * (c.dirty_chunks + 1));
+      BOOST_CHECK(wbs.written_offset() - wbs.submitted_offset() < chunk_size);
+    }
+    // Writing behind the cursor does not move the window
+    const auto retired = wbs.retired_offset();
+    BOOST_CHECK(wbs.write(0, {{store.data(), 4096}}).value() == 4096);
+    BOOST_CHECK(wbs.retired_offset() == retired);
+    wbs.flush().value();
+    BOOST_CHECK(wbs.retired_offset() == testbytes);
+    BOOST_CHECK(wbs.dirty_bytes() == 0);
+    BOOST_CHECK(fh.read(0, {{check.data(), check.size()}}).value() == testbytes);
+    BOOST_CHECK(0 == memcmp(check.data(), store.data(), testbytes));
+  }
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, algorithm, write_behind, "Tests that algorithm::write_behind_stream works as expected", TestWriteBehindStream())